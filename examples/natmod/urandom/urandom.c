@@ -3,18 +3,18 @@
 
 #include "py/dynruntime.h"
 
-// Dynamic native modules don't support a data section so these must go in the BSS
-uint32_t yasmarang_pad, yasmarang_n, yasmarang_d;
-uint8_t yasmarang_dat;
+// Dynamic native modules don't support a data section so this must go in the BSS
+uint32_t urandom_state[4];
 
 #include "extmod/modurandom.c"
 
 mp_obj_t mpy_init(mp_obj_fun_bc_t *self, size_t n_args, size_t n_kw, mp_obj_t *args) {
     MP_DYNRUNTIME_INIT_ENTRY
 
-    yasmarang_pad = 0xeda4baba;
-    yasmarang_n = 69;
-    yasmarang_d = 233;
+    urandom_state[0] = 0x64625032;
+    urandom_state[1] = 0xd9c0799c;
+    urandom_state[2] = 0xaf362e10;
+    urandom_state[3] = 0x7fa88912;
 
     mp_store_global(MP_QSTR___name__, MP_OBJ_NEW_QSTR(MP_QSTR_urandom));
     mp_store_global(MP_QSTR_getrandbits, MP_OBJ_FROM_PTR(&mod_urandom_getrandbits_obj));
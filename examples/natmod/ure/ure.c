@@ -32,6 +32,16 @@ void *memmove(void *dest, const void *src, size_t n) {
     return mp_fun_table.memmove_(dest, src, n);
 }
 
+void *memchr(const void *s, int c, size_t n) {
+    const unsigned char *p = s;
+    for (; n--; ++p) {
+        if (*p == (unsigned char)c) {
+            return (void *)p;
+        }
+    }
+    return NULL;
+}
+
 mp_obj_type_t match_type;
 mp_obj_type_t re_type;
 
@@ -36,6 +36,7 @@
 #include "py/mphal.h"
 
 #include "lib/netutils/netutils.h"
+#include "extmod/socket_stats.h"
 
 #include "lwip/init.h"
 #include "lwip/tcp.h"
@@ -311,6 +312,10 @@ typedef struct _lwip_socket_obj_t {
     #define STATE_ACTIVE_UDP 5
     // Negative value is lwIP error
     int8_t state;
+
+    #if MICROPY_PY_USOCKET_STATS
+    mp_socket_stats_t stats;
+    #endif
 } lwip_socket_obj_t;
 
 static inline void poll_sockets(void) {
@@ -821,6 +826,9 @@ STATIC mp_obj_t lwip_socket_make_new(const mp_obj_type_t *type, size_t n_args, s
     socket->type = MOD_NETWORK_SOCK_STREAM;
     socket->callback = MP_OBJ_NULL;
     socket->state = STATE_NEW;
+    #if MICROPY_PY_USOCKET_STATS
+    memset(&socket->stats, 0, sizeof(socket->stats));
+    #endif
 
     if (n_args >= 1) {
         socket->domain = mp_obj_get_int(args[0]);
@@ -959,6 +967,9 @@ STATIC mp_obj_t lwip_socket_accept(mp_obj_t self_in) {
     // exception when the LWIP concurrency lock is held
     lwip_socket_obj_t *socket2 = m_new_obj_with_finaliser(lwip_socket_obj_t);
     socket2->base.type = &lwip_socket_type;
+    #if MICROPY_PY_USOCKET_STATS
+    memset(&socket2->stats, 0, sizeof(socket2->stats));
+    #endif
 
     MICROPY_PY_LWIP_ENTER
 
@@ -1138,6 +1149,7 @@ STATIC mp_obj_t lwip_socket_send(mp_obj_t self_in, mp_obj_t buf_in) {
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
 
+    MP_SOCKET_STATS_START(socket->timeout != 0);
     mp_uint_t ret = 0;
     switch (socket->type) {
         case MOD_NETWORK_SOCK_STREAM: {
@@ -1151,6 +1163,7 @@ STATIC mp_obj_t lwip_socket_send(mp_obj_t self_in, mp_obj_t buf_in) {
             ret = lwip_raw_udp_send(socket, bufinfo.buf, bufinfo.len, NULL, 0, &_errno);
             break;
     }
+    MP_SOCKET_STATS_RECORD(&socket->stats, MP_SOCKET_STATS_OUT, ret, ret == -1 ? _errno : 0);
     if (ret == -1) {
         mp_raise_OSError(_errno);
     }
@@ -1169,6 +1182,7 @@ STATIC mp_obj_t lwip_socket_recv(mp_obj_t self_in, mp_obj_t len_in) {
     vstr_t vstr;
     vstr_init_len(&vstr, len);
 
+    MP_SOCKET_STATS_START(socket->timeout != 0);
     mp_uint_t ret = 0;
     switch (socket->type) {
         case MOD_NETWORK_SOCK_STREAM: {
@@ -1182,6 +1196,7 @@ STATIC mp_obj_t lwip_socket_recv(mp_obj_t self_in, mp_obj_t len_in) {
             ret = lwip_raw_udp_receive(socket, (byte *)vstr.buf, len, NULL, NULL, &_errno);
             break;
     }
+    MP_SOCKET_STATS_RECORD(&socket->stats, MP_SOCKET_STATS_IN, ret, ret == -1 ? _errno : 0);
     if (ret == -1) {
         mp_raise_OSError(_errno);
     }
@@ -1206,6 +1221,7 @@ STATIC mp_obj_t lwip_socket_sendto(mp_obj_t self_in, mp_obj_t data_in, mp_obj_t
     uint8_t ip[NETUTILS_IPV4ADDR_BUFSIZE];
     mp_uint_t port = netutils_parse_inet_addr(addr_in, ip, NETUTILS_BIG);
 
+    MP_SOCKET_STATS_START(socket->timeout != 0);
     mp_uint_t ret = 0;
     switch (socket->type) {
         case MOD_NETWORK_SOCK_STREAM: {
@@ -1219,6 +1235,7 @@ STATIC mp_obj_t lwip_socket_sendto(mp_obj_t self_in, mp_obj_t data_in, mp_obj_t
             ret = lwip_raw_udp_send(socket, bufinfo.buf, bufinfo.len, ip, port, &_errno);
             break;
     }
+    MP_SOCKET_STATS_RECORD(&socket->stats, MP_SOCKET_STATS_OUT, ret, ret == -1 ? _errno : 0);
     if (ret == -1) {
         mp_raise_OSError(_errno);
     }
@@ -1239,6 +1256,7 @@ STATIC mp_obj_t lwip_socket_recvfrom(mp_obj_t self_in, mp_obj_t len_in) {
     byte ip[4];
     mp_uint_t port;
 
+    MP_SOCKET_STATS_START(socket->timeout != 0);
     mp_uint_t ret = 0;
     switch (socket->type) {
         case MOD_NETWORK_SOCK_STREAM: {
@@ -1254,6 +1272,7 @@ STATIC mp_obj_t lwip_socket_recvfrom(mp_obj_t self_in, mp_obj_t len_in) {
             ret = lwip_raw_udp_receive(socket, (byte *)vstr.buf, len, ip, &port, &_errno);
             break;
     }
+    MP_SOCKET_STATS_RECORD(&socket->stats, MP_SOCKET_STATS_IN, ret, ret == -1 ? _errno : 0);
     if (ret == -1) {
         mp_raise_OSError(_errno);
     }
@@ -1294,7 +1313,9 @@ STATIC mp_obj_t lwip_socket_sendall(mp_obj_t self_in, mp_obj_t buf_in) {
             // TODO: In CPython3.5, socket timeout should apply to the
             // entire sendall() operation, not to individual send() chunks.
             while (bufinfo.len != 0) {
+                MP_SOCKET_STATS_START(socket->timeout != 0);
                 ret = lwip_tcp_send(socket, bufinfo.buf, bufinfo.len, &_errno);
+                MP_SOCKET_STATS_RECORD(&socket->stats, MP_SOCKET_STATS_OUT, ret, ret == -1 ? _errno : 0);
                 if (ret == -1) {
                     mp_raise_OSError(_errno);
                 }
@@ -1312,6 +1333,14 @@ STATIC mp_obj_t lwip_socket_sendall(mp_obj_t self_in, mp_obj_t buf_in) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(lwip_socket_sendall_obj, lwip_socket_sendall);
 
+#if MICROPY_PY_USOCKET_STATS
+STATIC mp_obj_t lwip_socket_stats(size_t n_args, const mp_obj_t *args) {
+    lwip_socket_obj_t *socket = MP_OBJ_TO_PTR(args[0]);
+    return mp_socket_stats_get(&socket->stats, n_args - 1, args + 1);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lwip_socket_stats_obj, 1, 2, lwip_socket_stats);
+#endif
+
 STATIC mp_obj_t lwip_socket_settimeout(mp_obj_t self_in, mp_obj_t timeout_in) {
     lwip_socket_obj_t *socket = MP_OBJ_TO_PTR(self_in);
     mp_uint_t timeout;
@@ -1400,33 +1429,47 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lwip_socket_makefile_obj, 1, 3, lwip_
 STATIC mp_uint_t lwip_socket_read(mp_obj_t self_in, void *buf, mp_uint_t size, int *errcode) {
     lwip_socket_obj_t *socket = MP_OBJ_TO_PTR(self_in);
 
+    MP_SOCKET_STATS_START(socket->timeout != 0);
+    mp_uint_t ret;
     switch (socket->type) {
         case MOD_NETWORK_SOCK_STREAM:
-            return lwip_tcp_receive(socket, buf, size, errcode);
+            ret = lwip_tcp_receive(socket, buf, size, errcode);
+            break;
         case MOD_NETWORK_SOCK_DGRAM:
         #if MICROPY_PY_LWIP_SOCK_RAW
         case MOD_NETWORK_SOCK_RAW:
         #endif
-            return lwip_raw_udp_receive(socket, buf, size, NULL, NULL, errcode);
+            ret = lwip_raw_udp_receive(socket, buf, size, NULL, NULL, errcode);
+            break;
+        default:
+            // Unreachable
+            return MP_STREAM_ERROR;
     }
-    // Unreachable
-    return MP_STREAM_ERROR;
+    MP_SOCKET_STATS_RECORD(&socket->stats, MP_SOCKET_STATS_IN, ret, ret == MP_STREAM_ERROR ? *errcode : 0);
+    return ret;
 }
 
 STATIC mp_uint_t lwip_socket_write(mp_obj_t self_in, const void *buf, mp_uint_t size, int *errcode) {
     lwip_socket_obj_t *socket = MP_OBJ_TO_PTR(self_in);
 
+    MP_SOCKET_STATS_START(socket->timeout != 0);
+    mp_uint_t ret;
     switch (socket->type) {
         case MOD_NETWORK_SOCK_STREAM:
-            return lwip_tcp_send(socket, buf, size, errcode);
+            ret = lwip_tcp_send(socket, buf, size, errcode);
+            break;
         case MOD_NETWORK_SOCK_DGRAM:
         #if MICROPY_PY_LWIP_SOCK_RAW
         case MOD_NETWORK_SOCK_RAW:
         #endif
-            return lwip_raw_udp_send(socket, buf, size, NULL, 0, errcode);
+            ret = lwip_raw_udp_send(socket, buf, size, NULL, 0, errcode);
+            break;
+        default:
+            // Unreachable
+            return MP_STREAM_ERROR;
     }
-    // Unreachable
-    return MP_STREAM_ERROR;
+    MP_SOCKET_STATS_RECORD(&socket->stats, MP_SOCKET_STATS_OUT, ret, ret == MP_STREAM_ERROR ? *errcode : 0);
+    return ret;
 }
 
 STATIC err_t _lwip_tcp_close_poll(void *arg, struct tcp_pcb *pcb) {
@@ -1564,6 +1607,9 @@ STATIC const mp_rom_map_elem_t lwip_socket_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_setblocking), MP_ROM_PTR(&lwip_socket_setblocking_obj) },
     { MP_ROM_QSTR(MP_QSTR_setsockopt), MP_ROM_PTR(&lwip_socket_setsockopt_obj) },
     { MP_ROM_QSTR(MP_QSTR_makefile), MP_ROM_PTR(&lwip_socket_makefile_obj) },
+    #if MICROPY_PY_USOCKET_STATS
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&lwip_socket_stats_obj) },
+    #endif
 
     { MP_ROM_QSTR(MP_QSTR_read), MP_ROM_PTR(&mp_stream_read_obj) },
     { MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&mp_stream_readinto_obj) },
@@ -1742,6 +1788,9 @@ STATIC const mp_rom_map_elem_t mp_module_lwip_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_callback), MP_ROM_PTR(&mod_lwip_callback_obj) },
     { MP_ROM_QSTR(MP_QSTR_getaddrinfo), MP_ROM_PTR(&lwip_getaddrinfo_obj) },
     { MP_ROM_QSTR(MP_QSTR_print_pcbs), MP_ROM_PTR(&lwip_print_pcbs_obj) },
+    #if MICROPY_PY_USOCKET_STATS
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&mp_socket_stats_global_obj) },
+    #endif
     // objects
     { MP_ROM_QSTR(MP_QSTR_socket), MP_ROM_PTR(&lwip_socket_type) },
     #ifdef MICROPY_PY_LWIP_SLIP
@@ -39,11 +39,12 @@
 // of PEP 272 can be made with a simple wrapper which adds all the
 // needed boilerplate.
 
-// values follow PEP 272
+// values follow PEP 272 (and PyCryptodome for GCM)
 enum {
     UCRYPTOLIB_MODE_ECB = 1,
     UCRYPTOLIB_MODE_CBC = 2,
     UCRYPTOLIB_MODE_CTR = 6,
+    UCRYPTOLIB_MODE_GCM = 11,
 };
 
 struct ctr_params {
@@ -79,6 +80,21 @@ struct mbedtls_aes_ctx_with_key {
 #define AES_CTX_IMPL struct mbedtls_aes_ctx_with_key
 #endif
 
+#if MICROPY_PY_UCRYPTOLIB_AES_BUILTIN
+#if defined(__AES__)
+#include <wmmintrin.h>
+#endif
+
+struct aes_builtin_ctx {
+    // Round keys: 32-bit words for the table-based implementation, or the
+    // bytes taken by the AES-NI instructions.
+    uint32_t rk[60];
+    uint8_t nr; // number of rounds
+    uint8_t iv[16];
+};
+#define AES_CTX_IMPL struct aes_builtin_ctx
+#endif
+
 typedef struct _mp_obj_aes_t {
     mp_obj_base_t base;
     AES_CTX_IMPL ctx;
@@ -102,6 +118,50 @@ static inline struct ctr_params *ctr_params_from_aes(mp_obj_aes_t *o) {
     return (struct ctr_params *)&o[1];
 }
 
+#if MICROPY_PY_UCRYPTOLIB_GCM || MICROPY_PY_UCRYPTOLIB_CHACHA20_POLY1305
+// Authenticated encryption takes additional data to authenticate, then the
+// data to encrypt or decrypt, and then produces or checks the tag.
+enum {
+    AEAD_STATE_AAD,
+    AEAD_STATE_DATA,
+    AEAD_STATE_DONE,
+};
+#endif
+
+#if MICROPY_PY_UCRYPTOLIB_GCM
+struct gcm_params {
+    // The data is encrypted in CTR mode, with counter.
+    struct ctr_params ctr;
+    uint8_t counter[16];
+    // Multiplication table for the hash key of GHASH (or, when PCLMULQDQ is
+    // used, just the key itself).
+    uint64_t htable[32];
+    uint8_t ghash[16]; // GHASH of the data so far
+    uint8_t tag_mask[16]; // encrypted initial counter block
+    uint64_t aad_len;
+    uint64_t data_len;
+    uint8_t state;
+};
+
+// In GCM mode the aes object is followed by gcm_params instead of ctr_params.
+typedef struct _mp_obj_aes_gcm_t {
+    mp_obj_aes_t aes;
+    struct gcm_params gcm;
+} mp_obj_aes_gcm_t;
+
+static inline bool is_gcm_mode(int block_mode) {
+    return block_mode == UCRYPTOLIB_MODE_GCM;
+}
+
+static inline struct gcm_params *gcm_params_from_aes(mp_obj_aes_t *o) {
+    return &((mp_obj_aes_gcm_t *)o)->gcm;
+}
+#else
+static inline bool is_gcm_mode(int block_mode) {
+    return false;
+}
+#endif
+
 #if MICROPY_SSL_AXTLS
 STATIC void aes_initial_set_key_impl(AES_CTX_IMPL *ctx, const uint8_t *key, size_t keysize, const uint8_t iv[16]) {
     assert(16 == keysize || 32 == keysize);
@@ -211,6 +271,664 @@ STATIC void aes_process_ctr_impl(AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *
 
 #endif
 
+#if MICROPY_PY_UCRYPTOLIB_AES_BUILTIN
+// Table-based AES.  Each round of encryption combines SubBytes, ShiftRows and
+// MixColumns into 16 lookups in aes_te0 and its rotations, and decryption
+// likewise uses aes_td0; only 1k is needed for each table.  When compiled for
+// a CPU with the AES-NI instructions (eg with -maes) they are used instead.
+
+STATIC const uint8_t aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+#if !defined(__AES__)
+STATIC const uint8_t aes_inv_sbox[256] = {
+    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38, 0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb,
+    0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87, 0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb,
+    0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d, 0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
+    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2, 0x76, 0x5b, 0xa2, 0x49, 0x6d, 0x8b, 0xd1, 0x25,
+    0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16, 0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92,
+    0x6c, 0x70, 0x48, 0x50, 0xfd, 0xed, 0xb9, 0xda, 0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
+    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a, 0xf7, 0xe4, 0x58, 0x05, 0xb8, 0xb3, 0x45, 0x06,
+    0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02, 0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b,
+    0x3a, 0x91, 0x11, 0x41, 0x4f, 0x67, 0xdc, 0xea, 0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
+    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85, 0xe2, 0xf9, 0x37, 0xe8, 0x1c, 0x75, 0xdf, 0x6e,
+    0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89, 0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b,
+    0xfc, 0x56, 0x3e, 0x4b, 0xc6, 0xd2, 0x79, 0x20, 0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
+    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31, 0xb1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xec, 0x5f,
+    0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d, 0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef,
+    0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0, 0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
+    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26, 0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d,
+};
+STATIC const uint32_t aes_te0[256] = {
+    0xc66363a5, 0xf87c7c84, 0xee777799, 0xf67b7b8d, 0xfff2f20d, 0xd66b6bbd, 0xde6f6fb1, 0x91c5c554,
+    0x60303050, 0x02010103, 0xce6767a9, 0x562b2b7d, 0xe7fefe19, 0xb5d7d762, 0x4dababe6, 0xec76769a,
+    0x8fcaca45, 0x1f82829d, 0x89c9c940, 0xfa7d7d87, 0xeffafa15, 0xb25959eb, 0x8e4747c9, 0xfbf0f00b,
+    0x41adadec, 0xb3d4d467, 0x5fa2a2fd, 0x45afafea, 0x239c9cbf, 0x53a4a4f7, 0xe4727296, 0x9bc0c05b,
+    0x75b7b7c2, 0xe1fdfd1c, 0x3d9393ae, 0x4c26266a, 0x6c36365a, 0x7e3f3f41, 0xf5f7f702, 0x83cccc4f,
+    0x6834345c, 0x51a5a5f4, 0xd1e5e534, 0xf9f1f108, 0xe2717193, 0xabd8d873, 0x62313153, 0x2a15153f,
+    0x0804040c, 0x95c7c752, 0x46232365, 0x9dc3c35e, 0x30181828, 0x379696a1, 0x0a05050f, 0x2f9a9ab5,
+    0x0e070709, 0x24121236, 0x1b80809b, 0xdfe2e23d, 0xcdebeb26, 0x4e272769, 0x7fb2b2cd, 0xea75759f,
+    0x1209091b, 0x1d83839e, 0x582c2c74, 0x341a1a2e, 0x361b1b2d, 0xdc6e6eb2, 0xb45a5aee, 0x5ba0a0fb,
+    0xa45252f6, 0x763b3b4d, 0xb7d6d661, 0x7db3b3ce, 0x5229297b, 0xdde3e33e, 0x5e2f2f71, 0x13848497,
+    0xa65353f5, 0xb9d1d168, 0x00000000, 0xc1eded2c, 0x40202060, 0xe3fcfc1f, 0x79b1b1c8, 0xb65b5bed,
+    0xd46a6abe, 0x8dcbcb46, 0x67bebed9, 0x7239394b, 0x944a4ade, 0x984c4cd4, 0xb05858e8, 0x85cfcf4a,
+    0xbbd0d06b, 0xc5efef2a, 0x4faaaae5, 0xedfbfb16, 0x864343c5, 0x9a4d4dd7, 0x66333355, 0x11858594,
+    0x8a4545cf, 0xe9f9f910, 0x04020206, 0xfe7f7f81, 0xa05050f0, 0x783c3c44, 0x259f9fba, 0x4ba8a8e3,
+    0xa25151f3, 0x5da3a3fe, 0x804040c0, 0x058f8f8a, 0x3f9292ad, 0x219d9dbc, 0x70383848, 0xf1f5f504,
+    0x63bcbcdf, 0x77b6b6c1, 0xafdada75, 0x42212163, 0x20101030, 0xe5ffff1a, 0xfdf3f30e, 0xbfd2d26d,
+    0x81cdcd4c, 0x180c0c14, 0x26131335, 0xc3ecec2f, 0xbe5f5fe1, 0x359797a2, 0x884444cc, 0x2e171739,
+    0x93c4c457, 0x55a7a7f2, 0xfc7e7e82, 0x7a3d3d47, 0xc86464ac, 0xba5d5de7, 0x3219192b, 0xe6737395,
+    0xc06060a0, 0x19818198, 0x9e4f4fd1, 0xa3dcdc7f, 0x44222266, 0x542a2a7e, 0x3b9090ab, 0x0b888883,
+    0x8c4646ca, 0xc7eeee29, 0x6bb8b8d3, 0x2814143c, 0xa7dede79, 0xbc5e5ee2, 0x160b0b1d, 0xaddbdb76,
+    0xdbe0e03b, 0x64323256, 0x743a3a4e, 0x140a0a1e, 0x924949db, 0x0c06060a, 0x4824246c, 0xb85c5ce4,
+    0x9fc2c25d, 0xbdd3d36e, 0x43acacef, 0xc46262a6, 0x399191a8, 0x319595a4, 0xd3e4e437, 0xf279798b,
+    0xd5e7e732, 0x8bc8c843, 0x6e373759, 0xda6d6db7, 0x018d8d8c, 0xb1d5d564, 0x9c4e4ed2, 0x49a9a9e0,
+    0xd86c6cb4, 0xac5656fa, 0xf3f4f407, 0xcfeaea25, 0xca6565af, 0xf47a7a8e, 0x47aeaee9, 0x10080818,
+    0x6fbabad5, 0xf0787888, 0x4a25256f, 0x5c2e2e72, 0x381c1c24, 0x57a6a6f1, 0x73b4b4c7, 0x97c6c651,
+    0xcbe8e823, 0xa1dddd7c, 0xe874749c, 0x3e1f1f21, 0x964b4bdd, 0x61bdbddc, 0x0d8b8b86, 0x0f8a8a85,
+    0xe0707090, 0x7c3e3e42, 0x71b5b5c4, 0xcc6666aa, 0x904848d8, 0x06030305, 0xf7f6f601, 0x1c0e0e12,
+    0xc26161a3, 0x6a35355f, 0xae5757f9, 0x69b9b9d0, 0x17868691, 0x99c1c158, 0x3a1d1d27, 0x279e9eb9,
+    0xd9e1e138, 0xebf8f813, 0x2b9898b3, 0x22111133, 0xd26969bb, 0xa9d9d970, 0x078e8e89, 0x339494a7,
+    0x2d9b9bb6, 0x3c1e1e22, 0x15878792, 0xc9e9e920, 0x87cece49, 0xaa5555ff, 0x50282878, 0xa5dfdf7a,
+    0x038c8c8f, 0x59a1a1f8, 0x09898980, 0x1a0d0d17, 0x65bfbfda, 0xd7e6e631, 0x844242c6, 0xd06868b8,
+    0x824141c3, 0x299999b0, 0x5a2d2d77, 0x1e0f0f11, 0x7bb0b0cb, 0xa85454fc, 0x6dbbbbd6, 0x2c16163a,
+};
+STATIC const uint32_t aes_td0[256] = {
+    0x51f4a750, 0x7e416553, 0x1a17a4c3, 0x3a275e96, 0x3bab6bcb, 0x1f9d45f1, 0xacfa58ab, 0x4be30393,
+    0x2030fa55, 0xad766df6, 0x88cc7691, 0xf5024c25, 0x4fe5d7fc, 0xc52acbd7, 0x26354480, 0xb562a38f,
+    0xdeb15a49, 0x25ba1b67, 0x45ea0e98, 0x5dfec0e1, 0xc32f7502, 0x814cf012, 0x8d4697a3, 0x6bd3f9c6,
+    0x038f5fe7, 0x15929c95, 0xbf6d7aeb, 0x955259da, 0xd4be832d, 0x587421d3, 0x49e06929, 0x8ec9c844,
+    0x75c2896a, 0xf48e7978, 0x99583e6b, 0x27b971dd, 0xbee14fb6, 0xf088ad17, 0xc920ac66, 0x7dce3ab4,
+    0x63df4a18, 0xe51a3182, 0x97513360, 0x62537f45, 0xb16477e0, 0xbb6bae84, 0xfe81a01c, 0xf9082b94,
+    0x70486858, 0x8f45fd19, 0x94de6c87, 0x527bf8b7, 0xab73d323, 0x724b02e2, 0xe31f8f57, 0x6655ab2a,
+    0xb2eb2807, 0x2fb5c203, 0x86c57b9a, 0xd33708a5, 0x302887f2, 0x23bfa5b2, 0x02036aba, 0xed16825c,
+    0x8acf1c2b, 0xa779b492, 0xf307f2f0, 0x4e69e2a1, 0x65daf4cd, 0x0605bed5, 0xd134621f, 0xc4a6fe8a,
+    0x342e539d, 0xa2f355a0, 0x058ae132, 0xa4f6eb75, 0x0b83ec39, 0x4060efaa, 0x5e719f06, 0xbd6e1051,
+    0x3e218af9, 0x96dd063d, 0xdd3e05ae, 0x4de6bd46, 0x91548db5, 0x71c45d05, 0x0406d46f, 0x605015ff,
+    0x1998fb24, 0xd6bde997, 0x894043cc, 0x67d99e77, 0xb0e842bd, 0x07898b88, 0xe7195b38, 0x79c8eedb,
+    0xa17c0a47, 0x7c420fe9, 0xf8841ec9, 0x00000000, 0x09808683, 0x322bed48, 0x1e1170ac, 0x6c5a724e,
+    0xfd0efffb, 0x0f853856, 0x3daed51e, 0x362d3927, 0x0a0fd964, 0x685ca621, 0x9b5b54d1, 0x24362e3a,
+    0x0c0a67b1, 0x9357e70f, 0xb4ee96d2, 0x1b9b919e, 0x80c0c54f, 0x61dc20a2, 0x5a774b69, 0x1c121a16,
+    0xe293ba0a, 0xc0a02ae5, 0x3c22e043, 0x121b171d, 0x0e090d0b, 0xf28bc7ad, 0x2db6a8b9, 0x141ea9c8,
+    0x57f11985, 0xaf75074c, 0xee99ddbb, 0xa37f60fd, 0xf701269f, 0x5c72f5bc, 0x44663bc5, 0x5bfb7e34,
+    0x8b432976, 0xcb23c6dc, 0xb6edfc68, 0xb8e4f163, 0xd731dcca, 0x42638510, 0x13972240, 0x84c61120,
+    0x854a247d, 0xd2bb3df8, 0xaef93211, 0xc729a16d, 0x1d9e2f4b, 0xdcb230f3, 0x0d8652ec, 0x77c1e3d0,
+    0x2bb3166c, 0xa970b999, 0x119448fa, 0x47e96422, 0xa8fc8cc4, 0xa0f03f1a, 0x567d2cd8, 0x223390ef,
+    0x87494ec7, 0xd938d1c1, 0x8ccaa2fe, 0x98d40b36, 0xa6f581cf, 0xa57ade28, 0xdab78e26, 0x3fadbfa4,
+    0x2c3a9de4, 0x5078920d, 0x6a5fcc9b, 0x547e4662, 0xf68d13c2, 0x90d8b8e8, 0x2e39f75e, 0x82c3aff5,
+    0x9f5d80be, 0x69d0937c, 0x6fd52da9, 0xcf2512b3, 0xc8ac993b, 0x10187da7, 0xe89c636e, 0xdb3bbb7b,
+    0xcd267809, 0x6e5918f4, 0xec9ab701, 0x834f9aa8, 0xe6956e65, 0xaaffe67e, 0x21bccf08, 0xef15e8e6,
+    0xbae79bd9, 0x4a6f36ce, 0xea9f09d4, 0x29b07cd6, 0x31a4b2af, 0x2a3f2331, 0xc6a59430, 0x35a266c0,
+    0x744ebc37, 0xfc82caa6, 0xe090d0b0, 0x33a7d815, 0xf104984a, 0x41ecdaf7, 0x7fcd500e, 0x1791f62f,
+    0x764dd68d, 0x43efb04d, 0xccaa4d54, 0xe49604df, 0x9ed1b5e3, 0x4c6a881b, 0xc12c1fb8, 0x4665517f,
+    0x9d5eea04, 0x018c355d, 0xfa877473, 0xfb0b412e, 0xb3671d5a, 0x92dbd252, 0xe9105633, 0x6dd64713,
+    0x9ad7618c, 0x37a10c7a, 0x59f8148e, 0xeb133c89, 0xcea927ee, 0xb761c935, 0xe11ce5ed, 0x7a47b13c,
+    0x9cd2df59, 0x55f2733f, 0x1814ce79, 0x73c737bf, 0x53f7cdea, 0x5ffdaa5b, 0xdf3d6f14, 0x7844db86,
+    0xcaaff381, 0xb968c43e, 0x3824342c, 0xc2a3405f, 0x161dc372, 0xbce2250c, 0x283c498b, 0xff0d9541,
+    0x39a80171, 0x080cb3de, 0xd8b4e49c, 0x6456c190, 0x7bcb8461, 0xd532b670, 0x486c5c74, 0xd0b85742,
+};
+#endif
+
+#define AES_GET32(p) (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 8) | (p)[3])
+#define AES_PUT32(p, v) do { (p)[0] = (v) >> 24; (p)[1] = (v) >> 16; (p)[2] = (v) >> 8; (p)[3] = (v); } while (0)
+#define AES_ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define AES_TE0(x) (aes_te0[(x) & 0xff])
+#define AES_TE1(x) AES_ROR(aes_te0[(x) & 0xff], 8)
+#define AES_TE2(x) AES_ROR(aes_te0[(x) & 0xff], 16)
+#define AES_TE3(x) AES_ROR(aes_te0[(x) & 0xff], 24)
+#define AES_TD0(x) (aes_td0[(x) & 0xff])
+#define AES_TD1(x) AES_ROR(aes_td0[(x) & 0xff], 8)
+#define AES_TD2(x) AES_ROR(aes_td0[(x) & 0xff], 16)
+#define AES_TD3(x) AES_ROR(aes_td0[(x) & 0xff], 24)
+#define AES_SUB(box, a, b, c, d) \
+    ((uint32_t)box[(a) >> 24] << 24 | (uint32_t)box[((b) >> 16) & 0xff] << 16 \
+    | (uint32_t)box[((c) >> 8) & 0xff] << 8 | box[(d) & 0xff])
+
+STATIC void aes_initial_set_key_impl(AES_CTX_IMPL *ctx, const uint8_t *key, size_t keysize, const uint8_t iv[16]) {
+    static const uint8_t rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+    assert(16 == keysize || 32 == keysize);
+    size_t nk = keysize / 4;
+    uint32_t *rk = ctx->rk;
+    ctx->nr = nk + 6;
+    for (size_t i = 0; i < nk; ++i) {
+        rk[i] = AES_GET32(key + 4 * i);
+    }
+    for (size_t i = nk; i < 4 * (ctx->nr + 1u); ++i) {
+        uint32_t t = rk[i - 1];
+        if (i % nk == 0) {
+            t = AES_SUB(aes_sbox, t << 8, t << 8, t << 8, t >> 24) ^ (uint32_t)rcon[i / nk - 1] << 24;
+        } else if (nk == 8 && i % nk == 4) {
+            t = AES_SUB(aes_sbox, t, t, t, t);
+        }
+        rk[i] = rk[i - nk] ^ t;
+    }
+    #if defined(__AES__)
+    for (size_t i = 0; i < 4 * (ctx->nr + 1u); ++i) {
+        rk[i] = MP_HTOBE32(rk[i]);
+    }
+    #endif
+    if (NULL != iv) {
+        memcpy(ctx->iv, iv, sizeof(ctx->iv));
+    }
+}
+
+STATIC void aes_final_set_key_impl(AES_CTX_IMPL *ctx, bool encrypt) {
+    if (encrypt) {
+        return;
+    }
+    // Decryption uses the round keys in reverse order, with InvMixColumns
+    // applied to all but the first and last.
+    uint32_t *rk = ctx->rk;
+    for (size_t i = 0, j = 4 * ctx->nr; i < j; i += 4, j -= 4) {
+        for (size_t k = 0; k < 4; ++k) {
+            uint32_t t = rk[i + k];
+            rk[i + k] = rk[j + k];
+            rk[j + k] = t;
+        }
+    }
+    for (size_t i = 4; i < 4 * ctx->nr; i += 4) {
+        #if defined(__AES__)
+        _mm_storeu_si128((__m128i *)(rk + i), _mm_aesimc_si128(_mm_loadu_si128((const __m128i *)(rk + i))));
+        #else
+        for (size_t k = i; k < i + 4; ++k) {
+            uint32_t w = rk[k];
+            rk[k] = AES_TD0(aes_sbox[w >> 24]) ^ AES_TD1(aes_sbox[(w >> 16) & 0xff])
+                ^ AES_TD2(aes_sbox[(w >> 8) & 0xff]) ^ AES_TD3(aes_sbox[w & 0xff]);
+        }
+        #endif
+    }
+}
+
+#if defined(__AES__)
+
+// Encrypt or decrypt n blocks, four at a time so the AES-NI instructions for
+// different blocks can overlap.
+STATIC void aes_builtin_crypt_blocks(AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *out, size_t n, bool encrypt) {
+    __m128i k[15];
+    size_t nr = ctx->nr;
+    for (size_t r = 0; r <= nr; ++r) {
+        k[r] = _mm_loadu_si128((const __m128i *)(ctx->rk + 4 * r));
+    }
+    while (n > 0) {
+        size_t nb = MIN(n, 4);
+        __m128i b[4];
+        for (size_t i = 0; i < nb; ++i) {
+            b[i] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + 16 * i)), k[0]);
+        }
+        for (size_t r = 1; r < nr; ++r) {
+            for (size_t i = 0; i < nb; ++i) {
+                b[i] = encrypt ? _mm_aesenc_si128(b[i], k[r]) : _mm_aesdec_si128(b[i], k[r]);
+            }
+        }
+        for (size_t i = 0; i < nb; ++i) {
+            b[i] = encrypt ? _mm_aesenclast_si128(b[i], k[nr]) : _mm_aesdeclast_si128(b[i], k[nr]);
+            _mm_storeu_si128((__m128i *)(out + 16 * i), b[i]);
+        }
+        in += 16 * nb;
+        out += 16 * nb;
+        n -= nb;
+    }
+}
+
+#else
+
+STATIC void aes_builtin_encrypt(const AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *out) {
+    const uint32_t *rk = ctx->rk;
+    uint32_t s0 = AES_GET32(in) ^ rk[0];
+    uint32_t s1 = AES_GET32(in + 4) ^ rk[1];
+    uint32_t s2 = AES_GET32(in + 8) ^ rk[2];
+    uint32_t s3 = AES_GET32(in + 12) ^ rk[3];
+    for (size_t r = 1; r < ctx->nr; ++r) {
+        rk += 4;
+        uint32_t t0 = AES_TE0(s0 >> 24) ^ AES_TE1(s1 >> 16) ^ AES_TE2(s2 >> 8) ^ AES_TE3(s3) ^ rk[0];
+        uint32_t t1 = AES_TE0(s1 >> 24) ^ AES_TE1(s2 >> 16) ^ AES_TE2(s3 >> 8) ^ AES_TE3(s0) ^ rk[1];
+        uint32_t t2 = AES_TE0(s2 >> 24) ^ AES_TE1(s3 >> 16) ^ AES_TE2(s0 >> 8) ^ AES_TE3(s1) ^ rk[2];
+        uint32_t t3 = AES_TE0(s3 >> 24) ^ AES_TE1(s0 >> 16) ^ AES_TE2(s1 >> 8) ^ AES_TE3(s2) ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+    rk += 4;
+    AES_PUT32(out, AES_SUB(aes_sbox, s0, s1, s2, s3) ^ rk[0]);
+    AES_PUT32(out + 4, AES_SUB(aes_sbox, s1, s2, s3, s0) ^ rk[1]);
+    AES_PUT32(out + 8, AES_SUB(aes_sbox, s2, s3, s0, s1) ^ rk[2]);
+    AES_PUT32(out + 12, AES_SUB(aes_sbox, s3, s0, s1, s2) ^ rk[3]);
+}
+
+STATIC void aes_builtin_decrypt(const AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *out) {
+    const uint32_t *rk = ctx->rk;
+    uint32_t s0 = AES_GET32(in) ^ rk[0];
+    uint32_t s1 = AES_GET32(in + 4) ^ rk[1];
+    uint32_t s2 = AES_GET32(in + 8) ^ rk[2];
+    uint32_t s3 = AES_GET32(in + 12) ^ rk[3];
+    for (size_t r = 1; r < ctx->nr; ++r) {
+        rk += 4;
+        uint32_t t0 = AES_TD0(s0 >> 24) ^ AES_TD1(s3 >> 16) ^ AES_TD2(s2 >> 8) ^ AES_TD3(s1) ^ rk[0];
+        uint32_t t1 = AES_TD0(s1 >> 24) ^ AES_TD1(s0 >> 16) ^ AES_TD2(s3 >> 8) ^ AES_TD3(s2) ^ rk[1];
+        uint32_t t2 = AES_TD0(s2 >> 24) ^ AES_TD1(s1 >> 16) ^ AES_TD2(s0 >> 8) ^ AES_TD3(s3) ^ rk[2];
+        uint32_t t3 = AES_TD0(s3 >> 24) ^ AES_TD1(s2 >> 16) ^ AES_TD2(s1 >> 8) ^ AES_TD3(s0) ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
+    }
+    rk += 4;
+    AES_PUT32(out, AES_SUB(aes_inv_sbox, s0, s3, s2, s1) ^ rk[0]);
+    AES_PUT32(out + 4, AES_SUB(aes_inv_sbox, s1, s0, s3, s2) ^ rk[1]);
+    AES_PUT32(out + 8, AES_SUB(aes_inv_sbox, s2, s1, s0, s3) ^ rk[2]);
+    AES_PUT32(out + 12, AES_SUB(aes_inv_sbox, s3, s2, s1, s0) ^ rk[3]);
+}
+
+STATIC void aes_builtin_crypt_blocks(AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *out, size_t n, bool encrypt) {
+    for (; n > 0; --n, in += 16, out += 16) {
+        if (encrypt) {
+            aes_builtin_encrypt(ctx, in, out);
+        } else {
+            aes_builtin_decrypt(ctx, in, out);
+        }
+    }
+}
+
+#endif
+
+STATIC void aes_process_ecb_impl(AES_CTX_IMPL *ctx, const uint8_t in[16], uint8_t out[16], bool encrypt) {
+    aes_builtin_crypt_blocks(ctx, in, out, 1, encrypt);
+}
+
+STATIC void aes_process_cbc_impl(AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *out, size_t in_len, bool encrypt) {
+    uint8_t *iv = ctx->iv;
+    for (; in_len >= 16; in_len -= 16, in += 16, out += 16) {
+        if (encrypt) {
+            for (size_t i = 0; i < 16; ++i) {
+                iv[i] ^= in[i];
+            }
+            aes_builtin_crypt_blocks(ctx, iv, iv, 1, true);
+            memcpy(out, iv, 16);
+        } else {
+            // in and out may be the same buffer, so decrypt into a copy
+            uint8_t block[16];
+            aes_builtin_crypt_blocks(ctx, in, block, 1, false);
+            for (size_t i = 0; i < 16; ++i) {
+                block[i] ^= iv[i];
+            }
+            memcpy(iv, in, 16);
+            memcpy(out, block, 16);
+        }
+    }
+}
+
+#endif
+
+// Encrypt n blocks with the encryption key, for counter modes.
+#if MICROPY_PY_UCRYPTOLIB_AES_BUILTIN
+STATIC void aes_encrypt_blocks_impl(AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *out, size_t n) {
+    aes_builtin_crypt_blocks(ctx, in, out, n, true);
+}
+#elif MICROPY_PY_UCRYPTOLIB_GCM
+STATIC void aes_encrypt_blocks_impl(AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *out, size_t n) {
+    for (; n > 0; --n, in += 16, out += 16) {
+        aes_process_ecb_impl(ctx, in, out, true);
+    }
+}
+#endif
+
+#if MICROPY_PY_UCRYPTOLIB_GCM || (MICROPY_PY_UCRYPTOLIB_CTR && MICROPY_PY_UCRYPTOLIB_AES_BUILTIN)
+
+// Number of counter blocks encrypted in one go, so that an implementation
+// which can work on several blocks at once (ie AES-NI) gets to do so.
+#define AES_CTR_BATCH (4)
+
+// XOR in_len bytes from in with the key stream of counter mode, into out.  The
+// last inc_len bytes of counter are incremented after each block: all of them
+// for CTR mode, and 4 of them for GCM.
+STATIC void aes_ctr_xor(AES_CTX_IMPL *ctx, struct ctr_params *ctr_params, uint8_t *counter, size_t inc_len, const uint8_t *in, uint8_t *out, size_t in_len) {
+    size_t n = ctr_params->offset;
+
+    // use up the rest of the current encrypted counter
+    for (; n != 0 && in_len != 0; --in_len) {
+        *out++ = *in++ ^ ctr_params->encrypted_counter[n];
+        n = (n + 1) & 0xf;
+    }
+
+    // uint32_t for the alignment needed by some implementations
+    uint32_t counters[AES_CTR_BATCH * 4];
+    uint32_t key_stream[AES_CTR_BATCH * 4];
+    while (in_len != 0) {
+        size_t nblocks = MIN((in_len + 15) / 16, AES_CTR_BATCH);
+        for (size_t i = 0; i < nblocks; ++i) {
+            memcpy(&counters[i * 4], counter, 16);
+            for (size_t j = 15; ++counter[j] == 0 && j > 16 - inc_len; --j) {
+            }
+        }
+        aes_encrypt_blocks_impl(ctx, (const uint8_t *)counters, (uint8_t *)key_stream, nblocks);
+        const uint8_t *ks = (const uint8_t *)key_stream;
+        size_t len = MIN(in_len, nblocks * 16);
+        for (size_t i = 0; i < len; ++i) {
+            out[i] = in[i] ^ ks[i];
+        }
+        in += len;
+        out += len;
+        in_len -= len;
+        if (len & 0xf) {
+            // keep the rest of the last block for next time
+            n = len & 0xf;
+            memcpy(ctr_params->encrypted_counter, ks + (len & ~0xf), 16);
+        }
+    }
+
+    ctr_params->offset = n;
+}
+
+#endif
+
+#if MICROPY_PY_UCRYPTOLIB_CTR && MICROPY_PY_UCRYPTOLIB_AES_BUILTIN
+STATIC void aes_process_ctr_impl(AES_CTX_IMPL *ctx, const uint8_t *in, uint8_t *out, size_t in_len, struct ctr_params *ctr_params) {
+    aes_ctr_xor(ctx, ctr_params, ctx->iv, 16, in, out, in_len);
+}
+#endif
+
+#if MICROPY_PY_UCRYPTOLIB_GCM
+// GCM: the data is encrypted in counter mode and authenticated with GHASH,
+// which multiplies by the hash key H in GF(2^128).  That's done either with
+// the 4-bit tables of Shoup's method (256 bytes per key), or if compiled for
+// a CPU with PCLMULQDQ (eg with -mpclmul -mssse3) with carry-less multiply.
+
+#if defined(__PCLMUL__) && defined(__SSSE3__)
+#define GCM_USE_PCLMUL (1)
+#include <wmmintrin.h>
+#include <tmmintrin.h>
+#else
+#define GCM_USE_PCLMUL (0)
+#endif
+
+STATIC void gcm_put64(uint8_t *p, uint64_t v) {
+    for (size_t i = 8; i-- > 0; v >>= 8) {
+        p[i] = v;
+    }
+}
+
+#if GCM_USE_PCLMUL
+
+// GHASH works on bit-reflected values, so the bytes are reversed to make the
+// bit order match that of the instructions.
+STATIC __m128i gcm_load(const void *p) {
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p),
+        _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+STATIC void gcm_store(void *p, __m128i v) {
+    _mm_storeu_si128((__m128i *)p, _mm_shuffle_epi8(v,
+        _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)));
+}
+
+// Multiply in GF(2^128), as described in Intel's white paper "Intel
+// Carry-Less Multiplication Instruction and its Usage for Computing the GCM
+// Mode": a 256-bit carry-less product, shifted left one bit for the
+// reflected bit order, then reduced modulo x^128 + x^7 + x^2 + x + 1.
+STATIC __m128i gcm_gfmul(__m128i a, __m128i b) {
+    __m128i lo = _mm_clmulepi64_si128(a, b, 0x00);
+    __m128i mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+    __m128i hi = _mm_clmulepi64_si128(a, b, 0x11);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    // shift the product left by one bit
+    __m128i lo_carry = _mm_srli_epi32(lo, 31);
+    __m128i hi_carry = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    hi = _mm_or_si128(hi, _mm_srli_si128(lo_carry, 12));
+    hi = _mm_or_si128(hi, _mm_slli_si128(hi_carry, 4));
+    lo = _mm_or_si128(lo, _mm_slli_si128(lo_carry, 4));
+
+    // reduce
+    __m128i t = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+    __m128i t_hi = _mm_srli_si128(t, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(t, 12));
+    t = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+    t = _mm_xor_si128(t, t_hi);
+    lo = _mm_xor_si128(lo, t);
+    return _mm_xor_si128(hi, lo);
+}
+
+STATIC void gcm_ghash_init(struct gcm_params *gcm, const uint8_t h[16]) {
+    _mm_storeu_si128((__m128i *)gcm->htable, gcm_load(h));
+}
+
+STATIC void gcm_ghash_blocks(struct gcm_params *gcm, const uint8_t *in, size_t n) {
+    __m128i h = _mm_loadu_si128((const __m128i *)gcm->htable);
+    __m128i x = gcm_load(gcm->ghash);
+    for (; n > 0; --n, in += 16) {
+        x = gcm_gfmul(_mm_xor_si128(x, gcm_load(in)), h);
+    }
+    gcm_store(gcm->ghash, x);
+}
+
+STATIC void gcm_gmult(struct gcm_params *gcm) {
+    __m128i h = _mm_loadu_si128((const __m128i *)gcm->htable);
+    gcm_store(gcm->ghash, gcm_gfmul(gcm_load(gcm->ghash), h));
+}
+
+#else
+
+STATIC uint64_t gcm_get64(const uint8_t *p) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        v = v << 8 | p[i];
+    }
+    return v;
+}
+
+// Reduction of the 4 bits shifted out of the low end at each step.
+STATIC const uint16_t gcm_last4[16] = {
+    0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+    0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0,
+};
+
+// htable holds the low then the high halves of H times each 4-bit value.
+STATIC void gcm_ghash_init(struct gcm_params *gcm, const uint8_t h[16]) {
+    uint64_t *hl = gcm->htable;
+    uint64_t *hh = gcm->htable + 16;
+    uint64_t vh = gcm_get64(h);
+    uint64_t vl = gcm_get64(h + 8);
+    hl[0] = hh[0] = 0;
+    hl[8] = vl;
+    hh[8] = vh;
+    for (size_t i = 4; i > 0; i >>= 1) {
+        uint32_t t = (vl & 1) * 0xe1000000;
+        vl = (vh << 63) | (vl >> 1);
+        vh = (vh >> 1) ^ ((uint64_t)t << 32);
+        hl[i] = vl;
+        hh[i] = vh;
+    }
+    for (size_t i = 2; i <= 8; i *= 2) {
+        for (size_t j = 1; j < i; ++j) {
+            hl[i + j] = hl[i] ^ hl[j];
+            hh[i + j] = hh[i] ^ hh[j];
+        }
+    }
+}
+
+STATIC void gcm_gmult(struct gcm_params *gcm) {
+    const uint64_t *hl = gcm->htable;
+    const uint64_t *hh = gcm->htable + 16;
+    const uint8_t *x = gcm->ghash;
+    size_t nibble = x[15] & 0xf;
+    uint64_t zh = hh[nibble];
+    uint64_t zl = hl[nibble];
+    for (int i = 15; i >= 0; --i) {
+        for (size_t half = (i == 15); half < 2; ++half) {
+            nibble = half ? x[i] >> 4 : x[i] & 0xf;
+            size_t rem = zl & 0xf;
+            zl = (zh << 60) | (zl >> 4);
+            zh = (zh >> 4) ^ ((uint64_t)gcm_last4[rem] << 48);
+            zh ^= hh[nibble];
+            zl ^= hl[nibble];
+        }
+    }
+    gcm_put64(gcm->ghash, zh);
+    gcm_put64(gcm->ghash + 8, zl);
+}
+
+STATIC void gcm_ghash_blocks(struct gcm_params *gcm, const uint8_t *in, size_t n) {
+    for (; n > 0; --n, in += 16) {
+        for (size_t i = 0; i < 16; ++i) {
+            gcm->ghash[i] ^= in[i];
+        }
+        gcm_gmult(gcm);
+    }
+}
+
+#endif
+
+// Add len bytes of data to GHASH, when pos bytes of the current part (the
+// additional data or the ciphertext) have been added so far.  A partial block
+// is XOR'd into the hash straight away, and multiplied once it's complete.
+STATIC void gcm_ghash_update(struct gcm_params *gcm, const uint8_t *in, size_t len, uint64_t pos) {
+    size_t p = pos & 0xf;
+    if (p != 0) {
+        for (; p < 16 && len != 0; ++p, --len) {
+            gcm->ghash[p] ^= *in++;
+        }
+        if (p < 16) {
+            return;
+        }
+        gcm_gmult(gcm);
+    }
+    gcm_ghash_blocks(gcm, in, len / 16);
+    in += len & ~0xf;
+    for (p = 0; p < (len & 0xf); ++p) {
+        gcm->ghash[p] ^= in[p];
+    }
+}
+
+// Pad the current part of the data with zeros to a whole block.
+STATIC void gcm_ghash_pad(struct gcm_params *gcm, uint64_t len) {
+    if (len & 0xf) {
+        gcm_gmult(gcm);
+    }
+}
+
+STATIC void aes_gcm_init(mp_obj_aes_t *self, const uint8_t *nonce, size_t nonce_len) {
+    struct gcm_params *gcm = gcm_params_from_aes(self);
+    static const uint8_t zero[16] = {0};
+    uint32_t block_aligned[4]; // see aes_ctr_xor
+    uint8_t *block = (uint8_t *)block_aligned;
+
+    // the hash key is the encrypted zero block
+    aes_encrypt_blocks_impl(&self->ctx, zero, block, 1);
+    gcm_ghash_init(gcm, block);
+    memset(gcm->ghash, 0, 16);
+
+    // initial counter block, from the nonce
+    if (nonce_len == 12) {
+        memcpy(gcm->counter, nonce, 12);
+        memset(gcm->counter + 12, 0, 3);
+        gcm->counter[15] = 1;
+    } else {
+        gcm_ghash_update(gcm, nonce, nonce_len, 0);
+        gcm_ghash_pad(gcm, nonce_len);
+        memset(block, 0, 8);
+        gcm_put64(block + 8, (uint64_t)nonce_len * 8);
+        gcm_ghash_blocks(gcm, block, 1);
+        memcpy(gcm->counter, gcm->ghash, 16);
+        memset(gcm->ghash, 0, 16);
+    }
+
+    // the initial block masks the tag, and the data uses the following ones
+    gcm->ctr.offset = 0;
+    aes_ctr_xor(&self->ctx, &gcm->ctr, gcm->counter, 4, zero, gcm->tag_mask, 16);
+    gcm->aad_len = 0;
+    gcm->data_len = 0;
+    gcm->state = AEAD_STATE_AAD;
+}
+
+STATIC void aes_gcm_process(mp_obj_aes_t *self, const uint8_t *in, uint8_t *out, size_t in_len, bool encrypt) {
+    struct gcm_params *gcm = gcm_params_from_aes(self);
+    if (gcm->state == AEAD_STATE_AAD) {
+        gcm_ghash_pad(gcm, gcm->aad_len);
+        gcm->state = AEAD_STATE_DATA;
+    }
+    // GHASH is over the ciphertext, so before decrypting (in case in and out
+    // are the same buffer) or after encrypting
+    if (!encrypt) {
+        gcm_ghash_update(gcm, in, in_len, gcm->data_len);
+    }
+    aes_ctr_xor(&self->ctx, &gcm->ctr, gcm->counter, 4, in, out, in_len);
+    if (encrypt) {
+        gcm_ghash_update(gcm, out, in_len, gcm->data_len);
+    }
+    gcm->data_len += in_len;
+}
+
+// Finish the GHASH and turn it into the tag, if not already done.
+STATIC const uint8_t *aes_gcm_tag(mp_obj_aes_t *self) {
+    struct gcm_params *gcm = gcm_params_from_aes(self);
+    if (gcm->state != AEAD_STATE_DONE) {
+        gcm_ghash_pad(gcm, gcm->state == AEAD_STATE_AAD ? gcm->aad_len : gcm->data_len);
+        uint8_t lengths[16];
+        gcm_put64(lengths, gcm->aad_len * 8);
+        gcm_put64(lengths + 8, gcm->data_len * 8);
+        gcm_ghash_blocks(gcm, lengths, 1);
+        for (size_t i = 0; i < 16; ++i) {
+            gcm->ghash[i] ^= gcm->tag_mask[i];
+        }
+        gcm->state = AEAD_STATE_DONE;
+    }
+    return gcm->ghash;
+}
+
+#endif // MICROPY_PY_UCRYPTOLIB_GCM
+
+#if MICROPY_PY_UCRYPTOLIB_GCM || MICROPY_PY_UCRYPTOLIB_CHACHA20_POLY1305
+STATIC void aead_verify(const uint8_t *tag, mp_obj_t tag_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(tag_in, &bufinfo, MP_BUFFER_READ);
+    // compare in constant time, so the time taken doesn't reveal how much of
+    // the tag is correct
+    uint8_t diff = bufinfo.len != 16;
+    for (size_t i = 0; i < 16 && i < bufinfo.len; ++i) {
+        diff |= tag[i] ^ ((const uint8_t *)bufinfo.buf)[i];
+    }
+    if (diff) {
+        mp_raise_ValueError(MP_ERROR_TEXT("MAC check failed"));
+    }
+}
+#endif
+
+// Get where to put the output of processing in_len bytes: out_buf if given,
+// otherwise a new vstr.
+STATIC uint8_t *ucryptolib_out_buf(mp_obj_t out_buf, size_t in_len, vstr_t *vstr) {
+    if (out_buf != MP_OBJ_NULL) {
+        mp_buffer_info_t out_bufinfo;
+        mp_get_buffer_raise(out_buf, &out_bufinfo, MP_BUFFER_WRITE);
+        if (out_bufinfo.len < in_len) {
+            mp_raise_ValueError(MP_ERROR_TEXT("output too small"));
+        }
+        return out_bufinfo.buf;
+    } else {
+        vstr_init_len(vstr, in_len);
+        return (uint8_t *)vstr->buf;
+    }
+}
+
 STATIC mp_obj_t ucryptolib_aes_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     mp_arg_check_num(n_args, n_kw, 2, 3, false);
 
@@ -221,6 +939,9 @@ STATIC mp_obj_t ucryptolib_aes_make_new(const mp_obj_type_t *type, size_t n_args
         case UCRYPTOLIB_MODE_CBC:
         #if MICROPY_PY_UCRYPTOLIB_CTR
         case UCRYPTOLIB_MODE_CTR:
+        #endif
+        #if MICROPY_PY_UCRYPTOLIB_GCM
+        case UCRYPTOLIB_MODE_GCM:
         #endif
             break;
 
@@ -228,7 +949,15 @@ STATIC mp_obj_t ucryptolib_aes_make_new(const mp_obj_type_t *type, size_t n_args
             mp_raise_ValueError(MP_ERROR_TEXT("mode"));
     }
 
-    mp_obj_aes_t *o = m_new_obj_var(mp_obj_aes_t, struct ctr_params, !!is_ctr_mode(block_mode));
+    mp_obj_aes_t *o;
+    #if MICROPY_PY_UCRYPTOLIB_GCM
+    if (is_gcm_mode(block_mode)) {
+        o = &m_new_obj(mp_obj_aes_gcm_t)->aes;
+    } else
+    #endif
+    {
+        o = m_new_obj_var(mp_obj_aes_t, struct ctr_params, !!is_ctr_mode(block_mode));
+    }
     o->base.type = type;
 
     o->block_mode = block_mode;
@@ -245,10 +974,11 @@ STATIC mp_obj_t ucryptolib_aes_make_new(const mp_obj_type_t *type, size_t n_args
     if (n_args > 2 && args[2] != mp_const_none) {
         mp_get_buffer_raise(args[2], &ivinfo, MP_BUFFER_READ);
 
-        if (16 != ivinfo.len) {
+        // the IV is the nonce in GCM mode, which may be any length
+        if (is_gcm_mode(block_mode) ? 0 == ivinfo.len : 16 != ivinfo.len) {
             mp_raise_ValueError(MP_ERROR_TEXT("IV"));
         }
-    } else if (o->block_mode == UCRYPTOLIB_MODE_CBC || is_ctr_mode(o->block_mode)) {
+    } else if (o->block_mode == UCRYPTOLIB_MODE_CBC || is_ctr_mode(o->block_mode) || is_gcm_mode(o->block_mode)) {
         mp_raise_ValueError(MP_ERROR_TEXT("IV"));
     }
 
@@ -256,6 +986,16 @@ STATIC mp_obj_t ucryptolib_aes_make_new(const mp_obj_type_t *type, size_t n_args
         ctr_params_from_aes(o)->offset = 0;
     }
 
+    #if MICROPY_PY_UCRYPTOLIB_GCM
+    if (is_gcm_mode(block_mode)) {
+        // GCM only uses the encryption key, and needs it now to set up GHASH
+        aes_initial_set_key_impl(&o->ctx, keyinfo.buf, keyinfo.len, NULL);
+        aes_final_set_key_impl(&o->ctx, true);
+        aes_gcm_init(o, ivinfo.buf, ivinfo.len);
+        return MP_OBJ_FROM_PTR(o);
+    }
+    #endif
+
     aes_initial_set_key_impl(&o->ctx, keyinfo.buf, keyinfo.len, ivinfo.buf);
 
     return MP_OBJ_FROM_PTR(o);
@@ -273,29 +1013,25 @@ STATIC mp_obj_t aes_process(size_t n_args, const mp_obj_t *args, bool encrypt) {
     mp_buffer_info_t in_bufinfo;
     mp_get_buffer_raise(in_buf, &in_bufinfo, MP_BUFFER_READ);
 
-    if (!is_ctr_mode(self->block_mode) && in_bufinfo.len % 16 != 0) {
+    if (!is_ctr_mode(self->block_mode) && !is_gcm_mode(self->block_mode) && in_bufinfo.len % 16 != 0) {
         mp_raise_ValueError(MP_ERROR_TEXT("blksize % 16"));
     }
 
-    vstr_t vstr;
-    mp_buffer_info_t out_bufinfo;
-    uint8_t *out_buf_ptr;
-
-    if (out_buf != MP_OBJ_NULL) {
-        mp_get_buffer_raise(out_buf, &out_bufinfo, MP_BUFFER_WRITE);
-        if (out_bufinfo.len < in_bufinfo.len) {
-            mp_raise_ValueError(MP_ERROR_TEXT("output too small"));
-        }
-        out_buf_ptr = out_bufinfo.buf;
-    } else {
-        vstr_init_len(&vstr, in_bufinfo.len);
-        out_buf_ptr = (uint8_t *)vstr.buf;
+    #if MICROPY_PY_UCRYPTOLIB_GCM
+    if (is_gcm_mode(self->block_mode) && gcm_params_from_aes(self)->state == AEAD_STATE_DONE) {
+        mp_raise_ValueError(MP_ERROR_TEXT("finished"));
     }
+    #endif
+
+    vstr_t vstr;
+    uint8_t *out_buf_ptr = ucryptolib_out_buf(out_buf, in_bufinfo.len, &vstr);
 
     if (AES_KEYTYPE_NONE == self->key_type) {
-        // always set key for encryption if CTR mode.
-        const bool encrypt_mode = encrypt || is_ctr_mode(self->block_mode);
-        aes_final_set_key_impl(&self->ctx, encrypt_mode);
+        // always set key for encryption if CTR mode; GCM mode already has it.
+        if (!is_gcm_mode(self->block_mode)) {
+            const bool encrypt_mode = encrypt || is_ctr_mode(self->block_mode);
+            aes_final_set_key_impl(&self->ctx, encrypt_mode);
+        }
         self->key_type = encrypt ? AES_KEYTYPE_ENC : AES_KEYTYPE_DEC;
     } else {
         if ((encrypt && self->key_type == AES_KEYTYPE_DEC) ||
@@ -325,6 +1061,12 @@ STATIC mp_obj_t aes_process(size_t n_args, const mp_obj_t *args, bool encrypt) {
                 ctr_params_from_aes(self));
             break;
         #endif
+
+        #if MICROPY_PY_UCRYPTOLIB_GCM
+        case UCRYPTOLIB_MODE_GCM:
+            aes_gcm_process(self, in_bufinfo.buf, out_buf_ptr, in_bufinfo.len, encrypt);
+            break;
+        #endif
     }
 
     if (out_buf != MP_OBJ_NULL) {
@@ -343,9 +1085,57 @@ STATIC mp_obj_t ucryptolib_aes_decrypt(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(ucryptolib_aes_decrypt_obj, 2, 3, ucryptolib_aes_decrypt);
 
+#if MICROPY_PY_UCRYPTOLIB_GCM
+STATIC mp_obj_aes_t *aes_gcm_get(mp_obj_t self_in) {
+    mp_obj_aes_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!is_gcm_mode(self->block_mode)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("mode"));
+    }
+    return self;
+}
+
+STATIC mp_obj_t ucryptolib_aes_update(mp_obj_t self_in, mp_obj_t aad_in) {
+    mp_obj_aes_t *self = aes_gcm_get(self_in);
+    struct gcm_params *gcm = gcm_params_from_aes(self);
+    if (gcm->state != AEAD_STATE_AAD) {
+        mp_raise_ValueError(MP_ERROR_TEXT("update() must come first"));
+    }
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(aad_in, &bufinfo, MP_BUFFER_READ);
+    gcm_ghash_update(gcm, bufinfo.buf, bufinfo.len, gcm->aad_len);
+    gcm->aad_len += bufinfo.len;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(ucryptolib_aes_update_obj, ucryptolib_aes_update);
+
+STATIC mp_obj_t ucryptolib_aes_digest(mp_obj_t self_in) {
+    mp_obj_aes_t *self = aes_gcm_get(self_in);
+    if (self->key_type == AES_KEYTYPE_DEC) {
+        mp_raise_ValueError(MP_ERROR_TEXT("can't encrypt & decrypt"));
+    }
+    return mp_obj_new_bytes(aes_gcm_tag(self), 16);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(ucryptolib_aes_digest_obj, ucryptolib_aes_digest);
+
+STATIC mp_obj_t ucryptolib_aes_verify(mp_obj_t self_in, mp_obj_t tag_in) {
+    mp_obj_aes_t *self = aes_gcm_get(self_in);
+    if (self->key_type == AES_KEYTYPE_ENC) {
+        mp_raise_ValueError(MP_ERROR_TEXT("can't encrypt & decrypt"));
+    }
+    aead_verify(aes_gcm_tag(self), tag_in);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(ucryptolib_aes_verify_obj, ucryptolib_aes_verify);
+#endif
+
 STATIC const mp_rom_map_elem_t ucryptolib_aes_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_encrypt), MP_ROM_PTR(&ucryptolib_aes_encrypt_obj) },
     { MP_ROM_QSTR(MP_QSTR_decrypt), MP_ROM_PTR(&ucryptolib_aes_decrypt_obj) },
+    #if MICROPY_PY_UCRYPTOLIB_GCM
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&ucryptolib_aes_update_obj) },
+    { MP_ROM_QSTR(MP_QSTR_digest), MP_ROM_PTR(&ucryptolib_aes_digest_obj) },
+    { MP_ROM_QSTR(MP_QSTR_verify), MP_ROM_PTR(&ucryptolib_aes_verify_obj) },
+    #endif
 };
 STATIC MP_DEFINE_CONST_DICT(ucryptolib_aes_locals_dict, ucryptolib_aes_locals_dict_table);
 
@@ -356,15 +1146,370 @@ STATIC const mp_obj_type_t ucryptolib_aes_type = {
     .locals_dict = (void *)&ucryptolib_aes_locals_dict,
 };
 
+#if MICROPY_PY_UCRYPTOLIB_CHACHA20_POLY1305
+// ChaCha20-Poly1305 authenticated encryption, as specified by RFC 8439.  It
+// only needs 32-bit additions, rotations and multiplies, so is fast without
+// any special instructions.
+
+typedef struct _mp_obj_chacha20_poly1305_t {
+    mp_obj_base_t base;
+    uint32_t chacha[16]; // ChaCha20 state: constants, key, block counter, nonce
+    uint8_t key_stream[64];
+    uint8_t key_stream_offset;
+    uint8_t key_type;
+    uint8_t state;
+    // Poly1305 state: the key r and accumulator h in 26-bit limbs, and the
+    // final pad s.  The data authenticated is always padded to whole blocks.
+    uint32_t r[5];
+    uint32_t h[5];
+    uint32_t s[4];
+    uint8_t block[16];
+    uint64_t aad_len;
+    uint64_t data_len;
+} mp_obj_chacha20_poly1305_t;
+
+#define CHACHA20_GET32(p) ((uint32_t)(p)[0] | (uint32_t)(p)[1] << 8 | (uint32_t)(p)[2] << 16 | (uint32_t)(p)[3] << 24)
+#define CHACHA20_ROTL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define CHACHA20_QUARTERROUND(a, b, c, d) \
+    a += b; d ^= a; d = CHACHA20_ROTL(d, 16); \
+    c += d; b ^= c; b = CHACHA20_ROTL(b, 12); \
+    a += b; d ^= a; d = CHACHA20_ROTL(d, 8); \
+    c += d; b ^= c; b = CHACHA20_ROTL(b, 7);
+
+// Generate the next 64 bytes of key stream.
+STATIC void chacha20_block(mp_obj_chacha20_poly1305_t *self) {
+    uint32_t x[16];
+    memcpy(x, self->chacha, sizeof(x));
+    for (size_t i = 0; i < 10; ++i) {
+        CHACHA20_QUARTERROUND(x[0], x[4], x[8], x[12]);
+        CHACHA20_QUARTERROUND(x[1], x[5], x[9], x[13]);
+        CHACHA20_QUARTERROUND(x[2], x[6], x[10], x[14]);
+        CHACHA20_QUARTERROUND(x[3], x[7], x[11], x[15]);
+        CHACHA20_QUARTERROUND(x[0], x[5], x[10], x[15]);
+        CHACHA20_QUARTERROUND(x[1], x[6], x[11], x[12]);
+        CHACHA20_QUARTERROUND(x[2], x[7], x[8], x[13]);
+        CHACHA20_QUARTERROUND(x[3], x[4], x[9], x[14]);
+    }
+    for (size_t i = 0; i < 16; ++i) {
+        uint32_t v = x[i] + self->chacha[i];
+        uint8_t *p = self->key_stream + 4 * i;
+        p[0] = v;
+        p[1] = v >> 8;
+        p[2] = v >> 16;
+        p[3] = v >> 24;
+    }
+    ++self->chacha[12];
+    self->key_stream_offset = 0;
+}
+
+STATIC void chacha20_xor(mp_obj_chacha20_poly1305_t *self, const uint8_t *in, uint8_t *out, size_t len) {
+    while (len != 0) {
+        if (self->key_stream_offset == 64) {
+            chacha20_block(self);
+        }
+        size_t n = MIN(len, 64u - self->key_stream_offset);
+        const uint8_t *ks = self->key_stream + self->key_stream_offset;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = in[i] ^ ks[i];
+        }
+        self->key_stream_offset += n;
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+STATIC void poly1305_blocks(mp_obj_chacha20_poly1305_t *self, const uint8_t *in, size_t n) {
+    const uint32_t r0 = self->r[0], r1 = self->r[1], r2 = self->r[2], r3 = self->r[3], r4 = self->r[4];
+    const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = self->h[0], h1 = self->h[1], h2 = self->h[2], h3 = self->h[3], h4 = self->h[4];
+    for (; n > 0; --n, in += 16) {
+        // h += block, with the 2^128 bit set
+        h0 += CHACHA20_GET32(in) & 0x3ffffff;
+        h1 += (CHACHA20_GET32(in + 3) >> 2) & 0x3ffffff;
+        h2 += (CHACHA20_GET32(in + 6) >> 4) & 0x3ffffff;
+        h3 += (CHACHA20_GET32(in + 9) >> 6) & 0x3ffffff;
+        h4 += (CHACHA20_GET32(in + 12) >> 8) | (1 << 24);
+
+        // h *= r, modulo 2^130 - 5
+        uint64_t d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 + (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+        uint64_t d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 + (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+        uint64_t d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 + (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+        uint64_t d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 + (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+        uint64_t d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 + (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+
+        // partially reduce
+        d1 += d0 >> 26;
+        h0 = d0 & 0x3ffffff;
+        d2 += d1 >> 26;
+        h1 = d1 & 0x3ffffff;
+        d3 += d2 >> 26;
+        h2 = d2 & 0x3ffffff;
+        d4 += d3 >> 26;
+        h3 = d3 & 0x3ffffff;
+        h0 += (uint32_t)(d4 >> 26) * 5;
+        h4 = d4 & 0x3ffffff;
+        h1 += h0 >> 26;
+        h0 &= 0x3ffffff;
+    }
+    self->h[0] = h0;
+    self->h[1] = h1;
+    self->h[2] = h2;
+    self->h[3] = h3;
+    self->h[4] = h4;
+}
+
+// Add len bytes of data to Poly1305, when pos bytes of the current part (the
+// additional data or the ciphertext) have been added so far.
+STATIC void poly1305_update(mp_obj_chacha20_poly1305_t *self, const uint8_t *in, size_t len, uint64_t pos) {
+    size_t p = pos & 0xf;
+    if (p != 0) {
+        size_t n = MIN(len, 16 - p);
+        memcpy(self->block + p, in, n);
+        in += n;
+        len -= n;
+        if (p + n < 16) {
+            return;
+        }
+        poly1305_blocks(self, self->block, 1);
+    }
+    poly1305_blocks(self, in, len / 16);
+    memcpy(self->block, in + (len & ~0xf), len & 0xf);
+}
+
+// Pad the current part of the data with zeros to a whole block.
+STATIC void poly1305_pad(mp_obj_chacha20_poly1305_t *self, uint64_t len) {
+    if (len & 0xf) {
+        memset(self->block + (len & 0xf), 0, 16 - (len & 0xf));
+        poly1305_blocks(self, self->block, 1);
+    }
+}
+
+// Finish Poly1305 and store the tag in self->block, if not already done.
+STATIC const uint8_t *chacha20_poly1305_tag(mp_obj_chacha20_poly1305_t *self) {
+    if (self->state == AEAD_STATE_DONE) {
+        return self->block;
+    }
+    poly1305_pad(self, self->state == AEAD_STATE_AAD ? self->aad_len : self->data_len);
+    uint8_t lengths[16];
+    for (size_t i = 0; i < 8; ++i) {
+        lengths[i] = self->aad_len >> (8 * i);
+        lengths[8 + i] = self->data_len >> (8 * i);
+    }
+    poly1305_blocks(self, lengths, 1);
+    self->state = AEAD_STATE_DONE;
+
+    // fully reduce h
+    uint32_t h0 = self->h[0], h1 = self->h[1], h2 = self->h[2], h3 = self->h[3], h4 = self->h[4];
+    h2 += h1 >> 26;
+    h1 &= 0x3ffffff;
+    h3 += h2 >> 26;
+    h2 &= 0x3ffffff;
+    h4 += h3 >> 26;
+    h3 &= 0x3ffffff;
+    h0 += (h4 >> 26) * 5;
+    h4 &= 0x3ffffff;
+    h1 += h0 >> 26;
+    h0 &= 0x3ffffff;
+
+    // compute h - p = h + 5 - 2^130, and use it if it's not negative
+    uint32_t g0 = h0 + 5;
+    uint32_t g1 = h1 + (g0 >> 26);
+    g0 &= 0x3ffffff;
+    uint32_t g2 = h2 + (g1 >> 26);
+    g1 &= 0x3ffffff;
+    uint32_t g3 = h3 + (g2 >> 26);
+    g2 &= 0x3ffffff;
+    uint32_t g4 = h4 + (g3 >> 26) - (1 << 26);
+    g3 &= 0x3ffffff;
+    uint32_t mask = (g4 >> 31) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+
+    // tag = (h + s) mod 2^128
+    uint32_t t[4] = {
+        h0 | h1 << 26,
+        h1 >> 6 | h2 << 20,
+        h2 >> 12 | h3 << 14,
+        h3 >> 18 | h4 << 8,
+    };
+    uint64_t f = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        f += (uint64_t)t[i] + self->s[i];
+        for (size_t j = 0; j < 4; ++j) {
+            self->block[4 * i + j] = f >> (8 * j);
+        }
+        f >>= 32;
+    }
+    return self->block;
+}
+
+STATIC mp_obj_t ucryptolib_chacha20_poly1305_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 2, 2, false);
+
+    mp_buffer_info_t keyinfo;
+    mp_get_buffer_raise(args[0], &keyinfo, MP_BUFFER_READ);
+    if (32 != keyinfo.len) {
+        mp_raise_ValueError(MP_ERROR_TEXT("key"));
+    }
+    mp_buffer_info_t nonceinfo;
+    mp_get_buffer_raise(args[1], &nonceinfo, MP_BUFFER_READ);
+    if (12 != nonceinfo.len) {
+        mp_raise_ValueError(MP_ERROR_TEXT("nonce"));
+    }
+
+    mp_obj_chacha20_poly1305_t *o = m_new_obj(mp_obj_chacha20_poly1305_t);
+    o->base.type = type;
+    o->chacha[0] = 0x61707865; // "expand 32-byte k"
+    o->chacha[1] = 0x3320646e;
+    o->chacha[2] = 0x79622d32;
+    o->chacha[3] = 0x6b206574;
+    for (size_t i = 0; i < 8; ++i) {
+        o->chacha[4 + i] = CHACHA20_GET32((const uint8_t *)keyinfo.buf + 4 * i);
+    }
+    o->chacha[12] = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        o->chacha[13 + i] = CHACHA20_GET32((const uint8_t *)nonceinfo.buf + 4 * i);
+    }
+
+    // the Poly1305 key is the start of the first block of key stream, and
+    // encryption uses the following blocks
+    chacha20_block(o);
+    const uint8_t *k = o->key_stream;
+    o->r[0] = CHACHA20_GET32(k) & 0x3ffffff;
+    o->r[1] = (CHACHA20_GET32(k + 3) >> 2) & 0x3ffff03;
+    o->r[2] = (CHACHA20_GET32(k + 6) >> 4) & 0x3ffc0ff;
+    o->r[3] = (CHACHA20_GET32(k + 9) >> 6) & 0x3f03fff;
+    o->r[4] = (CHACHA20_GET32(k + 12) >> 8) & 0x00fffff;
+    for (size_t i = 0; i < 4; ++i) {
+        o->s[i] = CHACHA20_GET32(k + 16 + 4 * i);
+    }
+    memset(o->h, 0, sizeof(o->h));
+    o->key_stream_offset = 64;
+    o->key_type = AES_KEYTYPE_NONE;
+    o->state = AEAD_STATE_AAD;
+    o->aad_len = 0;
+    o->data_len = 0;
+
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_obj_t chacha20_poly1305_process(size_t n_args, const mp_obj_t *args, bool encrypt) {
+    mp_obj_chacha20_poly1305_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    mp_buffer_info_t in_bufinfo;
+    mp_get_buffer_raise(args[1], &in_bufinfo, MP_BUFFER_READ);
+    mp_obj_t out_buf = n_args > 2 ? args[2] : MP_OBJ_NULL;
+
+    if (self->state == AEAD_STATE_DONE) {
+        mp_raise_ValueError(MP_ERROR_TEXT("finished"));
+    }
+    if (self->key_type == (encrypt ? AES_KEYTYPE_DEC : AES_KEYTYPE_ENC)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("can't encrypt & decrypt"));
+    }
+    self->key_type = encrypt ? AES_KEYTYPE_ENC : AES_KEYTYPE_DEC;
+
+    vstr_t vstr;
+    uint8_t *out = ucryptolib_out_buf(out_buf, in_bufinfo.len, &vstr);
+
+    if (self->state == AEAD_STATE_AAD) {
+        poly1305_pad(self, self->aad_len);
+        self->state = AEAD_STATE_DATA;
+    }
+    // Poly1305 is over the ciphertext (see aes_gcm_process)
+    if (!encrypt) {
+        poly1305_update(self, in_bufinfo.buf, in_bufinfo.len, self->data_len);
+    }
+    chacha20_xor(self, in_bufinfo.buf, out, in_bufinfo.len);
+    if (encrypt) {
+        poly1305_update(self, out, in_bufinfo.len, self->data_len);
+    }
+    self->data_len += in_bufinfo.len;
+
+    if (out_buf != MP_OBJ_NULL) {
+        return out_buf;
+    }
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+
+STATIC mp_obj_t ucryptolib_chacha20_poly1305_encrypt(size_t n_args, const mp_obj_t *args) {
+    return chacha20_poly1305_process(n_args, args, true);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(ucryptolib_chacha20_poly1305_encrypt_obj, 2, 3, ucryptolib_chacha20_poly1305_encrypt);
+
+STATIC mp_obj_t ucryptolib_chacha20_poly1305_decrypt(size_t n_args, const mp_obj_t *args) {
+    return chacha20_poly1305_process(n_args, args, false);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(ucryptolib_chacha20_poly1305_decrypt_obj, 2, 3, ucryptolib_chacha20_poly1305_decrypt);
+
+STATIC mp_obj_t ucryptolib_chacha20_poly1305_update(mp_obj_t self_in, mp_obj_t aad_in) {
+    mp_obj_chacha20_poly1305_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->state != AEAD_STATE_AAD) {
+        mp_raise_ValueError(MP_ERROR_TEXT("update() must come first"));
+    }
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(aad_in, &bufinfo, MP_BUFFER_READ);
+    poly1305_update(self, bufinfo.buf, bufinfo.len, self->aad_len);
+    self->aad_len += bufinfo.len;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(ucryptolib_chacha20_poly1305_update_obj, ucryptolib_chacha20_poly1305_update);
+
+STATIC mp_obj_t ucryptolib_chacha20_poly1305_digest(mp_obj_t self_in) {
+    mp_obj_chacha20_poly1305_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->key_type == AES_KEYTYPE_DEC) {
+        mp_raise_ValueError(MP_ERROR_TEXT("can't encrypt & decrypt"));
+    }
+    return mp_obj_new_bytes(chacha20_poly1305_tag(self), 16);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(ucryptolib_chacha20_poly1305_digest_obj, ucryptolib_chacha20_poly1305_digest);
+
+STATIC mp_obj_t ucryptolib_chacha20_poly1305_verify(mp_obj_t self_in, mp_obj_t tag_in) {
+    mp_obj_chacha20_poly1305_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->key_type == AES_KEYTYPE_ENC) {
+        mp_raise_ValueError(MP_ERROR_TEXT("can't encrypt & decrypt"));
+    }
+    aead_verify(chacha20_poly1305_tag(self), tag_in);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(ucryptolib_chacha20_poly1305_verify_obj, ucryptolib_chacha20_poly1305_verify);
+
+STATIC const mp_rom_map_elem_t ucryptolib_chacha20_poly1305_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_encrypt), MP_ROM_PTR(&ucryptolib_chacha20_poly1305_encrypt_obj) },
+    { MP_ROM_QSTR(MP_QSTR_decrypt), MP_ROM_PTR(&ucryptolib_chacha20_poly1305_decrypt_obj) },
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&ucryptolib_chacha20_poly1305_update_obj) },
+    { MP_ROM_QSTR(MP_QSTR_digest), MP_ROM_PTR(&ucryptolib_chacha20_poly1305_digest_obj) },
+    { MP_ROM_QSTR(MP_QSTR_verify), MP_ROM_PTR(&ucryptolib_chacha20_poly1305_verify_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(ucryptolib_chacha20_poly1305_locals_dict, ucryptolib_chacha20_poly1305_locals_dict_table);
+
+STATIC const mp_obj_type_t ucryptolib_chacha20_poly1305_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_chacha20_poly1305,
+    .make_new = ucryptolib_chacha20_poly1305_make_new,
+    .locals_dict = (void *)&ucryptolib_chacha20_poly1305_locals_dict,
+};
+
+#endif // MICROPY_PY_UCRYPTOLIB_CHACHA20_POLY1305
+
 STATIC const mp_rom_map_elem_t mp_module_ucryptolib_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ucryptolib) },
     { MP_ROM_QSTR(MP_QSTR_aes), MP_ROM_PTR(&ucryptolib_aes_type) },
+    #if MICROPY_PY_UCRYPTOLIB_CHACHA20_POLY1305
+    { MP_ROM_QSTR(MP_QSTR_chacha20_poly1305), MP_ROM_PTR(&ucryptolib_chacha20_poly1305_type) },
+    #endif
     #if MICROPY_PY_UCRYPTOLIB_CONSTS
     { MP_ROM_QSTR(MP_QSTR_MODE_ECB), MP_ROM_INT(UCRYPTOLIB_MODE_ECB) },
     { MP_ROM_QSTR(MP_QSTR_MODE_CBC), MP_ROM_INT(UCRYPTOLIB_MODE_CBC) },
     #if MICROPY_PY_UCRYPTOLIB_CTR
     { MP_ROM_QSTR(MP_QSTR_MODE_CTR), MP_ROM_INT(UCRYPTOLIB_MODE_CTR) },
     #endif
+    #if MICROPY_PY_UCRYPTOLIB_GCM
+    { MP_ROM_QSTR(MP_QSTR_MODE_GCM), MP_ROM_INT(UCRYPTOLIB_MODE_GCM) },
+    #endif
     #endif
 };
 
@@ -63,6 +63,16 @@ typedef struct _mp_obj_hash_t {
     char state[0];
 } mp_obj_hash_t;
 
+// Return a new hash object with a copy of the state of self, which is of the
+// given size.
+STATIC mp_obj_hash_t *uhashlib_copy(mp_obj_t self_in, size_t size) {
+    mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, size);
+    o->base.type = self->base.type;
+    memcpy(o->state, self->state, size);
+    return o;
+}
+
 #if MICROPY_PY_UHASHLIB_SHA256
 STATIC mp_obj_t uhashlib_sha256_update(mp_obj_t self_in, mp_obj_t arg);
 
@@ -98,10 +108,43 @@ STATIC mp_obj_t uhashlib_sha256_digest(mp_obj_t self_in) {
     mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
     vstr_t vstr;
     vstr_init_len(&vstr, 32);
-    mbedtls_sha256_finish_ret((mbedtls_sha256_context *)&self->state, (unsigned char *)vstr.buf);
+    // finish a copy of the state, so more data can still be added
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_clone(&ctx, (mbedtls_sha256_context *)self->state);
+    mbedtls_sha256_finish_ret(&ctx, (unsigned char *)vstr.buf);
+    mbedtls_sha256_free(&ctx);
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
 
+STATIC mp_obj_t uhashlib_sha256_copy(mp_obj_t self_in) {
+    mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, sizeof(mbedtls_sha256_context));
+    o->base.type = self->base.type;
+    mbedtls_sha256_init((mbedtls_sha256_context *)o->state);
+    mbedtls_sha256_clone((mbedtls_sha256_context *)o->state, (mbedtls_sha256_context *)self->state);
+    return MP_OBJ_FROM_PTR(o);
+}
+
+typedef mbedtls_sha256_context uhashlib_sha256_ctx_t;
+
+STATIC void uhashlib_sha256_ctx_init(uhashlib_sha256_ctx_t *ctx) {
+    mbedtls_sha256_init(ctx);
+    mbedtls_sha256_starts_ret(ctx, 0);
+}
+
+// Contexts may refer to hardware state (eg with MBEDTLS_SHA256_ALT), so they
+// must be cloned rather than copied as structs, and freed when done with.
+STATIC void uhashlib_sha256_ctx_copy(uhashlib_sha256_ctx_t *dest, const uhashlib_sha256_ctx_t *src) {
+    mbedtls_sha256_init(dest);
+    mbedtls_sha256_clone(dest, src);
+}
+
+#define uhashlib_sha256_ctx_free mbedtls_sha256_free
+
+#define uhashlib_sha256_ctx_update mbedtls_sha256_update_ret
+#define uhashlib_sha256_ctx_final mbedtls_sha256_finish_ret
+
 #else
 
 #include "crypto-algorithms/sha256.c"
@@ -129,17 +172,34 @@ STATIC mp_obj_t uhashlib_sha256_digest(mp_obj_t self_in) {
     mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
     vstr_t vstr;
     vstr_init_len(&vstr, SHA256_BLOCK_SIZE);
-    sha256_final((CRYAL_SHA256_CTX *)self->state, (byte *)vstr.buf);
+    // finish a copy of the state, so more data can still be added
+    CRYAL_SHA256_CTX ctx = *(CRYAL_SHA256_CTX *)self->state;
+    sha256_final(&ctx, (byte *)vstr.buf);
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
+
+STATIC mp_obj_t uhashlib_sha256_copy(mp_obj_t self_in) {
+    return MP_OBJ_FROM_PTR(uhashlib_copy(self_in, sizeof(CRYAL_SHA256_CTX)));
+}
+
+typedef CRYAL_SHA256_CTX uhashlib_sha256_ctx_t;
+
+#define uhashlib_sha256_ctx_init sha256_init
+#define uhashlib_sha256_ctx_update sha256_update
+#define uhashlib_sha256_ctx_final sha256_final
+#define uhashlib_sha256_ctx_copy(dest, src) (*(dest) = *(src))
+#define uhashlib_sha256_ctx_free(ctx) (void)(ctx)
+
 #endif
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(uhashlib_sha256_update_obj, uhashlib_sha256_update);
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(uhashlib_sha256_digest_obj, uhashlib_sha256_digest);
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(uhashlib_sha256_copy_obj, uhashlib_sha256_copy);
 
 STATIC const mp_rom_map_elem_t uhashlib_sha256_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&uhashlib_sha256_update_obj) },
     { MP_ROM_QSTR(MP_QSTR_digest), MP_ROM_PTR(&uhashlib_sha256_digest_obj) },
+    { MP_ROM_QSTR(MP_QSTR_copy), MP_ROM_PTR(&uhashlib_sha256_copy_obj) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(uhashlib_sha256_locals_dict, uhashlib_sha256_locals_dict_table);
@@ -150,6 +210,194 @@ STATIC const mp_obj_type_t uhashlib_sha256_type = {
     .make_new = uhashlib_sha256_make_new,
     .locals_dict = (void *)&uhashlib_sha256_locals_dict,
 };
+
+#if MICROPY_PY_UHASHLIB_HMAC
+// HMAC-SHA256 keeps the hash states after the inner and outer padded keys,
+// so that each message only costs hashing the message and one more block.
+
+#define HMAC_BLOCK_SIZE (64)
+#define HMAC_DIGEST_SIZE (32)
+
+typedef struct _mp_obj_hmac_t {
+    mp_obj_base_t base;
+    uhashlib_sha256_ctx_t inner;
+    uhashlib_sha256_ctx_t outer;
+} mp_obj_hmac_t;
+
+STATIC void hmac_init(mp_obj_hmac_t *self, const uint8_t *key, size_t key_len) {
+    uint8_t block[HMAC_BLOCK_SIZE];
+    if (key_len > HMAC_BLOCK_SIZE) {
+        // long keys are hashed first
+        uhashlib_sha256_ctx_init(&self->inner);
+        uhashlib_sha256_ctx_update(&self->inner, key, key_len);
+        uhashlib_sha256_ctx_final(&self->inner, block);
+        uhashlib_sha256_ctx_free(&self->inner);
+        key_len = HMAC_DIGEST_SIZE;
+    } else {
+        memcpy(block, key, key_len);
+    }
+    memset(block + key_len, 0, HMAC_BLOCK_SIZE - key_len);
+    for (size_t i = 0; i < HMAC_BLOCK_SIZE; ++i) {
+        block[i] ^= 0x36;
+    }
+    uhashlib_sha256_ctx_init(&self->inner);
+    uhashlib_sha256_ctx_update(&self->inner, block, HMAC_BLOCK_SIZE);
+    for (size_t i = 0; i < HMAC_BLOCK_SIZE; ++i) {
+        block[i] ^= 0x36 ^ 0x5c;
+    }
+    uhashlib_sha256_ctx_init(&self->outer);
+    uhashlib_sha256_ctx_update(&self->outer, block, HMAC_BLOCK_SIZE);
+}
+
+// Finish the HMAC of a message, given the inner hash state after the message
+// has been added to it, which is freed.
+STATIC void hmac_final(mp_obj_hmac_t *self, uhashlib_sha256_ctx_t *inner, uint8_t *out) {
+    uint8_t h[HMAC_DIGEST_SIZE];
+    uhashlib_sha256_ctx_final(inner, h);
+    uhashlib_sha256_ctx_free(inner);
+    uhashlib_sha256_ctx_copy(inner, &self->outer);
+    uhashlib_sha256_ctx_update(inner, h, HMAC_DIGEST_SIZE);
+    uhashlib_sha256_ctx_final(inner, out);
+    uhashlib_sha256_ctx_free(inner);
+}
+
+// Only SHA-256 is supported, given as a name or as the constructor.
+STATIC void hmac_check_digestmod(mp_obj_t digestmod) {
+    if (digestmod != mp_const_none
+        && digestmod != MP_OBJ_FROM_PTR(&uhashlib_sha256_type)
+        && !(mp_obj_is_str(digestmod) && strcmp(mp_obj_str_get_str(digestmod), "sha256") == 0)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("unsupported hash type"));
+    }
+}
+
+STATIC mp_obj_t uhashlib_hmac_update(mp_obj_t self_in, mp_obj_t arg);
+
+STATIC mp_obj_t uhashlib_hmac_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    enum { ARG_key, ARG_msg, ARG_digestmod };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_key, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_msg, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_digestmod, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+    hmac_check_digestmod(vals[ARG_digestmod].u_obj);
+
+    mp_buffer_info_t keyinfo;
+    mp_get_buffer_raise(vals[ARG_key].u_obj, &keyinfo, MP_BUFFER_READ);
+    mp_obj_hmac_t *o = m_new_obj(mp_obj_hmac_t);
+    o->base.type = type;
+    hmac_init(o, keyinfo.buf, keyinfo.len);
+    if (vals[ARG_msg].u_obj != mp_const_none) {
+        uhashlib_hmac_update(MP_OBJ_FROM_PTR(o), vals[ARG_msg].u_obj);
+    }
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_obj_t uhashlib_hmac_update(mp_obj_t self_in, mp_obj_t arg) {
+    mp_obj_hmac_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(arg, &bufinfo, MP_BUFFER_READ);
+    uhashlib_sha256_ctx_update(&self->inner, bufinfo.buf, bufinfo.len);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(uhashlib_hmac_update_obj, uhashlib_hmac_update);
+
+STATIC mp_obj_t uhashlib_hmac_digest(mp_obj_t self_in) {
+    mp_obj_hmac_t *self = MP_OBJ_TO_PTR(self_in);
+    vstr_t vstr;
+    vstr_init_len(&vstr, HMAC_DIGEST_SIZE);
+    uhashlib_sha256_ctx_t inner;
+    uhashlib_sha256_ctx_copy(&inner, &self->inner);
+    hmac_final(self, &inner, (uint8_t *)vstr.buf);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(uhashlib_hmac_digest_obj, uhashlib_hmac_digest);
+
+STATIC mp_obj_t uhashlib_hmac_copy(mp_obj_t self_in) {
+    mp_obj_hmac_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_hmac_t *o = m_new_obj(mp_obj_hmac_t);
+    o->base.type = self->base.type;
+    uhashlib_sha256_ctx_copy(&o->inner, &self->inner);
+    uhashlib_sha256_ctx_copy(&o->outer, &self->outer);
+    return MP_OBJ_FROM_PTR(o);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(uhashlib_hmac_copy_obj, uhashlib_hmac_copy);
+
+STATIC const mp_rom_map_elem_t uhashlib_hmac_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&uhashlib_hmac_update_obj) },
+    { MP_ROM_QSTR(MP_QSTR_digest), MP_ROM_PTR(&uhashlib_hmac_digest_obj) },
+    { MP_ROM_QSTR(MP_QSTR_copy), MP_ROM_PTR(&uhashlib_hmac_copy_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(uhashlib_hmac_locals_dict, uhashlib_hmac_locals_dict_table);
+
+STATIC const mp_obj_type_t uhashlib_hmac_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_hmac,
+    .make_new = uhashlib_hmac_make_new,
+    .locals_dict = (void *)&uhashlib_hmac_locals_dict,
+};
+
+// pbkdf2_hmac(hash_name, password, salt, iterations, dklen=None)
+STATIC mp_obj_t uhashlib_pbkdf2_hmac(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_hash_name, ARG_password, ARG_salt, ARG_iterations, ARG_dklen };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_hash_name, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_password, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_salt, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_iterations, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_dklen, MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+    hmac_check_digestmod(vals[ARG_hash_name].u_obj);
+
+    mp_buffer_info_t password, salt;
+    mp_get_buffer_raise(vals[ARG_password].u_obj, &password, MP_BUFFER_READ);
+    mp_get_buffer_raise(vals[ARG_salt].u_obj, &salt, MP_BUFFER_READ);
+    mp_int_t iterations = vals[ARG_iterations].u_int;
+    mp_int_t dklen = HMAC_DIGEST_SIZE;
+    if (vals[ARG_dklen].u_obj != mp_const_none) {
+        dklen = mp_obj_get_int(vals[ARG_dklen].u_obj);
+    }
+    if (iterations < 1 || dklen < 1) {
+        mp_raise_ValueError(NULL);
+    }
+
+    mp_obj_hmac_t hmac;
+    hmac_init(&hmac, password.buf, password.len);
+    vstr_t vstr;
+    vstr_init_len(&vstr, dklen);
+    uint8_t *out = (uint8_t *)vstr.buf;
+    for (uint32_t block = 1; dklen > 0; ++block) {
+        // U_1 = HMAC(password, salt || INT(block)), T = U_1 ^ U_2 ^ ... ^ U_c
+        uint8_t u[HMAC_DIGEST_SIZE], t[HMAC_DIGEST_SIZE];
+        uint8_t block_be[4] = { block >> 24, block >> 16, block >> 8, block };
+        uhashlib_sha256_ctx_t inner;
+        uhashlib_sha256_ctx_copy(&inner, &hmac.inner);
+        uhashlib_sha256_ctx_update(&inner, salt.buf, salt.len);
+        uhashlib_sha256_ctx_update(&inner, block_be, 4);
+        hmac_final(&hmac, &inner, u);
+        memcpy(t, u, HMAC_DIGEST_SIZE);
+        for (mp_int_t i = 1; i < iterations; ++i) {
+            uhashlib_sha256_ctx_copy(&inner, &hmac.inner);
+            uhashlib_sha256_ctx_update(&inner, u, HMAC_DIGEST_SIZE);
+            hmac_final(&hmac, &inner, u);
+            for (size_t j = 0; j < HMAC_DIGEST_SIZE; ++j) {
+                t[j] ^= u[j];
+            }
+        }
+        size_t n = MIN(dklen, HMAC_DIGEST_SIZE);
+        memcpy(out, t, n);
+        out += n;
+        dklen -= n;
+    }
+    uhashlib_sha256_ctx_free(&hmac.inner);
+    uhashlib_sha256_ctx_free(&hmac.outer);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(uhashlib_pbkdf2_hmac_obj, 0, uhashlib_pbkdf2_hmac);
+#endif // MICROPY_PY_UHASHLIB_HMAC
 #endif
 
 #if MICROPY_PY_UHASHLIB_SHA1
@@ -182,6 +430,10 @@ STATIC mp_obj_t uhashlib_sha1_digest(mp_obj_t self_in) {
     SHA1_Final((byte *)vstr.buf, (SHA1_CTX *)self->state);
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
+
+STATIC mp_obj_t uhashlib_sha1_copy(mp_obj_t self_in) {
+    return MP_OBJ_FROM_PTR(uhashlib_copy(self_in, sizeof(SHA1_CTX)));
+}
 #endif
 
 #if MICROPY_SSL_MBEDTLS
@@ -220,14 +472,25 @@ STATIC mp_obj_t uhashlib_sha1_digest(mp_obj_t self_in) {
     mbedtls_sha1_free((mbedtls_sha1_context *)self->state);
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
+
+STATIC mp_obj_t uhashlib_sha1_copy(mp_obj_t self_in) {
+    mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, sizeof(mbedtls_sha1_context));
+    o->base.type = self->base.type;
+    mbedtls_sha1_init((mbedtls_sha1_context *)o->state);
+    mbedtls_sha1_clone((mbedtls_sha1_context *)o->state, (mbedtls_sha1_context *)self->state);
+    return MP_OBJ_FROM_PTR(o);
+}
 #endif
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(uhashlib_sha1_update_obj, uhashlib_sha1_update);
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(uhashlib_sha1_digest_obj, uhashlib_sha1_digest);
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(uhashlib_sha1_copy_obj, uhashlib_sha1_copy);
 
 STATIC const mp_rom_map_elem_t uhashlib_sha1_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&uhashlib_sha1_update_obj) },
     { MP_ROM_QSTR(MP_QSTR_digest), MP_ROM_PTR(&uhashlib_sha1_digest_obj) },
+    { MP_ROM_QSTR(MP_QSTR_copy), MP_ROM_PTR(&uhashlib_sha1_copy_obj) },
 };
 STATIC MP_DEFINE_CONST_DICT(uhashlib_sha1_locals_dict, uhashlib_sha1_locals_dict_table);
 
@@ -269,6 +532,10 @@ STATIC mp_obj_t uhashlib_md5_digest(mp_obj_t self_in) {
     MD5_Final((byte *)vstr.buf, (MD5_CTX *)self->state);
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
+
+STATIC mp_obj_t uhashlib_md5_copy(mp_obj_t self_in) {
+    return MP_OBJ_FROM_PTR(uhashlib_copy(self_in, sizeof(MD5_CTX)));
+}
 #endif // MICROPY_SSL_AXTLS
 
 #if MICROPY_SSL_MBEDTLS
@@ -307,14 +574,25 @@ STATIC mp_obj_t uhashlib_md5_digest(mp_obj_t self_in) {
     mbedtls_md5_free((mbedtls_md5_context *)self->state);
     return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
 }
+
+STATIC mp_obj_t uhashlib_md5_copy(mp_obj_t self_in) {
+    mp_obj_hash_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_hash_t *o = m_new_obj_var(mp_obj_hash_t, char, sizeof(mbedtls_md5_context));
+    o->base.type = self->base.type;
+    mbedtls_md5_init((mbedtls_md5_context *)o->state);
+    mbedtls_md5_clone((mbedtls_md5_context *)o->state, (mbedtls_md5_context *)self->state);
+    return MP_OBJ_FROM_PTR(o);
+}
 #endif // MICROPY_SSL_MBEDTLS
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(uhashlib_md5_update_obj, uhashlib_md5_update);
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(uhashlib_md5_digest_obj, uhashlib_md5_digest);
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(uhashlib_md5_copy_obj, uhashlib_md5_copy);
 
 STATIC const mp_rom_map_elem_t uhashlib_md5_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_update), MP_ROM_PTR(&uhashlib_md5_update_obj) },
     { MP_ROM_QSTR(MP_QSTR_digest), MP_ROM_PTR(&uhashlib_md5_digest_obj) },
+    { MP_ROM_QSTR(MP_QSTR_copy), MP_ROM_PTR(&uhashlib_md5_copy_obj) },
 };
 STATIC MP_DEFINE_CONST_DICT(uhashlib_md5_locals_dict, uhashlib_md5_locals_dict_table);
 
@@ -330,6 +608,10 @@ STATIC const mp_rom_map_elem_t mp_module_uhashlib_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uhashlib) },
     #if MICROPY_PY_UHASHLIB_SHA256
     { MP_ROM_QSTR(MP_QSTR_sha256), MP_ROM_PTR(&uhashlib_sha256_type) },
+    #if MICROPY_PY_UHASHLIB_HMAC
+    { MP_ROM_QSTR(MP_QSTR_hmac), MP_ROM_PTR(&uhashlib_hmac_type) },
+    { MP_ROM_QSTR(MP_QSTR_pbkdf2_hmac), MP_ROM_PTR(&uhashlib_pbkdf2_hmac_obj) },
+    #endif
     #endif
     #if MICROPY_PY_UHASHLIB_SHA1
     { MP_ROM_QSTR(MP_QSTR_sha1), MP_ROM_PTR(&uhashlib_sha1_type) },
@@ -0,0 +1,461 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+
+#if MICROPY_PY_UHTTP
+
+// Incremental HTTP/1.x message parser, modelled on picohttpparser.
+//
+// The parse functions take a buffer holding the data received so far and
+// return None if the header section is not complete yet.  Otherwise the
+// request line/status line and headers are returned as memoryviews into
+// the buffer, so no header data is copied.  Passing the length of the buffer
+// at the previous (incomplete) attempt as last_len means only new data is
+// scanned for the end of the header section.
+
+typedef struct _uhttp_parser_t {
+    mp_obj_t buf_obj;
+    const byte *buf;
+    size_t buf_len;
+    size_t len; // length of the header section
+    size_t pos;
+} uhttp_parser_t;
+
+STATIC NORETURN void uhttp_raise_bad(void) {
+    mp_raise_ValueError(MP_ERROR_TEXT("bad HTTP message"));
+}
+
+STATIC mp_obj_t uhttp_span(uhttp_parser_t *p, size_t start, size_t end) {
+    #if MICROPY_PY_BUILTINS_MEMORYVIEW
+    return mp_obj_new_memoryview_slice(p->buf_obj, start, end - start);
+    #else
+    return mp_obj_new_bytes(p->buf + start, end - start);
+    #endif
+}
+
+// Characters allowed in a method or header field name (RFC 7230 tchar).
+STATIC bool uhttp_is_tchar(byte c) {
+    if (unichar_isalpha(c) || unichar_isdigit(c)) {
+        return true;
+    }
+    return c != 0 && strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+// Search for the empty line ending the header section, starting the scan a
+// little before last_len.  Returns the length of the header section
+// (including the empty line), or 0 if it isn't complete yet.
+STATIC size_t uhttp_find_header_end(const byte *buf, size_t len, size_t last_len) {
+    size_t pos = last_len < 3 ? 0 : last_len - 3;
+    while (pos < len) {
+        const byte *nl = memchr(buf + pos, '\n', len - pos);
+        if (nl == NULL) {
+            return 0;
+        }
+        pos = nl - buf + 1;
+        if (pos < len && buf[pos] == '\n') {
+            return pos + 1;
+        }
+        if (pos + 1 < len && buf[pos] == '\r' && buf[pos + 1] == '\n') {
+            return pos + 2;
+        }
+    }
+    return 0;
+}
+
+// Returns the position of the end of the current line (before any CR) and
+// advances past its line terminator.
+STATIC size_t uhttp_line_end(uhttp_parser_t *p) {
+    const byte *nl = memchr(p->buf + p->pos, '\n', p->len - p->pos);
+    if (nl == NULL) {
+        uhttp_raise_bad();
+    }
+    size_t end = nl - p->buf;
+    p->pos = end + 1;
+    if (end > 0 && p->buf[end - 1] == '\r') {
+        --end;
+    }
+    return end;
+}
+
+// Parse "HTTP/1.x" at buf[pos:] and return x.
+STATIC mp_int_t uhttp_parse_version(const byte *buf, size_t pos, size_t end) {
+    if (end - pos < 8 || memcmp(buf + pos, "HTTP/1.", 7) != 0 || !unichar_isdigit(buf[pos + 7])) {
+        uhttp_raise_bad();
+    }
+    return buf[pos + 7] - '0';
+}
+
+STATIC mp_obj_t uhttp_parse_header_fields(uhttp_parser_t *p) {
+    mp_obj_t headers = mp_obj_new_list(0, NULL);
+    for (;;) {
+        size_t start = p->pos;
+        size_t end = uhttp_line_end(p);
+        if (end == start) {
+            // empty line, end of headers
+            return headers;
+        }
+        const byte *line = p->buf;
+        size_t colon = start;
+        while (colon < end && uhttp_is_tchar(line[colon])) {
+            ++colon;
+        }
+        if (colon == start || colon == end || line[colon] != ':') {
+            // also rejects obsolete line folding
+            uhttp_raise_bad();
+        }
+        size_t vstart = colon + 1;
+        while (vstart < end && (line[vstart] == ' ' || line[vstart] == '\t')) {
+            ++vstart;
+        }
+        size_t vend = end;
+        while (vend > vstart && (line[vend - 1] == ' ' || line[vend - 1] == '\t')) {
+            --vend;
+        }
+        for (size_t i = vstart; i < vend; ++i) {
+            if ((line[i] < 0x20 && line[i] != '\t') || line[i] == 0x7f) {
+                uhttp_raise_bad();
+            }
+        }
+        mp_obj_t field[2] = { uhttp_span(p, start, colon), uhttp_span(p, vstart, vend) };
+        mp_obj_list_append(headers, mp_obj_new_tuple(2, field));
+    }
+}
+
+// Sets up the parser; returns false if the header section is incomplete.
+STATIC bool uhttp_parser_init(uhttp_parser_t *p, size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    mp_int_t last_len = n_args > 1 ? mp_obj_get_int(args[1]) : 0;
+    if (last_len < 0) {
+        mp_raise_ValueError(NULL);
+    }
+    p->buf_obj = args[0];
+    p->buf = bufinfo.buf;
+    p->buf_len = bufinfo.len;
+    p->pos = 0;
+    p->len = uhttp_find_header_end(bufinfo.buf, bufinfo.len, MIN((size_t)last_len, bufinfo.len));
+    return p->len != 0;
+}
+
+// Skip the empty lines that may precede a request or status line.
+STATIC void uhttp_skip_empty_lines(uhttp_parser_t *p) {
+    while (p->pos < p->len && (p->buf[p->pos] == '\r' || p->buf[p->pos] == '\n')) {
+        ++p->pos;
+    }
+}
+
+// parse_request(buf[, last_len]) -> (method, path, minor_version, headers, header_len)
+STATIC mp_obj_t mod_uhttp_parse_request(size_t n_args, const mp_obj_t *args) {
+    uhttp_parser_t p;
+    if (!uhttp_parser_init(&p, n_args, args)) {
+        return mp_const_none;
+    }
+    uhttp_skip_empty_lines(&p);
+    size_t i = p.pos;
+    size_t end = uhttp_line_end(&p);
+
+    size_t method_start = i;
+    while (i < end && uhttp_is_tchar(p.buf[i])) {
+        ++i;
+    }
+    size_t method_end = i;
+    if (method_end == method_start || i == end || p.buf[i++] != ' ') {
+        uhttp_raise_bad();
+    }
+
+    size_t path_start = i;
+    while (i < end && p.buf[i] > ' ' && p.buf[i] != 0x7f) {
+        ++i;
+    }
+    size_t path_end = i;
+    if (path_end == path_start || i == end || p.buf[i++] != ' ') {
+        uhttp_raise_bad();
+    }
+
+    if (end - i != 8) {
+        uhttp_raise_bad();
+    }
+    mp_int_t minor_version = uhttp_parse_version(p.buf, i, end);
+
+    mp_obj_t items[5] = {
+        uhttp_span(&p, method_start, method_end),
+        uhttp_span(&p, path_start, path_end),
+        MP_OBJ_NEW_SMALL_INT(minor_version),
+        uhttp_parse_header_fields(&p),
+        MP_OBJ_NEW_SMALL_INT(p.len),
+    };
+    return mp_obj_new_tuple(5, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uhttp_parse_request_obj, 1, 2, mod_uhttp_parse_request);
+
+// parse_response(buf[, last_len]) -> (minor_version, status, reason, headers, header_len)
+STATIC mp_obj_t mod_uhttp_parse_response(size_t n_args, const mp_obj_t *args) {
+    uhttp_parser_t p;
+    if (!uhttp_parser_init(&p, n_args, args)) {
+        return mp_const_none;
+    }
+    uhttp_skip_empty_lines(&p);
+    size_t i = p.pos;
+    size_t end = uhttp_line_end(&p);
+
+    mp_int_t minor_version = uhttp_parse_version(p.buf, i, end);
+    i += 8;
+    if (end - i < 4 || p.buf[i] != ' ') {
+        uhttp_raise_bad();
+    }
+    mp_int_t status = 0;
+    for (size_t j = i + 1; j < i + 4; ++j) {
+        if (!unichar_isdigit(p.buf[j])) {
+            uhttp_raise_bad();
+        }
+        status = status * 10 + p.buf[j] - '0';
+    }
+    i += 4;
+
+    // the reason phrase is optional
+    if (i < end && p.buf[i++] != ' ') {
+        uhttp_raise_bad();
+    }
+
+    mp_obj_t items[5] = {
+        MP_OBJ_NEW_SMALL_INT(minor_version),
+        MP_OBJ_NEW_SMALL_INT(status),
+        uhttp_span(&p, i, end),
+        uhttp_parse_header_fields(&p),
+        MP_OBJ_NEW_SMALL_INT(p.len),
+    };
+    return mp_obj_new_tuple(5, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uhttp_parse_response_obj, 1, 2, mod_uhttp_parse_response);
+
+// parse_headers(buf[, last_len]) -> (headers, header_len)
+// For a header block on its own, such as the trailer of a chunked body.
+STATIC mp_obj_t mod_uhttp_parse_headers(size_t n_args, const mp_obj_t *args) {
+    uhttp_parser_t p;
+    if (!uhttp_parser_init(&p, n_args, args)) {
+        // check for an empty header block, which has no preceding line
+        if (p.buf_len >= 1 && p.buf[0] == '\n') {
+            p.len = 1;
+        } else if (p.buf_len >= 2 && p.buf[0] == '\r' && p.buf[1] == '\n') {
+            p.len = 2;
+        } else {
+            return mp_const_none;
+        }
+    }
+    mp_obj_t items[2] = {
+        uhttp_parse_header_fields(&p),
+        MP_OBJ_NEW_SMALL_INT(p.len),
+    };
+    return mp_obj_new_tuple(2, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uhttp_parse_headers_obj, 1, 2, mod_uhttp_parse_headers);
+
+/******************************************************************************/
+// Chunked transfer decoding
+
+enum {
+    CHUNK_SIZE,
+    CHUNK_EXT,
+    CHUNK_DATA,
+    CHUNK_CRLF,
+    CHUNK_TRAILER_LINE_HEAD,
+    CHUNK_TRAILER_LINE_MIDDLE,
+};
+
+typedef struct _mp_obj_chunked_decoder_t {
+    mp_obj_base_t base;
+    size_t bytes_left_in_chunk;
+    byte hex_digits;
+    byte state;
+} mp_obj_chunked_decoder_t;
+
+STATIC mp_obj_t chunked_decoder_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 0, 0, false);
+    mp_obj_chunked_decoder_t *o = m_new_obj(mp_obj_chunked_decoder_t);
+    o->base.type = type;
+    o->bytes_left_in_chunk = 0;
+    o->hex_digits = 0;
+    o->state = CHUNK_SIZE;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+// decode(buf[, n]) -> (size, remaining)
+// Decode the first n bytes of buf in place.  The decoded body data is moved to
+// buf[:size].  remaining is None while more chunked data is expected;
+// once the last chunk and trailer are consumed it is the number of bytes
+// that followed the chunked body, which are moved to buf[size:size + remaining].
+STATIC mp_obj_t chunked_decoder_decode(size_t n_args, const mp_obj_t *args) {
+    mp_obj_chunked_decoder_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_RW);
+    byte *buf = bufinfo.buf;
+    size_t len = bufinfo.len;
+    if (n_args > 2) {
+        len = MIN(len, (size_t)mp_obj_get_int(args[2]));
+    }
+
+    size_t src = 0;
+    size_t dst = 0;
+    for (;;) {
+        switch (self->state) {
+            case CHUNK_SIZE:
+                for (;; ++src) {
+                    if (src == len) {
+                        goto incomplete;
+                    }
+                    if (!unichar_isxdigit(buf[src])) {
+                        if (self->hex_digits == 0) {
+                            goto error;
+                        }
+                        break;
+                    }
+                    if (self->hex_digits == sizeof(size_t) * 2 - 1) {
+                        goto error;
+                    }
+                    self->bytes_left_in_chunk = self->bytes_left_in_chunk * 16 + unichar_xdigit_value(buf[src]);
+                    ++self->hex_digits;
+                }
+                self->hex_digits = 0;
+                self->state = CHUNK_EXT;
+                MP_FALLTHROUGH
+            case CHUNK_EXT: {
+                // chunk extensions are ignored
+                byte *nl = memchr(buf + src, '\n', len - src);
+                if (nl == NULL) {
+                    src = len;
+                    goto incomplete;
+                }
+                src = nl - buf + 1;
+                if (self->bytes_left_in_chunk == 0) {
+                    self->state = CHUNK_TRAILER_LINE_HEAD;
+                    break;
+                }
+                self->state = CHUNK_DATA;
+                MP_FALLTHROUGH
+            }
+            case CHUNK_DATA: {
+                size_t avail = len - src;
+                size_t n = MIN(avail, self->bytes_left_in_chunk);
+                memmove(buf + dst, buf + src, n);
+                src += n;
+                dst += n;
+                self->bytes_left_in_chunk -= n;
+                if (self->bytes_left_in_chunk != 0) {
+                    goto incomplete;
+                }
+                self->state = CHUNK_CRLF;
+                MP_FALLTHROUGH
+            }
+            case CHUNK_CRLF:
+                for (;; ++src) {
+                    if (src == len) {
+                        goto incomplete;
+                    }
+                    if (buf[src] != '\r') {
+                        break;
+                    }
+                }
+                if (buf[src++] != '\n') {
+                    goto error;
+                }
+                self->state = CHUNK_SIZE;
+                break;
+            case CHUNK_TRAILER_LINE_HEAD:
+                for (;; ++src) {
+                    if (src == len) {
+                        goto incomplete;
+                    }
+                    if (buf[src] != '\r') {
+                        break;
+                    }
+                }
+                if (buf[src++] == '\n') {
+                    goto complete;
+                }
+                self->state = CHUNK_TRAILER_LINE_MIDDLE;
+                MP_FALLTHROUGH
+            case CHUNK_TRAILER_LINE_MIDDLE: {
+                byte *nl = memchr(buf + src, '\n', len - src);
+                if (nl == NULL) {
+                    src = len;
+                    goto incomplete;
+                }
+                src = nl - buf + 1;
+                self->state = CHUNK_TRAILER_LINE_HEAD;
+                break;
+            }
+        }
+    }
+
+error:
+    uhttp_raise_bad();
+
+complete: {
+        size_t remaining = len - src;
+        memmove(buf + dst, buf + src, remaining);
+        self->state = CHUNK_SIZE;
+        mp_obj_t items[2] = { MP_OBJ_NEW_SMALL_INT(dst), MP_OBJ_NEW_SMALL_INT(remaining) };
+        return mp_obj_new_tuple(2, items);
+    }
+
+incomplete: {
+        mp_obj_t items[2] = { MP_OBJ_NEW_SMALL_INT(dst), mp_const_none };
+        return mp_obj_new_tuple(2, items);
+    }
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(chunked_decoder_decode_obj, 2, 3, chunked_decoder_decode);
+
+STATIC const mp_rom_map_elem_t chunked_decoder_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_decode), MP_ROM_PTR(&chunked_decoder_decode_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(chunked_decoder_locals_dict, chunked_decoder_locals_dict_table);
+
+STATIC const mp_obj_type_t chunked_decoder_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_ChunkedDecoder,
+    .make_new = chunked_decoder_make_new,
+    .locals_dict = (void *)&chunked_decoder_locals_dict,
+};
+
+STATIC const mp_rom_map_elem_t mp_module_uhttp_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uhttp) },
+    { MP_ROM_QSTR(MP_QSTR_parse_request), MP_ROM_PTR(&mod_uhttp_parse_request_obj) },
+    { MP_ROM_QSTR(MP_QSTR_parse_response), MP_ROM_PTR(&mod_uhttp_parse_response_obj) },
+    { MP_ROM_QSTR(MP_QSTR_parse_headers), MP_ROM_PTR(&mod_uhttp_parse_headers_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ChunkedDecoder), MP_ROM_PTR(&chunked_decoder_type) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_uhttp_globals, mp_module_uhttp_globals_table);
+
+const mp_obj_module_t mp_module_uhttp = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t *)&mp_module_uhttp_globals,
+};
+
+#endif // MICROPY_PY_UHTTP
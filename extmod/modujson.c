@@ -25,31 +25,268 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
+#include "py/formatfloat.h"
 #include "py/objlist.h"
-#include "py/objstringio.h"
+#include "py/objstr.h"
 #include "py/parsenum.h"
 #include "py/runtime.h"
+#include "py/stackctrl.h"
 #include "py/stream.h"
 
 #if MICROPY_PY_UJSON
 
-STATIC mp_obj_t mod_ujson_dump(mp_obj_t obj, mp_obj_t stream) {
-    mp_get_stream_raise(stream, MP_STREAM_OP_WRITE);
-    mp_print_t print = {MP_OBJ_TO_PTR(stream), mp_stream_write_adaptor};
-    mp_obj_print_helper(&print, obj, PRINT_JSON);
+// The encoder below writes JSON into a small buffer which is flushed to the
+// output stream (for dump) or vstr (for dumps) when full, so the output is
+// written in large pieces rather than token by token.  The common types are
+// encoded directly: strings are escaped a run of characters at a time, and
+// small ints and floats are formatted without going through mp_printf.
+// Any other object falls back to its print method with PRINT_JSON.
+
+// Size of the encoder's output buffer.
+#define UJSON_ENC_BUF_SIZE (256)
+
+typedef struct _ujson_enc_t {
+    mp_print_t print; // used for objects printed by their own print method
+    mp_obj_t stream; // output stream, or MP_OBJ_NULL to output to vstr
+    vstr_t *vstr;
+    const char *item_sep;
+    size_t item_sep_len;
+    const char *key_sep;
+    size_t key_sep_len;
+    size_t len; // number of bytes in buf
+    byte buf[UJSON_ENC_BUF_SIZE];
+} ujson_enc_t;
+
+STATIC void ujson_enc_output(ujson_enc_t *enc, const char *str, size_t len) {
+    if (enc->stream != MP_OBJ_NULL) {
+        mp_stream_write_adaptor(MP_OBJ_TO_PTR(enc->stream), str, len);
+    } else {
+        vstr_add_strn(enc->vstr, str, len);
+    }
+}
+
+STATIC void ujson_enc_flush(ujson_enc_t *enc) {
+    if (enc->len != 0) {
+        ujson_enc_output(enc, (const char *)enc->buf, enc->len);
+        enc->len = 0;
+    }
+}
+
+STATIC void ujson_enc_write(ujson_enc_t *enc, const char *str, size_t len) {
+    if (UJSON_ENC_BUF_SIZE - enc->len < len) {
+        ujson_enc_flush(enc);
+        if (len >= UJSON_ENC_BUF_SIZE) {
+            // too big to be worth buffering
+            ujson_enc_output(enc, str, len);
+            return;
+        }
+    }
+    memcpy(enc->buf + enc->len, str, len);
+    enc->len += len;
+}
+
+static inline void ujson_enc_write_byte(ujson_enc_t *enc, byte c) {
+    if (enc->len == UJSON_ENC_BUF_SIZE) {
+        ujson_enc_flush(enc);
+    }
+    enc->buf[enc->len++] = c;
+}
+
+STATIC void ujson_enc_print_strn(void *data, const char *str, size_t len) {
+    ujson_enc_write(data, str, len);
+}
+
+// Same output as mp_str_print_json, but copying runs of characters that
+// don't need escaping in one go.
+STATIC void ujson_enc_str(ujson_enc_t *enc, const byte *str, size_t len) {
+    ujson_enc_write_byte(enc, '"');
+    for (const byte *top = str + len; str < top;) {
+        const byte *run = str;
+        while (str < top && *str >= 32 && *str != '"' && *str != '\\') {
+            ++str;
+        }
+        if (str != run) {
+            ujson_enc_write(enc, (const char *)run, str - run);
+        }
+        if (str == top) {
+            break;
+        }
+        byte c = *str++;
+        char esc[6] = {'\\', c, 0, 0, 0, 0};
+        size_t esc_len = 2;
+        if (c == '\n') {
+            esc[1] = 'n';
+        } else if (c == '\r') {
+            esc[1] = 'r';
+        } else if (c == '\t') {
+            esc[1] = 't';
+        } else if (c < 32) {
+            esc[1] = 'u';
+            esc[2] = '0';
+            esc[3] = '0';
+            esc[4] = "0123456789abcdef"[c >> 4];
+            esc[5] = "0123456789abcdef"[c & 0xf];
+            esc_len = 6;
+        }
+        ujson_enc_write(enc, esc, esc_len);
+    }
+    ujson_enc_write_byte(enc, '"');
+}
+
+STATIC void ujson_enc_small_int(ujson_enc_t *enc, mp_int_t val) {
+    char digits[sizeof(mp_int_t) * 3 + 2];
+    char *p = digits + sizeof(digits);
+    mp_uint_t u = val < 0 ? -(mp_uint_t)val : (mp_uint_t)val;
+    do {
+        *--p = '0' + u % 10;
+        u /= 10;
+    } while (u != 0);
+    if (val < 0) {
+        *--p = '-';
+    }
+    ujson_enc_write(enc, p, digits + sizeof(digits) - p);
+}
+
+#if MICROPY_PY_BUILTINS_FLOAT
+// Same output as float_print in py/objfloat.c.
+STATIC void ujson_enc_float(ujson_enc_t *enc, mp_float_t val) {
+    #if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_FLOAT
+    char buf[16];
+    #if MICROPY_OBJ_REPR == MICROPY_OBJ_REPR_C
+    const int precision = 6;
+    #else
+    const int precision = 7;
+    #endif
+    #else
+    char buf[32];
+    const int precision = 16;
+    #endif
+    int len = mp_format_float(val, buf, sizeof(buf), 'g', precision, '\0');
+    ujson_enc_write(enc, buf, len);
+    if (strpbrk(buf, ".en") == NULL) {
+        // Python floats always have decimal point (unless inf or nan)
+        ujson_enc_write(enc, ".0", 2);
+    }
+}
+#endif
+
+STATIC void ujson_enc_obj(ujson_enc_t *enc, mp_obj_t obj) {
+    MP_STACK_CHECK();
+    if (mp_obj_is_small_int(obj)) {
+        ujson_enc_small_int(enc, MP_OBJ_SMALL_INT_VALUE(obj));
+    } else if (mp_obj_is_str_or_bytes(obj)) {
+        GET_STR_DATA_LEN(obj, str, len);
+        ujson_enc_str(enc, str, len);
+    } else if (obj == mp_const_none) {
+        ujson_enc_write(enc, "null", 4);
+    } else if (obj == mp_const_true) {
+        ujson_enc_write(enc, "true", 4);
+    } else if (obj == mp_const_false) {
+        ujson_enc_write(enc, "false", 5);
+    #if MICROPY_PY_BUILTINS_FLOAT
+    } else if (mp_obj_is_float(obj)) {
+        ujson_enc_float(enc, mp_obj_float_get(obj));
+    #endif
+    } else if (mp_obj_is_type(obj, &mp_type_list) || mp_obj_is_type(obj, &mp_type_tuple)) {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(obj, &len, &items);
+        ujson_enc_write_byte(enc, '[');
+        for (size_t i = 0; i < len; ++i) {
+            if (i != 0) {
+                ujson_enc_write(enc, enc->item_sep, enc->item_sep_len);
+            }
+            ujson_enc_obj(enc, items[i]);
+        }
+        ujson_enc_write_byte(enc, ']');
+    } else if (mp_obj_is_dict_or_ordereddict(obj)) {
+        mp_map_t *map = mp_obj_dict_get_map(obj);
+        bool first = true;
+        ujson_enc_write_byte(enc, '{');
+        for (size_t i = 0; i < map->alloc; ++i) {
+            if (!mp_map_slot_is_filled(map, i)) {
+                continue;
+            }
+            if (!first) {
+                ujson_enc_write(enc, enc->item_sep, enc->item_sep_len);
+            }
+            first = false;
+            mp_obj_t key = map->table[i].key;
+            if (mp_obj_is_str_or_bytes(key)) {
+                ujson_enc_obj(enc, key);
+            } else {
+                ujson_enc_write_byte(enc, '"');
+                ujson_enc_obj(enc, key);
+                ujson_enc_write_byte(enc, '"');
+            }
+            ujson_enc_write(enc, enc->key_sep, enc->key_sep_len);
+            ujson_enc_obj(enc, map->table[i].value);
+        }
+        ujson_enc_write_byte(enc, '}');
+    } else {
+        mp_obj_print_helper(&enc->print, obj, PRINT_JSON);
+    }
+}
+
+STATIC void ujson_enc_init(ujson_enc_t *enc, mp_obj_t separators) {
+    enc->print.data = enc;
+    enc->print.print_strn = ujson_enc_print_strn;
+    enc->len = 0;
+    if (separators == mp_const_none) {
+        enc->item_sep = ", ";
+        enc->item_sep_len = 2;
+        enc->key_sep = ": ";
+        enc->key_sep_len = 2;
+    } else {
+        mp_obj_t *items;
+        mp_obj_get_array_fixed_n(separators, 2, &items);
+        enc->item_sep = mp_obj_str_get_data(items[0], &enc->item_sep_len);
+        enc->key_sep = mp_obj_str_get_data(items[1], &enc->key_sep_len);
+    }
+}
+
+STATIC mp_obj_t mod_ujson_dump(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_obj, ARG_stream, ARG_separators };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_separators, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_get_stream_raise(args[ARG_stream].u_obj, MP_STREAM_OP_WRITE);
+    ujson_enc_t enc;
+    ujson_enc_init(&enc, args[ARG_separators].u_obj);
+    enc.stream = args[ARG_stream].u_obj;
+    ujson_enc_obj(&enc, args[ARG_obj].u_obj);
+    ujson_enc_flush(&enc);
     return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_ujson_dump_obj, mod_ujson_dump);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_ujson_dump_obj, 2, mod_ujson_dump);
+
+STATIC mp_obj_t mod_ujson_dumps(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_obj, ARG_separators };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_separators, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = mp_const_none} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
-STATIC mp_obj_t mod_ujson_dumps(mp_obj_t obj) {
     vstr_t vstr;
-    mp_print_t print;
-    vstr_init_print(&vstr, 8, &print);
-    mp_obj_print_helper(&print, obj, PRINT_JSON);
+    vstr_init(&vstr, 8);
+    ujson_enc_t enc;
+    ujson_enc_init(&enc, args[ARG_separators].u_obj);
+    enc.stream = MP_OBJ_NULL;
+    enc.vstr = &vstr;
+    ujson_enc_obj(&enc, args[ARG_obj].u_obj);
+    ujson_enc_flush(&enc);
     return mp_obj_new_str_from_vstr(&mp_type_str, &vstr);
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_dumps_obj, mod_ujson_dumps);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_ujson_dumps_obj, 1, mod_ujson_dumps);
 
 // The function below implements a simple non-recursive JSON parser.
 //
@@ -63,49 +300,174 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_dumps_obj, mod_ujson_dumps);
 // Most of the work is parsing the primitives (null, false, true, numbers,
 // strings).  It does 1 pass over the input stream.  It tries to be fast and
 // small in code size, while not using more RAM than necessary.
+//
+// The input is scanned from a block of memory: for loads this is the string
+// itself, for load it is a buffer refilled with large reads from the stream.
+// Runs of plain string characters, numbers and whitespace are processed
+// directly from the block instead of one character at a time.
+//
+// Documents often repeat the same keys (and short string values) many times,
+// eg an array of records, so recently created short strings are kept in a
+// small cache and reused, which saves an allocation and shares the hash.
+// Arrays and objects are also created with room for as many items (up to a
+// small limit) as the last array or object, respectively, closed at the same
+// nesting depth, to avoid growing them item by item.  Both caches live in
+// ujson_stream_t so that they carry over between the values built by an
+// iterload iterator.
+
+// Size of the buffer used to read from a stream.
+#define UJSON_STREAM_BUF_SIZE (256)
+
+// Number of entries in the string cache (must be a power of 2), and the
+// maximum length of a string to cache.
+#define UJSON_STR_CACHE_SIZE (32)
+#define UJSON_STR_CACHE_MAX_LEN (32)
+
+// Number of nesting levels for which container sizes are remembered, and the
+// largest size that is used to presize a new container.
+#define UJSON_HINT_DEPTH (8)
+#define UJSON_HINT_MAX (32)
 
 typedef struct _ujson_stream_t {
     mp_obj_t stream_obj;
     mp_uint_t (*read)(mp_obj_t obj, void *buf, mp_uint_t size, int *errcode);
-    int errcode;
+    byte *buf; // buffer for reading from the stream, NULL if parsing from memory
+    const byte *data; // current block of input
+    size_t len; // number of bytes in the current block
+    size_t i; // index of the current character within the block
     byte cur;
+    mp_obj_t strs[UJSON_STR_CACHE_SIZE]; // recently created short strings
+    uint8_t list_hints[UJSON_HINT_DEPTH]; // size of last list closed at each depth
+    uint8_t dict_hints[UJSON_HINT_DEPTH]; // size of last dict closed at each depth
 } ujson_stream_t;
 
 #define S_EOF (0) // null is not allowed in json stream so is ok as EOF marker
-#define S_END(s) ((s).cur == S_EOF)
-#define S_CUR(s) ((s).cur)
-#define S_NEXT(s) (ujson_stream_next(&(s)))
+#define S_END(s) ((s)->cur == S_EOF)
+#define S_CUR(s) ((s)->cur)
+#define S_NEXT(s) (ujson_stream_next(s))
 
-STATIC byte ujson_stream_next(ujson_stream_t *s) {
-    mp_uint_t ret = s->read(s->stream_obj, &s->cur, 1, &s->errcode);
-    if (s->errcode != 0) {
-        mp_raise_OSError(s->errcode);
+STATIC void ujson_stream_init(ujson_stream_t *s, mp_obj_t stream_obj, const mp_stream_p_t *stream_p, byte *buf, const byte *data, size_t len) {
+    memset(s, 0, sizeof(*s));
+    s->stream_obj = stream_obj;
+    s->read = stream_p == NULL ? NULL : stream_p->read;
+    s->buf = buf;
+    s->data = data;
+    s->len = len;
+}
+
+// Called when the current block is exhausted.
+STATIC byte ujson_stream_fill(ujson_stream_t *s) {
+    if (s->buf != NULL) {
+        int errcode;
+        mp_uint_t ret = s->read(s->stream_obj, s->buf, UJSON_STREAM_BUF_SIZE, &errcode);
+        if (ret == MP_STREAM_ERROR) {
+            mp_raise_OSError(errcode);
+        }
+        s->len = ret;
+        s->i = 0;
+        if (ret != 0) {
+            return s->cur = s->buf[0];
+        }
     }
-    if (ret == 0) {
-        s->cur = S_EOF;
+    s->i = s->len;
+    return s->cur = S_EOF;
+}
+
+static inline byte ujson_stream_next(ujson_stream_t *s) {
+    if (++s->i < s->len) {
+        return s->cur = s->data[s->i];
     }
-    return s->cur;
+    return ujson_stream_fill(s);
 }
 
-STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
-    const mp_stream_p_t *stream_p = mp_get_stream_raise(stream_obj, MP_STREAM_OP_READ);
-    ujson_stream_t s = {stream_obj, stream_p->read, 0, 0};
-    vstr_t vstr;
-    vstr_init(&vstr, 8);
-    mp_obj_list_t stack; // we use a list as a simple stack for nested JSON
-    stack.len = 0;
-    stack.items = NULL;
-    mp_obj_t stack_top = MP_OBJ_NULL;
-    const mp_obj_type_t *stack_top_type = NULL;
-    mp_obj_t stack_key = MP_OBJ_NULL;
-    S_NEXT(s);
+// Load the first character of the input.
+STATIC void ujson_stream_start(ujson_stream_t *s) {
+    if (s->len != 0) {
+        s->cur = s->data[0];
+    } else {
+        ujson_stream_fill(s);
+    }
+}
+
+// Move forward n characters, all of which must be within the current block.
+static inline void ujson_stream_skip(ujson_stream_t *s, size_t n) {
+    s->i += n - 1;
+    ujson_stream_next(s);
+}
+
+// Skip a run of whitespace within the current block in one go.
+static inline void ujson_skip_ws(ujson_stream_t *s) {
+    size_t i = s->i;
+    while (i < s->len) {
+        byte c = s->data[i];
+        if (!(c == ' ' || c == '\n' || c == '\t' || c == '\r')) {
+            break;
+        }
+        ++i;
+    }
+    if (i != s->i) {
+        ujson_stream_skip(s, i - s->i);
+    }
+}
+
+// Return the number of characters at the current position that can be
+// copied verbatim into a string, ie up to the next quote or backslash or the
+// end of the block.  memchr is usually vectorised by the C library.
+STATIC size_t ujson_scan_str(ujson_stream_t *s) {
+    if (s->i >= s->len) {
+        return 0;
+    }
+    const byte *start = s->data + s->i;
+    size_t n = s->len - s->i;
+    const byte *q = memchr(start, '"', n);
+    if (q != NULL) {
+        n = q - start;
+    }
+    const byte *bs = memchr(start, '\\', n);
+    if (bs != NULL) {
+        n = bs - start;
+    }
+    return n;
+}
+
+// Create a str object, reusing an identical one from the cache if possible.
+STATIC mp_obj_t ujson_new_str(ujson_stream_t *s, const char *str, size_t len) {
+    if (len > UJSON_STR_CACHE_MAX_LEN) {
+        return mp_obj_new_str(str, len);
+    }
+    mp_uint_t hash = qstr_compute_hash((const byte *)str, len);
+    mp_obj_t *entry = &s->strs[hash & (UJSON_STR_CACHE_SIZE - 1)];
+    if (*entry != MP_OBJ_NULL) {
+        GET_STR_DATA_LEN(*entry, entry_str, entry_len);
+        if (entry_len == len && memcmp(entry_str, str, len) == 0) {
+            return *entry;
+        }
+    }
+    return *entry = mp_obj_new_str(str, len);
+}
+
+// Tokens returned by ujson_next_token.
+enum {
+    UJSON_TOK_EOF,
+    UJSON_TOK_VALUE,
+    UJSON_TOK_START_ARRAY,
+    UJSON_TOK_END_ARRAY,
+    UJSON_TOK_START_OBJECT,
+    UJSON_TOK_END_OBJECT,
+};
+
+STATIC NORETURN void ujson_raise_syntax(void) {
+    mp_raise_ValueError(MP_ERROR_TEXT("syntax error in JSON"));
+}
+
+// Read the next token from the input, skipping whitespace, commas and colons.
+// For UJSON_TOK_VALUE the primitive value is returned in *value.  vstr is
+// scratch space for building strings and numbers.
+STATIC int ujson_next_token(ujson_stream_t *s, vstr_t *vstr, mp_obj_t *value) {
     for (;;) {
-    cont:
         if (S_END(s)) {
-            break;
+            return UJSON_TOK_EOF;
         }
-        mp_obj_t next = MP_OBJ_NULL;
-        bool enter = false;
         byte cur = S_CUR(s);
         S_NEXT(s);
         switch (cur) {
@@ -115,34 +477,46 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
             case '\t':
             case '\n':
             case '\r':
-                goto cont;
+                ujson_skip_ws(s);
+                continue;
             case 'n':
                 if (S_CUR(s) == 'u' && S_NEXT(s) == 'l' && S_NEXT(s) == 'l') {
                     S_NEXT(s);
-                    next = mp_const_none;
-                } else {
-                    goto fail;
+                    *value = mp_const_none;
+                    return UJSON_TOK_VALUE;
                 }
-                break;
+                ujson_raise_syntax();
             case 'f':
                 if (S_CUR(s) == 'a' && S_NEXT(s) == 'l' && S_NEXT(s) == 's' && S_NEXT(s) == 'e') {
                     S_NEXT(s);
-                    next = mp_const_false;
-                } else {
-                    goto fail;
+                    *value = mp_const_false;
+                    return UJSON_TOK_VALUE;
                 }
-                break;
+                ujson_raise_syntax();
             case 't':
                 if (S_CUR(s) == 'r' && S_NEXT(s) == 'u' && S_NEXT(s) == 'e') {
                     S_NEXT(s);
-                    next = mp_const_true;
-                } else {
-                    goto fail;
+                    *value = mp_const_true;
+                    return UJSON_TOK_VALUE;
                 }
-                break;
+                ujson_raise_syntax();
             case '"':
-                vstr_reset(&vstr);
-                for (; !S_END(s) && S_CUR(s) != '"';) {
+                vstr_reset(vstr);
+                for (;;) {
+                    size_t n = ujson_scan_str(s);
+                    if (n != 0) {
+                        if (vstr->len == 0 && s->i + n < s->len && s->data[s->i + n] == '"') {
+                            // whole string is in the block without escapes
+                            *value = ujson_new_str(s, (const char *)s->data + s->i, n);
+                            ujson_stream_skip(s, n + 1);
+                            return UJSON_TOK_VALUE;
+                        }
+                        vstr_add_strn(vstr, (const char *)s->data + s->i, n);
+                        ujson_stream_skip(s, n);
+                    }
+                    if (S_END(s) || S_CUR(s) == '"') {
+                        break;
+                    }
                     byte c = S_CUR(s);
                     if (c == '\\') {
                         c = S_NEXT(s);
@@ -171,21 +545,21 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
                                     }
                                     num = (num << 4) | c;
                                 }
-                                vstr_add_char(&vstr, num);
+                                vstr_add_char(vstr, num);
                                 goto str_cont;
                             }
                         }
                     }
-                    vstr_add_byte(&vstr, c);
+                    vstr_add_byte(vstr, c);
                 str_cont:
                     S_NEXT(s);
                 }
                 if (S_END(s)) {
-                    goto fail;
+                    ujson_raise_syntax();
                 }
                 S_NEXT(s);
-                next = mp_obj_new_str(vstr.buf, vstr.len);
-                break;
+                *value = ujson_new_str(s, vstr->buf, vstr->len);
+                return UJSON_TOK_VALUE;
             case '-':
             case '0':
             case '1':
@@ -198,9 +572,35 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
             case '8':
             case '9': {
                 bool flt = false;
-                vstr_reset(&vstr);
+                if (s->i >= 1 && s->i <= s->len) {
+                    // cur is at s->i - 1 in the current block; if the whole
+                    // number is in the block then parse it from there
+                    size_t j = s->i;
+                    for (; j < s->len; ++j) {
+                        byte c = s->data[j];
+                        if (c == '.' || c == 'E' || c == 'e') {
+                            flt = true;
+                        } else if (!(c == '+' || c == '-' || unichar_isdigit(c))) {
+                            break;
+                        }
+                    }
+                    if (j < s->len || s->buf == NULL) {
+                        const char *num = (const char *)s->data + s->i - 1;
+                        size_t num_len = j - s->i + 1;
+                        if (flt) {
+                            *value = mp_parse_num_decimal(num, num_len, false, false, NULL);
+                        } else {
+                            *value = mp_parse_num_integer(num, num_len, 10, NULL);
+                        }
+                        s->i = j - 1;
+                        S_NEXT(s);
+                        return UJSON_TOK_VALUE;
+                    }
+                    flt = false;
+                }
+                vstr_reset(vstr);
                 for (;;) {
-                    vstr_add_byte(&vstr, cur);
+                    vstr_add_byte(vstr, cur);
                     cur = S_CUR(s);
                     if (cur == '.' || cur == 'E' || cur == 'e') {
                         flt = true;
@@ -212,44 +612,98 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
                     S_NEXT(s);
                 }
                 if (flt) {
-                    next = mp_parse_num_decimal(vstr.buf, vstr.len, false, false, NULL);
+                    *value = mp_parse_num_decimal(vstr->buf, vstr->len, false, false, NULL);
                 } else {
-                    next = mp_parse_num_integer(vstr.buf, vstr.len, 10, NULL);
+                    *value = mp_parse_num_integer(vstr->buf, vstr->len, 10, NULL);
                 }
-                break;
+                return UJSON_TOK_VALUE;
             }
             case '[':
-                next = mp_obj_new_list(0, NULL);
-                enter = true;
-                break;
+                return UJSON_TOK_START_ARRAY;
+            case ']':
+                return UJSON_TOK_END_ARRAY;
             case '{':
-                next = mp_obj_new_dict(0);
+                return UJSON_TOK_START_OBJECT;
+            case '}':
+                return UJSON_TOK_END_OBJECT;
+            default:
+                ujson_raise_syntax();
+        }
+    }
+}
+
+// Build the object for one complete JSON value, whose first token tok has
+// already been read.  The input is consumed up to the end of the value.
+STATIC mp_obj_t ujson_build(ujson_stream_t *s, vstr_t *vstr, int tok, mp_obj_t next) {
+    mp_obj_list_t stack; // we use a list as a simple stack for nested JSON
+    stack.len = 0;
+    stack.items = NULL;
+    mp_obj_t stack_top = MP_OBJ_NULL;
+    const mp_obj_type_t *stack_top_type = NULL;
+    mp_obj_t stack_key = MP_OBJ_NULL;
+    for (;; tok = ujson_next_token(s, vstr, &next)) {
+        bool enter = false;
+        switch (tok) {
+            case UJSON_TOK_EOF:
+                if (stack_top == MP_OBJ_NULL || stack.len != 0) {
+                    // not exactly 1 object
+                    ujson_raise_syntax();
+                }
+                return stack_top;
+            case UJSON_TOK_VALUE:
+                break;
+            case UJSON_TOK_START_ARRAY:
+            case UJSON_TOK_START_OBJECT: {
+                // presize using the last container of the same kind closed at
+                // the same depth, but no larger than the rest of the current
+                // block of input could hold (each item takes at least 2 chars)
+                size_t depth = stack_top == MP_OBJ_NULL ? 0 : stack.len + 1;
+                size_t hint = 0;
+                if (depth < UJSON_HINT_DEPTH) {
+                    hint = tok == UJSON_TOK_START_ARRAY ? s->list_hints[depth] : s->dict_hints[depth];
+                    hint = MIN(hint, (s->len - MIN(s->i, s->len)) / 2 + 1);
+                }
+                if (tok == UJSON_TOK_START_ARRAY) {
+                    next = mp_obj_new_list(hint, NULL);
+                    mp_obj_list_t *list = MP_OBJ_TO_PTR(next);
+                    mp_seq_clear(list->items, 0, list->alloc, sizeof(*list->items));
+                    list->len = 0;
+                } else {
+                    // leave some slack so the hash table isn't completely full
+                    next = mp_obj_new_dict(hint + hint / 4);
+                }
                 enter = true;
                 break;
-            case '}':
-            case ']': {
+            }
+            default: // UJSON_TOK_END_ARRAY, UJSON_TOK_END_OBJECT
                 if (stack_top == MP_OBJ_NULL) {
                     // no object at all
-                    goto fail;
+                    ujson_raise_syntax();
+                }
+                if (stack.len < UJSON_HINT_DEPTH) {
+                    if (stack_top_type == &mp_type_list) {
+                        size_t n = ((mp_obj_list_t *)MP_OBJ_TO_PTR(stack_top))->len;
+                        s->list_hints[stack.len] = MIN(n, UJSON_HINT_MAX);
+                    } else {
+                        size_t n = mp_obj_dict_len(stack_top);
+                        s->dict_hints[stack.len] = MIN(n, UJSON_HINT_MAX);
+                    }
                 }
                 if (stack.len == 0) {
                     // finished; compound object
-                    goto success;
+                    return stack_top;
                 }
                 stack.len -= 1;
                 stack_top = stack.items[stack.len];
                 stack_top_type = mp_obj_get_type(stack_top);
-                goto cont;
-            }
-            default:
-                goto fail;
+                continue;
         }
         if (stack_top == MP_OBJ_NULL) {
             stack_top = next;
             stack_top_type = mp_obj_get_type(stack_top);
             if (!enter) {
                 // finished; single primitive only
-                goto success;
+                return stack_top;
             }
         } else {
             // append to list or dict
@@ -259,7 +713,7 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
                 if (stack_key == MP_OBJ_NULL) {
                     stack_key = next;
                     if (enter) {
-                        goto fail;
+                        ujson_raise_syntax();
                     }
                 } else {
                     mp_obj_dict_store(stack_top, stack_key, next);
@@ -278,42 +732,309 @@ STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
             }
         }
     }
-success:
+}
+
+STATIC mp_obj_t ujson_parse(ujson_stream_t *s) {
+    vstr_t vstr;
+    vstr_init(&vstr, 8);
+    ujson_stream_start(s);
+    mp_obj_t next = MP_OBJ_NULL;
+    int tok = ujson_next_token(s, &vstr, &next);
+    mp_obj_t obj = ujson_build(s, &vstr, tok, next);
     // eat trailing whitespace
     while (unichar_isspace(S_CUR(s))) {
         S_NEXT(s);
     }
     if (!S_END(s)) {
         // unexpected chars
-        goto fail;
-    }
-    if (stack_top == MP_OBJ_NULL || stack.len != 0) {
-        // not exactly 1 object
-        goto fail;
+        ujson_raise_syntax();
     }
     vstr_clear(&vstr);
-    return stack_top;
+    return obj;
+}
 
-fail:
-    mp_raise_ValueError(MP_ERROR_TEXT("syntax error in JSON"));
+STATIC mp_obj_t mod_ujson_load(mp_obj_t stream_obj) {
+    const mp_stream_p_t *stream_p = mp_get_stream_raise(stream_obj, MP_STREAM_OP_READ);
+    byte buf[UJSON_STREAM_BUF_SIZE];
+    ujson_stream_t s;
+    ujson_stream_init(&s, stream_obj, stream_p, buf, buf, 0);
+    return ujson_parse(&s);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_load_obj, mod_ujson_load);
 
 STATIC mp_obj_t mod_ujson_loads(mp_obj_t obj) {
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(obj, &bufinfo, MP_BUFFER_READ);
-    vstr_t vstr = {bufinfo.len, bufinfo.len, (char *)bufinfo.buf, true};
-    mp_obj_stringio_t sio = {{&mp_type_stringio}, &vstr, 0, MP_OBJ_NULL};
-    return mod_ujson_load(MP_OBJ_FROM_PTR(&sio));
+    ujson_stream_t s;
+    ujson_stream_init(&s, MP_OBJ_NULL, NULL, NULL, bufinfo.buf, bufinfo.len);
+    return ujson_parse(&s);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_loads_obj, mod_ujson_loads);
 
+#if MICROPY_PY_UJSON_ITERLOAD
+
+// Incremental parsing with iterload and iterevents.  The iterator object
+// owns the input state so that only one value (or event) is built at a time,
+// and memory use is bounded by the largest element rather than the document.
+
+// Events yielded by iterevents.
+#define UJSON_EV_START_ARRAY (1)
+#define UJSON_EV_END_ARRAY (2)
+#define UJSON_EV_START_OBJECT (3)
+#define UJSON_EV_END_OBJECT (4)
+#define UJSON_EV_KEY (5)
+#define UJSON_EV_VALUE (6)
+
+// States of an iterload iterator.
+enum {
+    UJSON_ITER_SEEK,
+    UJSON_ITER_ITEMS,
+    UJSON_ITER_PAIRS,
+    UJSON_ITER_SINGLE,
+    UJSON_ITER_DONE,
+};
+
+typedef struct _ujson_iter_obj_t {
+    mp_obj_base_t base;
+    mp_fun_1_t iternext;
+    mp_obj_t src; // stream or buffer being parsed, kept here so it stays alive
+    mp_obj_t path;
+    ujson_stream_t s;
+    vstr_t vstr; // scratch space for strings and numbers
+    vstr_t nest; // iterevents: one byte per open container, see below
+    byte state;
+} ujson_iter_obj_t;
+
+STATIC ujson_iter_obj_t *ujson_iter_new(mp_obj_t src, mp_fun_1_t iternext) {
+    ujson_iter_obj_t *o = m_new_obj(ujson_iter_obj_t);
+    o->base.type = &mp_type_polymorph_iter;
+    o->iternext = iternext;
+    o->src = src;
+    o->path = mp_const_empty_tuple;
+    mp_buffer_info_t bufinfo;
+    if (mp_get_buffer(src, &bufinfo, MP_BUFFER_READ)) {
+        ujson_stream_init(&o->s, MP_OBJ_NULL, NULL, NULL, bufinfo.buf, bufinfo.len);
+    } else {
+        const mp_stream_p_t *stream_p = mp_get_stream_raise(src, MP_STREAM_OP_READ);
+        byte *buf = m_new(byte, UJSON_STREAM_BUF_SIZE);
+        ujson_stream_init(&o->s, src, stream_p, buf, buf, 0);
+    }
+    vstr_init(&o->vstr, 8);
+    vstr_init(&o->nest, 0);
+    o->state = UJSON_ITER_SEEK;
+    ujson_stream_start(&o->s);
+    return o;
+}
+
+// Read the next token, which must be the start of a value.
+STATIC int ujson_iter_value_token(ujson_iter_obj_t *o, mp_obj_t *value) {
+    int tok = ujson_next_token(&o->s, &o->vstr, value);
+    if (tok == UJSON_TOK_EOF || tok == UJSON_TOK_END_ARRAY || tok == UJSON_TOK_END_OBJECT) {
+        ujson_raise_syntax();
+    }
+    return tok;
+}
+
+// Consume the rest of a value whose first token has been read, without
+// keeping any of it.
+STATIC void ujson_iter_skip(ujson_iter_obj_t *o, int tok) {
+    size_t depth = 0;
+    for (;;) {
+        mp_obj_t value;
+        switch (tok) {
+            case UJSON_TOK_EOF:
+                ujson_raise_syntax();
+            case UJSON_TOK_START_ARRAY:
+            case UJSON_TOK_START_OBJECT:
+                depth += 1;
+                break;
+            case UJSON_TOK_END_ARRAY:
+            case UJSON_TOK_END_OBJECT:
+                depth -= 1;
+                break;
+        }
+        if (depth == 0) {
+            return;
+        }
+        tok = ujson_next_token(&o->s, &o->vstr, &value);
+    }
+}
+
+// Follow the path of keys and indices to the value to iterate over, and
+// set the state according to its type.
+STATIC void ujson_iter_seek(ujson_iter_obj_t *o) {
+    size_t path_len;
+    mp_obj_t *path;
+    mp_obj_get_array(o->path, &path_len, &path);
+    mp_obj_t value = MP_OBJ_NULL;
+    int tok = ujson_iter_value_token(o, &value);
+    for (size_t i = 0; i < path_len; ++i) {
+        if (mp_obj_is_int(path[i])) {
+            if (tok != UJSON_TOK_START_ARRAY) {
+                mp_raise_TypeError(MP_ERROR_TEXT("JSON value isn't an array"));
+            }
+            for (mp_int_t n = mp_obj_get_int(path[i]);; --n) {
+                tok = ujson_next_token(&o->s, &o->vstr, &value);
+                if (tok == UJSON_TOK_EOF || tok == UJSON_TOK_END_ARRAY || tok == UJSON_TOK_END_OBJECT) {
+                    mp_raise_msg(&mp_type_IndexError, MP_ERROR_TEXT("index out of range"));
+                }
+                if (n == 0) {
+                    break;
+                }
+                ujson_iter_skip(o, tok);
+            }
+        } else {
+            if (tok != UJSON_TOK_START_OBJECT) {
+                mp_raise_TypeError(MP_ERROR_TEXT("JSON value isn't an object"));
+            }
+            for (;;) {
+                tok = ujson_next_token(&o->s, &o->vstr, &value);
+                if (tok != UJSON_TOK_VALUE) {
+                    if (tok == UJSON_TOK_END_OBJECT) {
+                        nlr_raise(mp_obj_new_exception_arg1(&mp_type_KeyError, path[i]));
+                    }
+                    ujson_raise_syntax();
+                }
+                bool match = mp_obj_equal(value, path[i]);
+                tok = ujson_iter_value_token(o, &value);
+                if (match) {
+                    break;
+                }
+                ujson_iter_skip(o, tok);
+            }
+        }
+    }
+    if (tok == UJSON_TOK_START_ARRAY) {
+        o->state = UJSON_ITER_ITEMS;
+    } else if (tok == UJSON_TOK_START_OBJECT) {
+        o->state = UJSON_ITER_PAIRS;
+    } else {
+        o->state = UJSON_ITER_SINGLE;
+        o->path = value; // hold the value until it's returned
+    }
+}
+
+STATIC mp_obj_t ujson_iterload_iternext(mp_obj_t self_in) {
+    ujson_iter_obj_t *o = MP_OBJ_TO_PTR(self_in);
+    if (o->state == UJSON_ITER_SEEK) {
+        ujson_iter_seek(o);
+    }
+    mp_obj_t value = MP_OBJ_NULL;
+    int tok;
+    switch (o->state) {
+        case UJSON_ITER_ITEMS:
+            tok = ujson_next_token(&o->s, &o->vstr, &value);
+            if (tok == UJSON_TOK_END_ARRAY) {
+                break;
+            }
+            if (tok == UJSON_TOK_EOF || tok == UJSON_TOK_END_OBJECT) {
+                ujson_raise_syntax();
+            }
+            return ujson_build(&o->s, &o->vstr, tok, value);
+        case UJSON_ITER_PAIRS: {
+            tok = ujson_next_token(&o->s, &o->vstr, &value);
+            if (tok == UJSON_TOK_END_OBJECT) {
+                break;
+            }
+            if (tok != UJSON_TOK_VALUE) {
+                ujson_raise_syntax();
+            }
+            mp_obj_t items[2] = {value, MP_OBJ_NULL};
+            tok = ujson_iter_value_token(o, &value);
+            items[1] = ujson_build(&o->s, &o->vstr, tok, value);
+            return mp_obj_new_tuple(2, items);
+        }
+        case UJSON_ITER_SINGLE:
+            value = o->path;
+            o->path = mp_const_none;
+            o->state = UJSON_ITER_DONE;
+            return value;
+    }
+    o->state = UJSON_ITER_DONE;
+    return MP_OBJ_STOP_ITERATION;
+}
+
+STATIC mp_obj_t mod_ujson_iterload(size_t n_args, const mp_obj_t *args) {
+    ujson_iter_obj_t *o = ujson_iter_new(args[0], ujson_iterload_iternext);
+    if (n_args > 1) {
+        o->path = args[1];
+    }
+    return MP_OBJ_FROM_PTR(o);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_ujson_iterload_obj, 1, 2, mod_ujson_iterload);
+
+// For iterevents, nest has one entry per open container: ']' for an array,
+// and for an object '}' if a key is expected next or ':' if a value is.
+STATIC mp_obj_t ujson_iterevents_iternext(mp_obj_t self_in) {
+    ujson_iter_obj_t *o = MP_OBJ_TO_PTR(self_in);
+    if (o->state == UJSON_ITER_DONE) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    mp_obj_t value = mp_const_none;
+    int tok = ujson_next_token(&o->s, &o->vstr, &value);
+    byte *top = o->nest.len == 0 ? NULL : (byte *)o->nest.buf + o->nest.len - 1;
+    mp_int_t ev;
+    if (tok == UJSON_TOK_EOF) {
+        if (top != NULL) {
+            ujson_raise_syntax();
+        }
+        o->state = UJSON_ITER_DONE;
+        return MP_OBJ_STOP_ITERATION;
+    } else if (tok == UJSON_TOK_END_ARRAY || tok == UJSON_TOK_END_OBJECT) {
+        byte expect = tok == UJSON_TOK_END_ARRAY ? ']' : '}';
+        if (top == NULL || *top != expect) {
+            ujson_raise_syntax();
+        }
+        o->nest.len -= 1;
+        ev = tok == UJSON_TOK_END_ARRAY ? UJSON_EV_END_ARRAY : UJSON_EV_END_OBJECT;
+    } else if (top != NULL && *top == '}') {
+        // a key is expected
+        if (tok != UJSON_TOK_VALUE || !mp_obj_is_str(value)) {
+            ujson_raise_syntax();
+        }
+        *top = ':';
+        ev = UJSON_EV_KEY;
+    } else {
+        if (top != NULL && *top == ':') {
+            *top = '}';
+        }
+        if (tok == UJSON_TOK_START_ARRAY) {
+            vstr_add_byte(&o->nest, ']');
+            ev = UJSON_EV_START_ARRAY;
+        } else if (tok == UJSON_TOK_START_OBJECT) {
+            vstr_add_byte(&o->nest, '}');
+            ev = UJSON_EV_START_OBJECT;
+        } else {
+            ev = UJSON_EV_VALUE;
+        }
+    }
+    mp_obj_t items[2] = {MP_OBJ_NEW_SMALL_INT(ev), value};
+    return mp_obj_new_tuple(2, items);
+}
+
+STATIC mp_obj_t mod_ujson_iterevents(mp_obj_t src) {
+    return MP_OBJ_FROM_PTR(ujson_iter_new(src, ujson_iterevents_iternext));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_ujson_iterevents_obj, mod_ujson_iterevents);
+
+#endif // MICROPY_PY_UJSON_ITERLOAD
+
 STATIC const mp_rom_map_elem_t mp_module_ujson_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ujson) },
     { MP_ROM_QSTR(MP_QSTR_dump), MP_ROM_PTR(&mod_ujson_dump_obj) },
     { MP_ROM_QSTR(MP_QSTR_dumps), MP_ROM_PTR(&mod_ujson_dumps_obj) },
     { MP_ROM_QSTR(MP_QSTR_load), MP_ROM_PTR(&mod_ujson_load_obj) },
     { MP_ROM_QSTR(MP_QSTR_loads), MP_ROM_PTR(&mod_ujson_loads_obj) },
+    #if MICROPY_PY_UJSON_ITERLOAD
+    { MP_ROM_QSTR(MP_QSTR_iterload), MP_ROM_PTR(&mod_ujson_iterload_obj) },
+    { MP_ROM_QSTR(MP_QSTR_iterevents), MP_ROM_PTR(&mod_ujson_iterevents_obj) },
+    { MP_ROM_QSTR(MP_QSTR_START_ARRAY), MP_ROM_INT(UJSON_EV_START_ARRAY) },
+    { MP_ROM_QSTR(MP_QSTR_END_ARRAY), MP_ROM_INT(UJSON_EV_END_ARRAY) },
+    { MP_ROM_QSTR(MP_QSTR_START_OBJECT), MP_ROM_INT(UJSON_EV_START_OBJECT) },
+    { MP_ROM_QSTR(MP_QSTR_END_OBJECT), MP_ROM_INT(UJSON_EV_END_OBJECT) },
+    { MP_ROM_QSTR(MP_QSTR_KEY), MP_ROM_INT(UJSON_EV_KEY) },
+    { MP_ROM_QSTR(MP_QSTR_VALUE), MP_ROM_INT(UJSON_EV_VALUE) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_ujson_globals, mp_module_ujson_globals_table);
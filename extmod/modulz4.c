@@ -0,0 +1,838 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/stream.h"
+#include "py/mperrno.h"
+
+#if MICROPY_PY_ULZ4
+
+// LZ4 compression and decompression.
+//
+// compress() and decompress() work on raw LZ4 blocks, as specified at
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md, and CompIO
+// and DecompIO read and write LZ4 frames, as specified at
+// https://github.com/lz4/lz4/blob/dev/doc/lz4_Frame_format.md, so the data
+// can be exchanged with the lz4 tool and libraries.
+//
+// The compressor finds matches with a single hash table of 16-bit entries,
+// of a fixed size of 2**MICROPY_PY_ULZ4_HASH_BITS, and the wbits argument
+// limits match offsets to below 2**wbits.  CompIO compresses independent
+// blocks of at most 2**wbits bytes, so that DecompIO only needs a history
+// buffer of that size to decode them.  DecompIO decodes a sequence at a
+// time straight from the stream, never reading past the end of the frame,
+// and so uses no more RAM than the history buffer and a small input buffer.
+
+#define ULZ4_MIN_MATCH (4)
+// The last 5 bytes of a block are always literals, and the last match must
+// start at least 12 bytes before the end of the block.
+#define ULZ4_LAST_LITERALS (5)
+#define ULZ4_MFLIMIT (12)
+
+// Worst case size of the compressed data for len bytes of input.
+#define ULZ4_BOUND(len) ((len) + (len) / 255 + 16)
+
+#define ULZ4_FRAME_MAGIC (0x184d2204)
+#define ULZ4_FLG_VERSION (0x40)
+#define ULZ4_FLG_BLOCK_INDEP (0x20)
+#define ULZ4_FLG_BLOCK_CHECKSUM (0x10)
+#define ULZ4_FLG_CONTENT_SIZE (0x08)
+#define ULZ4_FLG_CONTENT_CHECKSUM (0x04)
+#define ULZ4_FLG_DICT_ID (0x01)
+#define ULZ4_BD_64KB (0x40)
+#define ULZ4_BLOCK_UNCOMPRESSED (0x80000000)
+
+// Size of DecompIO's buffer for compressed data.
+#define ULZ4_DECOMPIO_BUF_SIZE (64)
+
+STATIC inline uint32_t ulz4_get32(const byte *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+STATIC inline uint32_t ulz4_get32le(const byte *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+STATIC inline void ulz4_put32le(byte *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+STATIC mp_int_t ulz4_get_wbits(size_t n_args, const mp_obj_t *args, size_t i) {
+    mp_int_t wbits = n_args > i ? mp_obj_get_int(args[i]) : 16;
+    if (wbits < 8 || wbits > 16) {
+        mp_raise_ValueError(MP_ERROR_TEXT("wbits"));
+    }
+    return wbits;
+}
+
+/******************************************************************************/
+// xxHash32, used for the checksums in the frame format
+
+#define ULZ4_PRIME1 (2654435761U)
+#define ULZ4_PRIME2 (2246822519U)
+#define ULZ4_PRIME3 (3266489917U)
+#define ULZ4_PRIME4 (668265263U)
+#define ULZ4_PRIME5 (374761393U)
+
+typedef struct _ulz4_xxh32_t {
+    uint32_t v[4];
+    uint32_t total_len;
+    byte buf[16];
+    byte buf_len;
+    bool large; // at least 16 bytes were hashed
+} ulz4_xxh32_t;
+
+STATIC inline uint32_t ulz4_rotl(uint32_t x, unsigned int r) {
+    return x << r | x >> (32 - r);
+}
+
+STATIC inline uint32_t ulz4_xxh32_round(uint32_t acc, uint32_t input) {
+    return ulz4_rotl(acc + input * ULZ4_PRIME2, 13) * ULZ4_PRIME1;
+}
+
+STATIC void ulz4_xxh32_init(ulz4_xxh32_t *h) {
+    h->v[0] = ULZ4_PRIME1 + ULZ4_PRIME2;
+    h->v[1] = ULZ4_PRIME2;
+    h->v[2] = 0;
+    h->v[3] = -ULZ4_PRIME1;
+    h->total_len = 0;
+    h->buf_len = 0;
+    h->large = false;
+}
+
+STATIC void ulz4_xxh32_stripe(ulz4_xxh32_t *h, const byte *p) {
+    for (size_t i = 0; i < 4; ++i) {
+        h->v[i] = ulz4_xxh32_round(h->v[i], ulz4_get32le(p + 4 * i));
+    }
+}
+
+STATIC void ulz4_xxh32_update(ulz4_xxh32_t *h, const byte *p, size_t len) {
+    h->total_len += len;
+    h->large |= len >= 16 || h->total_len >= 16;
+    if (h->buf_len + len < 16) {
+        memcpy(h->buf + h->buf_len, p, len);
+        h->buf_len += len;
+        return;
+    }
+    if (h->buf_len != 0) {
+        size_t n = 16 - h->buf_len;
+        memcpy(h->buf + h->buf_len, p, n);
+        ulz4_xxh32_stripe(h, h->buf);
+        p += n;
+        len -= n;
+    }
+    for (; len >= 16; p += 16, len -= 16) {
+        ulz4_xxh32_stripe(h, p);
+    }
+    memcpy(h->buf, p, len);
+    h->buf_len = len;
+}
+
+STATIC uint32_t ulz4_xxh32_digest(const ulz4_xxh32_t *h) {
+    uint32_t acc;
+    if (h->large) {
+        acc = ulz4_rotl(h->v[0], 1) + ulz4_rotl(h->v[1], 7) + ulz4_rotl(h->v[2], 12) + ulz4_rotl(h->v[3], 18);
+    } else {
+        acc = ULZ4_PRIME5;
+    }
+    acc += h->total_len;
+    const byte *p = h->buf;
+    size_t len = h->buf_len;
+    for (; len >= 4; p += 4, len -= 4) {
+        acc = ulz4_rotl(acc + ulz4_get32le(p) * ULZ4_PRIME3, 17) * ULZ4_PRIME4;
+    }
+    for (; len > 0; ++p, --len) {
+        acc = ulz4_rotl(acc + *p * ULZ4_PRIME5, 11) * ULZ4_PRIME1;
+    }
+    acc ^= acc >> 15;
+    acc *= ULZ4_PRIME2;
+    acc ^= acc >> 13;
+    acc *= ULZ4_PRIME3;
+    acc ^= acc >> 16;
+    return acc;
+}
+
+/******************************************************************************/
+// Block compression and decompression
+
+STATIC inline uint32_t ulz4_hash(uint32_t v) {
+    return (v * ULZ4_PRIME1) >> (32 - MICROPY_PY_ULZ4_HASH_BITS);
+}
+
+STATIC byte *ulz4_put_len(byte *op, size_t n) {
+    for (; n >= 255; n -= 255) {
+        *op++ = 255;
+    }
+    *op++ = n;
+    return op;
+}
+
+STATIC byte *ulz4_put_seq(byte *op, const byte *lit, size_t lit_len, size_t off, size_t match_len) {
+    byte *token = op++;
+    if (lit_len >= 15) {
+        *token = 15 << 4;
+        op = ulz4_put_len(op, lit_len - 15);
+    } else {
+        *token = lit_len << 4;
+    }
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (off != 0) {
+        *op++ = off;
+        *op++ = off >> 8;
+        match_len -= ULZ4_MIN_MATCH;
+        if (match_len >= 15) {
+            *token |= 15;
+            op = ulz4_put_len(op, match_len - 15);
+        } else {
+            *token |= match_len;
+        }
+    }
+    return op;
+}
+
+// Compress len bytes at src to dest, which must have room for ULZ4_BOUND(len)
+// bytes, using match offsets below max_off, and return the compressed length.
+// table must have 2**MICROPY_PY_ULZ4_HASH_BITS entries.  They hold the low
+// 16 bits of positions in src, and the most recent position with those bits
+// is taken as the match candidate.  Any offset is at most 65535 anyway, and
+// a wrong guess is caught by comparing the data.
+STATIC size_t ulz4_compress_block(uint16_t *table, const byte *src, size_t len, byte *dest, size_t max_off) {
+    const byte *end = src + len;
+    const byte *anchor = src;
+    byte *op = dest;
+
+    memset(table, 0, sizeof(uint16_t) << MICROPY_PY_ULZ4_HASH_BITS);
+
+    if (len > ULZ4_MFLIMIT) {
+        const byte *mflimit = end - ULZ4_MFLIMIT;
+        const byte *match_limit = end - ULZ4_LAST_LITERALS;
+        const byte *ip = src;
+        while (ip <= mflimit) {
+            uint32_t seq = ulz4_get32(ip);
+            uint32_t h = ulz4_hash(seq);
+            size_t pos = ip - src;
+            size_t off = (uint16_t)(pos - table[h]);
+            table[h] = pos;
+            if (off == 0 || off > pos || off >= max_off || ulz4_get32(ip - off) != seq) {
+                // skip ahead faster the longer no match has been found
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // extend the match backwards and forwards
+            const byte *match = ip - off;
+            while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                --ip;
+                --match;
+            }
+            const byte *mp = ip + ULZ4_MIN_MATCH;
+            while (mp < match_limit && *mp == mp[-off]) {
+                ++mp;
+            }
+
+            op = ulz4_put_seq(op, anchor, ip - anchor, off, mp - ip);
+            ip = anchor = mp;
+            if (ip <= mflimit) {
+                // hash a position inside the match, which helps with runs
+                table[ulz4_hash(ulz4_get32(ip - 2))] = ip - 2 - src;
+            }
+        }
+    }
+
+    // the remaining data is a final sequence of literals only
+    op = ulz4_put_seq(op, anchor, end - anchor, 0, 0);
+    return op - dest;
+}
+
+STATIC bool ulz4_get_len(const byte **ip, const byte *iend, size_t *n) {
+    if (*n == 15) {
+        byte b;
+        do {
+            if (*ip >= iend) {
+                return false;
+            }
+            b = *(*ip)++;
+            *n += b;
+        } while (b == 255);
+    }
+    return true;
+}
+
+// Decompress the len bytes of LZ4 block at src into the dest_len bytes at
+// dest, returning the decompressed length, or -1 if the data is not valid or
+// doesn't fit.  The output may overlap the input if src is at or after dest;
+// the data can then be decompressed in place, provided no output needs to
+// be written over input that has not been read yet.
+STATIC mp_int_t ulz4_decompress_block(const byte *src, size_t len, byte *dest, size_t dest_len) {
+    const byte *ip = src;
+    const byte *iend = src + len;
+    byte *op = dest;
+    byte *oend = dest + dest_len;
+    bool overlap = (const byte *)dest <= iend && src <= (const byte *)oend;
+    if (overlap && src < (const byte *)dest) {
+        return -1;
+    }
+
+    for (;;) {
+        if (ip >= iend) {
+            return -1;
+        }
+        byte token = *ip++;
+
+        // literals, moved as op may be (but never is after) ip
+        size_t n = token >> 4;
+        if (!ulz4_get_len(&ip, iend, &n) || n > (size_t)(iend - ip) || n > (size_t)(oend - op)) {
+            return -1;
+        }
+        memmove(op, ip, n);
+        op += n;
+        ip += n;
+        if (ip == iend) {
+            // the last sequence has no match
+            return op - dest;
+        }
+
+        // match
+        if (iend - ip < 2) {
+            return -1;
+        }
+        size_t off = ip[0] | ip[1] << 8;
+        ip += 2;
+        n = token & 15;
+        if (!ulz4_get_len(&ip, iend, &n)) {
+            return -1;
+        }
+        n += ULZ4_MIN_MATCH;
+        if (off == 0 || off > (size_t)(op - dest) || n > (size_t)(oend - op)
+            || (overlap && op + n > ip)) {
+            return -1;
+        }
+        const byte *match = op - off;
+        if (off >= n) {
+            memcpy(op, match, n);
+            op += n;
+        } else {
+            // the match overlaps the output, so repeats the last off bytes
+            while (n--) {
+                *op++ = *match++;
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+// Module functions
+
+STATIC mp_obj_t mod_ulz4_compress(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    mp_int_t wbits = ulz4_get_wbits(n_args, args, 1);
+    uint16_t *table = m_new(uint16_t, 1 << MICROPY_PY_ULZ4_HASH_BITS);
+    vstr_t vstr;
+    vstr_init_len(&vstr, ULZ4_BOUND(bufinfo.len));
+    vstr.len = ulz4_compress_block(table, bufinfo.buf, bufinfo.len, (byte *)vstr.buf, 1 << wbits);
+    m_del(uint16_t, table, 1 << MICROPY_PY_ULZ4_HASH_BITS);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_ulz4_compress_obj, 1, 2, mod_ulz4_compress);
+
+STATIC void ulz4_decompress_error(void) {
+    mp_raise_ValueError(MP_ERROR_TEXT("invalid LZ4 data"));
+}
+
+STATIC mp_obj_t mod_ulz4_decompress(mp_obj_t data_in, mp_obj_t size_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data_in, &bufinfo, MP_BUFFER_READ);
+    mp_int_t size = mp_obj_get_int(size_in);
+    if (size < 0) {
+        mp_raise_ValueError(NULL);
+    }
+    vstr_t vstr;
+    vstr_init_len(&vstr, size);
+    mp_int_t len = ulz4_decompress_block(bufinfo.buf, bufinfo.len, (byte *)vstr.buf, size);
+    if (len < 0) {
+        vstr_clear(&vstr);
+        ulz4_decompress_error();
+    }
+    vstr.len = len;
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_ulz4_decompress_obj, mod_ulz4_decompress);
+
+STATIC mp_obj_t mod_ulz4_decompress_into(mp_obj_t data_in, mp_obj_t buf_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data_in, &bufinfo, MP_BUFFER_READ);
+    mp_buffer_info_t destinfo;
+    mp_get_buffer_raise(buf_in, &destinfo, MP_BUFFER_WRITE);
+    mp_int_t len = ulz4_decompress_block(bufinfo.buf, bufinfo.len, destinfo.buf, destinfo.len);
+    if (len < 0) {
+        ulz4_decompress_error();
+    }
+    return MP_OBJ_NEW_SMALL_INT(len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_ulz4_decompress_into_obj, mod_ulz4_decompress_into);
+
+/******************************************************************************/
+// CompIO, writing an LZ4 frame to a stream
+
+typedef struct _mp_obj_ulz4_compio_t {
+    mp_obj_base_t base;
+    mp_obj_t dest_stream;
+    ulz4_xxh32_t checksum;
+    uint16_t *table;
+    byte *block; // the block being collected, of block_size bytes
+    byte *outbuf; // 4-byte block header and compressed block
+    size_t block_size;
+    size_t block_len;
+    bool finished;
+} mp_obj_ulz4_compio_t;
+
+STATIC mp_obj_t ulz4_compio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+    mp_get_stream_raise(args[0], MP_STREAM_OP_WRITE);
+    mp_int_t wbits = ulz4_get_wbits(n_args, args, 1);
+
+    mp_obj_ulz4_compio_t *o = m_new_obj(mp_obj_ulz4_compio_t);
+    o->base.type = type;
+    o->dest_stream = args[0];
+    ulz4_xxh32_init(&o->checksum);
+    o->table = m_new(uint16_t, 1 << MICROPY_PY_ULZ4_HASH_BITS);
+    o->block_size = 1 << wbits;
+    o->block = m_new(byte, o->block_size);
+    o->outbuf = m_new(byte, 4 + ULZ4_BOUND(o->block_size));
+    o->block_len = 0;
+    o->finished = false;
+
+    // frame header: magic, independent blocks with a content checksum,
+    // blocks of up to 64k, and the header checksum
+    byte header[7];
+    ulz4_put32le(header, ULZ4_FRAME_MAGIC);
+    header[4] = ULZ4_FLG_VERSION | ULZ4_FLG_BLOCK_INDEP | ULZ4_FLG_CONTENT_CHECKSUM;
+    header[5] = ULZ4_BD_64KB;
+    ulz4_xxh32_t hc;
+    ulz4_xxh32_init(&hc);
+    ulz4_xxh32_update(&hc, header + 4, 2);
+    header[6] = ulz4_xxh32_digest(&hc) >> 8;
+    mp_stream_write(o->dest_stream, header, sizeof(header), MP_STREAM_RW_WRITE);
+    return MP_OBJ_FROM_PTR(o);
+}
+
+// Write out the collected block, stored as is if it doesn't compress.
+STATIC void ulz4_compio_write_block(mp_obj_ulz4_compio_t *o) {
+    if (o->block_len == 0) {
+        return;
+    }
+    size_t len = ulz4_compress_block(o->table, o->block, o->block_len, o->outbuf + 4, o->block_size);
+    uint32_t header = len;
+    if (len >= o->block_len) {
+        len = o->block_len;
+        header = len | ULZ4_BLOCK_UNCOMPRESSED;
+        memcpy(o->outbuf + 4, o->block, len);
+    }
+    ulz4_put32le(o->outbuf, header);
+    mp_stream_write(o->dest_stream, o->outbuf, 4 + len, MP_STREAM_RW_WRITE);
+    o->block_len = 0;
+}
+
+STATIC mp_uint_t ulz4_compio_write(mp_obj_t self_in, const void *buf_in, mp_uint_t size, int *errcode) {
+    mp_obj_ulz4_compio_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->finished) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    const byte *buf = buf_in;
+    ulz4_xxh32_update(&self->checksum, buf, size);
+    for (mp_uint_t left = size; left > 0;) {
+        size_t n = MIN(left, self->block_size - self->block_len);
+        memcpy(self->block + self->block_len, buf, n);
+        self->block_len += n;
+        buf += n;
+        left -= n;
+        if (self->block_len == self->block_size) {
+            ulz4_compio_write_block(self);
+        }
+    }
+    return size;
+}
+
+STATIC mp_uint_t ulz4_compio_ioctl(mp_obj_t self_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    mp_obj_ulz4_compio_t *self = MP_OBJ_TO_PTR(self_in);
+    if (request == MP_STREAM_FLUSH || request == MP_STREAM_CLOSE) {
+        // the output stream is flushed but not closed
+        if (!self->finished) {
+            ulz4_compio_write_block(self);
+            if (request == MP_STREAM_CLOSE) {
+                // end mark and content checksum
+                byte trailer[8];
+                ulz4_put32le(trailer, 0);
+                ulz4_put32le(trailer + 4, ulz4_xxh32_digest(&self->checksum));
+                mp_stream_write(self->dest_stream, trailer, sizeof(trailer), MP_STREAM_RW_WRITE);
+                self->finished = true;
+            }
+        }
+        const mp_stream_p_t *stream_p = mp_get_stream(self->dest_stream);
+        if (stream_p->ioctl != NULL) {
+            int err;
+            stream_p->ioctl(self->dest_stream, MP_STREAM_FLUSH, 0, &err);
+        }
+        return 0;
+    } else {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+}
+
+STATIC const mp_rom_map_elem_t ulz4_compio_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&mp_stream_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mp_stream_close_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(ulz4_compio_locals_dict, ulz4_compio_locals_dict_table);
+
+STATIC const mp_stream_p_t ulz4_compio_stream_p = {
+    .write = ulz4_compio_write,
+    .ioctl = ulz4_compio_ioctl,
+};
+
+STATIC const mp_obj_type_t ulz4_compio_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_CompIO,
+    .make_new = ulz4_compio_make_new,
+    .protocol = &ulz4_compio_stream_p,
+    .locals_dict = (void *)&ulz4_compio_locals_dict,
+};
+
+/******************************************************************************/
+// DecompIO, reading an LZ4 frame from a stream
+
+enum {
+    ULZ4_ST_BLOCK, // at the start of a block
+    ULZ4_ST_TOKEN, // at the start of a sequence
+    ULZ4_ST_LITERALS, // in the literals of a sequence
+    ULZ4_ST_MATCH, // in the match of a sequence
+    ULZ4_ST_RAW, // in an uncompressed block
+    ULZ4_ST_END, // at the end of the frame
+};
+
+typedef struct _mp_obj_ulz4_decompio_t {
+    mp_obj_base_t base;
+    mp_obj_t src_stream;
+    ulz4_xxh32_t content_sum;
+    ulz4_xxh32_t block_sum;
+    byte *hist; // the last 2**wbits bytes of output
+    size_t hist_mask;
+    size_t hist_pos;
+    size_t out_len; // total output, up to the size of hist
+    uint32_t block_left; // bytes of the block still to be read from the stream
+    size_t count; // bytes of literals or match still to be output
+    size_t match_off;
+    byte match_len; // the match length bits of the token
+    byte flags; // FLG byte of the frame
+    byte state;
+    byte in_pos;
+    byte in_len;
+    byte inbuf[ULZ4_DECOMPIO_BUF_SIZE];
+} mp_obj_ulz4_decompio_t;
+
+STATIC void ulz4_read_exact(mp_obj_t stream, byte *buf, size_t len) {
+    int err;
+    mp_uint_t out_sz = mp_stream_rw(stream, buf, len, &err, MP_STREAM_RW_READ);
+    if (err != 0) {
+        mp_raise_OSError(err);
+    }
+    if (out_sz < len) {
+        mp_raise_type(&mp_type_EOFError);
+    }
+}
+
+STATIC uint32_t ulz4_read32le(mp_obj_t stream) {
+    byte buf[4];
+    ulz4_read_exact(stream, buf, sizeof(buf));
+    return ulz4_get32le(buf);
+}
+
+// Return the number of bytes of the current block available in inbuf,
+// reading more from the stream if none are, but not past the block end.
+STATIC size_t ulz4_decompio_avail(mp_obj_ulz4_decompio_t *o) {
+    if (o->in_pos == o->in_len && o->block_left != 0) {
+        size_t n = MIN(o->block_left, sizeof(o->inbuf));
+        ulz4_read_exact(o->src_stream, o->inbuf, n);
+        if (o->flags & ULZ4_FLG_BLOCK_CHECKSUM) {
+            ulz4_xxh32_update(&o->block_sum, o->inbuf, n);
+        }
+        o->block_left -= n;
+        o->in_pos = 0;
+        o->in_len = n;
+    }
+    return o->in_len - o->in_pos;
+}
+
+STATIC bool ulz4_decompio_byte(mp_obj_ulz4_decompio_t *o, byte *b) {
+    if (ulz4_decompio_avail(o) == 0) {
+        return false;
+    }
+    *b = o->inbuf[o->in_pos++];
+    return true;
+}
+
+STATIC bool ulz4_decompio_len(mp_obj_ulz4_decompio_t *o, size_t *n) {
+    if (*n == 15) {
+        byte b;
+        do {
+            if (!ulz4_decompio_byte(o, &b)) {
+                return false;
+            }
+            *n += b;
+        } while (b == 255);
+    }
+    return true;
+}
+
+STATIC inline void ulz4_decompio_out(mp_obj_ulz4_decompio_t *o, byte **out, byte b) {
+    *(*out)++ = b;
+    o->hist[o->hist_pos] = b;
+    o->hist_pos = (o->hist_pos + 1) & o->hist_mask;
+}
+
+// Finish the current block, checking its checksum if it has one.
+STATIC bool ulz4_decompio_end_block(mp_obj_ulz4_decompio_t *o) {
+    o->state = ULZ4_ST_BLOCK;
+    return !(o->flags & ULZ4_FLG_BLOCK_CHECKSUM)
+           || ulz4_read32le(o->src_stream) == ulz4_xxh32_digest(&o->block_sum);
+}
+
+// Decompress into buf until it's full or the frame ends.  Returns the number
+// of bytes written, or -1 if the data is not valid.
+STATIC mp_int_t ulz4_decompio_run(mp_obj_ulz4_decompio_t *o, byte *buf, size_t size) {
+    byte *out = buf;
+    byte *out_end = buf + size;
+    while (out < out_end) {
+        switch (o->state) {
+            case ULZ4_ST_BLOCK: {
+                uint32_t header = ulz4_read32le(o->src_stream);
+                if (header == 0) {
+                    // end mark; the caller adds the output to the content
+                    // checksum except at the end, when it's done here
+                    o->state = ULZ4_ST_END;
+                    ulz4_xxh32_update(&o->content_sum, buf, out - buf);
+                    if ((o->flags & ULZ4_FLG_CONTENT_CHECKSUM)
+                        && ulz4_read32le(o->src_stream) != ulz4_xxh32_digest(&o->content_sum)) {
+                        return -1;
+                    }
+                    return out - buf;
+                }
+                o->block_left = header & ~ULZ4_BLOCK_UNCOMPRESSED;
+                ulz4_xxh32_init(&o->block_sum);
+                o->state = (header & ULZ4_BLOCK_UNCOMPRESSED) ? ULZ4_ST_RAW : ULZ4_ST_TOKEN;
+                break;
+            }
+            case ULZ4_ST_TOKEN: {
+                byte token;
+                if (!ulz4_decompio_byte(o, &token)) {
+                    return -1;
+                }
+                o->count = token >> 4;
+                o->match_len = token & 15;
+                if (!ulz4_decompio_len(o, &o->count)) {
+                    return -1;
+                }
+                o->state = ULZ4_ST_LITERALS;
+                break;
+            }
+            case ULZ4_ST_LITERALS: {
+                while (o->count != 0 && out < out_end) {
+                    size_t n = ulz4_decompio_avail(o);
+                    if (n == 0) {
+                        return -1;
+                    }
+                    n = MIN(n, MIN(o->count, (size_t)(out_end - out)));
+                    o->count -= n;
+                    while (n--) {
+                        ulz4_decompio_out(o, &out, o->inbuf[o->in_pos++]);
+                    }
+                }
+                if (o->count != 0) {
+                    break;
+                }
+                if (ulz4_decompio_avail(o) == 0) {
+                    // the last sequence of the block has no match
+                    if (!ulz4_decompio_end_block(o)) {
+                        return -1;
+                    }
+                    break;
+                }
+                byte off[2];
+                if (!ulz4_decompio_byte(o, &off[0]) || !ulz4_decompio_byte(o, &off[1])) {
+                    return -1;
+                }
+                o->match_off = off[0] | off[1] << 8;
+                o->count = o->match_len;
+                if (!ulz4_decompio_len(o, &o->count)) {
+                    return -1;
+                }
+                o->count += ULZ4_MIN_MATCH;
+                // the offset must be within the output so far, and the history
+                if (o->match_off == 0 || o->match_off > o->out_len + (out - buf)
+                    || o->match_off > o->hist_mask + 1) {
+                    return -1;
+                }
+                o->state = ULZ4_ST_MATCH;
+                break;
+            }
+            case ULZ4_ST_MATCH: {
+                size_t n = MIN(o->count, (size_t)(out_end - out));
+                o->count -= n;
+                size_t pos = o->hist_pos - o->match_off;
+                while (n--) {
+                    ulz4_decompio_out(o, &out, o->hist[pos & o->hist_mask]);
+                    ++pos;
+                }
+                if (o->count == 0) {
+                    o->state = ULZ4_ST_TOKEN;
+                }
+                break;
+            }
+            case ULZ4_ST_RAW: {
+                size_t n = ulz4_decompio_avail(o);
+                if (n == 0) {
+                    if (!ulz4_decompio_end_block(o)) {
+                        return -1;
+                    }
+                    break;
+                }
+                n = MIN(n, (size_t)(out_end - out));
+                while (n--) {
+                    ulz4_decompio_out(o, &out, o->inbuf[o->in_pos++]);
+                }
+                break;
+            }
+            default:
+                return out - buf;
+        }
+    }
+    return out - buf;
+}
+
+STATIC mp_obj_t ulz4_decompio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+    mp_get_stream_raise(args[0], MP_STREAM_OP_READ);
+    mp_int_t wbits = ulz4_get_wbits(n_args, args, 1);
+
+    mp_obj_ulz4_decompio_t *o = m_new_obj(mp_obj_ulz4_decompio_t);
+    o->base.type = type;
+    o->src_stream = args[0];
+    ulz4_xxh32_init(&o->content_sum);
+    o->hist = m_new(byte, 1 << wbits);
+    o->hist_mask = (1 << wbits) - 1;
+    o->hist_pos = 0;
+    o->out_len = 0;
+    o->block_left = 0;
+    o->state = ULZ4_ST_BLOCK;
+    o->in_pos = 0;
+    o->in_len = 0;
+
+    // frame header, with optional content size (which is skipped) and no
+    // dictionary id
+    byte header[15];
+    ulz4_read_exact(o->src_stream, header, 7);
+    byte flags = header[4];
+    size_t len = 7;
+    if (flags & ULZ4_FLG_CONTENT_SIZE) {
+        ulz4_read_exact(o->src_stream, header + 7, 8);
+        len += 8;
+    }
+    ulz4_xxh32_t hc;
+    ulz4_xxh32_init(&hc);
+    ulz4_xxh32_update(&hc, header + 4, len - 5);
+    if (ulz4_get32le(header) != ULZ4_FRAME_MAGIC
+        || (flags & 0xc3) != ULZ4_FLG_VERSION
+        || (byte)(ulz4_xxh32_digest(&hc) >> 8) != header[len - 1]) {
+        mp_raise_ValueError(MP_ERROR_TEXT("compression header"));
+    }
+    o->flags = flags;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_uint_t ulz4_decompio_read(mp_obj_t o_in, void *buf, mp_uint_t size, int *errcode) {
+    mp_obj_ulz4_decompio_t *o = MP_OBJ_TO_PTR(o_in);
+    mp_int_t len = ulz4_decompio_run(o, buf, size);
+    if (len < 0) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    if (o->state != ULZ4_ST_END) {
+        ulz4_xxh32_update(&o->content_sum, buf, len);
+    }
+    o->out_len = MIN(o->out_len + len, o->hist_mask + 1);
+    return len;
+}
+
+STATIC const mp_rom_map_elem_t ulz4_decompio_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_read), MP_ROM_PTR(&mp_stream_read_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&mp_stream_readinto_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readline), MP_ROM_PTR(&mp_stream_unbuffered_readline_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(ulz4_decompio_locals_dict, ulz4_decompio_locals_dict_table);
+
+STATIC const mp_stream_p_t ulz4_decompio_stream_p = {
+    .read = ulz4_decompio_read,
+};
+
+STATIC const mp_obj_type_t ulz4_decompio_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_DecompIO,
+    .make_new = ulz4_decompio_make_new,
+    .protocol = &ulz4_decompio_stream_p,
+    .locals_dict = (void *)&ulz4_decompio_locals_dict,
+};
+
+STATIC const mp_rom_map_elem_t mp_module_ulz4_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ulz4) },
+    { MP_ROM_QSTR(MP_QSTR_compress), MP_ROM_PTR(&mod_ulz4_compress_obj) },
+    { MP_ROM_QSTR(MP_QSTR_decompress), MP_ROM_PTR(&mod_ulz4_decompress_obj) },
+    { MP_ROM_QSTR(MP_QSTR_decompress_into), MP_ROM_PTR(&mod_ulz4_decompress_into_obj) },
+    { MP_ROM_QSTR(MP_QSTR_CompIO), MP_ROM_PTR(&ulz4_compio_type) },
+    { MP_ROM_QSTR(MP_QSTR_DecompIO), MP_ROM_PTR(&ulz4_decompio_type) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_ulz4_globals, mp_module_ulz4_globals_table);
+
+const mp_obj_module_t mp_module_ulz4 = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t *)&mp_module_ulz4_globals,
+};
+
+#endif // MICROPY_PY_ULZ4
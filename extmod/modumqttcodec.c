@@ -0,0 +1,396 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+
+#if MICROPY_PY_UMQTTCODEC
+
+// MQTT 3.1.1 packet encoder and decoder.
+//
+// The encode functions write a complete packet (or, for PUBLISH, optionally
+// just its header) into a caller-provided buffer and return the number of
+// bytes written, so no intermediate objects are created.  The decoder takes a
+// buffer holding the data received so far and returns None if it doesn't
+// contain a complete packet yet, otherwise the packet fields with the topic
+// and payload as memoryviews into the buffer.  No I/O is done here, so the
+// same code works with blocking sockets and with uasyncio streams.
+
+// Packet types, as stored in the high nibble of the first byte.
+#define UMQTT_CONNECT (1)
+#define UMQTT_CONNACK (2)
+#define UMQTT_PUBLISH (3)
+#define UMQTT_PUBACK (4)
+#define UMQTT_PUBREC (5)
+#define UMQTT_PUBREL (6)
+#define UMQTT_PUBCOMP (7)
+#define UMQTT_SUBSCRIBE (8)
+#define UMQTT_SUBACK (9)
+#define UMQTT_UNSUBSCRIBE (10)
+#define UMQTT_UNSUBACK (11)
+#define UMQTT_PINGREQ (12)
+#define UMQTT_PINGRESP (13)
+#define UMQTT_DISCONNECT (14)
+
+// Largest value that fits in the 4-byte remaining length field.
+#define UMQTT_MAX_REMAINING_LENGTH (268435455)
+
+STATIC NORETURN void umqtt_raise_bad(void) {
+    mp_raise_ValueError(MP_ERROR_TEXT("bad MQTT packet"));
+}
+
+// Get the destination buffer and check that it can hold len bytes.
+STATIC byte *umqtt_get_dest(mp_obj_t buf_in, size_t len) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    if (bufinfo.len < len) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer too small"));
+    }
+    return bufinfo.buf;
+}
+
+// Number of bytes needed to encode the remaining length n.
+STATIC size_t umqtt_varint_size(size_t n) {
+    if (n > UMQTT_MAX_REMAINING_LENGTH) {
+        mp_raise_ValueError(MP_ERROR_TEXT("packet too large"));
+    }
+    return n < 0x80 ? 1 : n < 0x4000 ? 2 : n < 0x200000 ? 3 : 4;
+}
+
+// Write the fixed header and return a pointer just past it.
+STATIC byte *umqtt_put_header(byte *p, byte type_flags, size_t rem_len) {
+    *p++ = type_flags;
+    do {
+        byte b = rem_len & 0x7f;
+        rem_len >>= 7;
+        if (rem_len != 0) {
+            b |= 0x80;
+        }
+        *p++ = b;
+    } while (rem_len != 0);
+    return p;
+}
+
+STATIC byte *umqtt_put_u16(byte *p, mp_uint_t v) {
+    p[0] = v >> 8;
+    p[1] = v;
+    return p + 2;
+}
+
+STATIC byte *umqtt_put_str(byte *p, const char *s, size_t len) {
+    p = umqtt_put_u16(p, len);
+    memcpy(p, s, len);
+    return p + len;
+}
+
+STATIC const char *umqtt_get_topic(mp_obj_t topic_in, size_t *len) {
+    const char *topic = mp_obj_str_get_data(topic_in, len);
+    if (*len > 0xffff) {
+        mp_raise_ValueError(MP_ERROR_TEXT("topic too long"));
+    }
+    return topic;
+}
+
+STATIC mp_uint_t umqtt_get_pid(mp_obj_t pid_in) {
+    mp_int_t pid = mp_obj_get_int(pid_in);
+    if (pid < 0 || pid > 0xffff) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bad packet id"));
+    }
+    return pid;
+}
+
+STATIC mp_obj_t mod_umqttcodec_encode_publish(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_buf, ARG_topic, ARG_msg, ARG_qos, ARG_retain, ARG_dup, ARG_pid };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_buf, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_topic, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_msg, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_qos, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_retain, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+        { MP_QSTR_dup, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+        { MP_QSTR_pid, MP_ARG_KW_ONLY | MP_ARG_OBJ, {.u_obj = MP_OBJ_NEW_SMALL_INT(0)} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_int_t qos = args[ARG_qos].u_int;
+    if (qos < 0 || qos > 2) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bad qos"));
+    }
+    mp_uint_t pid = umqtt_get_pid(args[ARG_pid].u_obj);
+
+    size_t topic_len;
+    const char *topic = umqtt_get_topic(args[ARG_topic].u_obj, &topic_len);
+
+    // The message is either a buffer, which is copied after the header, or
+    // an integer giving its length, in which case only the header is written
+    // and the caller sends the payload separately.
+    mp_buffer_info_t msg = {.buf = NULL, .len = 0};
+    size_t msg_len;
+    if (mp_obj_is_int(args[ARG_msg].u_obj)) {
+        mp_int_t n = mp_obj_get_int(args[ARG_msg].u_obj);
+        if (n < 0) {
+            mp_raise_ValueError(NULL);
+        }
+        msg_len = n;
+    } else {
+        mp_get_buffer_raise(args[ARG_msg].u_obj, &msg, MP_BUFFER_READ);
+        msg_len = msg.len;
+    }
+
+    size_t rem_len = 2 + topic_len + (qos > 0 ? 2 : 0) + msg_len;
+    size_t hdr_len = 1 + umqtt_varint_size(rem_len);
+    size_t out_len = hdr_len + rem_len - (msg.buf == NULL ? msg_len : 0);
+    byte *p = umqtt_get_dest(args[ARG_buf].u_obj, out_len);
+
+    byte type_flags = UMQTT_PUBLISH << 4 | qos << 1;
+    if (args[ARG_retain].u_bool) {
+        type_flags |= 0x01;
+    }
+    if (args[ARG_dup].u_bool) {
+        type_flags |= 0x08;
+    }
+    p = umqtt_put_header(p, type_flags, rem_len);
+    p = umqtt_put_str(p, topic, topic_len);
+    if (qos > 0) {
+        p = umqtt_put_u16(p, pid);
+    }
+    if (msg.buf != NULL) {
+        memcpy(p, msg.buf, msg_len);
+    }
+    return MP_OBJ_NEW_SMALL_INT(out_len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_umqttcodec_encode_publish_obj, 3, mod_umqttcodec_encode_publish);
+
+STATIC mp_obj_t mod_umqttcodec_encode_subscribe(size_t n_args, const mp_obj_t *args) {
+    mp_uint_t pid = umqtt_get_pid(args[1]);
+    size_t topic_len;
+    const char *topic = umqtt_get_topic(args[2], &topic_len);
+    mp_int_t qos = n_args > 3 ? mp_obj_get_int(args[3]) : 0;
+    if (qos < 0 || qos > 2) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bad qos"));
+    }
+
+    size_t rem_len = 2 + 2 + topic_len + 1;
+    size_t out_len = 1 + umqtt_varint_size(rem_len) + rem_len;
+    byte *p = umqtt_get_dest(args[0], out_len);
+    p = umqtt_put_header(p, UMQTT_SUBSCRIBE << 4 | 0x02, rem_len);
+    p = umqtt_put_u16(p, pid);
+    p = umqtt_put_str(p, topic, topic_len);
+    *p = qos;
+    return MP_OBJ_NEW_SMALL_INT(out_len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_umqttcodec_encode_subscribe_obj, 3, 4, mod_umqttcodec_encode_subscribe);
+
+STATIC mp_obj_t mod_umqttcodec_encode_suback(mp_obj_t buf_in, mp_obj_t pid_in, mp_obj_t codes_in) {
+    mp_uint_t pid = umqtt_get_pid(pid_in);
+    mp_buffer_info_t codes;
+    mp_get_buffer_raise(codes_in, &codes, MP_BUFFER_READ);
+
+    size_t rem_len = 2 + codes.len;
+    size_t out_len = 1 + umqtt_varint_size(rem_len) + rem_len;
+    byte *p = umqtt_get_dest(buf_in, out_len);
+    p = umqtt_put_header(p, UMQTT_SUBACK << 4, rem_len);
+    p = umqtt_put_u16(p, pid);
+    memcpy(p, codes.buf, codes.len);
+    return MP_OBJ_NEW_SMALL_INT(out_len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(mod_umqttcodec_encode_suback_obj, mod_umqttcodec_encode_suback);
+
+// Encode one of the 4-byte acknowledgement packets that carry only a packet id.
+STATIC mp_obj_t mod_umqttcodec_encode_ack(mp_obj_t buf_in, mp_obj_t type_in, mp_obj_t pid_in) {
+    mp_int_t type = mp_obj_get_int(type_in);
+    byte type_flags;
+    switch (type) {
+        case UMQTT_PUBACK:
+        case UMQTT_PUBREC:
+        case UMQTT_PUBCOMP:
+        case UMQTT_UNSUBACK:
+            type_flags = type << 4;
+            break;
+        case UMQTT_PUBREL:
+            type_flags = type << 4 | 0x02;
+            break;
+        default:
+            mp_raise_ValueError(MP_ERROR_TEXT("bad packet type"));
+    }
+    mp_uint_t pid = umqtt_get_pid(pid_in);
+    byte *p = umqtt_get_dest(buf_in, 4);
+    p = umqtt_put_header(p, type_flags, 2);
+    umqtt_put_u16(p, pid);
+    return MP_OBJ_NEW_SMALL_INT(4);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(mod_umqttcodec_encode_ack_obj, mod_umqttcodec_encode_ack);
+
+STATIC mp_obj_t mod_umqttcodec_encode_pingreq(mp_obj_t buf_in) {
+    umqtt_put_header(umqtt_get_dest(buf_in, 2), UMQTT_PINGREQ << 4, 0);
+    return MP_OBJ_NEW_SMALL_INT(2);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_umqttcodec_encode_pingreq_obj, mod_umqttcodec_encode_pingreq);
+
+STATIC mp_obj_t umqtt_span(mp_obj_t buf_obj, const byte *buf, size_t start, size_t end) {
+    #if MICROPY_PY_BUILTINS_MEMORYVIEW
+    (void)buf;
+    return mp_obj_new_memoryview_slice(buf_obj, start, end - start);
+    #else
+    return mp_obj_new_bytes(buf + start, end - start);
+    #endif
+}
+
+STATIC mp_obj_t mod_umqttcodec_decode(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    const byte *buf = bufinfo.buf;
+    size_t start = 0;
+    size_t end = bufinfo.len;
+    if (n_args > 1) {
+        start = mp_obj_get_int(args[1]);
+        if (n_args > 2) {
+            end = mp_obj_get_int(args[2]);
+        }
+        if (end > bufinfo.len || start > end) {
+            mp_raise_ValueError(NULL);
+        }
+    }
+
+    // Fixed header: type/flags byte then the remaining length, encoded in
+    // 1 to 4 bytes of 7 bits each.  The common single-byte case is handled
+    // without looping.
+    if (end - start < 2) {
+        return mp_const_none;
+    }
+    size_t pos = start + 1;
+    size_t rem_len = buf[pos++];
+    if (rem_len & 0x80) {
+        rem_len &= 0x7f;
+        for (unsigned int shift = 7;; shift += 7) {
+            if (shift > 21) {
+                umqtt_raise_bad();
+            }
+            if (pos == end) {
+                return mp_const_none;
+            }
+            byte b = buf[pos++];
+            rem_len |= (size_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                break;
+            }
+        }
+    }
+    if (end - pos < rem_len) {
+        return mp_const_none;
+    }
+    size_t pkt_end = pos + rem_len;
+
+    byte type = buf[start] >> 4;
+    byte flags = buf[start] & 0x0f;
+    mp_uint_t pid = 0;
+    mp_obj_t topic = mp_const_none;
+    switch (type) {
+        case UMQTT_PUBLISH: {
+            if (rem_len < 2) {
+                umqtt_raise_bad();
+            }
+            size_t topic_len = buf[pos] << 8 | buf[pos + 1];
+            pos += 2;
+            if (pkt_end - pos < topic_len) {
+                umqtt_raise_bad();
+            }
+            topic = umqtt_span(args[0], buf, pos, pos + topic_len);
+            pos += topic_len;
+            if (flags & 0x06) {
+                if (pkt_end - pos < 2) {
+                    umqtt_raise_bad();
+                }
+                pid = buf[pos] << 8 | buf[pos + 1];
+                pos += 2;
+            }
+            break;
+        }
+        case UMQTT_PUBACK:
+        case UMQTT_PUBREC:
+        case UMQTT_PUBREL:
+        case UMQTT_PUBCOMP:
+        case UMQTT_SUBSCRIBE:
+        case UMQTT_SUBACK:
+        case UMQTT_UNSUBSCRIBE:
+        case UMQTT_UNSUBACK:
+            if (rem_len < 2) {
+                umqtt_raise_bad();
+            }
+            pid = buf[pos] << 8 | buf[pos + 1];
+            pos += 2;
+            break;
+        default:
+            break;
+    }
+
+    mp_obj_t tuple[6] = {
+        MP_OBJ_NEW_SMALL_INT(type),
+        MP_OBJ_NEW_SMALL_INT(flags),
+        MP_OBJ_NEW_SMALL_INT(pid),
+        topic,
+        umqtt_span(args[0], buf, pos, pkt_end),
+        MP_OBJ_NEW_SMALL_INT(pkt_end),
+    };
+    return mp_obj_new_tuple(6, tuple);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_umqttcodec_decode_obj, 1, 3, mod_umqttcodec_decode);
+
+STATIC const mp_rom_map_elem_t mp_module_umqttcodec_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_umqttcodec) },
+    { MP_ROM_QSTR(MP_QSTR_encode_publish), MP_ROM_PTR(&mod_umqttcodec_encode_publish_obj) },
+    { MP_ROM_QSTR(MP_QSTR_encode_subscribe), MP_ROM_PTR(&mod_umqttcodec_encode_subscribe_obj) },
+    { MP_ROM_QSTR(MP_QSTR_encode_suback), MP_ROM_PTR(&mod_umqttcodec_encode_suback_obj) },
+    { MP_ROM_QSTR(MP_QSTR_encode_ack), MP_ROM_PTR(&mod_umqttcodec_encode_ack_obj) },
+    { MP_ROM_QSTR(MP_QSTR_encode_pingreq), MP_ROM_PTR(&mod_umqttcodec_encode_pingreq_obj) },
+    { MP_ROM_QSTR(MP_QSTR_decode), MP_ROM_PTR(&mod_umqttcodec_decode_obj) },
+
+    { MP_ROM_QSTR(MP_QSTR_CONNECT), MP_ROM_INT(UMQTT_CONNECT) },
+    { MP_ROM_QSTR(MP_QSTR_CONNACK), MP_ROM_INT(UMQTT_CONNACK) },
+    { MP_ROM_QSTR(MP_QSTR_PUBLISH), MP_ROM_INT(UMQTT_PUBLISH) },
+    { MP_ROM_QSTR(MP_QSTR_PUBACK), MP_ROM_INT(UMQTT_PUBACK) },
+    { MP_ROM_QSTR(MP_QSTR_PUBREC), MP_ROM_INT(UMQTT_PUBREC) },
+    { MP_ROM_QSTR(MP_QSTR_PUBREL), MP_ROM_INT(UMQTT_PUBREL) },
+    { MP_ROM_QSTR(MP_QSTR_PUBCOMP), MP_ROM_INT(UMQTT_PUBCOMP) },
+    { MP_ROM_QSTR(MP_QSTR_SUBSCRIBE), MP_ROM_INT(UMQTT_SUBSCRIBE) },
+    { MP_ROM_QSTR(MP_QSTR_SUBACK), MP_ROM_INT(UMQTT_SUBACK) },
+    { MP_ROM_QSTR(MP_QSTR_UNSUBSCRIBE), MP_ROM_INT(UMQTT_UNSUBSCRIBE) },
+    { MP_ROM_QSTR(MP_QSTR_UNSUBACK), MP_ROM_INT(UMQTT_UNSUBACK) },
+    { MP_ROM_QSTR(MP_QSTR_PINGREQ), MP_ROM_INT(UMQTT_PINGREQ) },
+    { MP_ROM_QSTR(MP_QSTR_PINGRESP), MP_ROM_INT(UMQTT_PINGRESP) },
+    { MP_ROM_QSTR(MP_QSTR_DISCONNECT), MP_ROM_INT(UMQTT_DISCONNECT) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_umqttcodec_globals, mp_module_umqttcodec_globals_table);
+
+const mp_obj_module_t mp_module_umqttcodec = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t *)&mp_module_umqttcodec_globals,
+};
+
+#endif // MICROPY_PY_UMQTTCODEC
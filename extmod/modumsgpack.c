@@ -0,0 +1,618 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/objint.h"
+#include "py/objlist.h"
+#include "py/objstr.h"
+#include "py/runtime.h"
+#include "py/smallint.h"
+#include "py/stackctrl.h"
+#include "py/stream.h"
+
+#if MICROPY_PY_UMSGPACK
+
+// MessagePack encoder and decoder.
+//
+// The format is specified at https://github.com/msgpack/msgpack/blob/master/spec.md
+// Supported types are None, bool, int (up to 64 bits), float, str, bytes
+// (and other objects with the buffer protocol), list, tuple and dict.
+// Arrays are decoded to lists, and ext types are not supported.
+//
+// The encoder writes into a vstr, which for dump is flushed to the stream
+// whenever it holds more than UMSGPACK_ENC_BUF_SIZE bytes.  The decoder works
+// on a block of memory: for loads and Unpacker this is the caller's data, for
+// load it is a vstr that is extended with exact-sized reads from the stream,
+// so that nothing past the end of the object is consumed.  Lengths read from
+// a stream can't be checked against the data before it arrives, so the vstr,
+// lists and dicts are grown as the data comes in rather than preallocated.
+
+// Amount of output to collect before writing it to the stream.
+#define UMSGPACK_ENC_BUF_SIZE (256)
+
+// Smallest read to make when extending the decoder's vstr from a stream.
+#define UMSGPACK_DEC_READ_MIN (64)
+
+// Most items to preallocate for an array or map read from a stream.
+#define UMSGPACK_DEC_PREALLOC_MAX (16)
+
+// Kinds of item, as determined by the first byte.
+enum {
+    UMSGPACK_NIL,
+    UMSGPACK_FALSE,
+    UMSGPACK_TRUE,
+    UMSGPACK_UINT,
+    UMSGPACK_INT,
+    UMSGPACK_FLOAT,
+    UMSGPACK_STR,
+    UMSGPACK_BIN,
+    UMSGPACK_ARRAY,
+    UMSGPACK_MAP,
+    UMSGPACK_EXT,
+};
+
+typedef struct _umsgpack_head_t {
+    byte kind;
+    byte width; // number of bytes following the first one that hold arg
+    uint64_t arg; // value of an int, bits of a float, else a length or count
+} umsgpack_head_t;
+
+/******************************************************************************/
+// Encoder
+
+typedef struct _umsgpack_enc_t {
+    mp_obj_t stream; // output stream, or MP_OBJ_NULL to only fill vstr
+    vstr_t vstr;
+} umsgpack_enc_t;
+
+STATIC void umsgpack_enc_flush(umsgpack_enc_t *e) {
+    if (e->stream != MP_OBJ_NULL && e->vstr.len != 0) {
+        mp_stream_write(e->stream, e->vstr.buf, e->vstr.len, MP_STREAM_RW_WRITE);
+        e->vstr.len = 0;
+    }
+}
+
+// Write the first byte and then width bytes of val, big endian.
+STATIC void umsgpack_enc_head(umsgpack_enc_t *e, byte code, uint64_t val, size_t width) {
+    byte *p = (byte *)vstr_add_len(&e->vstr, 1 + width);
+    *p = code;
+    for (p += width; width > 0; --width, val >>= 8) {
+        *p-- = val;
+    }
+}
+
+// Write the header for a str, bin, array or map of length n.  fix is the
+// code for the fixed-length form, used if n < fix_limit, code8 is the code
+// for a 1-byte length (or 0 if there isn't one) and code16 is the code for a
+// 2-byte length, which is followed by the one for a 4-byte length.
+STATIC void umsgpack_enc_len(umsgpack_enc_t *e, byte fix, size_t fix_limit, byte code8, byte code16, size_t n) {
+    if (n < fix_limit) {
+        umsgpack_enc_head(e, fix | n, 0, 0);
+    } else if (code8 != 0 && n <= 0xff) {
+        umsgpack_enc_head(e, code8, n, 1);
+    } else if (n <= 0xffff) {
+        umsgpack_enc_head(e, code16, n, 2);
+    } else {
+        umsgpack_enc_head(e, code16 + 1, n, 4);
+    }
+}
+
+// Write an int given as its 64-bit two's complement value, in the smallest form.
+STATIC void umsgpack_enc_int(umsgpack_enc_t *e, uint64_t val, bool neg) {
+    if (!neg) {
+        if (val < 0x80) {
+            umsgpack_enc_head(e, val, 0, 0);
+        } else if (val <= 0xff) {
+            umsgpack_enc_head(e, 0xcc, val, 1);
+        } else if (val <= 0xffff) {
+            umsgpack_enc_head(e, 0xcd, val, 2);
+        } else if (val <= 0xffffffff) {
+            umsgpack_enc_head(e, 0xce, val, 4);
+        } else {
+            umsgpack_enc_head(e, 0xcf, val, 8);
+        }
+    } else {
+        int64_t sval = val;
+        if (sval >= -32) {
+            umsgpack_enc_head(e, sval & 0xff, 0, 0);
+        } else if (sval >= INT8_MIN) {
+            umsgpack_enc_head(e, 0xd0, val, 1);
+        } else if (sval >= INT16_MIN) {
+            umsgpack_enc_head(e, 0xd1, val, 2);
+        } else if (sval >= INT32_MIN) {
+            umsgpack_enc_head(e, 0xd2, val, 4);
+        } else {
+            umsgpack_enc_head(e, 0xd3, val, 8);
+        }
+    }
+}
+
+STATIC void umsgpack_enc_obj(umsgpack_enc_t *e, mp_obj_t obj) {
+    MP_STACK_CHECK();
+    if (e->vstr.len >= UMSGPACK_ENC_BUF_SIZE) {
+        umsgpack_enc_flush(e);
+    }
+    if (mp_obj_is_small_int(obj)) {
+        mp_int_t val = MP_OBJ_SMALL_INT_VALUE(obj);
+        umsgpack_enc_int(e, (uint64_t)(int64_t)val, val < 0);
+    } else if (mp_obj_is_str(obj)) {
+        GET_STR_DATA_LEN(obj, str, len);
+        umsgpack_enc_len(e, 0xa0, 32, 0xd9, 0xda, len);
+        vstr_add_strn(&e->vstr, (const char *)str, len);
+    } else if (obj == mp_const_none) {
+        umsgpack_enc_head(e, 0xc0, 0, 0);
+    } else if (obj == mp_const_false) {
+        umsgpack_enc_head(e, 0xc2, 0, 0);
+    } else if (obj == mp_const_true) {
+        umsgpack_enc_head(e, 0xc3, 0, 0);
+    } else if (mp_obj_is_int(obj)) {
+        // a big int, which must fit in 64 bits
+        bool neg = mp_obj_int_sign(obj) < 0;
+        mp_obj_t limit = neg ? mp_obj_new_int_from_ll(INT64_MIN) : mp_obj_new_int_from_ull(UINT64_MAX);
+        if (mp_obj_is_true(mp_binary_op(neg ? MP_BINARY_OP_LESS : MP_BINARY_OP_MORE, obj, limit))) {
+            mp_raise_msg(&mp_type_OverflowError, MP_ERROR_TEXT("overflow converting long int to machine word"));
+        }
+        byte buf[8];
+        mp_obj_int_to_bytes_impl(obj, false, sizeof(buf), buf);
+        uint64_t val = 0;
+        for (size_t i = sizeof(buf); i > 0; --i) {
+            val = val << 8 | buf[i - 1];
+        }
+        umsgpack_enc_int(e, val, neg);
+    #if MICROPY_PY_BUILTINS_FLOAT
+    } else if (mp_obj_is_float(obj)) {
+        #if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_DOUBLE
+        union { double f; uint64_t i; } u = {mp_obj_float_get(obj)};
+        umsgpack_enc_head(e, 0xcb, u.i, 8);
+        #else
+        union { float f; uint32_t i; } u = {mp_obj_float_get(obj)};
+        umsgpack_enc_head(e, 0xca, u.i, 4);
+        #endif
+    #endif
+    } else if (mp_obj_is_type(obj, &mp_type_list) || mp_obj_is_type(obj, &mp_type_tuple)) {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(obj, &len, &items);
+        umsgpack_enc_len(e, 0x90, 16, 0, 0xdc, len);
+        for (size_t i = 0; i < len; ++i) {
+            umsgpack_enc_obj(e, items[i]);
+        }
+    } else if (mp_obj_is_dict_or_ordereddict(obj)) {
+        mp_map_t *map = mp_obj_dict_get_map(obj);
+        umsgpack_enc_len(e, 0x80, 16, 0, 0xde, map->used);
+        for (size_t i = 0; i < map->alloc; ++i) {
+            if (mp_map_slot_is_filled(map, i)) {
+                umsgpack_enc_obj(e, map->table[i].key);
+                umsgpack_enc_obj(e, map->table[i].value);
+            }
+        }
+    } else {
+        mp_buffer_info_t bufinfo;
+        if (!mp_get_buffer(obj, &bufinfo, MP_BUFFER_READ)) {
+            mp_raise_TypeError(MP_ERROR_TEXT("unsupported type"));
+        }
+        umsgpack_enc_len(e, 0, 0, 0xc4, 0xc5, bufinfo.len);
+        if (e->stream != MP_OBJ_NULL && bufinfo.len >= UMSGPACK_ENC_BUF_SIZE) {
+            // write a large payload directly rather than copying it
+            umsgpack_enc_flush(e);
+            mp_stream_write(e->stream, bufinfo.buf, bufinfo.len, MP_STREAM_RW_WRITE);
+        } else {
+            vstr_add_strn(&e->vstr, bufinfo.buf, bufinfo.len);
+        }
+    }
+}
+
+STATIC mp_obj_t mod_umsgpack_dumps(mp_obj_t obj) {
+    umsgpack_enc_t e;
+    e.stream = MP_OBJ_NULL;
+    vstr_init(&e.vstr, 16);
+    umsgpack_enc_obj(&e, obj);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &e.vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_umsgpack_dumps_obj, mod_umsgpack_dumps);
+
+STATIC mp_obj_t mod_umsgpack_dump(mp_obj_t obj, mp_obj_t stream) {
+    mp_get_stream_raise(stream, MP_STREAM_OP_WRITE);
+    umsgpack_enc_t e;
+    e.stream = stream;
+    vstr_init(&e.vstr, UMSGPACK_ENC_BUF_SIZE + 16);
+    umsgpack_enc_obj(&e, obj);
+    umsgpack_enc_flush(&e);
+    vstr_clear(&e.vstr);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_umsgpack_dump_obj, mod_umsgpack_dump);
+
+/******************************************************************************/
+// Decoder
+
+typedef struct _umsgpack_dec_t {
+    const byte *data;
+    size_t len;
+    size_t pos;
+    mp_obj_t stream; // stream to read more data from, or MP_OBJ_NULL
+    vstr_t *vstr; // holds the data read from stream
+    mp_obj_t src; // object owning data, for zero-copy bin, or MP_OBJ_NULL
+} umsgpack_dec_t;
+
+// Decode the first byte of an item, setting everything in head except for
+// arg when width is non-zero.
+STATIC void umsgpack_head_start(byte c, umsgpack_head_t *h) {
+    h->width = 0;
+    h->arg = c;
+    if (c < 0x80) {
+        h->kind = UMSGPACK_UINT;
+    } else if (c < 0x90) {
+        h->kind = UMSGPACK_MAP;
+        h->arg = c & 0x0f;
+    } else if (c < 0xa0) {
+        h->kind = UMSGPACK_ARRAY;
+        h->arg = c & 0x0f;
+    } else if (c < 0xc0) {
+        h->kind = UMSGPACK_STR;
+        h->arg = c & 0x1f;
+    } else if (c >= 0xe0) {
+        h->kind = UMSGPACK_INT;
+        h->arg = (int64_t)(int8_t)c;
+    } else if (c == 0xc0) {
+        h->kind = UMSGPACK_NIL;
+    } else if (c == 0xc2) {
+        h->kind = UMSGPACK_FALSE;
+    } else if (c == 0xc3) {
+        h->kind = UMSGPACK_TRUE;
+    } else if (c >= 0xc4 && c <= 0xc6) {
+        h->kind = UMSGPACK_BIN;
+        h->width = 1 << (c - 0xc4);
+    } else if (c >= 0xc7 && c <= 0xc9) {
+        h->kind = UMSGPACK_EXT;
+        h->width = 1 << (c - 0xc7);
+    } else if (c == 0xca || c == 0xcb) {
+        h->kind = UMSGPACK_FLOAT;
+        h->width = 4 << (c - 0xca);
+    } else if (c >= 0xcc && c <= 0xcf) {
+        h->kind = UMSGPACK_UINT;
+        h->width = 1 << (c - 0xcc);
+    } else if (c >= 0xd0 && c <= 0xd3) {
+        h->kind = UMSGPACK_INT;
+        h->width = 1 << (c - 0xd0);
+    } else if (c >= 0xd4 && c <= 0xd8) {
+        h->kind = UMSGPACK_EXT;
+        h->arg = 1 << (c - 0xd4);
+    } else if (c >= 0xd9 && c <= 0xdb) {
+        h->kind = UMSGPACK_STR;
+        h->width = 1 << (c - 0xd9);
+    } else if (c == 0xdc || c == 0xdd) {
+        h->kind = UMSGPACK_ARRAY;
+        h->width = 2 << (c - 0xdc);
+    } else if (c == 0xde || c == 0xdf) {
+        h->kind = UMSGPACK_MAP;
+        h->width = 2 << (c - 0xde);
+    } else {
+        // 0xc1 is never used
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid MessagePack data"));
+    }
+}
+
+// Read the width bytes of arg that follow the first byte.
+STATIC void umsgpack_head_arg(const byte *p, umsgpack_head_t *h) {
+    uint64_t arg = 0;
+    for (size_t i = 0; i < h->width; ++i) {
+        arg = arg << 8 | p[i];
+    }
+    if (h->kind == UMSGPACK_INT) {
+        // sign extend
+        int shift = 64 - 8 * h->width;
+        arg = (uint64_t)((int64_t)(arg << shift) >> shift);
+    }
+    h->arg = arg;
+}
+
+// Return the number of bytes of data following the header.
+static inline uint64_t umsgpack_head_payload(const umsgpack_head_t *h) {
+    if (h->kind == UMSGPACK_STR || h->kind == UMSGPACK_BIN) {
+        return h->arg;
+    } else if (h->kind == UMSGPACK_EXT) {
+        return h->arg + 1; // includes the type byte
+    } else {
+        return 0;
+    }
+}
+
+// Return the length of the complete item at the start of data, or 0 if
+// there isn't a complete item yet.
+STATIC size_t umsgpack_scan(const byte *data, size_t len) {
+    size_t pos = 0;
+    uint64_t pending = 1;
+    while (pending > 0) {
+        if (pos >= len) {
+            return 0;
+        }
+        umsgpack_head_t h;
+        umsgpack_head_start(data[pos++], &h);
+        if (h.width > len - pos) {
+            return 0;
+        }
+        if (h.width != 0) {
+            umsgpack_head_arg(data + pos, &h);
+            pos += h.width;
+        }
+        uint64_t payload = umsgpack_head_payload(&h);
+        if (payload > len - pos) {
+            return 0;
+        }
+        pos += payload;
+        pending -= 1;
+        if (h.kind == UMSGPACK_ARRAY) {
+            pending += h.arg;
+        } else if (h.kind == UMSGPACK_MAP) {
+            pending += 2 * h.arg;
+        }
+        if (pending > len - pos) {
+            // each pending item needs at least one more byte
+            return 0;
+        }
+    }
+    return pos;
+}
+
+// Make sure there are n bytes available at the current position, reading
+// them from the stream if there is one.
+STATIC void umsgpack_dec_need(umsgpack_dec_t *d, uint64_t n) {
+    if (n <= d->len - d->pos) {
+        return;
+    }
+    if (d->stream == MP_OBJ_NULL) {
+        mp_raise_ValueError(MP_ERROR_TEXT("incomplete MessagePack data"));
+    }
+    while (n > d->len - d->pos) {
+        // at most double the buffer per read, so that a bogus length can only
+        // make it grow to about twice the data that actually arrived
+        size_t want = MIN(n - (d->len - d->pos), MAX(d->vstr->len, UMSGPACK_DEC_READ_MIN));
+        int errcode;
+        mp_uint_t out_sz = mp_stream_read_exactly(d->stream, vstr_add_len(d->vstr, want), want, &errcode);
+        if (out_sz == MP_STREAM_ERROR) {
+            mp_raise_OSError(errcode);
+        }
+        d->vstr->len -= want - out_sz;
+        d->data = (const byte *)d->vstr->buf;
+        d->len = d->vstr->len;
+        if (out_sz < want) {
+            mp_raise_type(&mp_type_EOFError);
+        }
+    }
+}
+
+STATIC mp_obj_t umsgpack_dec_obj(umsgpack_dec_t *d) {
+    MP_STACK_CHECK();
+    umsgpack_dec_need(d, 1);
+    umsgpack_head_t h;
+    umsgpack_head_start(d->data[d->pos++], &h);
+    if (h.width != 0) {
+        umsgpack_dec_need(d, h.width);
+        umsgpack_head_arg(d->data + d->pos, &h);
+        d->pos += h.width;
+    }
+    switch (h.kind) {
+        case UMSGPACK_NIL:
+            return mp_const_none;
+        case UMSGPACK_FALSE:
+            return mp_const_false;
+        case UMSGPACK_TRUE:
+            return mp_const_true;
+        case UMSGPACK_UINT:
+            if (h.arg <= MP_SMALL_INT_MAX) {
+                return MP_OBJ_NEW_SMALL_INT(h.arg);
+            }
+            return mp_obj_new_int_from_ull(h.arg);
+        case UMSGPACK_INT:
+            if ((int64_t)h.arg >= MP_SMALL_INT_MIN && (int64_t)h.arg <= MP_SMALL_INT_MAX) {
+                return MP_OBJ_NEW_SMALL_INT((mp_int_t)(int64_t)h.arg);
+            }
+            return mp_obj_new_int_from_ll((int64_t)h.arg);
+        #if MICROPY_PY_BUILTINS_FLOAT
+        case UMSGPACK_FLOAT:
+            if (h.width == 4) {
+                union { uint32_t i; float f; } u = {h.arg};
+                return mp_obj_new_float((mp_float_t)u.f);
+            } else {
+                union { uint64_t i; double f; } u = {h.arg};
+                return mp_obj_new_float((mp_float_t)u.f);
+            }
+        #endif
+        case UMSGPACK_STR:
+        case UMSGPACK_BIN: {
+            umsgpack_dec_need(d, h.arg);
+            size_t start = d->pos;
+            d->pos += h.arg;
+            if (h.kind == UMSGPACK_STR) {
+                return mp_obj_new_str((const char *)d->data + start, h.arg);
+            } else if (d->src != MP_OBJ_NULL) {
+                return mp_obj_new_memoryview_slice(d->src, start, h.arg);
+            } else {
+                return mp_obj_new_bytes(d->data + start, h.arg);
+            }
+        }
+        case UMSGPACK_ARRAY: {
+            size_t prealloc = h.arg;
+            if (h.arg > d->len - d->pos) {
+                if (d->stream == MP_OBJ_NULL) {
+                    // not enough data for the items, so don't allocate them
+                    umsgpack_dec_need(d, h.arg);
+                }
+                prealloc = UMSGPACK_DEC_PREALLOC_MAX;
+            }
+            mp_obj_t list = mp_obj_new_list(prealloc, NULL);
+            mp_obj_list_t *l = MP_OBJ_TO_PTR(list);
+            mp_seq_clear(l->items, 0, l->alloc, sizeof(*l->items));
+            l->len = 0;
+            for (uint64_t i = 0; i < h.arg; ++i) {
+                mp_obj_list_append(list, umsgpack_dec_obj(d));
+            }
+            return list;
+        }
+        case UMSGPACK_MAP: {
+            size_t prealloc = h.arg;
+            if (h.arg > (d->len - d->pos) / 2) {
+                if (d->stream == MP_OBJ_NULL) {
+                    umsgpack_dec_need(d, 2 * h.arg);
+                }
+                prealloc = UMSGPACK_DEC_PREALLOC_MAX;
+            }
+            mp_obj_t dict = mp_obj_new_dict(prealloc);
+            for (uint64_t i = 0; i < h.arg; ++i) {
+                mp_obj_t key = umsgpack_dec_obj(d);
+                mp_obj_dict_store(dict, key, umsgpack_dec_obj(d));
+            }
+            return dict;
+        }
+        default:
+            mp_raise_ValueError(MP_ERROR_TEXT("unsupported MessagePack type"));
+    }
+}
+
+// Decode one complete object from memory, checking that it uses all the data.
+STATIC mp_obj_t umsgpack_dec_mem(const byte *data, size_t len, mp_obj_t src) {
+    umsgpack_dec_t d = {data, len, 0, MP_OBJ_NULL, NULL, src};
+    mp_obj_t obj = umsgpack_dec_obj(&d);
+    if (d.pos != len) {
+        mp_raise_ValueError(MP_ERROR_TEXT("extra data"));
+    }
+    return obj;
+}
+
+STATIC mp_obj_t mod_umsgpack_loads(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_data, ARG_zerocopy };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_zerocopy, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = false} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args, pos_args, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[ARG_data].u_obj, &bufinfo, MP_BUFFER_READ);
+    return umsgpack_dec_mem(bufinfo.buf, bufinfo.len, args[ARG_zerocopy].u_bool ? args[ARG_data].u_obj : MP_OBJ_NULL);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mod_umsgpack_loads_obj, 1, mod_umsgpack_loads);
+
+STATIC mp_obj_t mod_umsgpack_load(mp_obj_t stream) {
+    mp_get_stream_raise(stream, MP_STREAM_OP_READ);
+    vstr_t vstr;
+    vstr_init(&vstr, 16);
+    umsgpack_dec_t d = {(const byte *)vstr.buf, 0, 0, stream, &vstr, MP_OBJ_NULL};
+    mp_obj_t obj = umsgpack_dec_obj(&d);
+    vstr_clear(&vstr);
+    return obj;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_umsgpack_load_obj, mod_umsgpack_load);
+
+/******************************************************************************/
+// Unpacker: splits a byte stream fed in arbitrary pieces into objects
+
+typedef struct _mp_obj_umsgpack_unpacker_t {
+    mp_obj_base_t base;
+    vstr_t vstr; // data fed in and not yet decoded
+    size_t pos; // start of the undecoded data in vstr
+} mp_obj_umsgpack_unpacker_t;
+
+STATIC mp_obj_t umsgpack_unpacker_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 0, 0, false);
+    mp_obj_umsgpack_unpacker_t *o = m_new_obj(mp_obj_umsgpack_unpacker_t);
+    o->base.type = type;
+    vstr_init(&o->vstr, 16);
+    o->pos = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_obj_t umsgpack_unpacker_feed(mp_obj_t self_in, mp_obj_t data_in) {
+    mp_obj_umsgpack_unpacker_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data_in, &bufinfo, MP_BUFFER_READ);
+    if (self->pos != 0) {
+        // discard data that has been decoded
+        self->vstr.len -= self->pos;
+        memmove(self->vstr.buf, self->vstr.buf + self->pos, self->vstr.len);
+        self->pos = 0;
+    }
+    vstr_add_strn(&self->vstr, bufinfo.buf, bufinfo.len);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(umsgpack_unpacker_feed_obj, umsgpack_unpacker_feed);
+
+STATIC mp_obj_t umsgpack_unpacker_iternext(mp_obj_t self_in) {
+    mp_obj_umsgpack_unpacker_t *self = MP_OBJ_TO_PTR(self_in);
+    const byte *data = (const byte *)self->vstr.buf + self->pos;
+    size_t n;
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        n = umsgpack_scan(data, self->vstr.len - self->pos);
+        nlr_pop();
+    } else {
+        // the data can't be split into objects, so drop all of it rather
+        // than raising the same error on every later call
+        self->pos = self->vstr.len;
+        nlr_jump(nlr.ret_val);
+    }
+    if (n == 0) {
+        return MP_OBJ_STOP_ITERATION;
+    }
+    // skip the object even if it fails to decode
+    self->pos += n;
+    return umsgpack_dec_mem(data, n, MP_OBJ_NULL);
+}
+
+STATIC const mp_rom_map_elem_t umsgpack_unpacker_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_feed), MP_ROM_PTR(&umsgpack_unpacker_feed_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(umsgpack_unpacker_locals_dict, umsgpack_unpacker_locals_dict_table);
+
+STATIC const mp_obj_type_t umsgpack_unpacker_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Unpacker,
+    .make_new = umsgpack_unpacker_make_new,
+    .getiter = mp_identity_getiter,
+    .iternext = umsgpack_unpacker_iternext,
+    .locals_dict = (mp_obj_dict_t *)&umsgpack_unpacker_locals_dict,
+};
+
+STATIC const mp_rom_map_elem_t mp_module_umsgpack_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_umsgpack) },
+    { MP_ROM_QSTR(MP_QSTR_dump), MP_ROM_PTR(&mod_umsgpack_dump_obj) },
+    { MP_ROM_QSTR(MP_QSTR_dumps), MP_ROM_PTR(&mod_umsgpack_dumps_obj) },
+    { MP_ROM_QSTR(MP_QSTR_load), MP_ROM_PTR(&mod_umsgpack_load_obj) },
+    { MP_ROM_QSTR(MP_QSTR_loads), MP_ROM_PTR(&mod_umsgpack_loads_obj) },
+    { MP_ROM_QSTR(MP_QSTR_Unpacker), MP_ROM_PTR(&umsgpack_unpacker_type) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_umsgpack_globals, mp_module_umsgpack_globals_table);
+
+const mp_obj_module_t mp_module_umsgpack = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t *)&mp_module_umsgpack_globals,
+};
+
+#endif // MICROPY_PY_UMSGPACK
@@ -38,47 +38,68 @@
 #define SEED_ON_IMPORT (0)
 #endif
 
-// Yasmarang random number generator
-// by Ilya Levin
-// http://www.literatecode.com/yasmarang
+// xoshiro128** random number generator
+// by David Blackman and Sebastiano Vigna
+// https://prng.di.unimi.it/
 // Public Domain
+//
+// It has 128 bits of state, a period of 2^128 - 1 and passes all known
+// statistical tests, while needing only a few shifts, xors and multiplies
+// per 32-bit output.
 
 #if !MICROPY_ENABLE_DYNRUNTIME
 #if SEED_ON_IMPORT
-// If the state is seeded on import then keep these variables in the BSS.
-STATIC uint32_t yasmarang_pad, yasmarang_n, yasmarang_d;
-STATIC uint8_t yasmarang_dat;
+// If the state is seeded on import then keep it in the BSS.
+STATIC uint32_t urandom_state[4];
 #else
-// Without seed-on-import these variables must be initialised via the data section.
-STATIC uint32_t yasmarang_pad = 0xeda4baba, yasmarang_n = 69, yasmarang_d = 233;
-STATIC uint8_t yasmarang_dat = 0;
+// Without seed-on-import the state must be initialised via the data section.
+// This is the state that seed(0) gives.
+STATIC uint32_t urandom_state[4] = { 0x64625032, 0xd9c0799c, 0xaf362e10, 0x7fa88912 };
 #endif
 #endif
 
-STATIC uint32_t yasmarang(void) {
-    yasmarang_pad += yasmarang_dat + yasmarang_d * yasmarang_n;
-    yasmarang_pad = (yasmarang_pad << 3) + (yasmarang_pad >> 29);
-    yasmarang_n = yasmarang_pad | 2;
-    yasmarang_d ^= (yasmarang_pad << 31) + (yasmarang_pad >> 1);
-    yasmarang_dat ^= (char)yasmarang_pad ^ (yasmarang_d >> 8) ^ 1;
+static inline uint32_t rotl32(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline uint32_t xoshiro128ss(uint32_t *s) {
+    uint32_t result = rotl32(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl32(s[3], 11);
+    return result;
+}
 
-    return yasmarang_pad ^ (yasmarang_d << 5) ^ (yasmarang_pad >> 18) ^ (yasmarang_dat << 1);
-}  /* yasmarang */
+STATIC uint32_t urandom_next(void) {
+    return xoshiro128ss(urandom_state);
+}
+
+// End of xoshiro128**
 
-// End of Yasmarang
+// SplitMix32, used to spread the bits of a seed over the whole state.
+STATIC uint32_t splitmix32(uint32_t *x) {
+    uint32_t z = (*x += 0x9e3779b9);
+    z = (z ^ (z >> 16)) * 0x21f0aaad;
+    z = (z ^ (z >> 15)) * 0x735a2d97;
+    return z ^ (z >> 15);
+}
 
 #if MICROPY_PY_URANDOM_EXTRA_FUNCS
 
 // returns an unsigned integer below the given argument
 // n must not be zero
-STATIC uint32_t yasmarang_randbelow(uint32_t n) {
+STATIC uint32_t urandom_randbelow(uint32_t n) {
     uint32_t mask = 1;
     while ((n & mask) < n) {
         mask = (mask << 1) | 1;
     }
     uint32_t r;
     do {
-        r = yasmarang() & mask;
+        r = urandom_next() & mask;
     } while (r >= n);
     return r;
 }
@@ -90,10 +111,8 @@ STATIC mp_obj_t mod_urandom_getrandbits(mp_obj_t num_in) {
     if (n > 32 || n == 0) {
         mp_raise_ValueError(NULL);
     }
-    uint32_t mask = ~0;
-    // Beware of C undefined behavior when shifting by >= than bit size
-    mask >>= (32 - n);
-    return mp_obj_new_int_from_uint(yasmarang() & mask);
+    // the high bits of the output are used
+    return mp_obj_new_int_from_uint(urandom_next() >> (32 - n));
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_urandom_getrandbits_obj, mod_urandom_getrandbits);
 
@@ -108,10 +127,17 @@ STATIC mp_obj_t mod_urandom_seed(size_t n_args, const mp_obj_t *args) {
     } else {
         seed = mp_obj_get_int_truncated(args[0]);
     }
-    yasmarang_pad = seed;
-    yasmarang_n = 69;
-    yasmarang_d = 233;
-    yasmarang_dat = 0;
+    uint32_t x = seed;
+    urandom_state[0] = splitmix32(&x);
+    urandom_state[1] = splitmix32(&x);
+    // mix in the high bits of the seed, if there are any
+    x ^= (uint32_t)((uint64_t)seed >> 32);
+    urandom_state[2] = splitmix32(&x);
+    urandom_state[3] = splitmix32(&x);
+    if ((urandom_state[0] | urandom_state[1] | urandom_state[2] | urandom_state[3]) == 0) {
+        // the all-zero state is the one state the generator can't leave
+        urandom_state[0] = 1;
+    }
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_urandom_seed_obj, 0, 1, mod_urandom_seed);
@@ -123,7 +149,7 @@ STATIC mp_obj_t mod_urandom_randrange(size_t n_args, const mp_obj_t *args) {
     if (n_args == 1) {
         // range(stop)
         if (start > 0) {
-            return mp_obj_new_int(yasmarang_randbelow(start));
+            return mp_obj_new_int(urandom_randbelow(start));
         } else {
             goto error;
         }
@@ -132,7 +158,7 @@ STATIC mp_obj_t mod_urandom_randrange(size_t n_args, const mp_obj_t *args) {
         if (n_args == 2) {
             // range(start, stop)
             if (start < stop) {
-                return mp_obj_new_int(start + yasmarang_randbelow(stop - start));
+                return mp_obj_new_int(start + urandom_randbelow(stop - start));
             } else {
                 goto error;
             }
@@ -148,7 +174,7 @@ STATIC mp_obj_t mod_urandom_randrange(size_t n_args, const mp_obj_t *args) {
                 goto error;
             }
             if (n > 0) {
-                return mp_obj_new_int(start + step * yasmarang_randbelow(n));
+                return mp_obj_new_int(start + step * urandom_randbelow(n));
             } else {
                 goto error;
             }
@@ -164,7 +190,7 @@ STATIC mp_obj_t mod_urandom_randint(mp_obj_t a_in, mp_obj_t b_in) {
     mp_int_t a = mp_obj_get_int(a_in);
     mp_int_t b = mp_obj_get_int(b_in);
     if (a <= b) {
-        return mp_obj_new_int(a + yasmarang_randbelow(b - a + 1));
+        return mp_obj_new_int(a + urandom_randbelow(b - a + 1));
     } else {
         mp_raise_ValueError(NULL);
     }
@@ -174,7 +200,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_urandom_randint_obj, mod_urandom_randint);
 STATIC mp_obj_t mod_urandom_choice(mp_obj_t seq) {
     mp_int_t len = mp_obj_get_int(mp_obj_len(seq));
     if (len > 0) {
-        return mp_obj_subscr(seq, mp_obj_new_int(yasmarang_randbelow(len)), MP_OBJ_SENTINEL);
+        return mp_obj_subscr(seq, mp_obj_new_int(urandom_randbelow(len)), MP_OBJ_SENTINEL);
     } else {
         mp_raise_type(&mp_type_IndexError);
     }
@@ -183,28 +209,28 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_urandom_choice_obj, mod_urandom_choice);
 
 #if MICROPY_PY_BUILTINS_FLOAT
 
-// returns a number in the range [0..1) using Yasmarang to fill in the fraction bits
-STATIC mp_float_t yasmarang_float(void) {
+// returns a number in the range [0..1) using the generator to fill in the fraction bits
+STATIC mp_float_t urandom_float(void) {
     mp_float_union_t u;
     u.p.sgn = 0;
     u.p.exp = (1 << (MP_FLOAT_EXP_BITS - 1)) - 1;
     if (MP_FLOAT_FRAC_BITS <= 32) {
-        u.p.frc = yasmarang();
+        u.p.frc = urandom_next();
     } else {
-        u.p.frc = ((uint64_t)yasmarang() << 32) | (uint64_t)yasmarang();
+        u.p.frc = ((uint64_t)urandom_next() << 32) | (uint64_t)urandom_next();
     }
     return u.f - 1;
 }
 
 STATIC mp_obj_t mod_urandom_random(void) {
-    return mp_obj_new_float(yasmarang_float());
+    return mp_obj_new_float(urandom_float());
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(mod_urandom_random_obj, mod_urandom_random);
 
 STATIC mp_obj_t mod_urandom_uniform(mp_obj_t a_in, mp_obj_t b_in) {
     mp_float_t a = mp_obj_get_float(a_in);
     mp_float_t b = mp_obj_get_float(b_in);
-    return mp_obj_new_float(a + (b - a) * yasmarang_float());
+    return mp_obj_new_float(a + (b - a) * urandom_float());
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_urandom_uniform_obj, mod_urandom_uniform);
 
@@ -212,6 +238,114 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_2(mod_urandom_uniform_obj, mod_urandom_uniform);
 
 #endif // MICROPY_PY_URANDOM_EXTRA_FUNCS
 
+#if MICROPY_PY_URANDOM_BULK
+
+// Advance the generator by 2^64 steps.  Calling this k times after seeding
+// gives the k-th of 2^64 non-overlapping streams, eg one per worker.
+STATIC mp_obj_t mod_urandom_jump(void) {
+    static const uint32_t jump[4] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+    uint32_t s[4] = { urandom_state[0], urandom_state[1], urandom_state[2], urandom_state[3] };
+    uint32_t acc[4] = { 0, 0, 0, 0 };
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t b = 0; b < 32; ++b) {
+            if (jump[i] & (1u << b)) {
+                acc[0] ^= s[0];
+                acc[1] ^= s[1];
+                acc[2] ^= s[2];
+                acc[3] ^= s[3];
+            }
+            xoshiro128ss(s);
+        }
+    }
+    memcpy(urandom_state, acc, sizeof(acc));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mod_urandom_jump_obj, mod_urandom_jump);
+
+// Fill buf with random bytes, running the generator on a local copy of the
+// state so it can stay in registers.
+STATIC void urandom_fill(uint8_t *buf, size_t len) {
+    uint32_t s[4] = { urandom_state[0], urandom_state[1], urandom_state[2], urandom_state[3] };
+    // bytes are stored little endian, so a seed gives the same bytes everywhere
+    for (; len >= 4; len -= 4, buf += 4) {
+        uint32_t r = xoshiro128ss(s);
+        buf[0] = r;
+        buf[1] = r >> 8;
+        buf[2] = r >> 16;
+        buf[3] = r >> 24;
+    }
+    if (len > 0) {
+        uint32_t r = xoshiro128ss(s);
+        for (; len > 0; --len, r >>= 8) {
+            *buf++ = r;
+        }
+    }
+    memcpy(urandom_state, s, sizeof(s));
+}
+
+STATIC mp_obj_t mod_urandom_randbytes(mp_obj_t n_in) {
+    mp_int_t n = mp_obj_get_int(n_in);
+    if (n < 0) {
+        mp_raise_ValueError(NULL);
+    }
+    vstr_t vstr;
+    vstr_init_len(&vstr, n);
+    urandom_fill((uint8_t *)vstr.buf, n);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_urandom_randbytes_obj, mod_urandom_randbytes);
+
+STATIC mp_obj_t mod_urandom_fill_into(mp_obj_t buf_in) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    urandom_fill(bufinfo.buf, bufinfo.len);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mod_urandom_fill_into_obj, mod_urandom_fill_into);
+
+#if MICROPY_PY_BUILTINS_FLOAT
+
+// uniform_into(buf, a=0.0, b=1.0): fill an array of floats or doubles with
+// numbers in the range [a, b).  Floats take the top 24 bits of one output and
+// doubles the top 53 bits of two, so each element has full precision.
+STATIC mp_obj_t mod_urandom_uniform_into(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_WRITE);
+    mp_float_t a = 0, b = 1;
+    if (n_args > 1) {
+        a = mp_obj_get_float(args[1]);
+    }
+    if (n_args > 2) {
+        b = mp_obj_get_float(args[2]);
+    }
+    uint32_t s[4] = { urandom_state[0], urandom_state[1], urandom_state[2], urandom_state[3] };
+    if (bufinfo.typecode == 'f') {
+        float fa = (float)a, fscale = (float)((b - a) / MICROPY_FLOAT_CONST(16777216.0));
+        float *p = bufinfo.buf;
+        for (size_t i = bufinfo.len / sizeof(float); i > 0; --i) {
+            *p++ = fa + (float)(xoshiro128ss(s) >> 8) * fscale;
+        }
+    #if MICROPY_FLOAT_IMPL == MICROPY_FLOAT_IMPL_DOUBLE
+    } else if (bufinfo.typecode == 'd') {
+        double scale = (b - a) / 9007199254740992.0;
+        double *p = bufinfo.buf;
+        for (size_t i = bufinfo.len / sizeof(double); i > 0; --i) {
+            uint64_t r = ((uint64_t)xoshiro128ss(s) << 32) | xoshiro128ss(s);
+            *p++ = a + (double)(r >> 11) * scale;
+        }
+    #endif
+    } else {
+        mp_raise_TypeError(MP_ERROR_TEXT("expecting a float array"));
+    }
+    memcpy(urandom_state, s, sizeof(s));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_urandom_uniform_into_obj, 1, 3, mod_urandom_uniform_into);
+
+#endif
+
+#endif // MICROPY_PY_URANDOM_BULK
+
 #if SEED_ON_IMPORT
 STATIC mp_obj_t mod_urandom___init__() {
     // This module may be imported by more than one name so need to ensure
@@ -243,6 +377,14 @@ STATIC const mp_rom_map_elem_t mp_module_urandom_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_uniform), MP_ROM_PTR(&mod_urandom_uniform_obj) },
     #endif
     #endif
+    #if MICROPY_PY_URANDOM_BULK
+    { MP_ROM_QSTR(MP_QSTR_jump), MP_ROM_PTR(&mod_urandom_jump_obj) },
+    { MP_ROM_QSTR(MP_QSTR_randbytes), MP_ROM_PTR(&mod_urandom_randbytes_obj) },
+    { MP_ROM_QSTR(MP_QSTR_fill_into), MP_ROM_PTR(&mod_urandom_fill_into_obj) },
+    #if MICROPY_PY_BUILTINS_FLOAT
+    { MP_ROM_QSTR(MP_QSTR_uniform_into), MP_ROM_PTR(&mod_urandom_uniform_into_obj) },
+    #endif
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_urandom_globals, mp_module_urandom_globals_table);
@@ -32,17 +32,33 @@
 #include "py/binary.h"
 #include "py/objstr.h"
 #include "py/stackctrl.h"
+#include "py/stream.h"
 
 #if MICROPY_PY_URE
 
 #define re1_5_stack_chk() MP_STACK_CHECK()
+#define re1_5_alloc(n) m_new(char, n)
+#define re1_5_free(p, n) m_del(char, p, n)
 
 #include "re1.5/re1.5.h"
 
 #define FLAG_DEBUG 0x1000
 
+// The Pike VM takes time linear in the length of the subject and doesn't
+// recurse on it, at the cost of some heap memory for each match
+#if MICROPY_PY_URE_PIKEVM
+#define re1_5_execprog re1_5_pikevm
+#else
+#define re1_5_execprog re1_5_recursiveloopprog
+#endif
+
 typedef struct _mp_obj_re_t {
     mp_obj_base_t base;
+    #if MICROPY_PY_URE_CACHE_SIZE > 0
+    // the arguments it was compiled from, to look it up in the cache
+    mp_obj_t pattern;
+    mp_int_t flags;
+    #endif
     ByteProg re;
 } mp_obj_re_t;
 
@@ -50,14 +66,68 @@ typedef struct _mp_obj_match_t {
     mp_obj_base_t base;
     int num_matches;
     mp_obj_t str;
-    const char *caps[0];
+    // Start and end of each group as offsets into str, or -1 if the group
+    // didn't match.  These are offsets rather than pointers because str may
+    // be a buffer which is resized after the match.
+    mp_int_t caps[0];
 } mp_obj_match_t;
 
 STATIC mp_obj_t mod_re_compile(size_t n_args, const mp_obj_t *args);
+STATIC mp_obj_re_t *re_compile_cached(mp_obj_t pattern, mp_obj_t flags);
 #if !MICROPY_ENABLE_DYNRUNTIME
 STATIC const mp_obj_type_t re_type;
 #endif
 
+// Get the data of the subject of a match: a str, bytes, or any other object
+// with the buffer protocol (eg a memoryview, to match part of a buffer).
+STATIC const char *re_subject_data(mp_obj_t str, size_t *len) {
+    if (mp_obj_is_str_or_bytes(str)) {
+        return mp_obj_str_get_data(str, len);
+    }
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(str, &bufinfo, MP_BUFFER_READ);
+    *len = bufinfo.len;
+    return bufinfo.buf;
+}
+
+// Set up subj to match str from index pos up to endpos, where ^ only matches
+// at the start of str and $ at endpos, as in CPython; both are clamped to
+// the subject, so pass MP_SSIZE_MAX as endpos to match to its end.
+// Returns false if endpos is before pos, in which case subj is left empty
+// at pos: only match() still tries that, as CPython does.
+STATIC bool re_subject(Subject *subj, mp_obj_t str, mp_int_t pos, mp_int_t endpos) {
+    size_t len;
+    const char *data = re_subject_data(str, &len);
+    if (pos < 0) {
+        pos = 0;
+    } else if ((size_t)pos > len) {
+        pos = len;
+    }
+    if (endpos < 0) {
+        endpos = 0;
+    } else if ((size_t)endpos > len) {
+        endpos = len;
+    }
+    subj->bol = data;
+    subj->begin = data + pos;
+    subj->end = data + MAX(pos, endpos);
+    subj->noempty = NULL;
+    return endpos >= pos;
+}
+
+// Convert the start and end pointers of each group in caps to offsets from
+// begin, the start of the subject's data.
+STATIC void re_caps_to_offsets(mp_int_t *offsets, const char **caps, int caps_num, const char *begin) {
+    for (int i = 0; i < caps_num; i += 2) {
+        if (caps[i] == NULL || caps[i + 1] == NULL) {
+            offsets[i] = offsets[i + 1] = -1;
+        } else {
+            offsets[i] = caps[i] - begin;
+            offsets[i + 1] = caps[i + 1] - begin;
+        }
+    }
+}
+
 STATIC void match_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
     (void)kind;
     mp_obj_match_t *self = MP_OBJ_TO_PTR(self_in);
@@ -71,13 +141,18 @@ STATIC mp_obj_t match_group(mp_obj_t self_in, mp_obj_t no_in) {
         nlr_raise(mp_obj_new_exception_arg1(&mp_type_IndexError, no_in));
     }
 
-    const char *start = self->caps[no * 2];
-    if (start == NULL) {
+    mp_int_t start = self->caps[no * 2];
+    if (start < 0) {
         // no match for this group
         return mp_const_none;
     }
+    // the subject may have been resized since the match, so clamp to it
+    size_t len;
+    const char *data = re_subject_data(self->str, &len);
+    size_t end = MIN((size_t)self->caps[no * 2 + 1], len);
+    start = MIN((size_t)start, end);
     return mp_obj_new_str_of_type(mp_obj_get_type(self->str),
-        (const byte *)start, self->caps[no * 2 + 1] - start);
+        (const byte *)data + start, end - start);
 }
 MP_DEFINE_CONST_FUN_OBJ_2(match_group_obj, match_group);
 
@@ -111,18 +186,8 @@ STATIC void match_span_helper(size_t n_args, const mp_obj_t *args, mp_obj_t span
         }
     }
 
-    mp_int_t s = -1;
-    mp_int_t e = -1;
-    const char *start = self->caps[no * 2];
-    if (start != NULL) {
-        // have a match for this group
-        const char *begin = mp_obj_str_get_str(self->str);
-        s = start - begin;
-        e = self->caps[no * 2 + 1] - begin;
-    }
-
-    span[0] = mp_obj_new_int(s);
-    span[1] = mp_obj_new_int(e);
+    span[0] = mp_obj_new_int(self->caps[no * 2]);
+    span[1] = mp_obj_new_int(self->caps[no * 2 + 1]);
 }
 
 STATIC mp_obj_t match_span(size_t n_args, const mp_obj_t *args) {
@@ -171,6 +236,17 @@ STATIC const mp_obj_type_t match_type = {
 };
 #endif
 
+// Create a match object for str from the group pointers in caps, where
+// begin is the start of the subject's data.
+STATIC mp_obj_t match_new(mp_obj_t str, const char **caps, int caps_num, const char *begin) {
+    mp_obj_match_t *match = m_new_obj_var(mp_obj_match_t, mp_int_t, caps_num);
+    match->base.type = &match_type;
+    match->num_matches = caps_num / 2; // caps_num counts start and end pointers
+    match->str = str;
+    re_caps_to_offsets(match->caps, caps, caps_num, begin);
+    return MP_OBJ_FROM_PTR(match);
+}
+
 STATIC void re_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
     (void)kind;
     mp_obj_re_t *self = MP_OBJ_TO_PTR(self_in);
@@ -178,31 +254,31 @@ STATIC void re_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t
 }
 
 STATIC mp_obj_t ure_exec(bool is_anchored, uint n_args, const mp_obj_t *args) {
-    (void)n_args;
     mp_obj_re_t *self;
+    Subject subj;
     if (mp_obj_is_type(args[0], &re_type)) {
+        // regex.match(string, pos=0, endpos=len(string))
         self = MP_OBJ_TO_PTR(args[0]);
+        if (!re_subject(&subj, args[1], n_args > 2 ? mp_obj_get_int(args[2]) : 0,
+            n_args > 3 ? mp_obj_get_int(args[3]) : MP_SSIZE_MAX) && !is_anchored) {
+            return mp_const_none;
+        }
     } else {
-        self = MP_OBJ_TO_PTR(mod_re_compile(1, args));
+        // ure.match(pattern, string, flags=0)
+        self = re_compile_cached(args[0], n_args > 2 ? args[2] : MP_OBJ_NULL);
+        re_subject(&subj, args[1], 0, MP_SSIZE_MAX);
     }
-    Subject subj;
-    size_t len;
-    subj.begin = mp_obj_str_get_data(args[1], &len);
-    subj.end = subj.begin + len;
     int caps_num = (self->re.sub + 1) * 2;
-    mp_obj_match_t *match = m_new_obj_var(mp_obj_match_t, char *, caps_num);
+    const char **caps = mp_local_alloc(caps_num * sizeof(char *));
     // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
-    memset((char *)match->caps, 0, caps_num * sizeof(char *));
-    int res = re1_5_recursiveloopprog(&self->re, &subj, match->caps, caps_num, is_anchored);
-    if (res == 0) {
-        m_del_var(mp_obj_match_t, char *, caps_num, match);
-        return mp_const_none;
+    memset((char **)caps, 0, caps_num * sizeof(char *));
+    mp_obj_t match = mp_const_none;
+    if (re1_5_execprog(&self->re, &subj, caps, caps_num, is_anchored)) {
+        match = match_new(args[1], caps, caps_num, subj.bol);
     }
-
-    match->base.type = &match_type;
-    match->num_matches = caps_num / 2; // caps_num counts start and end pointers
-    match->str = args[1];
-    return MP_OBJ_FROM_PTR(match);
+    // cast is a workaround for a bug in msvc (see above)
+    mp_local_free((char **)caps);
+    return match;
 }
 
 STATIC mp_obj_t re_match(size_t n_args, const mp_obj_t *args) {
@@ -216,12 +292,19 @@ STATIC mp_obj_t re_search(size_t n_args, const mp_obj_t *args) {
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(re_search_obj, 2, 4, re_search);
 
 STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
-    mp_obj_re_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_re_t *self;
+    if (mp_obj_is_type(args[0], &re_type)) {
+        self = MP_OBJ_TO_PTR(args[0]);
+    } else {
+        self = re_compile_cached(args[0], n_args > 3 ? args[3] : MP_OBJ_NULL);
+    }
     Subject subj;
     size_t len;
     const mp_obj_type_t *str_type = mp_obj_get_type(args[1]);
     subj.begin = mp_obj_str_get_data(args[1], &len);
     subj.end = subj.begin + len;
+    subj.bol = subj.begin;
+    subj.noempty = NULL;
     int caps_num = (self->re.sub + 1) * 2;
 
     int maxsplit = 0;
@@ -234,7 +317,7 @@ STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
     while (true) {
         // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
         memset((char **)caps, 0, caps_num * sizeof(char *));
-        int res = re1_5_recursiveloopprog(&self->re, &subj, caps, caps_num, false);
+        int res = re1_5_execprog(&self->re, &subj, caps, caps_num, false);
 
         // if we didn't have a match, or had an empty match, it's time to stop
         if (!res || caps[0] == caps[1]) {
@@ -246,7 +329,7 @@ STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
         if (self->re.sub > 0) {
             mp_raise_NotImplementedError(MP_ERROR_TEXT("splitting with sub-captures"));
         }
-        subj.begin = caps[1];
+        subj.begin = subj.bol = caps[1];
         if (maxsplit > 0 && --maxsplit == 0) {
             break;
         }
@@ -259,102 +342,148 @@ STATIC mp_obj_t re_split(size_t n_args, const mp_obj_t *args) {
     return retval;
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(re_split_obj, 2, 3, re_split);
+// ure.split(pattern, string, maxsplit=0, flags=0)
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_re_split_obj, 2, 4, re_split);
 
 #if MICROPY_PY_URE_SUB
 
-STATIC mp_obj_t re_sub_helper(size_t n_args, const mp_obj_t *args) {
-    mp_obj_re_t *self;
-    if (mp_obj_is_type(args[0], &re_type)) {
-        self = MP_OBJ_TO_PTR(args[0]);
-    } else {
-        self = MP_OBJ_TO_PTR(mod_re_compile(1, args));
+// Size of the buffer used by sub_into to collect output for a stream.
+#define RE_SUB_STREAM_BUF_SIZE (64)
+
+// Where the result of a substitution goes: a vstr for sub, and for sub_into
+// either a writable buffer or a stream, with output for the stream collected
+// in buf so that it's written in large pieces.
+typedef struct _re_sub_out_t {
+    vstr_t *vstr;
+    mp_obj_t stream;
+    byte *buf;
+    size_t alloc; // size of buf
+    size_t len; // number of bytes in buf
+    size_t total; // number of bytes output
+} re_sub_out_t;
+
+STATIC void re_sub_flush(re_sub_out_t *out) {
+    if (out->stream != MP_OBJ_NULL && out->len != 0) {
+        mp_stream_write_adaptor(MP_OBJ_TO_PTR(out->stream), (const char *)out->buf, out->len);
+        out->len = 0;
     }
-    mp_obj_t replace = args[1];
-    mp_obj_t where = args[2];
-    mp_int_t count = 0;
-    if (n_args > 3) {
-        count = mp_obj_get_int(args[3]);
-        // Note: flags are currently ignored
+}
+
+STATIC void re_sub_write(re_sub_out_t *out, const char *str, size_t len) {
+    out->total += len;
+    if (out->vstr != NULL) {
+        vstr_add_strn(out->vstr, str, len);
+        return;
+    }
+    if (out->alloc - out->len < len) {
+        if (out->stream == MP_OBJ_NULL) {
+            mp_raise_ValueError(MP_ERROR_TEXT("buffer too small"));
+        }
+        re_sub_flush(out);
+        if (len >= out->alloc) {
+            mp_stream_write_adaptor(MP_OBJ_TO_PTR(out->stream), str, len);
+            return;
+        }
     }
+    memcpy(out->buf + out->len, str, len);
+    out->len += len;
+}
 
+// Substitute up to count matches of self in where (all if count is 0) with
+// replace.  Returns false if there were none and the output is a vstr, in
+// which case nothing is output.
+STATIC bool re_sub_run(mp_obj_re_t *self, mp_obj_t replace, mp_obj_t where, mp_int_t count, re_sub_out_t *out) {
     size_t where_len;
     const char *where_str = mp_obj_str_get_data(where, &where_len);
     Subject subj;
     subj.begin = where_str;
     subj.end = subj.begin + where_len;
+    subj.bol = subj.begin;
+    subj.noempty = NULL;
     int caps_num = (self->re.sub + 1) * 2;
+    bool found = false;
 
-    vstr_t vstr_return;
-    vstr_return.buf = NULL; // We'll init the vstr after the first match
-    mp_obj_match_t *match = mp_local_alloc(sizeof(mp_obj_match_t) + caps_num * sizeof(char *));
+    mp_obj_match_t *match = mp_local_alloc(sizeof(mp_obj_match_t) + caps_num * sizeof(mp_int_t));
     match->base.type = &match_type;
     match->num_matches = caps_num / 2; // caps_num counts start and end pointers
     match->str = where;
+    const char **caps = mp_local_alloc(caps_num * sizeof(char *));
 
     for (;;) {
         // cast is a workaround for a bug in msvc: it treats const char** as a const pointer instead of a pointer to pointer to const char
-        memset((char *)match->caps, 0, caps_num * sizeof(char *));
-        int res = re1_5_recursiveloopprog(&self->re, &subj, match->caps, caps_num, false);
+        memset((char **)caps, 0, caps_num * sizeof(char *));
+        int res = re1_5_execprog(&self->re, &subj, caps, caps_num, false);
 
         // If we didn't have a match, or had an empty match, it's time to stop
-        if (!res || match->caps[0] == match->caps[1]) {
+        if (!res || caps[0] == caps[1]) {
             break;
         }
 
         // Initialise the vstr if it's not already
-        if (vstr_return.buf == NULL) {
-            vstr_init(&vstr_return, match->caps[0] - subj.begin);
+        if (!found && out->vstr != NULL) {
+            vstr_init(out->vstr, caps[0] - subj.begin);
         }
+        found = true;
 
         // Add pre-match string
-        vstr_add_strn(&vstr_return, subj.begin, match->caps[0] - subj.begin);
+        re_sub_write(out, subj.begin, caps[0] - subj.begin);
 
         // Get replacement string
-        const char *repl = mp_obj_str_get_str((mp_obj_is_callable(replace) ? mp_call_function_1(replace, MP_OBJ_FROM_PTR(match)) : replace));
+        mp_obj_t repl_obj = replace;
+        if (mp_obj_is_callable(replace)) {
+            re_caps_to_offsets(match->caps, caps, caps_num, where_str);
+            repl_obj = mp_call_function_1(replace, MP_OBJ_FROM_PTR(match));
+        }
+        const char *repl = mp_obj_str_get_str(repl_obj);
 
         // Append replacement string to result, substituting any regex groups
         while (*repl != '\0') {
-            if (*repl == '\\') {
+            // Add the run of bytes up to the next escape
+            const char *run = repl;
+            while (*repl != '\0' && *repl != '\\') {
                 ++repl;
-                bool is_g_format = false;
-                if (*repl == 'g' && repl[1] == '<') {
-                    // Group specified with syntax "\g<number>"
-                    repl += 2;
-                    is_g_format = true;
+            }
+            re_sub_write(out, run, repl - run);
+            if (*repl == '\0') {
+                break;
+            }
+
+            ++repl;
+            bool is_g_format = false;
+            if (*repl == 'g' && repl[1] == '<') {
+                // Group specified with syntax "\g<number>"
+                repl += 2;
+                is_g_format = true;
+            }
+
+            if ('0' <= *repl && *repl <= '9') {
+                // Group specified with syntax "\g<number>" or "\number"
+                unsigned int match_no = 0;
+                do {
+                    match_no = match_no * 10 + (*repl++ - '0');
+                } while ('0' <= *repl && *repl <= '9');
+                if (is_g_format && *repl == '>') {
+                    ++repl;
+                }
+
+                if (match_no >= (unsigned int)match->num_matches) {
+                    nlr_raise(mp_obj_new_exception_arg1(&mp_type_IndexError, MP_OBJ_NEW_SMALL_INT(match_no)));
                 }
 
-                if ('0' <= *repl && *repl <= '9') {
-                    // Group specified with syntax "\g<number>" or "\number"
-                    unsigned int match_no = 0;
-                    do {
-                        match_no = match_no * 10 + (*repl++ - '0');
-                    } while ('0' <= *repl && *repl <= '9');
-                    if (is_g_format && *repl == '>') {
-                        ++repl;
-                    }
-
-                    if (match_no >= (unsigned int)match->num_matches) {
-                        nlr_raise(mp_obj_new_exception_arg1(&mp_type_IndexError, MP_OBJ_NEW_SMALL_INT(match_no)));
-                    }
-
-                    const char *start_match = match->caps[match_no * 2];
-                    if (start_match != NULL) {
-                        // Add the substring matched by group
-                        const char *end_match = match->caps[match_no * 2 + 1];
-                        vstr_add_strn(&vstr_return, start_match, end_match - start_match);
-                    }
-                } else if (*repl == '\\') {
-                    // Add the \ character
-                    vstr_add_byte(&vstr_return, *repl++);
+                const char *start_match = caps[match_no * 2];
+                if (start_match != NULL) {
+                    // Add the substring matched by group
+                    const char *end_match = caps[match_no * 2 + 1];
+                    re_sub_write(out, start_match, end_match - start_match);
                 }
-            } else {
-                // Just add the current byte from the replacement string
-                vstr_add_byte(&vstr_return, *repl++);
+            } else if (*repl == '\\') {
+                // Add the \ character
+                re_sub_write(out, repl++, 1);
             }
         }
 
         // Move start pointer to end of last match
-        subj.begin = match->caps[1];
+        subj.begin = subj.bol = caps[1];
 
         // Stop substitutions if count was given and gets to 0
         if (count > 0 && --count == 0) {
@@ -362,23 +491,191 @@ STATIC mp_obj_t re_sub_helper(size_t n_args, const mp_obj_t *args) {
         }
     }
 
+    // cast is a workaround for a bug in msvc (see above)
+    mp_local_free((char **)caps);
     mp_local_free(match);
 
-    if (vstr_return.buf == NULL) {
+    if (!found && out->vstr != NULL) {
         // Optimisation for case of no substitutions
-        return where;
+        return false;
     }
 
     // Add post-match string
-    vstr_add_strn(&vstr_return, subj.begin, subj.end - subj.begin);
+    re_sub_write(out, subj.begin, subj.end - subj.begin);
+    return true;
+}
 
+STATIC mp_obj_t re_sub_helper(size_t n_args, const mp_obj_t *args) {
+    mp_obj_re_t *self;
+    if (mp_obj_is_type(args[0], &re_type)) {
+        self = MP_OBJ_TO_PTR(args[0]);
+    } else {
+        self = re_compile_cached(args[0], n_args > 4 ? args[4] : MP_OBJ_NULL);
+    }
+    mp_obj_t where = args[2];
+    mp_int_t count = 0;
+    if (n_args > 3) {
+        count = mp_obj_get_int(args[3]);
+        // Note: flags are currently ignored
+    }
+
+    vstr_t vstr_return;
+    re_sub_out_t out;
+    out.vstr = &vstr_return;
+    out.stream = MP_OBJ_NULL;
+    out.total = 0;
+    if (!re_sub_run(self, args[1], where, count, &out)) {
+        return where;
+    }
     return mp_obj_new_str_from_vstr(mp_obj_get_type(where), &vstr_return);
 }
 
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(re_sub_obj, 3, 5, re_sub_helper);
 
+// regex.sub_into(replace, string, out, count=0): like sub, but write the
+// result to out, which is a writable buffer or a stream, and return the
+// number of bytes written.
+STATIC mp_obj_t re_sub_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_re_t *self = MP_OBJ_TO_PTR(args[0]);
+    byte stream_buf[RE_SUB_STREAM_BUF_SIZE];
+    re_sub_out_t out;
+    mp_buffer_info_t bufinfo;
+    out.vstr = NULL;
+    out.len = 0;
+    out.total = 0;
+    if (mp_get_buffer(args[3], &bufinfo, MP_BUFFER_WRITE)) {
+        out.stream = MP_OBJ_NULL;
+        out.buf = bufinfo.buf;
+        out.alloc = bufinfo.len;
+    } else {
+        mp_get_stream_raise(args[3], MP_STREAM_OP_WRITE);
+        out.stream = args[3];
+        out.buf = stream_buf;
+        out.alloc = sizeof(stream_buf);
+    }
+    re_sub_run(self, args[1], args[2], n_args > 4 ? mp_obj_get_int(args[4]) : 0, &out);
+    re_sub_flush(&out);
+    return mp_obj_new_int_from_uint(out.total);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(re_sub_into_obj, 4, 5, re_sub_into);
+
 #endif
 
+#if MICROPY_PY_URE_FINDITER
+
+// Iterator returned by regex.finditer.  The positions are kept as indices
+// rather than pointers, and the subject's data fetched again for each match,
+// in case the subject is a buffer which is resized in between.
+typedef struct _re_finditer_t {
+    mp_obj_base_t base;
+    mp_fun_1_t iternext;
+    mp_obj_re_t *re;
+    mp_obj_t str;
+    mp_int_t pos;
+    mp_int_t endpos;
+    bool noempty;
+} re_finditer_t;
+
+// Find the next match of re in str from *pos, which is moved to the end of
+// it, and store the offsets of its groups in spans.  As in CPython finditer
+// (3.7+), empty matches are included, and the search after an empty match
+// may find a non-empty match at the same position, but not an empty one;
+// *noempty records whether that applies to the next search.
+STATIC bool re_find_next(mp_obj_re_t *re, mp_obj_t str, mp_int_t *pos, mp_int_t endpos, bool *noempty, mp_int_t *spans, int caps_num) {
+    Subject subj;
+    if (*pos < 0 || !re_subject(&subj, str, *pos, endpos)) {
+        return false;
+    }
+    if (*noempty) {
+        subj.noempty = subj.begin;
+    }
+    const char **caps = mp_local_alloc(caps_num * sizeof(char *));
+    // cast is a workaround for a bug in msvc (see above)
+    memset((char **)caps, 0, caps_num * sizeof(char *));
+    bool found = re1_5_execprog(&re->re, &subj, caps, caps_num, false);
+    if (found) {
+        re_caps_to_offsets(spans, caps, caps_num, subj.bol);
+        *pos = spans[1];
+        *noempty = spans[0] == spans[1];
+    } else {
+        *pos = -1;
+    }
+    // cast is a workaround for a bug in msvc (see above)
+    mp_local_free((char **)caps);
+    return found;
+}
+
+STATIC mp_obj_t re_finditer_iternext(mp_obj_t self_in) {
+    re_finditer_t *self = MP_OBJ_TO_PTR(self_in);
+    int caps_num = (self->re->re.sub + 1) * 2;
+    mp_obj_match_t *match = m_new_obj_var(mp_obj_match_t, mp_int_t, caps_num);
+    if (!re_find_next(self->re, self->str, &self->pos, self->endpos, &self->noempty, match->caps, caps_num)) {
+        m_del_var(mp_obj_match_t, mp_int_t, caps_num, match);
+        self->pos = -1;
+        return MP_OBJ_STOP_ITERATION;
+    }
+    match->base.type = &match_type;
+    match->num_matches = caps_num / 2;
+    match->str = self->str;
+    return MP_OBJ_FROM_PTR(match);
+}
+
+STATIC mp_obj_t re_finditer(size_t n_args, const mp_obj_t *args) {
+    re_finditer_t *o = m_new_obj(re_finditer_t);
+    o->base.type = &mp_type_polymorph_iter;
+    o->iternext = re_finditer_iternext;
+    o->re = MP_OBJ_TO_PTR(args[0]);
+    o->str = args[1];
+    o->pos = n_args > 2 ? mp_obj_get_int(args[2]) : 0;
+    o->endpos = n_args > 3 ? mp_obj_get_int(args[3]) : MP_SSIZE_MAX;
+    o->noempty = false;
+    if (o->pos < 0) {
+        o->pos = 0;
+    }
+    return MP_OBJ_FROM_PTR(o);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(re_finditer_obj, 2, 4, re_finditer);
+
+// regex.spans_into(string, buf, pos=0, endpos=len(string)): store the start and end of
+// successive matches, as finditer finds them, in the typed array buf (eg an
+// array('i')), until it is full.  Returns the number of matches stored; if buf
+// filled up, the search can be continued from the end of the last one.
+STATIC mp_obj_t re_spans_into(size_t n_args, const mp_obj_t *args) {
+    mp_obj_re_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t str = args[1];
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[2], &bufinfo, MP_BUFFER_WRITE);
+    size_t max = bufinfo.len / mp_binary_get_size('@', bufinfo.typecode, NULL) / 2;
+    mp_int_t pos = n_args > 3 ? mp_obj_get_int(args[3]) : 0;
+    mp_int_t endpos = n_args > 4 ? mp_obj_get_int(args[4]) : MP_SSIZE_MAX;
+    if (pos < 0) {
+        pos = 0;
+    }
+    if (max > 0) {
+        // every span lies within the string, so check once that its length
+        // can be stored rather than range-checking each value
+        mp_obj_t len = mp_obj_len(str);
+        mp_binary_set_val_array_from_int(bufinfo.typecode, bufinfo.buf, 0, MP_OBJ_SMALL_INT_VALUE(len));
+        if (!mp_obj_equal(mp_binary_get_val_array(bufinfo.typecode, bufinfo.buf, 0), len)) {
+            mp_raise_msg(&mp_type_OverflowError, MP_ERROR_TEXT("buffer type too small for string"));
+        }
+    }
+
+    int caps_num = (self->re.sub + 1) * 2;
+    mp_int_t *spans = mp_local_alloc(caps_num * sizeof(mp_int_t));
+    bool noempty = false;
+    size_t n = 0;
+    for (; n < max && re_find_next(self, str, &pos, endpos, &noempty, spans, caps_num); ++n) {
+        mp_binary_set_val_array_from_int(bufinfo.typecode, bufinfo.buf, 2 * n, spans[0]);
+        mp_binary_set_val_array_from_int(bufinfo.typecode, bufinfo.buf, 2 * n + 1, spans[1]);
+    }
+    mp_local_free(spans);
+    return MP_OBJ_NEW_SMALL_INT(n);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(re_spans_into_obj, 3, 5, re_spans_into);
+
+#endif // MICROPY_PY_URE_FINDITER
+
 #if !MICROPY_ENABLE_DYNRUNTIME
 STATIC const mp_rom_map_elem_t re_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_match), MP_ROM_PTR(&re_match_obj) },
@@ -386,6 +683,11 @@ STATIC const mp_rom_map_elem_t re_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_split), MP_ROM_PTR(&re_split_obj) },
     #if MICROPY_PY_URE_SUB
     { MP_ROM_QSTR(MP_QSTR_sub), MP_ROM_PTR(&re_sub_obj) },
+    { MP_ROM_QSTR(MP_QSTR_sub_into), MP_ROM_PTR(&re_sub_into_obj) },
+    #endif
+    #if MICROPY_PY_URE_FINDITER
+    { MP_ROM_QSTR(MP_QSTR_finditer), MP_ROM_PTR(&re_finditer_obj) },
+    { MP_ROM_QSTR(MP_QSTR_spans_into), MP_ROM_PTR(&re_spans_into_obj) },
     #endif
 };
 
@@ -408,12 +710,16 @@ STATIC mp_obj_t mod_re_compile(size_t n_args, const mp_obj_t *args) {
     }
     mp_obj_re_t *o = m_new_obj_var(mp_obj_re_t, char, size);
     o->base.type = &re_type;
-    #if MICROPY_PY_URE_DEBUG
-    int flags = 0;
+    #if MICROPY_PY_URE_DEBUG || MICROPY_PY_URE_CACHE_SIZE > 0
+    mp_int_t flags = 0;
     if (n_args > 1) {
         flags = mp_obj_get_int(args[1]);
     }
     #endif
+    #if MICROPY_PY_URE_CACHE_SIZE > 0
+    o->pattern = args[0];
+    o->flags = flags;
+    #endif
     int error = re1_5_compilecode(&o->re, re_str);
     if (error != 0) {
     error:
@@ -428,15 +734,86 @@ STATIC mp_obj_t mod_re_compile(size_t n_args, const mp_obj_t *args) {
 }
 MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_re_compile_obj, 1, 2, mod_re_compile);
 
+// Compile a pattern given to one of the module-level functions.  Programs
+// compiled this way are kept in a small cache, most recently used first, so
+// that functions called repeatedly with the same pattern (eg in a loop) don't
+// parse it and allocate a new program every time.
+STATIC mp_obj_re_t *re_compile_cached(mp_obj_t pattern, mp_obj_t flags_in) {
+    mp_obj_t args[2] = { pattern, flags_in };
+    #if MICROPY_PY_URE_CACHE_SIZE > 0
+    mp_int_t flags = flags_in == MP_OBJ_NULL ? 0 : mp_obj_get_int(flags_in);
+    mp_obj_t *cache = MP_STATE_VM(ure_cache);
+    size_t i = 0;
+    for (; i < MICROPY_PY_URE_CACHE_SIZE && cache[i] != MP_OBJ_NULL; ++i) {
+        mp_obj_re_t *o = MP_OBJ_TO_PTR(cache[i]);
+        if (o->flags == flags && (o->pattern == pattern
+                                  || (mp_obj_get_type(o->pattern) == mp_obj_get_type(pattern)
+                                      && mp_obj_equal(o->pattern, pattern)))) {
+            ++MP_STATE_VM(ure_cache_hits);
+            memmove(&cache[1], &cache[0], i * sizeof(mp_obj_t));
+            cache[0] = MP_OBJ_FROM_PTR(o);
+            return o;
+        }
+    }
+    ++MP_STATE_VM(ure_cache_misses);
+    mp_obj_t o = mod_re_compile(flags_in == MP_OBJ_NULL ? 1 : 2, args);
+    #if MICROPY_PY_URE_DEBUG
+    if (flags & FLAG_DEBUG) {
+        // don't cache it, so the program is dumped again next time
+        return MP_OBJ_TO_PTR(o);
+    }
+    #endif
+    // insert at the front, dropping the least recently used if full
+    if (i == MICROPY_PY_URE_CACHE_SIZE) {
+        --i;
+    }
+    memmove(&cache[1], &cache[0], i * sizeof(mp_obj_t));
+    cache[0] = o;
+    return MP_OBJ_TO_PTR(o);
+    #else
+    return MP_OBJ_TO_PTR(mod_re_compile(flags_in == MP_OBJ_NULL ? 1 : 2, args));
+    #endif
+}
+
+#if MICROPY_PY_URE_CACHE_SIZE > 0 && !MICROPY_ENABLE_DYNRUNTIME
+STATIC mp_obj_t mod_re_purge(void) {
+    for (size_t i = 0; i < MICROPY_PY_URE_CACHE_SIZE; ++i) {
+        MP_STATE_VM(ure_cache)[i] = MP_OBJ_NULL;
+    }
+    return mp_const_none;
+}
+MP_DEFINE_CONST_FUN_OBJ_0(mod_re_purge_obj, mod_re_purge);
+
+STATIC mp_obj_t mod_re_cache_info(void) {
+    size_t n = 0;
+    while (n < MICROPY_PY_URE_CACHE_SIZE && MP_STATE_VM(ure_cache)[n] != MP_OBJ_NULL) {
+        ++n;
+    }
+    mp_obj_t items[4] = {
+        mp_obj_new_int_from_uint(MP_STATE_VM(ure_cache_hits)),
+        mp_obj_new_int_from_uint(MP_STATE_VM(ure_cache_misses)),
+        MP_OBJ_NEW_SMALL_INT(MICROPY_PY_URE_CACHE_SIZE),
+        MP_OBJ_NEW_SMALL_INT(n),
+    };
+    return mp_obj_new_tuple(4, items);
+}
+MP_DEFINE_CONST_FUN_OBJ_0(mod_re_cache_info_obj, mod_re_cache_info);
+#endif
+
 #if !MICROPY_ENABLE_DYNRUNTIME
 STATIC const mp_rom_map_elem_t mp_module_re_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ure) },
     { MP_ROM_QSTR(MP_QSTR_compile), MP_ROM_PTR(&mod_re_compile_obj) },
     { MP_ROM_QSTR(MP_QSTR_match), MP_ROM_PTR(&re_match_obj) },
     { MP_ROM_QSTR(MP_QSTR_search), MP_ROM_PTR(&re_search_obj) },
+    { MP_ROM_QSTR(MP_QSTR_split), MP_ROM_PTR(&mod_re_split_obj) },
     #if MICROPY_PY_URE_SUB
     { MP_ROM_QSTR(MP_QSTR_sub), MP_ROM_PTR(&re_sub_obj) },
     #endif
+    #if MICROPY_PY_URE_CACHE_SIZE > 0
+    { MP_ROM_QSTR(MP_QSTR_purge), MP_ROM_PTR(&mod_re_purge_obj) },
+    { MP_ROM_QSTR(MP_QSTR_cache_info), MP_ROM_PTR(&mod_re_cache_info_obj) },
+    #endif
     #if MICROPY_PY_URE_DEBUG
     { MP_ROM_QSTR(MP_QSTR_DEBUG), MP_ROM_INT(FLAG_DEBUG) },
     #endif
@@ -458,7 +835,12 @@ const mp_obj_module_t mp_module_ure = {
 #if MICROPY_PY_URE_DEBUG
 #include "re1.5/dumpcode.c"
 #endif
+#if MICROPY_PY_URE_PIKEVM
+#include "re1.5/pike.c"
+#else
 #include "re1.5/recursiveloop.c"
+#endif
 #include "re1.5/charclass.c"
+#include "re1.5/prefilter.c"
 
 #endif // MICROPY_PY_URE
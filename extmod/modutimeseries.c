@@ -0,0 +1,661 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/stream.h"
+#include "py/binary.h"
+#include "py/objarray.h"
+#include "py/objint.h"
+#include "py/mperrno.h"
+
+#if MICROPY_PY_UTIMESERIES
+
+#if MICROPY_LONGINT_IMPL == MICROPY_LONGINT_IMPL_NONE
+#error utimeseries requires long int support
+#endif
+
+#if !MICROPY_PY_ARRAY
+#error utimeseries requires MICROPY_PY_ARRAY
+#endif
+
+// An append-only store of timestamped records of a fixed format, kept in a
+// file (or any seekable stream).
+//
+// The file is made of blocks of block_size bytes, which are always written
+// whole and at block-aligned offsets, so that a filesystem on flash never has
+// to read-modify-write a partial erase block or sector.  Block 0 holds the
+// file header:
+//
+//     0   magic "uTSF"
+//     4   version (1 byte)
+//     5   length of the record format (1 byte)
+//     6   zero (2 bytes)
+//     8   block size (4 bytes)
+//     12  record format, as for ustruct, little endian
+//
+// Every other block is a segment of records:
+//
+//     0   magic "uTSB"
+//     4   number of records (2 bytes)
+//     6   number of bytes of records (2 bytes)
+//     8   timestamp of the first record (8 bytes, signed)
+//     16  records
+//
+// Each record is the difference between its timestamp and the previous one
+// in the segment (0 for the first), as an unsigned LEB128 varint, followed by
+// the packed values.  All integers in the headers are little endian, and the
+// unused ends of blocks are filled with 0xff, the erased state of flash.
+//
+// The segment being appended to is kept in RAM and written out when it's
+// full, on flush(), and every sync_every records.  The timestamp of the first
+// record of each segment is kept in RAM too, as a sparse index, so a query
+// only reads the segments which overlap the requested time range.
+
+#define TS_FILE_HEADER_SIZE (12)
+#define TS_FMT_MAX (32)
+#define TS_SEG_HEADER_SIZE (16)
+#define TS_VARINT_MAX (10)
+#define TS_VERSION (1)
+
+#define TS_BLOCK_SIZE_MIN (64)
+#define TS_BLOCK_SIZE_MAX (65536)
+
+typedef struct _mp_obj_timeseries_t {
+    mp_obj_base_t base;
+    mp_obj_t stream;
+    byte *buf; // the current segment
+    byte *rbuf; // for reading other segments, allocated by the first query
+    int64_t *index; // timestamp of the first record of each segment
+    size_t index_alloc;
+    size_t seg; // number of the current segment, from 0
+    size_t count; // number of records in all segments
+    int64_t last_time;
+    uint32_t block_size;
+    uint16_t record_size;
+    uint16_t seg_count; // records in the current segment
+    uint16_t seg_used; // bytes of records in the current segment
+    uint16_t sync_every;
+    uint16_t unsynced; // records appended since the last sync
+    bool dirty; // current segment has changed since it was last written
+    bool closed;
+    byte fmt_len;
+    char fmt[TS_FMT_MAX];
+} mp_obj_timeseries_t;
+
+STATIC inline uint32_t ts_get16(const byte *p) {
+    return p[0] | p[1] << 8;
+}
+
+STATIC inline uint32_t ts_get32(const byte *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+STATIC inline int64_t ts_get64(const byte *p) {
+    return (int64_t)((uint64_t)ts_get32(p) | (uint64_t)ts_get32(p + 4) << 32);
+}
+
+STATIC void ts_put16(byte *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+STATIC void ts_put32(byte *p, uint32_t v) {
+    ts_put16(p, v);
+    ts_put16(p + 2, v >> 16);
+}
+
+STATIC void ts_put64(byte *p, int64_t v) {
+    ts_put32(p, (uint64_t)v);
+    ts_put32(p + 4, (uint64_t)v >> 32);
+}
+
+// Timestamps can be any integer which fits in 64 bits.
+STATIC int64_t ts_get_time(mp_obj_t t_in) {
+    if (mp_obj_is_small_int(t_in)) {
+        return MP_OBJ_SMALL_INT_VALUE(t_in);
+    }
+    #if MICROPY_LONGINT_IMPL != MICROPY_LONGINT_IMPL_NONE
+    if (mp_obj_is_type(t_in, &mp_type_int)) {
+        mp_binary_op_t op = MP_BINARY_OP_MORE;
+        long long limit = INT64_MAX;
+        if (mp_obj_int_sign(t_in) < 0) {
+            op = MP_BINARY_OP_LESS;
+            limit = INT64_MIN;
+        }
+        if (mp_binary_op(op, t_in, mp_obj_new_int_from_ll(limit)) == mp_const_true) {
+            mp_raise_msg(&mp_type_OverflowError, MP_ERROR_TEXT("timestamp out of range"));
+        }
+    }
+    #endif
+    int64_t t;
+    mp_binary_set_val_array('q', &t, 0, t_in);
+    return t;
+}
+
+STATIC void ts_check_open(mp_obj_timeseries_t *self) {
+    if (self->closed) {
+        mp_raise_ValueError(MP_ERROR_TEXT("I/O operation on closed file"));
+    }
+}
+
+NORETURN STATIC void ts_raise_corrupt(void) {
+    mp_raise_OSError(MP_EIO);
+}
+
+/******************************************************************************/
+// Stream access
+
+STATIC void ts_seek(mp_obj_timeseries_t *self, size_t block) {
+    const mp_stream_p_t *stream_p = mp_get_stream(self->stream);
+    struct mp_stream_seek_t seek_s;
+    seek_s.offset = (mp_off_t)block * self->block_size;
+    seek_s.whence = MP_SEEK_SET;
+    int errcode;
+    if (stream_p->ioctl(self->stream, MP_STREAM_SEEK, (uintptr_t)&seek_s, &errcode) == MP_STREAM_ERROR) {
+        mp_raise_OSError(errcode);
+    }
+}
+
+// Read up to len bytes from the start of a block, returning how many were read.
+STATIC size_t ts_read_block(mp_obj_timeseries_t *self, size_t block, byte *buf, size_t len) {
+    ts_seek(self, block);
+    int errcode;
+    size_t n = mp_stream_rw(self->stream, buf, len, &errcode, MP_STREAM_RW_READ);
+    if (errcode != 0) {
+        mp_raise_OSError(errcode);
+    }
+    return n;
+}
+
+STATIC void ts_write_block(mp_obj_timeseries_t *self, size_t block, const byte *buf) {
+    ts_seek(self, block);
+    int errcode;
+    mp_stream_rw(self->stream, (void *)buf, self->block_size, &errcode, MP_STREAM_RW_WRITE);
+    if (errcode != 0) {
+        mp_raise_OSError(errcode);
+    }
+}
+
+// Write out the current segment, if it has changed.
+STATIC void ts_write_segment(mp_obj_timeseries_t *self) {
+    if (!self->dirty) {
+        return;
+    }
+    byte *buf = self->buf;
+    memcpy(buf, "uTSB", 4);
+    ts_put16(buf + 4, self->seg_count);
+    ts_put16(buf + 6, self->seg_used);
+    ts_put64(buf + 8, self->index[self->seg]);
+    size_t end = TS_SEG_HEADER_SIZE + self->seg_used;
+    memset(buf + end, 0xff, self->block_size - end);
+    ts_write_block(self, 1 + self->seg, buf);
+    self->dirty = false;
+}
+
+STATIC void ts_sync(mp_obj_timeseries_t *self) {
+    ts_write_segment(self);
+    const mp_stream_p_t *stream_p = mp_get_stream(self->stream);
+    int errcode;
+    if (stream_p->ioctl(self->stream, MP_STREAM_FLUSH, 0, &errcode) == MP_STREAM_ERROR) {
+        mp_raise_OSError(errcode);
+    }
+    self->unsynced = 0;
+}
+
+/******************************************************************************/
+// Segments
+
+// Decode the varint at *p, not going beyond end.
+STATIC uint64_t ts_get_varint(const byte **p, const byte *end) {
+    uint64_t v = 0;
+    for (unsigned shift = 0; *p < end && shift < 64; shift += 7) {
+        byte b = *(*p)++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return v;
+        }
+    }
+    ts_raise_corrupt();
+}
+
+STATIC size_t ts_put_varint(byte *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = v;
+    return n;
+}
+
+// Check the header of the segment in buf, returning false if the block
+// doesn't hold a segment.
+STATIC bool ts_check_segment(mp_obj_timeseries_t *self, const byte *buf) {
+    if (memcmp(buf, "uTSB", 4) != 0) {
+        return false;
+    }
+    size_t count = ts_get16(buf + 4);
+    size_t used = ts_get16(buf + 6);
+    if (count == 0 || used > self->block_size - TS_SEG_HEADER_SIZE
+        || used < count * (1 + self->record_size)) {
+        ts_raise_corrupt();
+    }
+    return true;
+}
+
+STATIC void ts_index_append(mp_obj_timeseries_t *self, size_t seg, int64_t t) {
+    if (seg >= self->index_alloc) {
+        size_t new_alloc = self->index_alloc * 2;
+        self->index = m_renew(int64_t, self->index, self->index_alloc, new_alloc);
+        self->index_alloc = new_alloc;
+    }
+    self->index[seg] = t;
+}
+
+// Append one record with the given timestamp, and return where its values
+// go.  The caller must fill them in and then call ts_commit.
+STATIC byte *ts_append(mp_obj_timeseries_t *self, int64_t t, size_t *len) {
+    if (self->count > 0 && t < self->last_time) {
+        mp_raise_ValueError(MP_ERROR_TEXT("timestamps must not decrease"));
+    }
+    byte delta[TS_VARINT_MAX];
+    size_t n = ts_put_varint(delta, self->seg_count > 0 ? (uint64_t)t - (uint64_t)self->last_time : 0);
+    if (TS_SEG_HEADER_SIZE + self->seg_used + n + self->record_size > self->block_size) {
+        // the current segment is full, so write it out and start a new one
+        ts_write_segment(self);
+        self->seg += 1;
+        self->seg_count = 0;
+        self->seg_used = 0;
+        n = ts_put_varint(delta, 0);
+    }
+    byte *p = self->buf + TS_SEG_HEADER_SIZE + self->seg_used;
+    memcpy(p, delta, n);
+    *len = n;
+    return p + n;
+}
+
+STATIC void ts_commit(mp_obj_timeseries_t *self, int64_t t, size_t len) {
+    if (self->seg_count == 0) {
+        ts_index_append(self, self->seg, t);
+    }
+    self->seg_count += 1;
+    self->seg_used += len + self->record_size;
+    self->count += 1;
+    self->last_time = t;
+    self->dirty = true;
+    if (self->sync_every != 0 && ++self->unsynced >= self->sync_every) {
+        ts_sync(self);
+    }
+}
+
+/******************************************************************************/
+// TimeSeries type
+
+STATIC mp_obj_t timeseries_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_stream, ARG_fmt, ARG_block_size, ARG_sync_every };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_stream, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_fmt, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_block_size, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 4096} },
+        { MP_QSTR_sync_every, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    mp_obj_t stream = args[ARG_stream].u_obj;
+    mp_get_stream_raise(stream, MP_STREAM_OP_READ | MP_STREAM_OP_WRITE | MP_STREAM_OP_IOCTL);
+
+    // Work out the size of a record; values are always stored little endian.
+    size_t fmt_len;
+    const char *fmt = mp_obj_str_get_data(args[ARG_fmt].u_obj, &fmt_len);
+    if (fmt_len > TS_FMT_MAX) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bad typecode"));
+    }
+    const char *f = fmt;
+    if (fmt_len > 0 && *f == '<') {
+        ++f;
+    }
+    size_t record_size = 0;
+    for (; f < fmt + fmt_len; ++f) {
+        #if MICROPY_PY_BUILTINS_FLOAT
+        static const char typecodes[] = "bBhHiIlLqQfd";
+        #else
+        static const char typecodes[] = "bBhHiIlLqQ";
+        #endif
+        if (*f == '\0' || strchr(typecodes, *f) == NULL) {
+            mp_raise_ValueError(MP_ERROR_TEXT("bad typecode"));
+        }
+        record_size += mp_binary_get_size('<', *f, NULL);
+    }
+
+    // a segment must have room for at least one record
+    mp_int_t block_size = args[ARG_block_size].u_int;
+    if (block_size < TS_BLOCK_SIZE_MIN || block_size > TS_BLOCK_SIZE_MAX || (block_size & (block_size - 1)) != 0
+        || TS_SEG_HEADER_SIZE + TS_VARINT_MAX + record_size > (size_t)block_size) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bad block size"));
+    }
+
+    mp_int_t sync_every = args[ARG_sync_every].u_int;
+    if (sync_every < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bad sync_every"));
+    }
+
+    mp_obj_timeseries_t *self = m_new_obj(mp_obj_timeseries_t);
+    self->base.type = type;
+    self->stream = stream;
+    self->fmt_len = fmt_len;
+    memcpy(self->fmt, fmt, fmt_len);
+    self->record_size = record_size;
+    self->sync_every = MIN(sync_every, 0xffff);
+    self->rbuf = NULL;
+    self->index_alloc = 4;
+    self->index = m_new(int64_t, self->index_alloc);
+    self->seg = 0;
+    self->count = 0;
+    self->last_time = 0;
+    self->seg_count = 0;
+    self->seg_used = 0;
+    self->unsynced = 0;
+    self->dirty = false;
+    self->closed = false;
+
+    // Read the file header, or write one to an empty stream.
+    byte hdr[TS_FILE_HEADER_SIZE + TS_FMT_MAX];
+    self->block_size = block_size;
+    size_t n = ts_read_block(self, 0, hdr, sizeof(hdr));
+    if (n == 0) {
+        self->buf = m_new(byte, block_size);
+        byte *buf = self->buf;
+        memset(buf, 0xff, block_size);
+        memcpy(buf, "uTSF", 4);
+        buf[4] = TS_VERSION;
+        buf[5] = fmt_len;
+        ts_put16(buf + 6, 0);
+        ts_put32(buf + 8, block_size);
+        memcpy(buf + TS_FILE_HEADER_SIZE, fmt, fmt_len);
+        ts_write_block(self, 0, buf);
+        return MP_OBJ_FROM_PTR(self);
+    }
+    if (n < TS_FILE_HEADER_SIZE || memcmp(hdr, "uTSF", 4) != 0 || hdr[4] != TS_VERSION) {
+        mp_raise_ValueError(MP_ERROR_TEXT("not a time series"));
+    }
+    block_size = ts_get32(hdr + 8);
+    if (block_size < TS_BLOCK_SIZE_MIN || block_size > TS_BLOCK_SIZE_MAX
+        || TS_SEG_HEADER_SIZE + TS_VARINT_MAX + record_size > (size_t)block_size) {
+        ts_raise_corrupt();
+    }
+    if (hdr[5] != fmt_len || n < TS_FILE_HEADER_SIZE + fmt_len || memcmp(hdr + TS_FILE_HEADER_SIZE, fmt, fmt_len) != 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("record format differs"));
+    }
+    self->block_size = block_size;
+    self->buf = m_new(byte, block_size);
+
+    // Build the index from the segment headers.
+    byte seg_hdr[TS_SEG_HEADER_SIZE];
+    size_t seg = 0;
+    while (ts_read_block(self, 1 + seg, seg_hdr, TS_SEG_HEADER_SIZE) == TS_SEG_HEADER_SIZE
+           && ts_check_segment(self, seg_hdr)) {
+        ts_index_append(self, seg, ts_get64(seg_hdr + 8));
+        self->count += ts_get16(seg_hdr + 4);
+        ++seg;
+    }
+
+    // Continue appending to the last segment.
+    if (seg > 0) {
+        self->seg = seg - 1;
+        byte *buf = self->buf;
+        if (ts_read_block(self, 1 + self->seg, buf, block_size) != (size_t)block_size) {
+            ts_raise_corrupt();
+        }
+        self->seg_count = ts_get16(buf + 4);
+        self->seg_used = ts_get16(buf + 6);
+        const byte *p = buf + TS_SEG_HEADER_SIZE;
+        const byte *end = p + self->seg_used;
+        int64_t t = self->index[self->seg];
+        for (size_t i = self->seg_count; i > 0; --i) {
+            t = (int64_t)((uint64_t)t + ts_get_varint(&p, end));
+            p += self->record_size;
+        }
+        if (p != end) {
+            ts_raise_corrupt();
+        }
+        self->last_time = t;
+    }
+
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// append(t, *values)
+STATIC mp_obj_t timeseries_append(size_t n_args, const mp_obj_t *args) {
+    mp_obj_timeseries_t *self = MP_OBJ_TO_PTR(args[0]);
+    ts_check_open(self);
+    const char *fmt = self->fmt;
+    const char *fmt_end = fmt + self->fmt_len;
+    if (fmt < fmt_end && *fmt == '<') {
+        ++fmt;
+    }
+    if ((size_t)(fmt_end - fmt) != n_args - 2) {
+        mp_raise_TypeError(MP_ERROR_TEXT("wrong number of values"));
+    }
+    int64_t t = ts_get_time(args[1]);
+    size_t len;
+    byte *p = ts_append(self, t, &len);
+    byte *p_base = p;
+    for (size_t i = 2; i < n_args; ++i) {
+        mp_binary_set_val('<', *fmt++, args[i], p_base, &p);
+    }
+    ts_commit(self, t, len);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(timeseries_append_obj, 2, MP_OBJ_FUN_ARGS_MAX, timeseries_append);
+
+// extend(times, data): append len(times) records, with values already packed
+// one after the other in data.
+STATIC mp_obj_t timeseries_extend(mp_obj_t self_in, mp_obj_t times_in, mp_obj_t data_in) {
+    mp_obj_timeseries_t *self = MP_OBJ_TO_PTR(self_in);
+    ts_check_open(self);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data_in, &bufinfo, MP_BUFFER_READ);
+    size_t n = mp_obj_get_int(mp_obj_len(times_in));
+    if (bufinfo.len != n * self->record_size) {
+        mp_raise_ValueError(MP_ERROR_TEXT("data length doesn't match times"));
+    }
+    const byte *data = bufinfo.buf;
+    mp_obj_iter_buf_t iter_buf;
+    mp_obj_t iter = mp_getiter(times_in, &iter_buf);
+    mp_obj_t t_in;
+    for (size_t i = 0; i < n && (t_in = mp_iternext(iter)) != MP_OBJ_STOP_ITERATION; ++i) {
+        int64_t t = ts_get_time(t_in);
+        size_t len;
+        byte *p = ts_append(self, t, &len);
+        memcpy(p, data, self->record_size);
+        data += self->record_size;
+        ts_commit(self, t, len);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(timeseries_extend_obj, timeseries_extend);
+
+// query(start=None, end=None): return the records with start <= t < end, as a
+// tuple of an array('q') of their timestamps and a bytes of their values.
+STATIC mp_obj_t timeseries_query(size_t n_args, const mp_obj_t *args) {
+    mp_obj_timeseries_t *self = MP_OBJ_TO_PTR(args[0]);
+    ts_check_open(self);
+    int64_t start = INT64_MIN;
+    int64_t end = INT64_MAX;
+    bool has_end = false;
+    if (n_args > 1 && args[1] != mp_const_none) {
+        start = ts_get_time(args[1]);
+    }
+    if (n_args > 2 && args[2] != mp_const_none) {
+        end = ts_get_time(args[2]);
+        has_end = true;
+    }
+
+    size_t nseg = self->seg + (self->seg_count > 0);
+
+    // Find the first segment which can hold a record at or after start: the
+    // last one whose first record is before start, since the ones before it
+    // end before its first record.
+    size_t lo = 0, hi = nseg;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (self->index[mid] < start) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    vstr_t times, data;
+    vstr_init(&times, 8 * sizeof(int64_t));
+    vstr_init(&data, 8 * self->record_size);
+    size_t n = 0;
+    for (size_t seg = lo; seg < nseg && (!has_end || self->index[seg] < end); ++seg) {
+        const byte *buf;
+        if (seg == self->seg) {
+            buf = self->buf;
+        } else {
+            if (self->rbuf == NULL) {
+                self->rbuf = m_new(byte, self->block_size);
+            }
+            if (ts_read_block(self, 1 + seg, self->rbuf, self->block_size) != self->block_size
+                || !ts_check_segment(self, self->rbuf)) {
+                ts_raise_corrupt();
+            }
+            buf = self->rbuf;
+        }
+        size_t count = ts_get16(buf + 4);
+        const byte *p = buf + TS_SEG_HEADER_SIZE;
+        const byte *p_end = p + ts_get16(buf + 6);
+        if (seg == self->seg) {
+            // the header of the current segment may not be written yet
+            count = self->seg_count;
+            p_end = p + self->seg_used;
+        }
+        int64_t t = self->index[seg];
+        for (; count > 0; --count) {
+            t = (int64_t)((uint64_t)t + ts_get_varint(&p, p_end));
+            if (p + self->record_size > p_end) {
+                ts_raise_corrupt();
+            }
+            if (has_end && t >= end) {
+                break;
+            }
+            if (t >= start) {
+                memcpy(vstr_add_len(&times, sizeof(int64_t)), &t, sizeof(int64_t));
+                memcpy(vstr_add_len(&data, self->record_size), p, self->record_size);
+                ++n;
+            }
+            p += self->record_size;
+        }
+    }
+
+    // Make an array('q') which takes over the buffer of the timestamps.
+    mp_obj_array_t *arr = m_new_obj(mp_obj_array_t);
+    arr->base.type = &mp_type_array;
+    arr->typecode = 'q';
+    arr->free = times.alloc / sizeof(int64_t) - n;
+    arr->len = n;
+    arr->items = times.buf;
+
+    mp_obj_t items[2] = {
+        MP_OBJ_FROM_PTR(arr),
+        mp_obj_new_str_from_vstr(&mp_type_bytes, &data),
+    };
+    return mp_obj_new_tuple(2, items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(timeseries_query_obj, 1, 3, timeseries_query);
+
+STATIC mp_obj_t timeseries_flush(mp_obj_t self_in) {
+    mp_obj_timeseries_t *self = MP_OBJ_TO_PTR(self_in);
+    ts_check_open(self);
+    ts_sync(self);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(timeseries_flush_obj, timeseries_flush);
+
+STATIC mp_obj_t timeseries_close(mp_obj_t self_in) {
+    mp_obj_timeseries_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!self->closed) {
+        ts_sync(self);
+        self->closed = true;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(timeseries_close_obj, timeseries_close);
+
+STATIC mp_obj_t timeseries___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    return timeseries_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(timeseries___exit___obj, 4, 4, timeseries___exit__);
+
+STATIC mp_obj_t timeseries_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
+    mp_obj_timeseries_t *self = MP_OBJ_TO_PTR(self_in);
+    switch (op) {
+        case MP_UNARY_OP_BOOL:
+            return mp_obj_new_bool(self->count != 0);
+        case MP_UNARY_OP_LEN:
+            return MP_OBJ_NEW_SMALL_INT(self->count);
+        default:
+            return MP_OBJ_NULL; // op not supported
+    }
+}
+
+STATIC const mp_rom_map_elem_t timeseries_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_append), MP_ROM_PTR(&timeseries_append_obj) },
+    { MP_ROM_QSTR(MP_QSTR_extend), MP_ROM_PTR(&timeseries_extend_obj) },
+    { MP_ROM_QSTR(MP_QSTR_query), MP_ROM_PTR(&timeseries_query_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&timeseries_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&timeseries_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&timeseries___exit___obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(timeseries_locals_dict, timeseries_locals_dict_table);
+
+STATIC const mp_obj_type_t timeseries_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_TimeSeries,
+    .make_new = timeseries_make_new,
+    .unary_op = timeseries_unary_op,
+    .locals_dict = (void *)&timeseries_locals_dict,
+};
+
+STATIC const mp_rom_map_elem_t mp_module_utimeseries_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_utimeseries) },
+    { MP_ROM_QSTR(MP_QSTR_TimeSeries), MP_ROM_PTR(&timeseries_type) },
+};
+STATIC MP_DEFINE_CONST_DICT(mp_module_utimeseries_globals, mp_module_utimeseries_globals_table);
+
+const mp_obj_module_t mp_module_utimeseries = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t *)&mp_module_utimeseries_globals,
+};
+
+#endif // MICROPY_PY_UTIMESERIES
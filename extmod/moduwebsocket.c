@@ -47,14 +47,28 @@ typedef struct _mp_obj_websocket_t {
     byte to_recv;
     byte mask_pos;
     byte buf_pos;
-    byte buf[6];
+    byte buf[12];
     byte opts;
     // Copy of last data frame flags
     byte ws_flags;
     // Copy of current frame flags
     byte last_flags;
+    // Payload bytes already stored by an interrupted readframe() call
+    size_t frame_pos;
 } mp_obj_websocket_t;
 
+// Payloads up to this size are sent in the same underlying write as
+// their frame header.
+#define WEBSOCKET_TX_COALESCE_SIZE (128)
+
+// Masking is done a machine word at a time; the word size must be a
+// multiple of the 4-byte mask so the mask pattern repeats within a word.
+#if MP_SSIZE_MAX > 0x7fffffff
+typedef uint64_t websocket_mask_word_t;
+#else
+typedef uint32_t websocket_mask_word_t;
+#endif
+
 STATIC mp_uint_t websocket_write(mp_obj_t self_in, const void *buf, mp_uint_t size, int *errcode);
 
 STATIC mp_obj_t websocket_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
@@ -67,6 +81,7 @@ STATIC mp_obj_t websocket_make_new(const mp_obj_type_t *type, size_t n_args, siz
     o->to_recv = 2;
     o->mask_pos = 0;
     o->buf_pos = 0;
+    o->frame_pos = 0;
     o->opts = FRAME_TXT;
     if (n_args > 1 && args[1] == mp_const_true) {
         o->opts |= BLOCKING_WRITE;
@@ -74,6 +89,31 @@ STATIC mp_obj_t websocket_make_new(const mp_obj_type_t *type, size_t n_args, siz
     return MP_OBJ_FROM_PTR(o);
 }
 
+// XOR buf with the 4-byte mask, starting at mask offset *pos.  Words are
+// loaded and stored with memcpy, which compilers turn into plain (unaligned
+// if needed) loads and stores, so buf needs no particular alignment.
+STATIC void websocket_mask(byte *buf, size_t len, const byte mask[4], byte *pos) {
+    byte p = *pos;
+    if (len >= sizeof(websocket_mask_word_t)) {
+        websocket_mask_word_t w;
+        byte *wb = (byte *)&w;
+        for (size_t i = 0; i < sizeof(w); ++i) {
+            wb[i] = mask[(p + i) & 3];
+        }
+        for (; len >= sizeof(w); len -= sizeof(w)) {
+            websocket_mask_word_t x;
+            memcpy(&x, buf, sizeof(x));
+            x ^= w;
+            memcpy(buf, &x, sizeof(x));
+            buf += sizeof(x);
+        }
+    }
+    while (len-- != 0) {
+        *buf++ ^= mask[p++ & 3];
+    }
+    *pos = p;
+}
+
 STATIC mp_uint_t websocket_read(mp_obj_t self_in, void *buf, mp_uint_t size, int *errcode) {
     mp_obj_websocket_t *self = MP_OBJ_TO_PTR(self_in);
     const mp_stream_p_t *stream_p = mp_get_stream(self->sock);
@@ -121,7 +161,7 @@ STATIC mp_uint_t websocket_read(mp_obj_t self_in, void *buf, mp_uint_t size, int
                     to_recv += 2;
                 } else if (sz == 127) {
                     // Msg size is next 8 bytes
-                    assert(0);
+                    to_recv += 8;
                 }
                 if (self->buf[1] & 0x80) {
                     // Next 4 bytes is mask
@@ -144,13 +184,24 @@ STATIC mp_uint_t websocket_read(mp_obj_t self_in, void *buf, mp_uint_t size, int
             }
 
             case FRAME_OPT: {
-                if ((self->buf_pos & 3) == 2) {
+                size_t len_sz = 0;
+                if (self->msg_sz == 126) {
                     // First two bytes are message length
                     self->msg_sz = (self->buf[0] << 8) | self->buf[1];
+                    len_sz = 2;
+                } else if (self->msg_sz == 127) {
+                    // First eight bytes are message length, only 32 bits supported
+                    if (self->buf[0] | self->buf[1] | self->buf[2] | self->buf[3]) {
+                        *errcode = MP_EFBIG;
+                        return MP_STREAM_ERROR;
+                    }
+                    self->msg_sz = (uint32_t)self->buf[4] << 24 | (uint32_t)self->buf[5] << 16
+                        | (uint32_t)self->buf[6] << 8 | self->buf[7];
+                    len_sz = 8;
                 }
-                if (self->buf_pos >= 4) {
+                if (self->buf_pos > len_sz) {
                     // Last 4 bytes is mask
-                    memcpy(self->mask, self->buf + self->buf_pos - 4, 4);
+                    memcpy(self->mask, self->buf + len_sz, 4);
                 }
                 self->buf_pos = 0;
                 if ((self->last_flags & FRAME_OPCODE_MASK) >= FRAME_CLOSE) {
@@ -169,15 +220,34 @@ STATIC mp_uint_t websocket_read(mp_obj_t self_in, void *buf, mp_uint_t size, int
                     goto no_payload;
                 }
 
+                if (self->state == CONTROL) {
+                    // Control frame payloads are consumed here rather than
+                    // being handed to the caller as data.
+                    size_t sz = MIN(sizeof(self->buf), self->msg_sz);
+                    mp_uint_t ctrl_sz = stream_p->read(self->sock, self->buf, sz, errcode);
+                    if (ctrl_sz == 0 || ctrl_sz == MP_STREAM_ERROR) {
+                        return ctrl_sz;
+                    }
+                    self->msg_sz -= ctrl_sz;
+                    if (self->msg_sz != 0) {
+                        continue;
+                    }
+                    goto no_payload;
+                }
+
+                if (size == 0) {
+                    // Caller only wants the header parsed (see readframe)
+                    return 0;
+                }
+
                 size_t sz = MIN(size, self->msg_sz);
                 out_sz = stream_p->read(self->sock, buf, sz, errcode);
                 if (out_sz == 0 || out_sz == MP_STREAM_ERROR) {
                     return out_sz;
                 }
 
-                sz = out_sz;
-                for (byte *p = buf; sz--; p++) {
-                    *p ^= self->mask[self->mask_pos++ & 3];
+                if (self->mask[0] | self->mask[1] | self->mask[2] | self->mask[3]) {
+                    websocket_mask(buf, out_sz, self->mask, &self->mask_pos);
                 }
 
                 self->msg_sz -= out_sz;
@@ -218,17 +288,24 @@ STATIC mp_uint_t websocket_read(mp_obj_t self_in, void *buf, mp_uint_t size, int
 
 STATIC mp_uint_t websocket_write(mp_obj_t self_in, const void *buf, mp_uint_t size, int *errcode) {
     mp_obj_websocket_t *self = MP_OBJ_TO_PTR(self_in);
-    assert(size < 0x10000);
-    byte header[4] = {0x80 | (self->opts & FRAME_OPCODE_MASK)};
-    int hdr_sz;
+    byte header[10 + WEBSOCKET_TX_COALESCE_SIZE] = {0x80 | (self->opts & FRAME_OPCODE_MASK)};
+    size_t hdr_sz;
     if (size < 126) {
         header[1] = size;
         hdr_sz = 2;
-    } else {
+    } else if (size < 0x10000) {
         header[1] = 126;
         header[2] = size >> 8;
         header[3] = size & 0xff;
         hdr_sz = 4;
+    } else {
+        header[1] = 127;
+        uint64_t sz64 = size;
+        for (int i = 9; i >= 2; --i) {
+            header[i] = sz64 & 0xff;
+            sz64 >>= 8;
+        }
+        hdr_sz = 10;
     }
 
     mp_obj_t dest[3];
@@ -238,9 +315,23 @@ STATIC mp_uint_t websocket_write(mp_obj_t self_in, const void *buf, mp_uint_t si
         mp_call_method_n_kw(1, 0, dest);
     }
 
-    mp_uint_t out_sz = mp_stream_write_exactly(self->sock, header, hdr_sz, errcode);
-    if (*errcode == 0) {
-        out_sz = mp_stream_write_exactly(self->sock, buf, size, errcode);
+    mp_uint_t out_sz;
+    if (size <= WEBSOCKET_TX_COALESCE_SIZE) {
+        // Small frame: send header and payload with a single write
+        memcpy(header + hdr_sz, buf, size);
+        mp_uint_t written = mp_stream_write_exactly(self->sock, header, hdr_sz + size, errcode);
+        if (*errcode != 0) {
+            out_sz = MP_STREAM_ERROR;
+        } else {
+            // A short write (eg EAGAIN after some bytes) counts only the
+            // payload bytes sent, as for the separate writes below.
+            out_sz = written > hdr_sz ? written - hdr_sz : 0;
+        }
+    } else {
+        out_sz = mp_stream_write_exactly(self->sock, header, hdr_sz, errcode);
+        if (*errcode == 0) {
+            out_sz = mp_stream_write_exactly(self->sock, buf, size, errcode);
+        }
     }
 
     if (self->opts & BLOCKING_WRITE) {
@@ -254,6 +345,54 @@ STATIC mp_uint_t websocket_write(mp_obj_t self_in, const void *buf, mp_uint_t si
     return out_sz;
 }
 
+// readframe(buf): read the whole payload of the next data frame into buf and
+// return its length.  Returns None if the stream is non-blocking and the frame
+// is not complete yet; the next call must pass the same buffer to continue.
+STATIC mp_obj_t websocket_readframe(mp_obj_t self_in, mp_obj_t buf_in) {
+    mp_obj_websocket_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    int errcode;
+
+    if (self->state != PAYLOAD) {
+        self->frame_pos = 0;
+        mp_uint_t out_sz = websocket_read(self_in, NULL, 0, &errcode);
+        if (out_sz == MP_STREAM_ERROR) {
+            goto error;
+        }
+        if (self->state != PAYLOAD) {
+            // EOF or close frame
+            return MP_OBJ_NEW_SMALL_INT(0);
+        }
+    }
+
+    if (self->frame_pos + self->msg_sz > bufinfo.len) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer too small"));
+    }
+
+    while (self->state == PAYLOAD) {
+        mp_uint_t out_sz = websocket_read(self_in, (byte *)bufinfo.buf + self->frame_pos, self->msg_sz, &errcode);
+        if (out_sz == MP_STREAM_ERROR) {
+            goto error;
+        }
+        if (out_sz == 0) {
+            return MP_OBJ_NEW_SMALL_INT(0);
+        }
+        self->frame_pos += out_sz;
+    }
+
+    size_t len = self->frame_pos;
+    self->frame_pos = 0;
+    return MP_OBJ_NEW_SMALL_INT(len);
+
+error:
+    if (mp_is_nonblocking_error(errcode)) {
+        return mp_const_none;
+    }
+    mp_raise_OSError(errcode);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(websocket_readframe_obj, websocket_readframe);
+
 STATIC mp_uint_t websocket_ioctl(mp_obj_t self_in, mp_uint_t request, uintptr_t arg, int *errcode) {
     mp_obj_websocket_t *self = MP_OBJ_TO_PTR(self_in);
     switch (request) {
@@ -279,6 +418,7 @@ STATIC const mp_rom_map_elem_t websocket_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_read), MP_ROM_PTR(&mp_stream_read_obj) },
     { MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&mp_stream_readinto_obj) },
     { MP_ROM_QSTR(MP_QSTR_readline), MP_ROM_PTR(&mp_stream_unbuffered_readline_obj) },
+    { MP_ROM_QSTR(MP_QSTR_readframe), MP_ROM_PTR(&websocket_readframe_obj) },
     { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
     { MP_ROM_QSTR(MP_QSTR_ioctl), MP_ROM_PTR(&mp_stream_ioctl_obj) },
     { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mp_stream_close_obj) },
@@ -33,6 +33,8 @@
 
 #if MICROPY_PY_UZLIB
 
+#define UZLIB_CONF_CRC32_SLICE8 (MICROPY_OPT_CRC_SLICE8)
+#define UZLIB_CONF_FAST_BITS (MICROPY_OPT_UZLIB_FAST_BITS)
 #include "uzlib/tinf.h"
 
 #if 0 // print debugging info
@@ -94,7 +96,8 @@ STATIC mp_obj_t decompio_make_new(const mp_obj_type_t *type, size_t n_args, size
         header_error:
             mp_raise_ValueError(MP_ERROR_TEXT("compression header"));
         }
-        dict_sz = 1 << dict_opt;
+        // the header gives the window size as log2 minus 8
+        dict_sz = 1 << (dict_opt + 8);
     } else {
         dict_sz = 1 << -dict_opt;
     }
@@ -186,11 +189,14 @@ STATIC mp_obj_t mod_uzlib_decompress(size_t n_args, const mp_obj_t *args) {
         if (st == TINF_DONE) {
             break;
         }
+        // grow the buffer by half its size, so large data isn't copied
+        // over and over again
         size_t offset = decomp->dest - dest_buf;
-        dest_buf = m_renew(byte, dest_buf, dest_buf_size, dest_buf_size + 256);
-        dest_buf_size += 256;
+        size_t grow = MAX(dest_buf_size / 2, 256);
+        dest_buf = m_renew(byte, dest_buf, dest_buf_size, dest_buf_size + grow);
+        dest_buf_size += grow;
         decomp->dest = dest_buf + offset;
-        decomp->dest_limit = decomp->dest + 256;
+        decomp->dest_limit = decomp->dest + grow;
     }
 
     mp_uint_t final_sz = decomp->dest - dest_buf;
@@ -205,11 +211,262 @@ error:
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_decompress_obj, 1, 3, mod_uzlib_decompress);
 
+#if MICROPY_PY_UZLIB_COMPRESS
+
+// Compression, using LZ77 with a window of 2**wbits bytes and static
+// Huffman codes.  The same object implements compressobj(), which collects
+// the output in a vstr, and CompIO, which writes it to a stream.
+
+// Size of the buffer that compressed data is written to before being
+// passed on to the vstr or stream.
+#define UZLIB_COMP_OUTBUF_SIZE (128)
+
+enum {
+    UZLIB_FORMAT_RAW,
+    UZLIB_FORMAT_ZLIB,
+    UZLIB_FORMAT_GZIP,
+};
+
+typedef struct _mp_obj_compio_t {
+    mp_obj_base_t base;
+    mp_obj_t dest_stream; // MP_OBJ_NULL to collect the output in vstr
+    vstr_t vstr;
+    struct uzlib_comp comp;
+    uint32_t checksum;
+    uint32_t in_len;
+    byte format;
+    bool finished;
+    byte outbuf[UZLIB_COMP_OUTBUF_SIZE];
+} mp_obj_compio_t;
+
+STATIC void compio_out(mp_obj_compio_t *o, const byte *buf, size_t len) {
+    if (o->dest_stream != MP_OBJ_NULL) {
+        mp_stream_write(o->dest_stream, buf, len, MP_STREAM_RW_WRITE);
+    } else {
+        vstr_add_strn(&o->vstr, (const char *)buf, len);
+    }
+}
+
+STATIC void compio_drain(mp_obj_compio_t *o) {
+    if (o->comp.out.outlen != 0) {
+        compio_out(o, o->outbuf, o->comp.out.outlen);
+        o->comp.out.outlen = 0;
+    }
+}
+
+// wbits is interpreted as for decompress: 9 to 15 for zlib format, 25 to 31
+// (16 + 9 to 15) for gzip format, and -9 to -15 for raw deflate data.
+STATIC mp_obj_compio_t *compio_new(const mp_obj_type_t *type, mp_obj_t dest_stream, size_t n_args, const mp_obj_t *args) {
+    mp_int_t wbits = n_args > 0 ? mp_obj_get_int(args[0]) : 10;
+    byte format = UZLIB_FORMAT_ZLIB;
+    if (wbits >= 16) {
+        format = UZLIB_FORMAT_GZIP;
+        wbits -= 16;
+    } else if (wbits < 0) {
+        format = UZLIB_FORMAT_RAW;
+        wbits = -wbits;
+    }
+    if (wbits < 9 || wbits > 15) {
+        mp_raise_ValueError(MP_ERROR_TEXT("wbits"));
+    }
+
+    mp_obj_compio_t *o = m_new_obj(mp_obj_compio_t);
+    o->base.type = type;
+    o->dest_stream = dest_stream;
+    if (dest_stream == MP_OBJ_NULL) {
+        vstr_init(&o->vstr, 16);
+    }
+    o->comp.dict_size = 1 << wbits;
+    o->comp.hash_bits = MIN(wbits - 1, 13);
+    o->comp.window = m_new(uint8_t, 2 << wbits);
+    o->comp.hash_table = m_new(uint16_t, 1 << o->comp.hash_bits);
+    o->comp.hash_chain = m_new(uint16_t, 1 << wbits);
+    uzlib_compress_init(&o->comp, o->outbuf, sizeof(o->outbuf));
+    o->in_len = 0;
+    o->format = format;
+    o->finished = false;
+
+    if (format == UZLIB_FORMAT_ZLIB) {
+        byte header[2] = {(wbits - 8) << 4 | 8, 0};
+        header[1] = 31 - (header[0] << 8) % 31;
+        o->checksum = 1;
+        compio_out(o, header, sizeof(header));
+    } else if (format == UZLIB_FORMAT_GZIP) {
+        // no file name or modification time, unknown OS
+        static const byte header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff};
+        o->checksum = 0xffffffff;
+        compio_out(o, header, sizeof(header));
+    }
+    return o;
+}
+
+STATIC void compio_input(mp_obj_compio_t *o, const byte *buf, size_t len) {
+    if (o->finished) {
+        mp_raise_ValueError(MP_ERROR_TEXT("compression finished"));
+    }
+    if (o->format == UZLIB_FORMAT_ZLIB) {
+        o->checksum = uzlib_adler32(buf, len, o->checksum);
+    } else if (o->format == UZLIB_FORMAT_GZIP) {
+        o->checksum = uzlib_crc32(buf, len, o->checksum);
+    }
+    o->in_len += len;
+    while (len > 0) {
+        unsigned int n = uzlib_compress_put(&o->comp, buf, len);
+        buf += n;
+        len -= n;
+        while (uzlib_compress_run(&o->comp, 0)) {
+            compio_drain(o);
+        }
+    }
+}
+
+// Compress all pending input, then either make the output so far decodable
+// or, if finish is true, end the compressed data.
+STATIC void compio_flush(mp_obj_compio_t *o, bool finish) {
+    if (o->finished) {
+        return;
+    }
+    while (uzlib_compress_run(&o->comp, 1)) {
+        compio_drain(o);
+    }
+    compio_drain(o);
+    if (!finish) {
+        uzlib_compress_sync(&o->comp);
+        compio_drain(o);
+        return;
+    }
+    uzlib_compress_finish(&o->comp);
+    compio_drain(o);
+    o->finished = true;
+    if (o->format == UZLIB_FORMAT_ZLIB) {
+        uint32_t sum = o->checksum;
+        byte trailer[4] = {sum >> 24, sum >> 16, sum >> 8, sum};
+        compio_out(o, trailer, sizeof(trailer));
+    } else if (o->format == UZLIB_FORMAT_GZIP) {
+        uint32_t crc = ~o->checksum;
+        uint32_t len = o->in_len;
+        byte trailer[8] = {crc, crc >> 8, crc >> 16, crc >> 24, len, len >> 8, len >> 16, len >> 24};
+        compio_out(o, trailer, sizeof(trailer));
+    }
+}
+
+// Return the output collected so far as bytes.
+STATIC mp_obj_t compio_take_output(mp_obj_compio_t *o) {
+    mp_obj_t res = mp_obj_new_bytes((const byte *)o->vstr.buf, o->vstr.len);
+    o->vstr.len = 0;
+    return res;
+}
+
+STATIC mp_obj_t compobj_compress(mp_obj_t self_in, mp_obj_t data) {
+    mp_obj_compio_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
+    compio_input(self, bufinfo.buf, bufinfo.len);
+    return compio_take_output(self);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(compobj_compress_obj, compobj_compress);
+
+STATIC mp_obj_t compobj_flush(mp_obj_t self_in) {
+    mp_obj_compio_t *self = MP_OBJ_TO_PTR(self_in);
+    compio_flush(self, true);
+    return compio_take_output(self);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(compobj_flush_obj, compobj_flush);
+
+STATIC const mp_rom_map_elem_t compobj_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_compress), MP_ROM_PTR(&compobj_compress_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&compobj_flush_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(compobj_locals_dict, compobj_locals_dict_table);
+
+STATIC const mp_obj_type_t compobj_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_Compress,
+    .locals_dict = (void *)&compobj_locals_dict,
+};
+
+STATIC mp_obj_t mod_uzlib_compressobj(size_t n_args, const mp_obj_t *args) {
+    return MP_OBJ_FROM_PTR(compio_new(&compobj_type, MP_OBJ_NULL, n_args, args));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_compressobj_obj, 0, 1, mod_uzlib_compressobj);
+
+STATIC mp_obj_t mod_uzlib_compress(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(args[0], &bufinfo, MP_BUFFER_READ);
+    mp_obj_compio_t *o = compio_new(&compobj_type, MP_OBJ_NULL, n_args - 1, args + 1);
+    compio_input(o, bufinfo.buf, bufinfo.len);
+    compio_flush(o, true);
+    return mp_obj_new_str_from_vstr(&mp_type_bytes, &o->vstr);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mod_uzlib_compress_obj, 1, 2, mod_uzlib_compress);
+
+STATIC mp_obj_t compio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+    mp_get_stream_raise(args[0], MP_STREAM_OP_WRITE);
+    return MP_OBJ_FROM_PTR(compio_new(type, args[0], n_args - 1, args + 1));
+}
+
+STATIC mp_uint_t compio_write(mp_obj_t self_in, const void *buf, mp_uint_t size, int *errcode) {
+    mp_obj_compio_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->finished) {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+    compio_input(self, buf, size);
+    return size;
+}
+
+STATIC mp_uint_t compio_ioctl(mp_obj_t self_in, mp_uint_t request, uintptr_t arg, int *errcode) {
+    mp_obj_compio_t *self = MP_OBJ_TO_PTR(self_in);
+    if (request == MP_STREAM_FLUSH || request == MP_STREAM_CLOSE) {
+        // the output stream is flushed but not closed
+        compio_flush(self, request == MP_STREAM_CLOSE);
+        const mp_stream_p_t *stream_p = mp_get_stream(self->dest_stream);
+        if (stream_p->ioctl != NULL) {
+            int err;
+            stream_p->ioctl(self->dest_stream, MP_STREAM_FLUSH, 0, &err);
+        }
+        return 0;
+    } else {
+        *errcode = MP_EINVAL;
+        return MP_STREAM_ERROR;
+    }
+}
+
+STATIC const mp_rom_map_elem_t compio_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&mp_stream_write_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&mp_stream_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mp_stream_close_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(compio_locals_dict, compio_locals_dict_table);
+
+STATIC const mp_stream_p_t compio_stream_p = {
+    .write = compio_write,
+    .ioctl = compio_ioctl,
+};
+
+STATIC const mp_obj_type_t compio_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_CompIO,
+    .make_new = compio_make_new,
+    .protocol = &compio_stream_p,
+    .locals_dict = (void *)&compio_locals_dict,
+};
+
+#endif // MICROPY_PY_UZLIB_COMPRESS
+
 #if !MICROPY_ENABLE_DYNRUNTIME
 STATIC const mp_rom_map_elem_t mp_module_uzlib_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_uzlib) },
     { MP_ROM_QSTR(MP_QSTR_decompress), MP_ROM_PTR(&mod_uzlib_decompress_obj) },
     { MP_ROM_QSTR(MP_QSTR_DecompIO), MP_ROM_PTR(&decompio_type) },
+    #if MICROPY_PY_UZLIB_COMPRESS
+    { MP_ROM_QSTR(MP_QSTR_compress), MP_ROM_PTR(&mod_uzlib_compress_obj) },
+    { MP_ROM_QSTR(MP_QSTR_compressobj), MP_ROM_PTR(&mod_uzlib_compressobj_obj) },
+    { MP_ROM_QSTR(MP_QSTR_CompIO), MP_ROM_PTR(&compio_type) },
+    #endif
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_module_uzlib_globals, mp_module_uzlib_globals_table);
@@ -228,5 +485,9 @@ const mp_obj_module_t mp_module_uzlib = {
 #include "uzlib/tinfgzip.c"
 #include "uzlib/adler32.c"
 #include "uzlib/crc32.c"
+#if MICROPY_PY_UZLIB_COMPRESS
+#include "uzlib/defl_static.c"
+#include "uzlib/lz77.c"
+#endif
 
 #endif // MICROPY_PY_UZLIB
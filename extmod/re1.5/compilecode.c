@@ -216,6 +216,8 @@ int re1_5_compilecode(ByteProg *prog, const char *re)
     prog->insts[prog->bytelen++] = Match;
     prog->len++;
 
+    re1_5_prefilter(prog);
+
     return 0;
 }
 
@@ -0,0 +1,221 @@
+// Copyright 2007-2009 Russ Cox.  All Rights Reserved.
+// Copyright 2026 agent.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re1.5.h"
+
+// Pike VM: runs all alternatives of the program in lock step over the
+// subject, one thread per distinct instruction, so the time taken is
+// proportional to the length of the subject times the length of the program,
+// and the C stack used is bounded by the length of the program.  Threads are
+// kept in priority order, so the match found is the same one the
+// backtracking matcher would find.
+
+typedef struct {
+    int n;
+    int *pc;
+    const char **caps;
+} ThreadList;
+
+typedef struct {
+    ByteProg *prog;
+    Subject *input;
+    int nsubp;
+    unsigned short gen;
+    unsigned short *mark;
+} PikeVM;
+
+// Programs needing at most this much state don't allocate any.
+#ifndef RE1_5_PIKEVM_STACK_SIZE
+#define RE1_5_PIKEVM_STACK_SIZE 256
+#endif
+
+// Start a new generation of instruction marks, for a new thread list.  This
+// is only done when the list is empty, so when the generation counter wraps
+// around the marks can simply be cleared.
+static void
+nextgen(PikeVM *vm)
+{
+    if (++vm->gen == 0) {
+        memset(vm->mark, 0, vm->prog->bytelen * sizeof(*vm->mark));
+        vm->gen = 1;
+    }
+}
+
+// Follow the program from pc, without consuming input, and add a thread to l
+// for each instruction reached which consumes input or matches.
+static void
+addthread(PikeVM *vm, ThreadList *l, int pc, const char *sp, const char **caps)
+{
+    const char *code = vm->prog->insts;
+    const char *old;
+    int off;
+
+    re1_5_stack_chk();
+
+    for (;;) {
+        if (vm->mark[pc] == vm->gen)
+            return;
+        vm->mark[pc] = vm->gen;
+        switch (code[pc]) {
+        case Jmp:
+            pc += 2 + (signed char)code[pc + 1];
+            continue;
+        case Split:
+            addthread(vm, l, pc + 2, sp, caps);
+            pc += 2 + (signed char)code[pc + 1];
+            continue;
+        case RSplit:
+            addthread(vm, l, pc + 2 + (signed char)code[pc + 1], sp, caps);
+            pc += 2;
+            continue;
+        case Save:
+            off = (unsigned char)code[pc + 1];
+            if (off >= vm->nsubp) {
+                pc += 2;
+                continue;
+            }
+            old = caps[off];
+            caps[off] = sp;
+            addthread(vm, l, pc + 2, sp, caps);
+            caps[off] = old;
+            return;
+        case Bol:
+            if (sp != vm->input->bol)
+                return;
+            pc++;
+            continue;
+        case Eol:
+            if (sp != vm->input->end)
+                return;
+            pc++;
+            continue;
+        default:
+            l->pc[l->n] = pc;
+            memcpy(l->caps + l->n * vm->nsubp, caps, vm->nsubp * sizeof(*caps));
+            l->n++;
+            return;
+        }
+    }
+}
+
+int
+re1_5_pikevm(ByteProg *prog, Subject *input, const char **subp, int nsubp, int is_anchored)
+{
+    const char *code = prog->insts;
+    const char *sp = input->begin;
+    int start = NON_ANCHORED_PREFIX;
+    int matched = 0;
+    int i, pc;
+
+    if (prog->litlen > 0) {
+        const char *lit = re1_5_findlit(prog, sp, re1_5_litend(prog, input, is_anchored));
+        if (lit == nil)
+            return 0;
+        if (prog->litpc == NON_ANCHORED_PREFIX)
+            sp = lit;
+    }
+
+    // A list has at most one thread for each instruction which consumes
+    // input or matches.
+    size_t nthread = 0;
+    for (pc = start; pc < prog->bytelen; pc += re1_5_insnsize(code + pc)) {
+        nthread += inst_is_consumer(code[pc]) || code[pc] == Match;
+    }
+
+    // All state comes from one block of memory: the captures of the threads
+    // in the two lists, the captures of the thread being added, the pcs of
+    // the threads in the two lists, then the instruction marks.
+    size_t size = (2 * nthread + 1) * nsubp * sizeof(const char*)
+        + 2 * nthread * sizeof(int)
+        + prog->bytelen * sizeof(unsigned short);
+    void *stackmem[RE1_5_PIKEVM_STACK_SIZE / sizeof(void*)];
+    char *mem = size <= sizeof(stackmem) ? (char*)stackmem : re1_5_alloc(size);
+    ThreadList lists[2];
+    ThreadList *clist = &lists[0], *nlist = &lists[1], *t;
+    char *p = mem;
+    for (i = 0; i < 2; i++) {
+        lists[i].n = 0;
+        lists[i].caps = (const char**)p;
+        p += nthread * nsubp * sizeof(const char*);
+    }
+    const char **caps = (const char**)p;
+    p += nsubp * sizeof(const char*);
+    for (i = 0; i < 2; i++) {
+        lists[i].pc = (int*)p;
+        p += nthread * sizeof(int);
+    }
+    PikeVM vm = { prog, input, nsubp, 1, (unsigned short*)p };
+    memset(vm.mark, 0, prog->bytelen * sizeof(unsigned short));
+
+    for (;;) {
+        if (!matched && (!is_anchored || sp == input->begin)) {
+            // Start a new thread at this position, with the lowest priority
+            // so that matches starting earlier are preferred.  If there are
+            // no other threads then skip straight to where the literal prefix
+            // occurs, if there is one.
+            if (clist->n == 0 && prog->litpc == NON_ANCHORED_PREFIX && prog->litlen > 0) {
+                sp = re1_5_findlit(prog, sp, input->end);
+                if (sp == nil)
+                    break;
+                nextgen(&vm);
+            }
+            memset((char*)caps, 0, nsubp * sizeof(*caps));
+            addthread(&vm, clist, start, sp, caps);
+        }
+        if (clist->n == 0 && (matched || is_anchored))
+            break;
+
+        nextgen(&vm);
+        for (i = 0; i < clist->n; i++) {
+            const char **tcaps = clist->caps + i * nsubp;
+            pc = clist->pc[i];
+            if (code[pc] == Match) {
+                if (sp == input->noempty)
+                    continue;
+                memcpy(subp, tcaps, nsubp * sizeof(*subp));
+                matched = 1;
+                // Threads after this one have lower priority, so drop them.
+                break;
+            }
+            if (sp >= input->end)
+                continue;
+            switch (code[pc]) {
+            case Char:
+                if (*sp != code[pc + 1])
+                    continue;
+                pc += 2;
+                break;
+            case Any:
+                pc += 1;
+                break;
+            case Class:
+            case ClassNot:
+                if (!_re1_5_classmatch(code + pc + 1, sp))
+                    continue;
+                pc += 2 + *(unsigned char*)(code + pc + 1) * 2;
+                break;
+            case NamedClass:
+                if (!_re1_5_namedclassmatch(code + pc + 1, sp))
+                    continue;
+                pc += 2;
+                break;
+            default:
+                re1_5_fatal("pikevm");
+            }
+            addthread(&vm, nlist, pc, sp + 1, tcaps);
+        }
+        t = clist;
+        clist = nlist;
+        nlist = t;
+        nlist->n = 0;
+        if (sp >= input->end)
+            break;
+        sp++;
+    }
+
+    if (mem != (char*)stackmem)
+        re1_5_free(mem, size);
+    return matched;
+}
@@ -0,0 +1,119 @@
+// Copyright 2026 agent.
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file.
+
+#include "re1.5.h"
+
+// Size of the instruction at pc, in bytes.
+int re1_5_insnsize(const char *pc)
+{
+    switch (*pc) {
+    case Class:
+    case ClassNot:
+        return 2 + *(unsigned char*)(pc + 1) * 2;
+    case Any:
+    case Bol:
+    case Eol:
+    case Match:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+// Whether the instruction at p can be skipped over by a forward jump, in
+// which case some paths through the program don't execute it.  Backward
+// jumps can only repeat instructions, so every path still executes the
+// instructions they jump over at least once.
+static int insnoptional(const ByteProg *prog, int p)
+{
+    const char *code = prog->insts;
+    int pc = NON_ANCHORED_PREFIX;
+    while (pc < prog->bytelen) {
+        if (code[pc] == Jmp || code[pc] == Split || code[pc] == RSplit) {
+            int target = pc + 2 + (signed char)code[pc + 1];
+            if (pc + 2 <= p && p < target) {
+                return 1;
+            }
+        }
+        pc += re1_5_insnsize(code + pc);
+    }
+    return 0;
+}
+
+// Find a string of literal characters that every match must contain, made of
+// Char instructions (possibly with Save instructions in between) which no path
+// through the program can skip.  If there is one at the start of the program
+// then every match starts with it and it is used as the prefix; otherwise the
+// longest one is used.  Matching can then quickly skip to, or rule out,
+// positions in the subject by searching for it.
+void re1_5_prefilter(ByteProg *prog)
+{
+    const char *code = prog->insts;
+    int pc = NON_ANCHORED_PREFIX;
+    prog->litpc = 0;
+    prog->litlen = 0;
+    while (pc < prog->bytelen) {
+        int start = pc;
+        int len = 0;
+        while ((code[pc] == Char || code[pc] == Save) && !insnoptional(prog, pc)) {
+            len += code[pc] == Char;
+            pc += 2;
+        }
+        if (len > prog->litlen && (prog->litpc != NON_ANCHORED_PREFIX)) {
+            prog->litpc = start;
+            prog->litlen = len;
+        }
+        if (pc == start) {
+            pc += re1_5_insnsize(code + pc);
+        }
+    }
+}
+
+// Return the first position in [sp, end) where the literal found by
+// re1_5_prefilter occurs, or nil if it doesn't occur there.
+const char *re1_5_findlit(const ByteProg *prog, const char *sp, const char *end)
+{
+    const char *lit = prog->insts + prog->litpc;
+    while (*lit == Save) {
+        lit += 2;
+    }
+    if (end - sp < prog->litlen) {
+        return nil;
+    }
+    const char *last = end - prog->litlen;
+    while (sp <= last) {
+        sp = memchr(sp, lit[1], last - sp + 1);
+        if (sp == nil) {
+            return nil;
+        }
+        const char *pc = lit + 2;
+        const char *s = sp + 1;
+        int n = prog->litlen - 1;
+        for (; n > 0; pc += 2) {
+            if (*pc == Char) {
+                if (*s++ != pc[1]) {
+                    break;
+                }
+                n--;
+            }
+        }
+        if (n == 0) {
+            return sp;
+        }
+        sp++;
+    }
+    return nil;
+}
+
+// Return the end of the part of the subject to search for the literal before
+// matching: when the match is anchored and the literal is a prefix, it can
+// only be at the start of the subject.
+const char *re1_5_litend(const ByteProg *prog, const Subject *input, int is_anchored)
+{
+    if (is_anchored && prog->litpc == NON_ANCHORED_PREFIX
+        && input->end - input->begin > prog->litlen) {
+        return input->begin + prog->litlen;
+    }
+    return input->end;
+}
@@ -51,6 +51,10 @@ void re1_5_fatal(char*);
 #ifndef re1_5_stack_chk
 #define re1_5_stack_chk()
 #endif
+#ifndef re1_5_alloc
+#define re1_5_alloc(n) malloc(n)
+#define re1_5_free(p, n) free(p)
+#endif
 void *mal(int);
 
 struct Prog
@@ -64,6 +68,8 @@ struct ByteProg
 	int bytelen;
 	int len;
 	int sub;
+	int litpc;	// start of a literal every match contains (see prefilter.c)
+	int litlen;	// number of chars in it, or 0 if there is none
 	char insts[0];
 };
 
@@ -130,8 +136,10 @@ Sub *update(Sub*, int, const char*);
 void decref(Sub*);
 
 struct Subject {
-	const char *begin;
+	const char *begin;	// where matching starts
 	const char *end;
+	const char *bol;	// where ^ matches
+	const char *noempty;	// if not nil, a match may not end here
 };
 
 
@@ -146,6 +154,10 @@ int re1_5_thompsonvm(ByteProg*, Subject*, const char**, int, int);
 
 int re1_5_sizecode(const char *re);
 int re1_5_compilecode(ByteProg *prog, const char *re);
+int re1_5_insnsize(const char *pc);
+void re1_5_prefilter(ByteProg *prog);
+const char *re1_5_findlit(const ByteProg *prog, const char *sp, const char *end);
+const char *re1_5_litend(const ByteProg *prog, const Subject *input, int is_anchored);
 void re1_5_dumpcode(ByteProg *prog);
 void cleanmarks(ByteProg *prog);
 int _re1_5_classmatch(const char *pc, const char *sp);
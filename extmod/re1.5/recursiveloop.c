@@ -40,6 +40,8 @@ recursiveloop(char *pc, const char *sp, Subject *input, const char **subp, int n
 			sp++;
 			continue;
 		case Match:
+			if(sp == input->noempty)
+				return 0;
 			return 1;
 		case Jmp:
 			off = (signed char)*pc++;
@@ -68,7 +70,7 @@ recursiveloop(char *pc, const char *sp, Subject *input, const char **subp, int n
 			subp[off] = old;
 			return 0;
 		case Bol:
-			if(sp != input->begin)
+			if(sp != input->bol)
 				return 0;
 			continue;
 		case Eol:
@@ -83,5 +85,20 @@ recursiveloop(char *pc, const char *sp, Subject *input, const char **subp, int n
 int
 re1_5_recursiveloopprog(ByteProg *prog, Subject *input, const char **subp, int nsubp, int is_anchored)
 {
+	const char *sp;
+
+	if(prog->litlen > 0) {
+		sp = re1_5_findlit(prog, input->begin, re1_5_litend(prog, input, is_anchored));
+		if(sp == nil)
+			return 0;
+		if(!is_anchored && prog->litpc == NON_ANCHORED_PREFIX) {
+			// Only try to match where the literal prefix occurs.
+			do {
+				if(recursiveloop(HANDLE_ANCHORED(prog->insts, 1), sp, input, subp, nsubp))
+					return 1;
+			} while((sp = re1_5_findlit(prog, sp + 1, input->end)) != nil);
+			return 0;
+		}
+	}
 	return recursiveloop(HANDLE_ANCHORED(prog->insts, is_anchored), input->begin, input, subp, nsubp);
 }
@@ -0,0 +1,79 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/mperrno.h"
+#include "extmod/socket_stats.h"
+
+#if MICROPY_PY_USOCKET_STATS
+
+// Aggregate over all sockets of the port.
+mp_socket_stats_t mp_socket_stats_global;
+
+STATIC void socket_stats_update(mp_socket_stats_t *stats, int dir, mp_int_t len, int err, mp_uint_t dt) {
+    stats->calls[dir] += 1;
+    if (len > 0) {
+        stats->bytes[dir] += len;
+    } else if (len < 0 && (err == MP_EAGAIN || err == MP_EWOULDBLOCK)) {
+        stats->would_block += 1;
+    }
+    stats->blocked_us += dt;
+}
+
+void mp_socket_stats_record(mp_socket_stats_t *stats, int dir, mp_int_t len, int err, bool timed, mp_uint_t t0) {
+    mp_uint_t dt = 0;
+    if (timed) {
+        dt = mp_hal_ticks_us() - t0;
+    }
+    socket_stats_update(stats, dir, len, err, dt);
+    socket_stats_update(&mp_socket_stats_global, dir, len, err, dt);
+}
+
+// Return the counters as a tuple and optionally reset them; args are the
+// arguments of the Python-level stats([reset]) call, excluding self.
+mp_obj_t mp_socket_stats_get(mp_socket_stats_t *stats, size_t n_args, const mp_obj_t *args) {
+    mp_obj_t tuple[6] = {
+        mp_obj_new_int_from_ull(stats->bytes[MP_SOCKET_STATS_IN]),
+        mp_obj_new_int_from_ull(stats->bytes[MP_SOCKET_STATS_OUT]),
+        mp_obj_new_int_from_uint(stats->calls[MP_SOCKET_STATS_IN]),
+        mp_obj_new_int_from_uint(stats->calls[MP_SOCKET_STATS_OUT]),
+        mp_obj_new_int_from_uint(stats->would_block),
+        mp_obj_new_int_from_ull(stats->blocked_us),
+    };
+    if (n_args > 0 && mp_obj_is_true(args[0])) {
+        memset(stats, 0, sizeof(*stats));
+    }
+    return mp_obj_new_tuple(6, tuple);
+}
+
+STATIC mp_obj_t socket_stats_global(size_t n_args, const mp_obj_t *args) {
+    return mp_socket_stats_get(&mp_socket_stats_global, n_args, args);
+}
+MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_socket_stats_global_obj, 0, 1, socket_stats_global);
+
+#endif // MICROPY_PY_USOCKET_STATS
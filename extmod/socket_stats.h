@@ -0,0 +1,74 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MICROPY_INCLUDED_EXTMOD_SOCKET_STATS_H
+#define MICROPY_INCLUDED_EXTMOD_SOCKET_STATS_H
+
+#include "py/obj.h"
+
+// Optional per-socket and global traffic counters, shared by the socket
+// implementations (eg ports/unix/modusocket.c and extmod/modlwip.c).
+// When MICROPY_PY_USOCKET_STATS is disabled the hook macros expand to nothing.
+
+#if MICROPY_PY_USOCKET_STATS
+
+#include "py/mphal.h"
+
+#define MP_SOCKET_STATS_IN (0)
+#define MP_SOCKET_STATS_OUT (1)
+
+typedef struct _mp_socket_stats_t {
+    uint64_t bytes[2];
+    mp_uint_t calls[2];
+    mp_uint_t would_block;
+    uint64_t blocked_us;
+} mp_socket_stats_t;
+
+extern mp_socket_stats_t mp_socket_stats_global;
+
+void mp_socket_stats_record(mp_socket_stats_t *stats, int dir, mp_int_t len, int err, bool timed, mp_uint_t t0);
+mp_obj_t mp_socket_stats_get(mp_socket_stats_t *stats, size_t n_args, const mp_obj_t *args);
+
+MP_DECLARE_CONST_FUN_OBJ_VAR_BETWEEN(mp_socket_stats_global_obj);
+
+// Start timing an operation; only blocking operations are timed so that
+// non-blocking sockets don't pay for reading the clock.
+#define MP_SOCKET_STATS_START(blocking) \
+    bool socket_stats_timed = (blocking); \
+    mp_uint_t socket_stats_t0 = socket_stats_timed ? mp_hal_ticks_us() : 0
+
+// Record the outcome of an operation started with MP_SOCKET_STATS_START:
+// len is the number of bytes transferred, or negative on error with err set.
+#define MP_SOCKET_STATS_RECORD(stats, dir, len, err) \
+    mp_socket_stats_record((stats), (dir), (len), (err), socket_stats_timed, socket_stats_t0)
+
+#else
+
+#define MP_SOCKET_STATS_START(blocking)
+#define MP_SOCKET_STATS_RECORD(stats, dir, len, err)
+
+#endif // MICROPY_PY_USOCKET_STATS
+
+#endif // MICROPY_INCLUDED_EXTMOD_SOCKET_STATS_H
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) uzlib authors
+ *
+ * This software is provided 'as-is', without any express
+ * or implied warranty.  In no event will the authors be
+ * held liable for any damages arising from the use of
+ * this software.
+ *
+ * Permission is granted to anyone to use this software
+ * for any purpose, including commercial applications,
+ * and to alter it and redistribute it freely, subject to
+ * the following restrictions:
+ *
+ * 1. The origin of this software must not be
+ *    misrepresented; you must not claim that you
+ *    wrote the original software. If you use this
+ *    software in a product, an acknowledgment in
+ *    the product documentation would be appreciated
+ *    but is not required.
+ *
+ * 2. Altered source versions must be plainly marked
+ *    as such, and must not be misrepresented as
+ *    being the original software.
+ *
+ * 3. This notice may not be removed or altered from
+ *    any source distribution.
+ */
+
+/*
+ * Output of deflate blocks using the static (fixed) Huffman codes of
+ * RFC 1951 section 3.2.6.  Bits are accumulated in outbits and written
+ * least significant first to outbuf, which the caller must make sure has
+ * room for at least 8 more bytes before each call.
+ */
+
+#include "uzlib.h"
+
+/* base lengths for length codes 257..285 */
+static const unsigned short defl_length_base[29] = {
+   3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+/* base distances for distance codes 0..29 */
+static const unsigned short defl_dist_base[30] = {
+   1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+   257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+   8193, 12289, 16385, 24577
+};
+
+void outbits(struct Outbuf *out, unsigned long bits, int nbits)
+{
+   out->outbits |= bits << out->noutbits;
+   out->noutbits += nbits;
+   while (out->noutbits >= 8) {
+      out->outbuf[out->outlen++] = out->outbits & 0xff;
+      out->outbits >>= 8;
+      out->noutbits -= 8;
+   }
+}
+
+/* Huffman codes are sent most significant bit first */
+static void outcode(struct Outbuf *out, unsigned int code, int nbits)
+{
+   unsigned int rev = 0;
+   int i;
+   for (i = 0; i < nbits; i++) {
+      rev = (rev << 1) | (code & 1);
+      code >>= 1;
+   }
+   outbits(out, rev, nbits);
+}
+
+/* output a symbol of the literal/length alphabet */
+static void outsym(struct Outbuf *out, unsigned int sym)
+{
+   if (sym < 144) {
+      outcode(out, 0x30 + sym, 8);
+   } else if (sym < 256) {
+      outcode(out, 0x190 + sym - 144, 9);
+   } else if (sym < 280) {
+      outcode(out, sym - 256, 7);
+   } else {
+      outcode(out, 0xc0 + sym - 280, 8);
+   }
+}
+
+void zlib_start_block(struct Outbuf *out, int bfinal)
+{
+   /* BFINAL, then BTYPE = 01 (static Huffman codes) */
+   outbits(out, 2 | (bfinal != 0), 3);
+}
+
+void zlib_finish_block(struct Outbuf *out)
+{
+   outsym(out, 256);
+}
+
+void zlib_sync_block(struct Outbuf *out)
+{
+   /* end the block, then send an empty stored block to align to a byte */
+   zlib_finish_block(out);
+   outbits(out, 0, 3);
+   if (out->noutbits != 0) {
+      outbits(out, 0, 8 - out->noutbits);
+   }
+   outbits(out, 0, 16);
+   outbits(out, 0xffff, 16);
+}
+
+void zlib_literal(struct Outbuf *out, unsigned char c)
+{
+   outsym(out, c);
+}
+
+void zlib_match(struct Outbuf *out, int distance, int len)
+{
+   int i;
+
+   /* length, 3..258 */
+   for (i = 28; defl_length_base[i] > len; i--) {
+   }
+   outsym(out, 257 + i);
+   if (i >= 8 && i < 28) {
+      outbits(out, len - defl_length_base[i], (i - 4) / 4);
+   }
+
+   /* distance, 1..32768, with a 5-bit code */
+   for (i = 29; defl_dist_base[i] > distance; i--) {
+   }
+   outcode(out, i, 5);
+   if (i >= 4) {
+      outbits(out, distance - defl_dist_base[i], i / 2 - 1);
+   }
+}
@@ -39,7 +39,8 @@ struct Outbuf {
 };
 
 void outbits(struct Outbuf *out, unsigned long bits, int nbits);
-void zlib_start_block(struct Outbuf *ctx);
+void zlib_start_block(struct Outbuf *ctx, int bfinal);
 void zlib_finish_block(struct Outbuf *ctx);
+void zlib_sync_block(struct Outbuf *ctx);
 void zlib_literal(struct Outbuf *ectx, unsigned char c);
 void zlib_match(struct Outbuf *ectx, int distance, int len);
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) uzlib authors
+ *
+ * This software is provided 'as-is', without any express
+ * or implied warranty.  In no event will the authors be
+ * held liable for any damages arising from the use of
+ * this software.
+ *
+ * Permission is granted to anyone to use this software
+ * for any purpose, including commercial applications,
+ * and to alter it and redistribute it freely, subject to
+ * the following restrictions:
+ *
+ * 1. The origin of this software must not be
+ *    misrepresented; you must not claim that you
+ *    wrote the original software. If you use this
+ *    software in a product, an acknowledgment in
+ *    the product documentation would be appreciated
+ *    but is not required.
+ *
+ * 2. Altered source versions must be plainly marked
+ *    as such, and must not be misrepresented as
+ *    being the original software.
+ *
+ * 3. This notice may not be removed or altered from
+ *    any source distribution.
+ */
+
+/*
+ * Streaming LZ77 compressor with hash chains, producing deflate data with
+ * static Huffman codes (see defl_static.c).
+ *
+ * Input is appended to a window of 2 * dict_size bytes with
+ * uzlib_compress_put, and compressed with uzlib_compress_run.  When the
+ * window is full its older half is discarded, so memory use is fixed by
+ * dict_size, which is also the maximum match distance.  Matches are found
+ * by hashing the next 3 bytes: hash_table holds the most recent position
+ * with each hash value, and hash_chain links each position in the
+ * dictionary to the previous one with the same hash.  Positions are window
+ * offsets, with 0 meaning none (so the first byte of the window is never
+ * used as a match).
+ */
+
+#include <string.h>
+
+#include "uzlib.h"
+
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+
+/* maximum number of hash chain entries to compare at each position */
+#ifndef UZLIB_COMP_MAX_CHAIN
+#define UZLIB_COMP_MAX_CHAIN 32
+#endif
+
+static inline unsigned int lz77_hash(const struct uzlib_comp *c, const unsigned char *p)
+{
+   uint32_t v = p[0] | p[1] << 8 | (uint32_t)p[2] << 16;
+   return (v * 2654435761u) >> (32 - c->hash_bits);
+}
+
+static inline void lz77_insert(struct uzlib_comp *c, unsigned int pos)
+{
+   unsigned int h = lz77_hash(c, c->window + pos);
+   c->hash_chain[pos & (c->dict_size - 1)] = c->hash_table[h];
+   c->hash_table[h] = pos;
+}
+
+void uzlib_compress_init(struct uzlib_comp *c, unsigned char *outbuf, int outsize)
+{
+   /* window, hash_table, hash_chain, hash_bits and dict_size are set by caller */
+   memset(&c->out, 0, sizeof(c->out));
+   c->out.outbuf = outbuf;
+   c->out.outsize = outsize;
+   memset(c->hash_table, 0, sizeof(*c->hash_table) << c->hash_bits);
+   c->win_len = 0;
+   c->win_pos = 0;
+   zlib_start_block(&c->out, 0);
+}
+
+/* Discard the older half of the window, moving the newer half down. */
+static void lz77_slide(struct uzlib_comp *c)
+{
+   unsigned int n = c->dict_size;
+   unsigned int i;
+   memmove(c->window, c->window + n, n);
+   c->win_len -= n;
+   c->win_pos -= n;
+   for (i = 0; i < (1u << c->hash_bits); i++) {
+      c->hash_table[i] = c->hash_table[i] >= n ? c->hash_table[i] - n : 0;
+   }
+   for (i = 0; i < n; i++) {
+      c->hash_chain[i] = c->hash_chain[i] >= n ? c->hash_chain[i] - n : 0;
+   }
+}
+
+unsigned int uzlib_compress_put(struct uzlib_comp *c, const void *src, unsigned int len)
+{
+   unsigned int space;
+   if (c->win_len == 2 * c->dict_size) {
+      /* uzlib_compress_run has left at most MAX_MATCH - 1 bytes unprocessed */
+      lz77_slide(c);
+   }
+   space = 2 * c->dict_size - c->win_len;
+   if (len > space) {
+      len = space;
+   }
+   memcpy(c->window + c->win_len, src, len);
+   c->win_len += len;
+   return len;
+}
+
+int uzlib_compress_run(struct uzlib_comp *c, int flush)
+{
+   unsigned char *win = c->window;
+   unsigned int keep = flush ? 0 : MAX_MATCH - 1;
+
+   while (c->win_len - c->win_pos > keep) {
+      unsigned int pos = c->win_pos;
+      unsigned int avail = c->win_len - pos;
+      unsigned int best_len = 0;
+      unsigned int best_dist = 0;
+
+      if (c->out.outlen + 8 > c->out.outsize) {
+         /* output buffer is full */
+         return 1;
+      }
+
+      if (avail >= MIN_MATCH) {
+         unsigned int max_len = avail < MAX_MATCH ? avail : MAX_MATCH;
+         unsigned int limit = pos > c->dict_size ? pos - c->dict_size : 0;
+         unsigned int chain = UZLIB_COMP_MAX_CHAIN;
+         unsigned int h = lz77_hash(c, win + pos);
+         unsigned int cand = c->hash_table[h];
+         c->hash_chain[pos & (c->dict_size - 1)] = cand;
+         c->hash_table[h] = pos;
+
+         for (; cand > limit && chain > 0; chain--, cand = c->hash_chain[cand & (c->dict_size - 1)]) {
+            const unsigned char *p = win + pos;
+            const unsigned char *q = win + cand;
+            unsigned int len;
+            if (q[best_len] != p[best_len] || q[0] != p[0] || q[1] != p[1]) {
+               continue;
+            }
+            for (len = 2; len < max_len && q[len] == p[len]; len++) {
+            }
+            if (len > best_len) {
+               best_len = len;
+               best_dist = pos - cand;
+               if (len == max_len) {
+                  break;
+               }
+            }
+         }
+      }
+
+      if (best_len >= MIN_MATCH) {
+         unsigned int end = pos + best_len;
+         zlib_match(&c->out, best_dist, best_len);
+         /* add the other positions within the match to the hash chains */
+         if (end > c->win_len - (MIN_MATCH - 1)) {
+            end = c->win_len - (MIN_MATCH - 1);
+         }
+         for (pos++; pos < end; pos++) {
+            lz77_insert(c, pos);
+         }
+         c->win_pos += best_len;
+      } else {
+         zlib_literal(&c->out, win[pos]);
+         c->win_pos += 1;
+      }
+   }
+   return 0;
+}
+
+void uzlib_compress_sync(struct uzlib_comp *c)
+{
+   zlib_sync_block(&c->out);
+   zlib_start_block(&c->out, 0);
+}
+
+void uzlib_compress_finish(struct uzlib_comp *c)
+{
+   /* end the current block and add an empty final block */
+   zlib_finish_block(&c->out);
+   zlib_start_block(&c->out, 1);
+   zlib_finish_block(&c->out);
+   if (c->out.noutbits != 0) {
+      outbits(&c->out, 0, 8 - c->out.noutbits);
+   }
+}
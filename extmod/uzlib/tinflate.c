@@ -121,6 +121,34 @@ static void tinf_build_bits_base(unsigned char *bits, unsigned short *base, int
 }
 #endif
 
+#if UZLIB_CONF_FAST_BITS
+/* Build the lookup table for codes of up to UZLIB_CONF_FAST_BITS bits from
+   the code length counts and the translation table.  Codes are stored most
+   significant bit first, so the table is indexed by the reversed code, and
+   each code fills all the entries whose low bits match it.  An entry holds
+   the symbol shifted left by 4 and the code length, or 0 if the code
+   starting with those bits is longer (or not valid). */
+static void tinf_build_fast(TINF_TREE *t)
+{
+   unsigned int len, i, idx = 0, code = 0;
+
+   for (i = 0; i < TINF_ARRAY_SIZE(t->fast); ++i) t->fast[i] = 0;
+
+   for (len = 1; len <= UZLIB_CONF_FAST_BITS; ++len, code <<= 1)
+   {
+      for (i = 0; i < t->table[len]; ++i, ++code, ++idx)
+      {
+         unsigned int rev = 0, c = code, j;
+         for (j = 0; j < len; ++j, c >>= 1) rev = (rev << 1) | (c & 1);
+         for (j = rev; j < TINF_ARRAY_SIZE(t->fast); j += 1 << len)
+         {
+            t->fast[j] = t->trans[idx] << 4 | len;
+         }
+      }
+   }
+}
+#endif
+
 /* build the fixed huffman trees */
 static void tinf_build_fixed_trees(TINF_TREE *lt, TINF_TREE *dt)
 {
@@ -144,6 +172,11 @@ static void tinf_build_fixed_trees(TINF_TREE *lt, TINF_TREE *dt)
    dt->table[5] = 32;
 
    for (i = 0; i < 32; ++i) dt->trans[i] = i;
+
+   #if UZLIB_CONF_FAST_BITS
+   tinf_build_fast(lt);
+   tinf_build_fast(dt);
+   #endif
 }
 
 /* given an array of code lengths, build a tree */
@@ -183,13 +216,18 @@ static void tinf_build_tree(TINF_TREE *t, const unsigned char *lengths, unsigned
    {
       if (lengths[i]) t->trans[offs[lengths[i]]++] = i;
    }
+
+   #if UZLIB_CONF_FAST_BITS
+   tinf_build_fast(t);
+   #endif
 }
 
 /* ---------------------- *
  * -- decode functions -- *
  * ---------------------- */
 
-unsigned char uzlib_get_byte(TINF_DATA *d)
+/* read the next byte from the source, bypassing the bit buffer */
+static unsigned char tinf_read_source(TINF_DATA *d)
 {
     /* If end of source buffer is not reached, return next byte from source
        buffer. */
@@ -215,6 +253,22 @@ unsigned char uzlib_get_byte(TINF_DATA *d)
     return 0;
 }
 
+unsigned char uzlib_get_byte(TINF_DATA *d)
+{
+    /* Bytes are only read at byte boundaries of the compressed data, so
+       drop any bits left over from the last byte decoded, then return the
+       whole bytes that were read ahead into the bit buffer, if any. */
+    d->tag >>= d->bitcount & 7;
+    d->bitcount &= ~7;
+    if (d->bitcount != 0) {
+        unsigned char c = d->tag;
+        d->tag >>= 8;
+        d->bitcount -= 8;
+        return c;
+    }
+    return tinf_read_source(d);
+}
+
 uint32_t tinf_get_le_uint32(TINF_DATA *d)
 {
     uint32_t val = 0;
@@ -235,49 +289,68 @@ uint32_t tinf_get_be_uint32(TINF_DATA *d)
     return val;
 }
 
-/* get one bit from source stream */
-static int tinf_getbit(TINF_DATA *d)
-{
-   unsigned int bit;
+/* The bit buffer: tag holds bitcount bits of input, least significant
+   first, and is zero above them.  It is topped up from the source buffer
+   while there is room, so most reads of bits or symbols need no refill.
+   Only when the source buffer is empty is the read callback used, and then
+   only for as many bytes as are needed, so that the source is never read
+   past the end of the compressed data. */
 
-   /* check if tag is empty */
-   if (!d->bitcount--)
+/* top up the bit buffer from the source buffer, without using the callback */
+static inline void tinf_refill(TINF_DATA *d)
+{
+   while (d->bitcount <= 24 && d->source < d->source_limit)
    {
-      /* load next tag */
-      d->tag = uzlib_get_byte(d);
-      d->bitcount = 7;
+      d->tag |= (unsigned int)*d->source++ << d->bitcount;
+      d->bitcount += 8;
    }
-
-   /* shift bit out of tag */
-   bit = d->tag & 0x01;
-   d->tag >>= 1;
-
-   return bit;
 }
 
 /* read a num bit value from a stream and add base */
 static unsigned int tinf_read_bits(TINF_DATA *d, int num, int base)
 {
-   unsigned int val = 0;
+   unsigned int val;
 
-   /* read num bits */
-   if (num)
+   tinf_refill(d);
+   while (d->bitcount < (unsigned int)num)
    {
-      unsigned int limit = 1 << (num);
-      unsigned int mask;
-
-      for (mask = 1; mask < limit; mask *= 2)
-         if (tinf_getbit(d)) val += mask;
+      d->tag |= (unsigned int)tinf_read_source(d) << d->bitcount;
+      d->bitcount += 8;
    }
 
+   val = d->tag & ((1u << num) - 1);
+   d->tag >>= num;
+   d->bitcount -= num;
+
    return val + base;
 }
 
+/* get one bit from source stream */
+static inline int tinf_getbit(TINF_DATA *d)
+{
+   return tinf_read_bits(d, 1, 0);
+}
+
 /* given a data stream and a tree, decode a symbol */
 static int tinf_decode_symbol(TINF_DATA *d, TINF_TREE *t)
 {
    int sum = 0, cur = 0, len = 0;
 
+   #if UZLIB_CONF_FAST_BITS
+   /* Look up codes of up to UZLIB_CONF_FAST_BITS bits in one go.  The bits
+      above bitcount are zero, so a short code is still found near the end
+      of the input; it's only used if all its bits are really there. */
+   unsigned int e;
+   tinf_refill(d);
+   e = t->fast[d->tag & ((1 << UZLIB_CONF_FAST_BITS) - 1)];
+   if ((e & 15) != 0 && (e & 15) <= d->bitcount)
+   {
+      d->tag >>= e & 15;
+      d->bitcount -= e & 15;
+      return e >> 4;
+   }
+   #endif
+
    /* get more bits while code value is above sum */
    do {
 
@@ -402,13 +475,45 @@ static int tinf_decode_trees(TINF_DATA *d, TINF_TREE *lt, TINF_TREE *dt)
  * -- block inflate functions -- *
  * ----------------------------- */
 
-/* given a stream and two trees, inflate next byte of output */
+/* given a stream and two trees, inflate output until dest is full or the
+   block ends */
 static int tinf_inflate_block_data(TINF_DATA *d, TINF_TREE *lt, TINF_TREE *dt)
 {
-    if (d->curlen == 0) {
+    for (;;) {
         unsigned int offs;
         int dist;
-        int sym = tinf_decode_symbol(d, lt);
+        int sym;
+
+        /* copy as much of the current dict substring as fits */
+        if (d->curlen != 0) {
+            unsigned int n = d->curlen;
+            if (n > (unsigned int)(d->dest_limit - d->dest)) {
+                n = d->dest_limit - d->dest;
+            }
+            d->curlen -= n;
+            if (d->dict_ring) {
+                while (n--) {
+                    TINF_PUT(d, d->dict_ring[d->lzOff]);
+                    if ((unsigned)++d->lzOff == d->dict_size) {
+                        d->lzOff = 0;
+                    }
+                }
+            } else {
+                /* byte by byte, as the substring may overlap the output */
+                unsigned char *p = d->dest;
+                const unsigned char *q = p + d->lzOff;
+                d->dest += n;
+                while (n--) {
+                    *p++ = *q++;
+                }
+            }
+        }
+
+        if (d->dest >= d->dest_limit) {
+            return TINF_OK;
+        }
+
+        sym = tinf_decode_symbol(d, lt);
         //printf("huff sym: %02x\n", sym);
 
         if (d->eof) {
@@ -418,7 +523,7 @@ static int tinf_inflate_block_data(TINF_DATA *d, TINF_TREE *lt, TINF_TREE *dt)
         /* literal byte */
         if (sym < 256) {
             TINF_PUT(d, sym);
-            return TINF_OK;
+            continue;
         }
 
         /* end of block */
@@ -470,28 +575,16 @@ static int tinf_inflate_block_data(TINF_DATA *d, TINF_TREE *lt, TINF_TREE *dt)
             d->lzOff = -offs;
         }
     }
-
-    /* copy next byte from dict substring */
-    if (d->dict_ring) {
-        TINF_PUT(d, d->dict_ring[d->lzOff]);
-        if ((unsigned)++d->lzOff == d->dict_size) {
-            d->lzOff = 0;
-        }
-    } else {
-        d->dest[0] = d->dest[d->lzOff];
-        d->dest++;
-    }
-    d->curlen--;
-    return TINF_OK;
 }
 
-/* inflate next byte from uncompressed block of data */
+/* inflate output from uncompressed block of data until dest is full or the
+   block ends */
 static int tinf_inflate_uncompressed_block(TINF_DATA *d)
 {
     if (d->curlen == 0) {
         unsigned int length, invlength;
 
-        /* get length */
+        /* get length (uzlib_get_byte starts on a byte boundary) */
         length = uzlib_get_byte(d);
         length += 256 * uzlib_get_byte(d);
         /* get one's complement of length */
@@ -503,17 +596,16 @@ static int tinf_inflate_uncompressed_block(TINF_DATA *d)
         /* increment length to properly return TINF_DONE below, without
            producing data at the same time */
         d->curlen = length + 1;
-
-        /* make sure we start next block on a byte boundary */
-        d->bitcount = 0;
     }
 
-    if (--d->curlen == 0) {
-        return TINF_DONE;
-    }
+    while (d->dest < d->dest_limit) {
+        if (--d->curlen == 0) {
+            return TINF_DONE;
+        }
 
-    unsigned char c = uzlib_get_byte(d);
-    TINF_PUT(d, c);
+        unsigned char c = uzlib_get_byte(d);
+        TINF_PUT(d, c);
+    }
     return TINF_OK;
 }
 
@@ -539,6 +631,7 @@ void uzlib_init(void)
 void uzlib_uncompress_init(TINF_DATA *d, void *dict, unsigned int dictLen)
 {
    d->eof = 0;
+   d->tag = 0;
    d->bitcount = 0;
    d->bfinal = 0;
    d->btype = -1;
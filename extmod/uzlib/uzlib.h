@@ -80,6 +80,10 @@ extern "C" {
 typedef struct {
    unsigned short table[16];  /* table of code length counts */
    unsigned short trans[288]; /* code -> symbol translation table */
+   #if UZLIB_CONF_FAST_BITS
+   /* (symbol << 4 | code length) for the codes of up to FAST_BITS bits */
+   unsigned short fast[1 << UZLIB_CONF_FAST_BITS];
+   #endif
 } TINF_TREE;
 
 struct uzlib_uncomp {
@@ -143,17 +147,34 @@ int TINFCC uzlib_gzip_parse_header(TINF_DATA *d);
 
 /* Compression API */
 
-typedef const uint8_t *uzlib_hash_entry_t;
-
 struct uzlib_comp {
     struct Outbuf out;
 
-    uzlib_hash_entry_t *hash_table;
+    /* Buffers provided by the caller: window is 2 * dict_size bytes,
+       hash_table has 1 << hash_bits entries and hash_chain has dict_size
+       entries.  dict_size is a power of 2, at most 32768. */
+    uint8_t *window;
+    uint16_t *hash_table;
+    uint16_t *hash_chain;
     unsigned int hash_bits;
     unsigned int dict_size;
+
+    unsigned int win_len; /* number of bytes in window */
+    unsigned int win_pos; /* position of the next byte to compress */
 };
 
-void TINFCC uzlib_compress(struct uzlib_comp *c, const uint8_t *src, unsigned slen);
+void TINFCC uzlib_compress_init(struct uzlib_comp *c, unsigned char *outbuf, int outsize);
+/* Add input to the window, returns the number of bytes that fitted */
+unsigned int TINFCC uzlib_compress_put(struct uzlib_comp *c, const void *src, unsigned int len);
+/* Compress data in the window, returns 1 if it stopped because out.outbuf
+   is full (the caller should empty it and call again).  Unless flush is
+   true, the last few bytes are kept back to match against later input. */
+int TINFCC uzlib_compress_run(struct uzlib_comp *c, int flush);
+/* Make all data compressed so far decodable (after uzlib_compress_run with
+   flush), and align the output to a byte */
+void TINFCC uzlib_compress_sync(struct uzlib_comp *c);
+/* End the deflate stream (after uzlib_compress_run with flush) */
+void TINFCC uzlib_compress_finish(struct uzlib_comp *c);
 
 /* Checksum API */
 
@@ -19,4 +19,17 @@
 #define UZLIB_CONF_PARANOID_CHECKS 0
 #endif
 
+#ifndef UZLIB_CONF_FAST_BITS
+/* Decode Huffman codes of up to this many bits with a lookup table, rather
+   than bit by bit.  Costs 2 * 2^N bytes for each of the literal/length and
+   distance trees.  0 disables the tables. */
+#define UZLIB_CONF_FAST_BITS 0
+#endif
+
+#ifndef UZLIB_CONF_CRC32_SLICE8
+/* Compute CRC32 8 bytes at a time using 8 lookup tables (8KiB), rather
+   than a nibble at a time using a 64 byte table. */
+#define UZLIB_CONF_CRC32_SLICE8 0
+#endif
+
 #endif /* UZLIB_CONF_H_INCLUDED */
@@ -70,6 +70,9 @@ typedef struct _mp_vfs_blockdev_t {
             mp_obj_t count[2];
         } old;
     } u;
+    #if MICROPY_VFS_BLOCKDEV_CACHE
+    struct _mp_vfs_blockdev_cache_t *cache; // write-back cache, or NULL for none
+    #endif
 } mp_vfs_blockdev_t;
 
 typedef struct _mp_vfs_mount_t {
@@ -85,6 +88,11 @@ int mp_vfs_blockdev_read_ext(mp_vfs_blockdev_t *self, size_t block_num, size_t b
 int mp_vfs_blockdev_write(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, const uint8_t *buf);
 int mp_vfs_blockdev_write_ext(mp_vfs_blockdev_t *self, size_t block_num, size_t block_off, size_t len, const uint8_t *buf);
 mp_obj_t mp_vfs_blockdev_ioctl(mp_vfs_blockdev_t *self, uintptr_t cmd, uintptr_t arg);
+#if MICROPY_VFS_BLOCKDEV_CACHE
+void mp_vfs_blockdev_cache_init(mp_vfs_blockdev_t *self, size_t num_blocks);
+int mp_vfs_blockdev_flush(mp_vfs_blockdev_t *self);
+mp_obj_t mp_vfs_blockdev_cache_stats(mp_vfs_blockdev_t *self, bool reset);
+#endif
 
 mp_vfs_mount_t *mp_vfs_lookup_path(const char *path, const char **path_out);
 mp_import_stat_t mp_vfs_import_stat(const char *path);
@@ -24,6 +24,8 @@
  * THE SOFTWARE.
  */
 
+#include <string.h>
+
 #include "py/runtime.h"
 #include "py/binary.h"
 #include "py/objarray.h"
@@ -44,9 +46,12 @@ void mp_vfs_blockdev_init(mp_vfs_blockdev_t *self, mp_obj_t bdev) {
         mp_load_method_maybe(bdev, MP_QSTR_sync, self->u.old.sync);
         mp_load_method(bdev, MP_QSTR_count, self->u.old.count);
     }
+    #if MICROPY_VFS_BLOCKDEV_CACHE
+    self->cache = NULL;
+    #endif
 }
 
-int mp_vfs_blockdev_read(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, uint8_t *buf) {
+STATIC int blockdev_read_dev(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, uint8_t *buf) {
     if (self->flags & MP_BLOCKDEV_FLAG_NATIVE) {
         mp_uint_t (*f)(uint8_t *, uint32_t, uint32_t) = (void *)(uintptr_t)self->readblocks[2];
         return f(buf, block_num, num_blocks);
@@ -73,7 +78,7 @@ int mp_vfs_blockdev_read_ext(mp_vfs_blockdev_t *self, size_t block_num, size_t b
     }
 }
 
-int mp_vfs_blockdev_write(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, const uint8_t *buf) {
+STATIC int blockdev_write_dev(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, const uint8_t *buf) {
     if (self->writeblocks[0] == MP_OBJ_NULL) {
         // read-only block device
         return -MP_EROFS;
@@ -92,6 +97,290 @@ int mp_vfs_blockdev_write(mp_vfs_blockdev_t *self, size_t block_num, size_t num_
     }
 }
 
+#if MICROPY_VFS_BLOCKDEV_CACHE
+
+// Write-back cache of single blocks.  Filesystems write their metadata (for
+// FAT: the FAT, directory entries and the partial sector of file data in its
+// window) one block at a time, rewriting the same blocks again and again, so
+// single-block writes are kept in the cache until the next sync, or until
+// there is no clean slot left.  Writes of several blocks (whole clusters of
+// file data) go straight to the device.  Single blocks which are read are
+// cached too, so rereading a FAT sector after switching windows is free.
+//
+// When a flush is needed all dirty blocks are written, blocks which are
+// consecutive on the device and in the cache in one call.  A block written
+// just after the block before it is put in the slot after that block's slot,
+// so sequentially written blocks can be written together.  Runs of blocks are
+// written in the order in which they were first made dirty, which keeps the
+// order the filesystem wrote them in as far as possible: FatFs writes file
+// data, then the FAT, then the directory entry, so that an interrupted
+// update doesn't leave a directory entry referring to clusters not yet
+// allocated.
+
+#define BLOCKDEV_CACHE_EMPTY (0xffffffff)
+
+typedef struct _mp_vfs_blockdev_cache_slot_t {
+    uint32_t block;
+    uint32_t used; // value of tick when last used
+    uint32_t dirty; // 0 if clean, else 1 + order in which it was made dirty
+} mp_vfs_blockdev_cache_slot_t;
+
+typedef struct _mp_vfs_blockdev_cache_t {
+    uint8_t *buf; // n_slots blocks of data, in slot order
+    size_t n_slots;
+    uint32_t tick;
+    uint32_t seq; // number of blocks made dirty since there were none
+    uint32_t n_dirty;
+    mp_uint_t hits;
+    mp_uint_t misses;
+    mp_uint_t writes;
+    mp_uint_t transfers;
+    mp_vfs_blockdev_cache_slot_t slot[];
+} mp_vfs_blockdev_cache_t;
+
+void mp_vfs_blockdev_cache_init(mp_vfs_blockdev_t *self, size_t num_blocks) {
+    mp_vfs_blockdev_cache_t *c = m_new_obj_var(mp_vfs_blockdev_cache_t, mp_vfs_blockdev_cache_slot_t, num_blocks);
+    c->buf = m_new(uint8_t, num_blocks * self->block_size);
+    c->n_slots = num_blocks;
+    c->tick = 0;
+    c->seq = 0;
+    c->n_dirty = 0;
+    c->hits = 0;
+    c->misses = 0;
+    c->writes = 0;
+    c->transfers = 0;
+    for (size_t i = 0; i < num_blocks; ++i) {
+        c->slot[i].block = BLOCKDEV_CACHE_EMPTY;
+        c->slot[i].used = 0;
+        c->slot[i].dirty = 0;
+    }
+    self->cache = c;
+}
+
+STATIC uint8_t *cache_data(mp_vfs_blockdev_t *self, mp_vfs_blockdev_cache_slot_t *slot) {
+    mp_vfs_blockdev_cache_t *c = self->cache;
+    return c->buf + (slot - c->slot) * self->block_size;
+}
+
+STATIC mp_vfs_blockdev_cache_slot_t *cache_find(mp_vfs_blockdev_cache_t *c, uint32_t block) {
+    for (size_t i = 0; i < c->n_slots; ++i) {
+        if (c->slot[i].block == block) {
+            return &c->slot[i];
+        }
+    }
+    return NULL;
+}
+
+STATIC void cache_touch(mp_vfs_blockdev_cache_t *c, mp_vfs_blockdev_cache_slot_t *slot) {
+    if (++c->tick == 0xffffffff) {
+        // Tick wrapped around, so forget the order of use of all slots.
+        for (size_t i = 0; i < c->n_slots; ++i) {
+            c->slot[i].used = 0;
+        }
+        c->tick = 1;
+    }
+    slot->used = c->tick;
+}
+
+int mp_vfs_blockdev_flush(mp_vfs_blockdev_t *self) {
+    mp_vfs_blockdev_cache_t *c = self->cache;
+    if (c == NULL) {
+        return 0;
+    }
+    mp_vfs_blockdev_cache_slot_t *end = c->slot + c->n_slots;
+    while (c->n_dirty > 0) {
+        // Find the block made dirty first, and the run of dirty blocks around it.
+        mp_vfs_blockdev_cache_slot_t *first = NULL;
+        for (mp_vfs_blockdev_cache_slot_t *s = c->slot; s < end; ++s) {
+            if (s->dirty && (first == NULL || s->dirty < first->dirty)) {
+                first = s;
+            }
+        }
+        mp_vfs_blockdev_cache_slot_t *last = first;
+        while (first > c->slot && first[-1].dirty && first[-1].block == first->block - 1) {
+            --first;
+        }
+        while (last + 1 < end && last[1].dirty && last[1].block == last->block + 1) {
+            ++last;
+        }
+        size_t n = last - first + 1;
+        ++c->transfers;
+        int ret = blockdev_write_dev(self, first->block, n, cache_data(self, first));
+        if (ret != 0) {
+            return ret;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            first[i].dirty = 0;
+        }
+        c->n_dirty -= n;
+    }
+    c->seq = 0;
+    return 0;
+}
+
+// Get a slot for a block which isn't cached, flushing dirty blocks if needed.
+STATIC int cache_alloc(mp_vfs_blockdev_t *self, uint32_t block, mp_vfs_blockdev_cache_slot_t **slot_out) {
+    mp_vfs_blockdev_cache_t *c = self->cache;
+    mp_vfs_blockdev_cache_slot_t *slot = block > 0 ? cache_find(c, block - 1) : NULL;
+    if (slot != NULL && slot + 1 < c->slot + c->n_slots && !slot[1].dirty) {
+        // Put the block after the block before it.
+        ++slot;
+    } else {
+        // Use the least recently used clean slot.
+        slot = NULL;
+        for (size_t i = 0; i < c->n_slots; ++i) {
+            mp_vfs_blockdev_cache_slot_t *s = &c->slot[i];
+            if (!s->dirty && (slot == NULL || s->used < slot->used)) {
+                slot = s;
+            }
+        }
+        if (slot == NULL) {
+            // All slots are dirty.
+            int ret = mp_vfs_blockdev_flush(self);
+            if (ret != 0) {
+                return ret;
+            }
+            slot = &c->slot[0];
+            for (size_t i = 1; i < c->n_slots; ++i) {
+                if (c->slot[i].used < slot->used) {
+                    slot = &c->slot[i];
+                }
+            }
+        }
+    }
+    slot->block = block;
+    *slot_out = slot;
+    return 0;
+}
+
+int mp_vfs_blockdev_read(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, uint8_t *buf) {
+    mp_vfs_blockdev_cache_t *c = self->cache;
+    if (c == NULL) {
+        return blockdev_read_dev(self, block_num, num_blocks, buf);
+    }
+
+    if (num_blocks == 1) {
+        mp_vfs_blockdev_cache_slot_t *slot = cache_find(c, block_num);
+        if (slot != NULL) {
+            ++c->hits;
+        } else {
+            ++c->misses;
+            int ret = cache_alloc(self, block_num, &slot);
+            if (ret == 0) {
+                ret = blockdev_read_dev(self, block_num, 1, cache_data(self, slot));
+            }
+            if (ret != 0) {
+                if (slot != NULL) {
+                    slot->block = BLOCKDEV_CACHE_EMPTY;
+                }
+                return ret;
+            }
+        }
+        cache_touch(c, slot);
+        memcpy(buf, cache_data(self, slot), self->block_size);
+        return 0;
+    }
+
+    // Read several blocks from the device, then replace the ones which are
+    // cached, since they may be dirty.
+    int ret = blockdev_read_dev(self, block_num, num_blocks, buf);
+    if (ret != 0) {
+        return ret;
+    }
+    c->misses += num_blocks;
+    for (size_t i = 0; i < c->n_slots; ++i) {
+        mp_vfs_blockdev_cache_slot_t *s = &c->slot[i];
+        if (s->block != BLOCKDEV_CACHE_EMPTY && s->block - block_num < num_blocks) {
+            memcpy(buf + (s->block - block_num) * self->block_size, cache_data(self, s), self->block_size);
+            ++c->hits;
+            --c->misses;
+        }
+    }
+    return 0;
+}
+
+int mp_vfs_blockdev_write(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, const uint8_t *buf) {
+    mp_vfs_blockdev_cache_t *c = self->cache;
+    if (c == NULL) {
+        return blockdev_write_dev(self, block_num, num_blocks, buf);
+    }
+
+    if (self->writeblocks[0] == MP_OBJ_NULL) {
+        // read-only block device
+        return -MP_EROFS;
+    }
+
+    if (num_blocks == 1) {
+        mp_vfs_blockdev_cache_slot_t *slot = cache_find(c, block_num);
+        if (slot == NULL) {
+            int ret = cache_alloc(self, block_num, &slot);
+            if (ret != 0) {
+                return ret;
+            }
+        }
+        memcpy(cache_data(self, slot), buf, self->block_size);
+        if (!slot->dirty) {
+            slot->dirty = ++c->seq;
+            ++c->n_dirty;
+        }
+        cache_touch(c, slot);
+        ++c->writes;
+        return 0;
+    }
+
+    // Write several blocks straight to the device, and update the cached
+    // copies of any of them, which are then clean.
+    int ret = blockdev_write_dev(self, block_num, num_blocks, buf);
+    if (ret != 0) {
+        return ret;
+    }
+    for (size_t i = 0; i < c->n_slots; ++i) {
+        mp_vfs_blockdev_cache_slot_t *s = &c->slot[i];
+        if (s->block != BLOCKDEV_CACHE_EMPTY && s->block - block_num < num_blocks) {
+            memcpy(cache_data(self, s), buf + (s->block - block_num) * self->block_size, self->block_size);
+            if (s->dirty) {
+                s->dirty = 0;
+                if (--c->n_dirty == 0) {
+                    c->seq = 0;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+mp_obj_t mp_vfs_blockdev_cache_stats(mp_vfs_blockdev_t *self, bool reset) {
+    mp_vfs_blockdev_cache_t *c = self->cache;
+    mp_obj_t items[4] = {
+        MP_OBJ_NEW_SMALL_INT(0), MP_OBJ_NEW_SMALL_INT(0), MP_OBJ_NEW_SMALL_INT(0), MP_OBJ_NEW_SMALL_INT(0),
+    };
+    if (c != NULL) {
+        items[0] = mp_obj_new_int_from_uint(c->hits);
+        items[1] = mp_obj_new_int_from_uint(c->misses);
+        items[2] = mp_obj_new_int_from_uint(c->writes);
+        items[3] = mp_obj_new_int_from_uint(c->transfers);
+        if (reset) {
+            c->hits = 0;
+            c->misses = 0;
+            c->writes = 0;
+            c->transfers = 0;
+        }
+    }
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(items), items);
+}
+
+#else
+
+int mp_vfs_blockdev_read(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, uint8_t *buf) {
+    return blockdev_read_dev(self, block_num, num_blocks, buf);
+}
+
+int mp_vfs_blockdev_write(mp_vfs_blockdev_t *self, size_t block_num, size_t num_blocks, const uint8_t *buf) {
+    return blockdev_write_dev(self, block_num, num_blocks, buf);
+}
+
+#endif // MICROPY_VFS_BLOCKDEV_CACHE
+
 int mp_vfs_blockdev_write_ext(mp_vfs_blockdev_t *self, size_t block_num, size_t block_off, size_t len, const uint8_t *buf) {
     if (self->writeblocks[0] == MP_OBJ_NULL) {
         // read-only block device
@@ -111,6 +400,15 @@ int mp_vfs_blockdev_write_ext(mp_vfs_blockdev_t *self, size_t block_num, size_t
 }
 
 mp_obj_t mp_vfs_blockdev_ioctl(mp_vfs_blockdev_t *self, uintptr_t cmd, uintptr_t arg) {
+    #if MICROPY_VFS_BLOCKDEV_CACHE
+    if (cmd == MP_BLOCKDEV_IOCTL_SYNC || cmd == MP_BLOCKDEV_IOCTL_DEINIT) {
+        // Write out dirty blocks before the device syncs or is deinitialised.
+        int ret = mp_vfs_blockdev_flush(self);
+        if (ret != 0) {
+            return MP_OBJ_NEW_SMALL_INT(ret);
+        }
+    }
+    #endif
     if (self->flags & MP_BLOCKDEV_FLAG_HAVE_IOCTL) {
         // New protocol with ioctl
         self->u.ioctl[2] = MP_OBJ_NEW_SMALL_INT(cmd);
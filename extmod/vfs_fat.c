@@ -63,7 +63,20 @@ STATIC mp_import_stat_t fat_vfs_import_stat(void *vfs_in, const char *path) {
 }
 
 STATIC mp_obj_t fat_vfs_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    #if MICROPY_VFS_BLOCKDEV_CACHE
+    enum { ARG_bdev, ARG_cache };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
+        { MP_QSTR_cache, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+    };
+    mp_arg_val_t arg_vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, arg_vals);
+    if (arg_vals[ARG_cache].u_int < 0) {
+        mp_raise_ValueError(NULL);
+    }
+    #else
     mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    #endif
 
     // create new object
     fs_user_mount_t *vfs = m_new_obj(fs_user_mount_t);
@@ -84,6 +97,13 @@ STATIC mp_obj_t fat_vfs_make_new(const mp_obj_type_t *type, size_t n_args, size_
         mp_raise_OSError(fresult_to_errno_table[res]);
     }
 
+    #if MICROPY_VFS_BLOCKDEV_CACHE
+    // The block size is known now the block device has been mounted.
+    if (arg_vals[ARG_cache].u_int > 0) {
+        mp_vfs_blockdev_cache_init(&vfs->blockdev, arg_vals[ARG_cache].u_int);
+    }
+    #endif
+
     return MP_OBJ_FROM_PTR(vfs);
 }
 
@@ -390,12 +410,28 @@ STATIC mp_obj_t vfs_fat_mount(mp_obj_t self_in, mp_obj_t readonly, mp_obj_t mkfs
 STATIC MP_DEFINE_CONST_FUN_OBJ_3(vfs_fat_mount_obj, vfs_fat_mount);
 
 STATIC mp_obj_t vfs_fat_umount(mp_obj_t self_in) {
+    #if MICROPY_VFS_BLOCKDEV_CACHE
+    fs_user_mount_t *self = MP_OBJ_TO_PTR(self_in);
+    int ret = mp_vfs_blockdev_flush(&self->blockdev);
+    if (ret != 0) {
+        mp_raise_OSError(-ret);
+    }
+    #else
     (void)self_in;
+    #endif
     // keep the FAT filesystem mounted internally so the VFS methods can still be used
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(fat_vfs_umount_obj, vfs_fat_umount);
 
+#if MICROPY_VFS_BLOCKDEV_CACHE
+STATIC mp_obj_t vfs_fat_cache_stats(size_t n_args, const mp_obj_t *args) {
+    fs_user_mount_t *self = MP_OBJ_TO_PTR(args[0]);
+    return mp_vfs_blockdev_cache_stats(&self->blockdev, n_args > 1 && mp_obj_is_true(args[1]));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(fat_vfs_cache_stats_obj, 1, 2, vfs_fat_cache_stats);
+#endif
+
 STATIC const mp_rom_map_elem_t fat_vfs_locals_dict_table[] = {
     #if _FS_REENTRANT
     { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&fat_vfs_del_obj) },
@@ -413,6 +449,9 @@ STATIC const mp_rom_map_elem_t fat_vfs_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_statvfs), MP_ROM_PTR(&fat_vfs_statvfs_obj) },
     { MP_ROM_QSTR(MP_QSTR_mount), MP_ROM_PTR(&vfs_fat_mount_obj) },
     { MP_ROM_QSTR(MP_QSTR_umount), MP_ROM_PTR(&fat_vfs_umount_obj) },
+    #if MICROPY_VFS_BLOCKDEV_CACHE
+    { MP_ROM_QSTR(MP_QSTR_cache_stats), MP_ROM_PTR(&fat_vfs_cache_stats_obj) },
+    #endif
 };
 STATIC MP_DEFINE_CONST_DICT(fat_vfs_locals_dict, fat_vfs_locals_dict_table);
 
@@ -124,6 +124,12 @@ DRESULT disk_ioctl(
     // Second part: convert the result for return
     switch (cmd) {
         case CTRL_SYNC:
+            #if MICROPY_VFS_BLOCKDEV_CACHE
+            if (vfs->blockdev.cache != NULL && mp_obj_is_small_int(ret) && MP_OBJ_SMALL_INT_VALUE(ret) < 0) {
+                // writing out the cache failed
+                return RES_ERROR;
+            }
+            #endif
             return RES_OK;
 
         case GET_SECTOR_COUNT: {
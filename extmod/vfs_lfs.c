@@ -32,7 +32,11 @@
 
 #if MICROPY_VFS && (MICROPY_VFS_LFS1 || MICROPY_VFS_LFS2)
 
-enum { LFS_MAKE_ARG_bdev, LFS_MAKE_ARG_readsize, LFS_MAKE_ARG_progsize, LFS_MAKE_ARG_lookahead, LFS_MAKE_ARG_mtime };
+enum { LFS_MAKE_ARG_bdev, LFS_MAKE_ARG_readsize, LFS_MAKE_ARG_progsize, LFS_MAKE_ARG_lookahead, LFS_MAKE_ARG_mtime,
+       #if MICROPY_VFS_LFS_CACHE
+       LFS_MAKE_ARG_cache, LFS_MAKE_ARG_readahead,
+       #endif
+};
 
 static const mp_arg_t lfs_make_allowed_args[] = {
     { MP_QSTR_, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL} },
@@ -40,8 +44,181 @@ static const mp_arg_t lfs_make_allowed_args[] = {
     { MP_QSTR_progsize, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 32} },
     { MP_QSTR_lookahead, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 32} },
     { MP_QSTR_mtime, MP_ARG_KW_ONLY | MP_ARG_BOOL, {.u_bool = true} },
+    #if MICROPY_VFS_LFS_CACHE
+    { MP_QSTR_cache, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+    { MP_QSTR_readahead, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 1} },
+    #endif
 };
 
+#if MICROPY_VFS_LFS_CACHE
+
+// Cache of whole blocks of the block device, shared by both littlefs versions.
+// It is write-through: progs go straight to the device and update any cached
+// copy of the block, so the cache never holds data the device doesn't.
+//
+// A miss while littlefs reads file data loads the aligned group of up to
+// readahead + 1 blocks around the block, in one call to the device.  littlefs
+// mostly allocates the blocks of a file in ascending order, so these are
+// likely to be the next blocks of the file.  Each such read evicts a whole
+// group of slots, so groups are limited to an eighth of the cache to keep the
+// blocks of the file's skip-list, which are read for every block, cached.
+
+#define LFS_CACHE_EMPTY (0xffffffff)
+
+typedef struct _mp_vfs_lfs_cache_slot_t {
+    uint32_t block;
+    uint32_t used; // value of tick when last used, 0 if read ahead and not used yet
+} mp_vfs_lfs_cache_slot_t;
+
+typedef struct _mp_vfs_lfs_cache_t {
+    mp_vfs_lfs_cache_slot_t *slot;
+    uint8_t *buf; // n_slots blocks of data, in slot order
+    size_t n_slots;
+    size_t readahead;
+    size_t block_size;
+    uint32_t block_count;
+    uint32_t tick;
+    bool file_read; // set while littlefs reads file data
+    mp_uint_t hits;
+    mp_uint_t misses;
+    mp_uint_t readahead_blocks;
+} mp_vfs_lfs_cache_t;
+
+STATIC void lfs_cache_invalidate(mp_vfs_lfs_cache_t *cache) {
+    for (size_t i = 0; i < cache->n_slots; ++i) {
+        cache->slot[i].block = LFS_CACHE_EMPTY;
+        cache->slot[i].used = 0;
+    }
+    cache->tick = 0;
+    cache->file_read = false;
+}
+
+STATIC void lfs_cache_init(mp_vfs_lfs_cache_t *cache, size_t n_slots, size_t readahead, size_t block_size, uint32_t block_count) {
+    cache->n_slots = n_slots;
+    cache->readahead = readahead;
+    cache->block_size = block_size;
+    cache->block_count = block_count;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->readahead_blocks = 0;
+    cache->file_read = false;
+    if (n_slots == 0) {
+        cache->slot = NULL;
+        cache->buf = NULL;
+        return;
+    }
+    cache->slot = m_new(mp_vfs_lfs_cache_slot_t, n_slots);
+    cache->buf = m_new(uint8_t, n_slots * block_size);
+    lfs_cache_invalidate(cache);
+}
+
+STATIC mp_vfs_lfs_cache_slot_t *lfs_cache_find(mp_vfs_lfs_cache_t *cache, uint32_t block) {
+    for (size_t i = 0; i < cache->n_slots; ++i) {
+        if (cache->slot[i].block == block) {
+            return &cache->slot[i];
+        }
+    }
+    return NULL;
+}
+
+STATIC uint8_t *lfs_cache_data(mp_vfs_lfs_cache_t *cache, mp_vfs_lfs_cache_slot_t *slot) {
+    return cache->buf + (slot - cache->slot) * cache->block_size;
+}
+
+STATIC void lfs_cache_touch(mp_vfs_lfs_cache_t *cache, mp_vfs_lfs_cache_slot_t *slot) {
+    if (++cache->tick == 0xffffffff) {
+        // Tick wrapped around, so forget the order of use of all slots.
+        for (size_t i = 0; i < cache->n_slots; ++i) {
+            cache->slot[i].used = 0;
+        }
+        cache->tick = 1;
+    }
+    slot->used = cache->tick;
+}
+
+STATIC int lfs_cache_read(mp_vfs_lfs_cache_t *cache, mp_vfs_blockdev_t *bdev, uint32_t block, size_t off, uint8_t *buf, size_t size) {
+    mp_vfs_lfs_cache_slot_t *slot = lfs_cache_find(cache, block);
+    if (slot != NULL) {
+        ++cache->hits;
+    } else {
+        ++cache->misses;
+
+        // Work out which blocks to read, and drop any of them already cached.
+        uint32_t first = block;
+        size_t n = 1;
+        if (cache->file_read) {
+            size_t g = MIN(cache->readahead + 1, MAX(cache->n_slots / 8, 1));
+            first = block - block % g;
+            n = MIN(g, cache->block_count - first);
+            for (size_t i = 0; i < n; ++i) {
+                mp_vfs_lfs_cache_slot_t *s = lfs_cache_find(cache, first + i);
+                if (s != NULL) {
+                    s->block = LFS_CACHE_EMPTY;
+                }
+            }
+        }
+
+        // Evict the run of n consecutive slots whose most recent use is oldest.
+        size_t start = 0;
+        uint32_t best = 0xffffffff;
+        for (size_t i = 0; i + n <= cache->n_slots; ++i) {
+            uint32_t newest = 0;
+            for (size_t j = i; j < i + n; ++j) {
+                if (cache->slot[j].block == LFS_CACHE_EMPTY) {
+                    continue;
+                }
+                newest = MAX(newest, cache->slot[j].used + 1);
+            }
+            if (newest < best) {
+                start = i;
+                best = newest;
+            }
+        }
+
+        slot = &cache->slot[start];
+        for (size_t i = 0; i < n; ++i) {
+            slot[i].block = LFS_CACHE_EMPTY;
+        }
+        int ret = mp_vfs_blockdev_read_ext(bdev, first, 0, n * cache->block_size, lfs_cache_data(cache, slot));
+        if (ret != 0) {
+            return ret;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            slot[i].block = first + i;
+            slot[i].used = 0;
+        }
+        cache->readahead_blocks += n - 1;
+        slot += block - first;
+    }
+    lfs_cache_touch(cache, slot);
+    memcpy(buf, lfs_cache_data(cache, slot) + off, size);
+    return 0;
+}
+
+STATIC int lfs_cache_prog(mp_vfs_lfs_cache_t *cache, mp_vfs_blockdev_t *bdev, uint32_t block, size_t off, const uint8_t *buf, size_t size) {
+    int ret = mp_vfs_blockdev_write_ext(bdev, block, off, size, buf);
+    mp_vfs_lfs_cache_slot_t *slot = lfs_cache_find(cache, block);
+    if (slot != NULL) {
+        if (ret == 0) {
+            memcpy(lfs_cache_data(cache, slot) + off, buf, size);
+        } else {
+            // The state of the block on the device is unknown.
+            slot->block = LFS_CACHE_EMPTY;
+        }
+    }
+    return ret;
+}
+
+STATIC void lfs_cache_erase(mp_vfs_lfs_cache_t *cache, uint32_t block) {
+    // What an erased block reads back as depends on the device, so drop it.
+    mp_vfs_lfs_cache_slot_t *slot = lfs_cache_find(cache, block);
+    if (slot != NULL) {
+        slot->block = LFS_CACHE_EMPTY;
+    }
+}
+
+#endif // MICROPY_VFS_LFS_CACHE
+
 #if MICROPY_VFS_LFS1
 
 #include "lib/littlefs/lfs1.h"
@@ -61,6 +238,9 @@ typedef struct _mp_obj_vfs_lfs1_t {
     vstr_t cur_dir;
     struct lfs1_config config;
     lfs1_t lfs;
+    #if MICROPY_VFS_LFS_CACHE
+    mp_vfs_lfs_cache_t cache;
+    #endif
 } mp_obj_vfs_lfs1_t;
 
 typedef struct _mp_obj_vfs_lfs1_file_t {
@@ -111,6 +291,9 @@ typedef struct _mp_obj_vfs_lfs2_t {
     vstr_t cur_dir;
     struct lfs2_config config;
     lfs2_t lfs;
+    #if MICROPY_VFS_LFS_CACHE
+    mp_vfs_lfs_cache_t cache;
+    #endif
 } mp_obj_vfs_lfs2_t;
 
 typedef struct _mp_obj_vfs_lfs2_file_t {
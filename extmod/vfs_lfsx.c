@@ -37,7 +37,8 @@
 #include "lib/timeutils/timeutils.h"
 
 STATIC int MP_VFS_LFSx(dev_ioctl)(const struct LFSx_API (config) * c, int cmd, int arg, bool must_return_int) {
-    mp_obj_t ret = mp_vfs_blockdev_ioctl(c->context, cmd, arg);
+    MP_OBJ_VFS_LFSx *self = c->context;
+    mp_obj_t ret = mp_vfs_blockdev_ioctl(&self->blockdev, cmd, arg);
     int ret_i = 0;
     if (must_return_int || ret != mp_const_none) {
         ret_i = mp_obj_get_int(ret);
@@ -46,14 +47,32 @@ STATIC int MP_VFS_LFSx(dev_ioctl)(const struct LFSx_API (config) * c, int cmd, i
 }
 
 STATIC int MP_VFS_LFSx(dev_read)(const struct LFSx_API (config) * c, LFSx_API(block_t) block, LFSx_API(off_t) off, void *buffer, LFSx_API(size_t) size) {
-    return mp_vfs_blockdev_read_ext(c->context, block, off, size, buffer);
+    MP_OBJ_VFS_LFSx *self = c->context;
+    #if MICROPY_VFS_LFS_CACHE
+    if (self->cache.n_slots != 0) {
+        return lfs_cache_read(&self->cache, &self->blockdev, block, off, buffer, size);
+    }
+    #endif
+    return mp_vfs_blockdev_read_ext(&self->blockdev, block, off, size, buffer);
 }
 
 STATIC int MP_VFS_LFSx(dev_prog)(const struct LFSx_API (config) * c, LFSx_API(block_t) block, LFSx_API(off_t) off, const void *buffer, LFSx_API(size_t) size) {
-    return mp_vfs_blockdev_write_ext(c->context, block, off, size, buffer);
+    MP_OBJ_VFS_LFSx *self = c->context;
+    #if MICROPY_VFS_LFS_CACHE
+    if (self->cache.n_slots != 0) {
+        return lfs_cache_prog(&self->cache, &self->blockdev, block, off, buffer, size);
+    }
+    #endif
+    return mp_vfs_blockdev_write_ext(&self->blockdev, block, off, size, buffer);
 }
 
 STATIC int MP_VFS_LFSx(dev_erase)(const struct LFSx_API (config) * c, LFSx_API(block_t) block) {
+    #if MICROPY_VFS_LFS_CACHE
+    MP_OBJ_VFS_LFSx *self = c->context;
+    if (self->cache.n_slots != 0) {
+        lfs_cache_erase(&self->cache, block);
+    }
+    #endif
     return MP_VFS_LFSx(dev_ioctl)(c, MP_BLOCKDEV_IOCTL_BLOCK_ERASE, block, true);
 }
 
@@ -61,14 +80,14 @@ STATIC int MP_VFS_LFSx(dev_sync)(const struct LFSx_API (config) * c) {
     return MP_VFS_LFSx(dev_ioctl)(c, MP_BLOCKDEV_IOCTL_SYNC, 0, false);
 }
 
-STATIC void MP_VFS_LFSx(init_config)(MP_OBJ_VFS_LFSx * self, mp_obj_t bdev, size_t read_size, size_t prog_size, size_t lookahead) {
+STATIC void MP_VFS_LFSx(init_config)(MP_OBJ_VFS_LFSx * self, mp_obj_t bdev, size_t read_size, size_t prog_size, size_t lookahead, size_t cache_blocks, size_t readahead) {
     self->blockdev.flags = MP_BLOCKDEV_FLAG_FREE_OBJ;
     mp_vfs_blockdev_init(&self->blockdev, bdev);
 
     struct LFSx_API (config) * config = &self->config;
     memset(config, 0, sizeof(*config));
 
-    config->context = &self->blockdev;
+    config->context = self;
 
     config->read = MP_VFS_LFSx(dev_read);
     config->prog = MP_VFS_LFSx(dev_prog);
@@ -98,6 +117,13 @@ STATIC void MP_VFS_LFSx(init_config)(MP_OBJ_VFS_LFSx * self, mp_obj_t bdev, size
     config->prog_buffer = m_new(uint8_t, config->cache_size);
     config->lookahead_buffer = m_new(uint8_t, config->lookahead_size);
     #endif
+
+    #if MICROPY_VFS_LFS_CACHE
+    lfs_cache_init(&self->cache, cache_blocks, readahead, bs, bc);
+    #else
+    (void)cache_blocks;
+    (void)readahead;
+    #endif
 }
 
 const char *MP_VFS_LFSx(make_path)(MP_OBJ_VFS_LFSx * self, mp_obj_t path_in) {
@@ -124,8 +150,18 @@ STATIC mp_obj_t MP_VFS_LFSx(make_new)(const mp_obj_type_t * type, size_t n_args,
     #if LFS_BUILD_VERSION == 2
     self->enable_mtime = args[LFS_MAKE_ARG_mtime].u_bool;
     #endif
+    size_t cache_blocks = 0;
+    size_t readahead = 0;
+    #if MICROPY_VFS_LFS_CACHE
+    if (args[LFS_MAKE_ARG_cache].u_int < 0 || args[LFS_MAKE_ARG_readahead].u_int < 0) {
+        mp_raise_ValueError(NULL);
+    }
+    cache_blocks = args[LFS_MAKE_ARG_cache].u_int;
+    readahead = args[LFS_MAKE_ARG_readahead].u_int;
+    #endif
     MP_VFS_LFSx(init_config)(self, args[LFS_MAKE_ARG_bdev].u_obj,
-        args[LFS_MAKE_ARG_readsize].u_int, args[LFS_MAKE_ARG_progsize].u_int, args[LFS_MAKE_ARG_lookahead].u_int);
+        args[LFS_MAKE_ARG_readsize].u_int, args[LFS_MAKE_ARG_progsize].u_int, args[LFS_MAKE_ARG_lookahead].u_int,
+        cache_blocks, readahead);
     int ret = LFSx_API(mount)(&self->lfs, &self->config);
     if (ret < 0) {
         mp_raise_OSError(-ret);
@@ -139,7 +175,8 @@ STATIC mp_obj_t MP_VFS_LFSx(mkfs)(size_t n_args, const mp_obj_t *pos_args, mp_ma
 
     MP_OBJ_VFS_LFSx self;
     MP_VFS_LFSx(init_config)(&self, args[LFS_MAKE_ARG_bdev].u_obj,
-        args[LFS_MAKE_ARG_readsize].u_int, args[LFS_MAKE_ARG_progsize].u_int, args[LFS_MAKE_ARG_lookahead].u_int);
+        args[LFS_MAKE_ARG_readsize].u_int, args[LFS_MAKE_ARG_progsize].u_int, args[LFS_MAKE_ARG_lookahead].u_int,
+        0, 0);
     int ret = LFSx_API(format)(&self.lfs, &self.config);
     if (ret < 0) {
         mp_raise_OSError(-ret);
@@ -441,10 +478,34 @@ STATIC mp_obj_t MP_VFS_LFSx(umount)(mp_obj_t self_in) {
     MP_OBJ_VFS_LFSx *self = MP_OBJ_TO_PTR(self_in);
     // LFS unmount never fails
     LFSx_API(unmount)(&self->lfs);
+    #if MICROPY_VFS_LFS_CACHE
+    if (self->cache.n_slots != 0) {
+        lfs_cache_invalidate(&self->cache);
+    }
+    #endif
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(MP_VFS_LFSx(umount_obj), MP_VFS_LFSx(umount));
 
+#if MICROPY_VFS_LFS_CACHE
+STATIC mp_obj_t MP_VFS_LFSx(cache_stats)(size_t n_args, const mp_obj_t *args) {
+    MP_OBJ_VFS_LFSx *self = MP_OBJ_TO_PTR(args[0]);
+    mp_vfs_lfs_cache_t *cache = &self->cache;
+    mp_obj_t items[] = {
+        mp_obj_new_int_from_uint(cache->hits),
+        mp_obj_new_int_from_uint(cache->misses),
+        mp_obj_new_int_from_uint(cache->readahead_blocks),
+    };
+    if (n_args > 1 && mp_obj_is_true(args[1])) {
+        cache->hits = 0;
+        cache->misses = 0;
+        cache->readahead_blocks = 0;
+    }
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(items), items);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(MP_VFS_LFSx(cache_stats_obj), 1, 2, MP_VFS_LFSx(cache_stats));
+#endif
+
 STATIC const mp_rom_map_elem_t MP_VFS_LFSx(locals_dict_table)[] = {
     { MP_ROM_QSTR(MP_QSTR_mkfs), MP_ROM_PTR(&MP_VFS_LFSx(mkfs_obj)) },
     { MP_ROM_QSTR(MP_QSTR_open), MP_ROM_PTR(&MP_VFS_LFSx(open_obj)) },
@@ -459,6 +520,9 @@ STATIC const mp_rom_map_elem_t MP_VFS_LFSx(locals_dict_table)[] = {
     { MP_ROM_QSTR(MP_QSTR_statvfs), MP_ROM_PTR(&MP_VFS_LFSx(statvfs_obj)) },
     { MP_ROM_QSTR(MP_QSTR_mount), MP_ROM_PTR(&MP_VFS_LFSx(mount_obj)) },
     { MP_ROM_QSTR(MP_QSTR_umount), MP_ROM_PTR(&MP_VFS_LFSx(umount_obj)) },
+    #if MICROPY_VFS_LFS_CACHE
+    { MP_ROM_QSTR(MP_QSTR_cache_stats), MP_ROM_PTR(&MP_VFS_LFSx(cache_stats_obj)) },
+    #endif
 };
 STATIC MP_DEFINE_CONST_DICT(MP_VFS_LFSx(locals_dict), MP_VFS_LFSx(locals_dict_table));
 
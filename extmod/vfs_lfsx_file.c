@@ -131,7 +131,13 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(MP_VFS_LFSx(file___exit___obj), 4, 4,
 STATIC mp_uint_t MP_VFS_LFSx(file_read)(mp_obj_t self_in, void *buf, mp_uint_t size, int *errcode) {
     MP_OBJ_VFS_LFSx_FILE *self = MP_OBJ_TO_PTR(self_in);
     MP_VFS_LFSx(check_open)(self);
+    #if MICROPY_VFS_LFS_CACHE
+    self->vfs->cache.file_read = true;
+    #endif
     LFSx_API(ssize_t) sz = LFSx_API(file_read)(&self->vfs->lfs, &self->file, buf, size);
+    #if MICROPY_VFS_LFS_CACHE
+    self->vfs->cache.file_read = false;
+    #endif
     if (sz < 0) {
         *errcode = -sz;
         return MP_STREAM_ERROR;
@@ -0,0 +1,372 @@
+/*
+ * This file is part of the MicroPython project, http://micropython.org/
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2026 agent
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/mphal.h"
+
+#if MICROPY_PY_MMAP
+
+#if defined(__OpenBSD__) || defined(__MACH__)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+// This module provides a subset of CPython's mmap module.  The mapped memory
+// is exposed via the buffer protocol so it can be used with memoryview,
+// ustruct.unpack_from, ure and so on without being copied into the heap.
+//
+// The mapping is released by close(), on exit of a with-block, or when the
+// object is garbage collected.  The buffer protocol has no release hook and
+// objects created from it, such as memoryviews, keep only a raw pointer to the
+// memory, so it can't be known when they are gone.  Hence once a buffer has
+// been exported:
+// - close() doesn't unmap the address range; it replaces the file mapping
+//   with anonymous zero-filled pages, detaching the file while leaving any
+//   views valid (they then read zeros);
+// - the finaliser leaves the mapping untouched, as views may still use it.
+//
+// Note that every use of the buffer protocol counts as an export, including
+// short-lived ones such as ustruct.unpack_from(fmt, m) or ure.search(p, m),
+// so the address range of such a mapping stays reserved until the process
+// exits.  The replacement pages are mapped with MAP_NORESERVE so they don't
+// count against the commit charge, but code that repeatedly maps large files
+// should use indexing and slicing of the mmap object instead, which don't
+// export a buffer.
+
+enum {
+    ACCESS_DEFAULT = 0,
+    ACCESS_READ = 1,
+    ACCESS_WRITE = 2,
+    ACCESS_COPY = 3,
+};
+
+typedef struct _mp_obj_mmap_t {
+    mp_obj_base_t base;
+    byte *data;
+    size_t len;
+    int prot;
+    bool exported;
+} mp_obj_mmap_t;
+
+STATIC mp_obj_mmap_t *mmap_get_open(mp_obj_t self_in) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->data == NULL) {
+        mp_raise_ValueError(MP_ERROR_TEXT("mmap closed"));
+    }
+    return self;
+}
+
+STATIC void mmap_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void)kind;
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->data == NULL) {
+        mp_printf(print, "<mmap closed>");
+    } else {
+        mp_printf(print, "<mmap len=%u>", (uint)self->len);
+    }
+}
+
+// mmap(fileno, length, flags=MAP_SHARED, prot=PROT_READ|PROT_WRITE, access=ACCESS_DEFAULT, offset=0)
+STATIC mp_obj_t mmap_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    enum { ARG_fileno, ARG_length, ARG_flags, ARG_prot, ARG_access, ARG_offset };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_fileno, MP_ARG_REQUIRED | MP_ARG_OBJ, {.u_rom_obj = MP_ROM_NONE} },
+        { MP_QSTR_length, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0} },
+        { MP_QSTR_flags, MP_ARG_INT, {.u_int = MAP_SHARED} },
+        { MP_QSTR_prot, MP_ARG_INT, {.u_int = PROT_READ | PROT_WRITE} },
+        { MP_QSTR_access, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = ACCESS_DEFAULT} },
+        { MP_QSTR_offset, MP_ARG_KW_ONLY | MP_ARG_INT, {.u_int = 0} },
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+
+    // Accept either a file descriptor or an object with a fileno() method
+    mp_obj_t fileno_in = vals[ARG_fileno].u_obj;
+    if (!mp_obj_is_int(fileno_in)) {
+        mp_obj_t dest[2];
+        mp_load_method(fileno_in, MP_QSTR_fileno, dest);
+        fileno_in = mp_call_method_n_kw(0, 0, dest);
+    }
+    int fd = mp_obj_get_int(fileno_in);
+
+    int flags = vals[ARG_flags].u_int;
+    int prot = vals[ARG_prot].u_int;
+    switch (vals[ARG_access].u_int) {
+        case ACCESS_DEFAULT:
+            break;
+        case ACCESS_READ:
+            flags = MAP_SHARED;
+            prot = PROT_READ;
+            break;
+        case ACCESS_WRITE:
+            flags = MAP_SHARED;
+            prot = PROT_READ | PROT_WRITE;
+            break;
+        case ACCESS_COPY:
+            flags = MAP_PRIVATE;
+            prot = PROT_READ | PROT_WRITE;
+            break;
+        default:
+            mp_raise_ValueError(MP_ERROR_TEXT("invalid access"));
+    }
+
+    mp_int_t length = vals[ARG_length].u_int;
+    mp_int_t offset = vals[ARG_offset].u_int;
+    if (length < 0 || offset < 0) {
+        mp_raise_ValueError(NULL);
+    }
+    struct stat sb;
+    int ret;
+    MP_HAL_RETRY_SYSCALL(ret, fstat(fd, &sb), mp_raise_OSError(err));
+    if (length == 0 || S_ISREG(sb.st_mode)) {
+        // Accessing a regular file beyond its end raises SIGBUS, so the
+        // mapping must lie within it, as CPython checks
+        if (offset > sb.st_size || (length == 0 && offset == sb.st_size)) {
+            mp_raise_ValueError(MP_ERROR_TEXT("mmap offset is greater than file size"));
+        }
+        if (length == 0) {
+            // Map from offset to the end of the file
+            length = sb.st_size - offset;
+        } else if (length > sb.st_size - offset) {
+            mp_raise_ValueError(MP_ERROR_TEXT("mmap length is greater than file size"));
+        }
+    }
+
+    void *data = mmap(NULL, length, prot, flags, fd, offset);
+    if (data == MAP_FAILED) {
+        mp_raise_OSError(errno);
+    }
+
+    mp_obj_mmap_t *o = m_new_obj_with_finaliser(mp_obj_mmap_t);
+    o->base.type = type;
+    o->data = data;
+    o->len = length;
+    o->prot = prot;
+    o->exported = false;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+STATIC mp_obj_t mmap_close(mp_obj_t self_in) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->data != NULL) {
+        if (self->exported) {
+            // Views may still point into the mapping, so keep the address
+            // range valid; if this fails the file mapping is simply kept.
+            mmap(self->data, self->len, self->prot,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+        } else {
+            munmap(self->data, self->len);
+        }
+        self->data = NULL;
+        self->len = 0;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mmap_close_obj, mmap_close);
+
+STATIC mp_obj_t mmap___del__(mp_obj_t self_in) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!self->exported) {
+        // Nothing else can refer to the mapping
+        mmap_close(self_in);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mmap___del___obj, mmap___del__);
+
+STATIC mp_obj_t mmap___exit__(size_t n_args, const mp_obj_t *args) {
+    (void)n_args;
+    return mmap_close(args[0]);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mmap___exit___obj, 4, 4, mmap___exit__);
+
+// Convert optional (start, length) arguments to a page-aligned range.
+STATIC void mmap_get_range(mp_obj_mmap_t *self, size_t n_args, const mp_obj_t *args, byte **start, size_t *len) {
+    size_t offset = 0;
+    size_t size = self->len;
+    if (n_args > 0) {
+        offset = mp_obj_get_int(args[0]);
+        size = n_args > 1 ? (size_t)mp_obj_get_int(args[1]) : self->len - offset;
+        if (offset > self->len || size > self->len - offset) {
+            mp_raise_ValueError(NULL);
+        }
+    }
+    // The kernel requires the start address to be page aligned
+    size_t page_mask = sysconf(_SC_PAGESIZE) - 1;
+    size_t skew = ((uintptr_t)(self->data + offset)) & page_mask;
+    *start = self->data + offset - skew;
+    *len = size + skew;
+}
+
+// flush([offset[, size]])
+STATIC mp_obj_t mmap_flush(size_t n_args, const mp_obj_t *args) {
+    mp_obj_mmap_t *self = mmap_get_open(args[0]);
+    byte *start;
+    size_t len;
+    mmap_get_range(self, n_args - 1, args + 1, &start, &len);
+    int ret;
+    MP_HAL_RETRY_SYSCALL(ret, msync(start, len, MS_SYNC), mp_raise_OSError(err));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mmap_flush_obj, 1, 3, mmap_flush);
+
+// madvise(option[, start[, length]])
+STATIC mp_obj_t mmap_madvise(size_t n_args, const mp_obj_t *args) {
+    mp_obj_mmap_t *self = mmap_get_open(args[0]);
+    int advice = mp_obj_get_int(args[1]);
+    byte *start;
+    size_t len;
+    mmap_get_range(self, n_args - 2, args + 2, &start, &len);
+    if (madvise(start, len, advice) != 0) {
+        mp_raise_OSError(errno);
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mmap_madvise_obj, 2, 4, mmap_madvise);
+
+STATIC mp_obj_t mmap_unary_op(mp_unary_op_t op, mp_obj_t self_in) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    switch (op) {
+        case MP_UNARY_OP_BOOL:
+            return mp_obj_new_bool(self->len != 0);
+        case MP_UNARY_OP_LEN:
+            return MP_OBJ_NEW_SMALL_INT(self->len);
+        default:
+            return MP_OBJ_NULL; // op not supported
+    }
+}
+
+STATIC mp_obj_t mmap_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value) {
+    mp_obj_mmap_t *self = mmap_get_open(self_in);
+    if (value == MP_OBJ_NULL) {
+        // delete
+        return MP_OBJ_NULL; // op not supported
+    }
+    #if MICROPY_PY_BUILTINS_SLICE
+    if (mp_obj_is_type(index, &mp_type_slice)) {
+        mp_bound_slice_t slice;
+        if (!mp_seq_get_fast_slice_indexes(self->len, index, &slice)) {
+            mp_raise_NotImplementedError(MP_ERROR_TEXT("only slices with step=1 (aka None) are supported"));
+        }
+        if (value == MP_OBJ_SENTINEL) {
+            // load
+            return mp_obj_new_bytes(self->data + slice.start, slice.stop - slice.start);
+        }
+        // store
+        if (!(self->prot & PROT_WRITE)) {
+            mp_raise_TypeError(MP_ERROR_TEXT("mmap is read-only"));
+        }
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(value, &bufinfo, MP_BUFFER_READ);
+        if (bufinfo.len != (size_t)(slice.stop - slice.start)) {
+            mp_raise_ValueError(MP_ERROR_TEXT("mmap slice assignment is wrong size"));
+        }
+        memcpy(self->data + slice.start, bufinfo.buf, bufinfo.len);
+        return mp_const_none;
+    }
+    #endif
+    size_t i = mp_get_index(self->base.type, self->len, index, false);
+    if (value == MP_OBJ_SENTINEL) {
+        // load
+        return MP_OBJ_NEW_SMALL_INT(self->data[i]);
+    }
+    // store
+    if (!(self->prot & PROT_WRITE)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("mmap is read-only"));
+    }
+    self->data[i] = mp_obj_get_int(value);
+    return mp_const_none;
+}
+
+STATIC mp_int_t mmap_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+    mp_obj_mmap_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->data == NULL || ((flags & MP_BUFFER_WRITE) && !(self->prot & PROT_WRITE))) {
+        return 1;
+    }
+    bufinfo->buf = self->data;
+    bufinfo->len = self->len;
+    bufinfo->typecode = 'B';
+    self->exported = true;
+    return 0;
+}
+
+STATIC const mp_rom_map_elem_t mmap_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&mmap___del___obj) },
+    { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mmap_close_obj) },
+    { MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&mmap_flush_obj) },
+    { MP_ROM_QSTR(MP_QSTR_madvise), MP_ROM_PTR(&mmap_madvise_obj) },
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&mp_identity_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&mmap___exit___obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(mmap_locals_dict, mmap_locals_dict_table);
+
+STATIC const mp_obj_type_t mmap_type = {
+    { &mp_type_type },
+    .name = MP_QSTR_mmap,
+    .print = mmap_print,
+    .make_new = mmap_make_new,
+    .unary_op = mmap_unary_op,
+    .subscr = mmap_subscr,
+    .buffer_p = { .get_buffer = mmap_get_buffer },
+    .locals_dict = (void *)&mmap_locals_dict,
+};
+
+STATIC const mp_rom_map_elem_t mp_module_mmap_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_mmap) },
+    { MP_ROM_QSTR(MP_QSTR_mmap), MP_ROM_PTR(&mmap_type) },
+
+    { MP_ROM_QSTR(MP_QSTR_ACCESS_DEFAULT), MP_ROM_INT(ACCESS_DEFAULT) },
+    { MP_ROM_QSTR(MP_QSTR_ACCESS_READ), MP_ROM_INT(ACCESS_READ) },
+    { MP_ROM_QSTR(MP_QSTR_ACCESS_WRITE), MP_ROM_INT(ACCESS_WRITE) },
+    { MP_ROM_QSTR(MP_QSTR_ACCESS_COPY), MP_ROM_INT(ACCESS_COPY) },
+    { MP_ROM_QSTR(MP_QSTR_MAP_SHARED), MP_ROM_INT(MAP_SHARED) },
+    { MP_ROM_QSTR(MP_QSTR_MAP_PRIVATE), MP_ROM_INT(MAP_PRIVATE) },
+    { MP_ROM_QSTR(MP_QSTR_PROT_READ), MP_ROM_INT(PROT_READ) },
+    { MP_ROM_QSTR(MP_QSTR_PROT_WRITE), MP_ROM_INT(PROT_WRITE) },
+    { MP_ROM_QSTR(MP_QSTR_MADV_NORMAL), MP_ROM_INT(MADV_NORMAL) },
+    { MP_ROM_QSTR(MP_QSTR_MADV_RANDOM), MP_ROM_INT(MADV_RANDOM) },
+    { MP_ROM_QSTR(MP_QSTR_MADV_SEQUENTIAL), MP_ROM_INT(MADV_SEQUENTIAL) },
+    { MP_ROM_QSTR(MP_QSTR_MADV_WILLNEED), MP_ROM_INT(MADV_WILLNEED) },
+    { MP_ROM_QSTR(MP_QSTR_MADV_DONTNEED), MP_ROM_INT(MADV_DONTNEED) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_module_mmap_globals, mp_module_mmap_globals_table);
+
+const mp_obj_module_t mp_module_mmap = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t *)&mp_module_mmap_globals,
+};
+
+#endif // MICROPY_PY_MMAP
@@ -46,6 +46,7 @@
 #include "py/builtin.h"
 #include "py/mphal.h"
 #include "py/mpthread.h"
+#include "extmod/socket_stats.h"
 
 /*
   The idea of this module is to implement reasonable minimum of
@@ -68,6 +69,9 @@ typedef struct _mp_obj_socket_t {
     mp_obj_base_t base;
     int fd;
     bool blocking;
+    #if MICROPY_PY_USOCKET_STATS
+    mp_socket_stats_t stats;
+    #endif
 } mp_obj_socket_t;
 
 const mp_obj_type_t mp_type_socket;
@@ -82,6 +86,9 @@ STATIC mp_obj_socket_t *socket_new(int fd) {
     o->base.type = &mp_type_socket;
     o->fd = fd;
     o->blocking = true;
+    #if MICROPY_PY_USOCKET_STATS
+    memset(&o->stats, 0, sizeof(o->stats));
+    #endif
     return o;
 }
 
@@ -95,6 +102,7 @@ STATIC void socket_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kin
 STATIC mp_uint_t socket_read(mp_obj_t o_in, void *buf, mp_uint_t size, int *errcode) {
     mp_obj_socket_t *o = MP_OBJ_TO_PTR(o_in);
     ssize_t r;
+    MP_SOCKET_STATS_START(o->blocking);
     MP_HAL_RETRY_SYSCALL(r, read(o->fd, buf, size), {
         // On blocking socket, we get EAGAIN in case SO_RCVTIMEO/SO_SNDTIMEO
         // timed out, and need to convert that to ETIMEDOUT.
@@ -102,15 +110,18 @@ STATIC mp_uint_t socket_read(mp_obj_t o_in, void *buf, mp_uint_t size, int *errc
             err = MP_ETIMEDOUT;
         }
 
+        MP_SOCKET_STATS_RECORD(&o->stats, MP_SOCKET_STATS_IN, -1, err);
         *errcode = err;
         return MP_STREAM_ERROR;
     });
+    MP_SOCKET_STATS_RECORD(&o->stats, MP_SOCKET_STATS_IN, r, 0);
     return (mp_uint_t)r;
 }
 
 STATIC mp_uint_t socket_write(mp_obj_t o_in, const void *buf, mp_uint_t size, int *errcode) {
     mp_obj_socket_t *o = MP_OBJ_TO_PTR(o_in);
     ssize_t r;
+    MP_SOCKET_STATS_START(o->blocking);
     MP_HAL_RETRY_SYSCALL(r, write(o->fd, buf, size), {
         // On blocking socket, we get EAGAIN in case SO_RCVTIMEO/SO_SNDTIMEO
         // timed out, and need to convert that to ETIMEDOUT.
@@ -118,9 +129,11 @@ STATIC mp_uint_t socket_write(mp_obj_t o_in, const void *buf, mp_uint_t size, in
             err = MP_ETIMEDOUT;
         }
 
+        MP_SOCKET_STATS_RECORD(&o->stats, MP_SOCKET_STATS_OUT, -1, err);
         *errcode = err;
         return MP_STREAM_ERROR;
     });
+    MP_SOCKET_STATS_RECORD(&o->stats, MP_SOCKET_STATS_OUT, r, 0);
     return (mp_uint_t)r;
 }
 
@@ -245,7 +258,12 @@ STATIC mp_obj_t socket_recv(size_t n_args, const mp_obj_t *args) {
 
     byte *buf = m_new(byte, sz);
     ssize_t out_sz;
-    MP_HAL_RETRY_SYSCALL(out_sz, recv(self->fd, buf, sz, flags), mp_raise_OSError(err));
+    MP_SOCKET_STATS_START(self->blocking);
+    MP_HAL_RETRY_SYSCALL(out_sz, recv(self->fd, buf, sz, flags), {
+        MP_SOCKET_STATS_RECORD(&self->stats, MP_SOCKET_STATS_IN, -1, err);
+        mp_raise_OSError(err);
+    });
+    MP_SOCKET_STATS_RECORD(&self->stats, MP_SOCKET_STATS_IN, out_sz, 0);
     mp_obj_t ret = mp_obj_new_str_of_type(&mp_type_bytes, buf, out_sz);
     m_del(char, buf, sz);
     return ret;
@@ -266,8 +284,12 @@ STATIC mp_obj_t socket_recvfrom(size_t n_args, const mp_obj_t *args) {
 
     byte *buf = m_new(byte, sz);
     ssize_t out_sz;
-    MP_HAL_RETRY_SYSCALL(out_sz, recvfrom(self->fd, buf, sz, flags, (struct sockaddr *)&addr, &addr_len),
-        mp_raise_OSError(err));
+    MP_SOCKET_STATS_START(self->blocking);
+    MP_HAL_RETRY_SYSCALL(out_sz, recvfrom(self->fd, buf, sz, flags, (struct sockaddr *)&addr, &addr_len), {
+        MP_SOCKET_STATS_RECORD(&self->stats, MP_SOCKET_STATS_IN, -1, err);
+        mp_raise_OSError(err);
+    });
+    MP_SOCKET_STATS_RECORD(&self->stats, MP_SOCKET_STATS_IN, out_sz, 0);
     mp_obj_t buf_o = mp_obj_new_str_of_type(&mp_type_bytes, buf, out_sz);
     m_del(char, buf, sz);
 
@@ -293,8 +315,12 @@ STATIC mp_obj_t socket_send(size_t n_args, const mp_obj_t *args) {
     mp_buffer_info_t bufinfo;
     mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
     ssize_t out_sz;
-    MP_HAL_RETRY_SYSCALL(out_sz, send(self->fd, bufinfo.buf, bufinfo.len, flags),
-        mp_raise_OSError(err));
+    MP_SOCKET_STATS_START(self->blocking);
+    MP_HAL_RETRY_SYSCALL(out_sz, send(self->fd, bufinfo.buf, bufinfo.len, flags), {
+        MP_SOCKET_STATS_RECORD(&self->stats, MP_SOCKET_STATS_OUT, -1, err);
+        mp_raise_OSError(err);
+    });
+    MP_SOCKET_STATS_RECORD(&self->stats, MP_SOCKET_STATS_OUT, out_sz, 0);
     return MP_OBJ_NEW_SMALL_INT(out_sz);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_send_obj, 2, 3, socket_send);
@@ -313,8 +339,13 @@ STATIC mp_obj_t socket_sendto(size_t n_args, const mp_obj_t *args) {
     mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
     mp_get_buffer_raise(dst_addr, &addr_bi, MP_BUFFER_READ);
     ssize_t out_sz;
+    MP_SOCKET_STATS_START(self->blocking);
     MP_HAL_RETRY_SYSCALL(out_sz, sendto(self->fd, bufinfo.buf, bufinfo.len, flags,
-        (struct sockaddr *)addr_bi.buf, addr_bi.len), mp_raise_OSError(err));
+        (struct sockaddr *)addr_bi.buf, addr_bi.len), {
+        MP_SOCKET_STATS_RECORD(&self->stats, MP_SOCKET_STATS_OUT, -1, err);
+        mp_raise_OSError(err);
+    });
+    MP_SOCKET_STATS_RECORD(&self->stats, MP_SOCKET_STATS_OUT, out_sz, 0);
     return MP_OBJ_NEW_SMALL_INT(out_sz);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_sendto_obj, 3, 4, socket_sendto);
@@ -425,6 +456,14 @@ STATIC mp_obj_t socket_makefile(size_t n_args, const mp_obj_t *args) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_makefile_obj, 1, 3, socket_makefile);
 
+#if MICROPY_PY_USOCKET_STATS
+STATIC mp_obj_t socket_stats(size_t n_args, const mp_obj_t *args) {
+    mp_obj_socket_t *self = MP_OBJ_TO_PTR(args[0]);
+    return mp_socket_stats_get(&self->stats, n_args - 1, args + 1);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(socket_stats_obj, 1, 2, socket_stats);
+#endif
+
 STATIC mp_obj_t socket_make_new(const mp_obj_type_t *type_in, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     (void)type_in;
     (void)n_kw;
@@ -471,6 +510,9 @@ STATIC const mp_rom_map_elem_t usocket_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR_setsockopt), MP_ROM_PTR(&socket_setsockopt_obj) },
     { MP_ROM_QSTR(MP_QSTR_setblocking), MP_ROM_PTR(&socket_setblocking_obj) },
     { MP_ROM_QSTR(MP_QSTR_settimeout), MP_ROM_PTR(&socket_settimeout_obj) },
+    #if MICROPY_PY_USOCKET_STATS
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&socket_stats_obj) },
+    #endif
     { MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&mp_stream_close_obj) },
 };
 
@@ -642,6 +684,9 @@ STATIC const mp_rom_map_elem_t mp_module_socket_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_inet_pton), MP_ROM_PTR(&mod_socket_inet_pton_obj) },
     { MP_ROM_QSTR(MP_QSTR_inet_ntop), MP_ROM_PTR(&mod_socket_inet_ntop_obj) },
     { MP_ROM_QSTR(MP_QSTR_sockaddr), MP_ROM_PTR(&mod_socket_sockaddr_obj) },
+    #if MICROPY_PY_USOCKET_STATS
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&mp_socket_stats_global_obj) },
+    #endif
 
 #define C(name) { MP_ROM_QSTR(MP_QSTR_##name), MP_ROM_INT(name) }
     C(AF_UNIX),
@@ -82,9 +82,17 @@
 #ifndef MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE
 #define MICROPY_OPT_CACHE_MAP_LOOKUP_IN_BYTECODE (1)
 #endif
+#ifndef MICROPY_OPT_CRC_SLICE8
+#define MICROPY_OPT_CRC_SLICE8      (1)
+#endif
+#ifndef MICROPY_OPT_UZLIB_FAST_BITS
+#define MICROPY_OPT_UZLIB_FAST_BITS (9)
+#endif
 #define MICROPY_MODULE_WEAK_LINKS   (1)
 #define MICROPY_CAN_OVERRIDE_BUILTINS (1)
 #define MICROPY_VFS_POSIX_FILE      (1)
+#define MICROPY_VFS_BLOCKDEV_CACHE  (1)
+#define MICROPY_VFS_LFS_CACHE       (1)
 #define MICROPY_PY_FUNCTION_ATTRS   (1)
 #define MICROPY_PY_DESCRIPTORS      (1)
 #define MICROPY_PY_DELATTR_SETATTR  (1)
@@ -143,23 +151,43 @@
 #define MICROPY_PY_UERRNO           (1)
 #define MICROPY_PY_UCTYPES          (1)
 #define MICROPY_PY_UZLIB            (1)
+#define MICROPY_PY_UZLIB_COMPRESS   (1)
 #define MICROPY_PY_UJSON            (1)
+#define MICROPY_PY_UJSON_ITERLOAD   (1)
 #define MICROPY_PY_URE              (1)
+#define MICROPY_PY_URE_CACHE_SIZE   (8)
+#define MICROPY_PY_URE_FINDITER     (1)
+#ifndef MICROPY_PY_URE_PIKEVM
+#define MICROPY_PY_URE_PIKEVM       (1)
+#endif
 #define MICROPY_PY_UHEAPQ           (1)
 #define MICROPY_PY_UTIMEQ           (1)
 #define MICROPY_PY_UHASHLIB         (1)
+#define MICROPY_PY_UHASHLIB_HMAC    (1)
 #if MICROPY_PY_USSL
 #define MICROPY_PY_UHASHLIB_MD5     (1)
 #define MICROPY_PY_UHASHLIB_SHA1    (1)
-#define MICROPY_PY_UCRYPTOLIB       (1)
 #endif
+#define MICROPY_PY_UCRYPTOLIB       (1)
+#define MICROPY_PY_UCRYPTOLIB_GCM   (1)
+#define MICROPY_PY_UCRYPTOLIB_CHACHA20_POLY1305 (1)
 #define MICROPY_PY_UBINASCII        (1)
 #define MICROPY_PY_UBINASCII_CRC32  (1)
+#define MICROPY_PY_UBINASCII_CRC32C (1)
+#define MICROPY_PY_UBINASCII_CRC16  (1)
+#define MICROPY_PY_UBINASCII_INTO   (1)
+#define MICROPY_PY_UBINASCII_STREAM (1)
 #define MICROPY_PY_URANDOM          (1)
+#define MICROPY_PY_URANDOM_BULK     (1)
 #ifndef MICROPY_PY_USELECT_POSIX
 #define MICROPY_PY_USELECT_POSIX    (1)
 #endif
 #define MICROPY_PY_UWEBSOCKET       (1)
+#define MICROPY_PY_UHTTP            (1)
+#define MICROPY_PY_UMQTTCODEC       (1)
+#define MICROPY_PY_UMSGPACK         (1)
+#define MICROPY_PY_ULZ4             (1)
+#define MICROPY_PY_UTIMESERIES      (1)
 #define MICROPY_PY_MACHINE          (1)
 #define MICROPY_PY_MACHINE_PULSE    (1)
 #define MICROPY_MACHINE_MEM_GET_READ_ADDR   mod_machine_mem_get_addr
@@ -202,6 +230,7 @@ extern const struct _mp_obj_module_t mp_module_uselect;
 extern const struct _mp_obj_module_t mp_module_time;
 extern const struct _mp_obj_module_t mp_module_termios;
 extern const struct _mp_obj_module_t mp_module_socket;
+extern const struct _mp_obj_module_t mp_module_mmap;
 extern const struct _mp_obj_module_t mp_module_ffi;
 extern const struct _mp_obj_module_t mp_module_jni;
 
@@ -235,6 +264,11 @@ extern const struct _mp_obj_module_t mp_module_jni;
 #else
 #define MICROPY_PY_SOCKET_DEF
 #endif
+#if MICROPY_PY_MMAP
+#define MICROPY_PY_MMAP_DEF { MP_ROM_QSTR(MP_QSTR_mmap), MP_ROM_PTR(&mp_module_mmap) },
+#else
+#define MICROPY_PY_MMAP_DEF
+#endif
 #if MICROPY_PY_USELECT_POSIX
 #define MICROPY_PY_USELECT_DEF { MP_ROM_QSTR(MP_QSTR_uselect), MP_ROM_PTR(&mp_module_uselect) },
 #else
@@ -250,6 +284,7 @@ extern const struct _mp_obj_module_t mp_module_jni;
     MICROPY_PY_UOS_DEF \
     MICROPY_PY_USELECT_DEF \
     MICROPY_PY_TERMIOS_DEF \
+    MICROPY_PY_MMAP_DEF \
 
 // type definitions for the specific machine
 
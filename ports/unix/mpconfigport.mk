@@ -20,6 +20,9 @@ MICROPY_PY_TERMIOS = 1
 # Subset of CPython socket module
 MICROPY_PY_SOCKET = 1
 
+# Subset of CPython mmap module
+MICROPY_PY_MMAP = 1
+
 # ffi module requires libffi (libffi-dev Debian package)
 MICROPY_PY_FFI = 1
 
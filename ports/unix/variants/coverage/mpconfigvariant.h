@@ -54,9 +54,15 @@
 #define MICROPY_PY_IO_RESOURCE_STREAM (1)
 #define MICROPY_PY_UASYNCIO            (1)
 #define MICROPY_PY_URE_DEBUG           (1)
+// use the backtracking matcher so that it stays covered; the 32-bit CI build
+// overrides this to test the Pike VM with groups and sub enabled
+#ifndef MICROPY_PY_URE_PIKEVM
+#define MICROPY_PY_URE_PIKEVM          (0)
+#endif
 #define MICROPY_PY_URE_MATCH_GROUPS    (1)
 #define MICROPY_PY_URE_MATCH_SPAN_START_END (1)
 #define MICROPY_PY_URE_SUB             (1)
+#define MICROPY_PY_USOCKET_STATS       (1)
 #define MICROPY_VFS_POSIX              (1)
 #define MICROPY_PY_FRAMEBUF            (1)
 #define MICROPY_PY_COLLECTIONS_NAMEDTUPLE__ASDICT (1)
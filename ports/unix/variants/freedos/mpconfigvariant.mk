@@ -18,3 +18,4 @@ MICROPY_PY_JNI = 0
 MICROPY_PY_BTREE = 0
 MICROPY_PY_THREAD = 0
 MICROPY_PY_USSL = 0
+MICROPY_PY_MMAP = 0
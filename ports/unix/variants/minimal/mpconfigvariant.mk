@@ -10,4 +10,5 @@ MICROPY_PY_SOCKET = 0
 MICROPY_PY_THREAD = 0
 MICROPY_PY_TERMIOS = 0
 MICROPY_PY_USSL = 0
+MICROPY_PY_MMAP = 0
 MICROPY_USE_READLINE = 0
@@ -120,6 +120,11 @@ extern const mp_obj_module_t mp_module_utimeq;
 extern const mp_obj_module_t mp_module_machine;
 extern const mp_obj_module_t mp_module_lwip;
 extern const mp_obj_module_t mp_module_uwebsocket;
+extern const mp_obj_module_t mp_module_uhttp;
+extern const mp_obj_module_t mp_module_umqttcodec;
+extern const mp_obj_module_t mp_module_umsgpack;
+extern const mp_obj_module_t mp_module_ulz4;
+extern const mp_obj_module_t mp_module_utimeseries;
 extern const mp_obj_module_t mp_module_webrepl;
 extern const mp_obj_module_t mp_module_framebuf;
 extern const mp_obj_module_t mp_module_btree;
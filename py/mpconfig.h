@@ -503,6 +503,19 @@
 #define MICROPY_OPT_MPZ_BITWISE (0)
 #endif
 
+// Whether to compute CRCs (in uzlib and ubinascii) 8 bytes at a time using
+// 8 lookup tables per CRC, rather than using small tables a nibble at a time.
+// Roughly 5x faster, but each CRC32 variant then needs 8KiB of tables.
+#ifndef MICROPY_OPT_CRC_SLICE8
+#define MICROPY_OPT_CRC_SLICE8 (0)
+#endif
+
+// Number of bits of Huffman code that uzlib decodes with a lookup table rather
+// than bit by bit, or 0 to decode bit by bit.  Inflating is much faster
+// with 9 bits, but each decompressor then needs 2KiB more RAM for the tables.
+#ifndef MICROPY_OPT_UZLIB_FAST_BITS
+#define MICROPY_OPT_UZLIB_FAST_BITS (0)
+#endif
 
 // Whether math.factorial is large, fast and recursive (1) or small and slow (0).
 #ifndef MICROPY_OPT_MATH_FACTORIAL
@@ -833,6 +846,17 @@ typedef double mp_float_t;
 #define MICROPY_VFS_FAT (0)
 #endif
 
+// Support for a write-back cache of single blocks in the VFS block device
+// layer, used by the FAT VFS component
+#ifndef MICROPY_VFS_BLOCKDEV_CACHE
+#define MICROPY_VFS_BLOCKDEV_CACHE (0)
+#endif
+
+// Support for an LRU block cache, with read-ahead, in the littlefs VFS components
+#ifndef MICROPY_VFS_LFS_CACHE
+#define MICROPY_VFS_LFS_CACHE (0)
+#endif
+
 /*****************************************************************************/
 /* Fine control over Python builtins, classes, modules, etc                  */
 
@@ -1361,10 +1385,20 @@ typedef double mp_float_t;
 #define MICROPY_PY_UZLIB (0)
 #endif
 
+// Whether to provide compression functions in uzlib
+#ifndef MICROPY_PY_UZLIB_COMPRESS
+#define MICROPY_PY_UZLIB_COMPRESS (0)
+#endif
+
 #ifndef MICROPY_PY_UJSON
 #define MICROPY_PY_UJSON (0)
 #endif
 
+// Whether to provide ujson.iterload and ujson.iterevents
+#ifndef MICROPY_PY_UJSON_ITERLOAD
+#define MICROPY_PY_UJSON_ITERLOAD (0)
+#endif
+
 #ifndef MICROPY_PY_URE
 #define MICROPY_PY_URE (0)
 #endif
@@ -1385,6 +1419,24 @@ typedef double mp_float_t;
 #define MICROPY_PY_URE_SUB (0)
 #endif
 
+// Whether to provide the regex.finditer and regex.spans_into methods
+#ifndef MICROPY_PY_URE_FINDITER
+#define MICROPY_PY_URE_FINDITER (0)
+#endif
+
+// Whether ure runs patterns with a Pike VM, which takes time linear in the
+// length of the subject and uses a bounded amount of C stack, rather than a
+// recursive backtracking matcher, which is smaller and uses no heap
+#ifndef MICROPY_PY_URE_PIKEVM
+#define MICROPY_PY_URE_PIKEVM (0)
+#endif
+
+// Number of patterns compiled by the ure module-level functions (match, search,
+// split, sub) to keep for reuse; 0 disables the cache
+#ifndef MICROPY_PY_URE_CACHE_SIZE
+#define MICROPY_PY_URE_CACHE_SIZE (0)
+#endif
+
 #ifndef MICROPY_PY_UHEAPQ
 #define MICROPY_PY_UHEAPQ (0)
 #endif
@@ -1410,6 +1462,11 @@ typedef double mp_float_t;
 #define MICROPY_PY_UHASHLIB_SHA256 (1)
 #endif
 
+// Whether to provide uhashlib.hmac and uhashlib.pbkdf2_hmac, for SHA-256
+#ifndef MICROPY_PY_UHASHLIB_HMAC
+#define MICROPY_PY_UHASHLIB_HMAC (0)
+#endif
+
 #ifndef MICROPY_PY_UCRYPTOLIB
 #define MICROPY_PY_UCRYPTOLIB (0)
 #endif
@@ -1423,6 +1480,24 @@ typedef double mp_float_t;
 #define MICROPY_PY_UCRYPTOLIB_CONSTS (0)
 #endif
 
+// Whether to provide AES in GCM mode (authenticated encryption)
+// Depends on MICROPY_PY_UCRYPTOLIB
+#ifndef MICROPY_PY_UCRYPTOLIB_GCM
+#define MICROPY_PY_UCRYPTOLIB_GCM (0)
+#endif
+
+// Whether to provide the ChaCha20-Poly1305 authenticated cipher
+// Depends on MICROPY_PY_UCRYPTOLIB
+#ifndef MICROPY_PY_UCRYPTOLIB_CHACHA20_POLY1305
+#define MICROPY_PY_UCRYPTOLIB_CHACHA20_POLY1305 (0)
+#endif
+
+// Whether ucryptolib uses its own (table-based) AES implementation, which it
+// must when there's no SSL library to provide one
+#ifndef MICROPY_PY_UCRYPTOLIB_AES_BUILTIN
+#define MICROPY_PY_UCRYPTOLIB_AES_BUILTIN (!MICROPY_SSL_AXTLS && !MICROPY_SSL_MBEDTLS)
+#endif
+
 #ifndef MICROPY_PY_UBINASCII
 #define MICROPY_PY_UBINASCII (0)
 #endif
@@ -1432,6 +1507,26 @@ typedef double mp_float_t;
 #define MICROPY_PY_UBINASCII_CRC32 (0)
 #endif
 
+// Whether to provide ubinascii.crc32c (Castagnoli polynomial)
+#ifndef MICROPY_PY_UBINASCII_CRC32C
+#define MICROPY_PY_UBINASCII_CRC32C (0)
+#endif
+
+// Whether to provide ubinascii.crc_hqx and ubinascii.crc16_modbus
+#ifndef MICROPY_PY_UBINASCII_CRC16
+#define MICROPY_PY_UBINASCII_CRC16 (0)
+#endif
+
+// Whether to provide the ubinascii *_into functions, which write to a buffer
+#ifndef MICROPY_PY_UBINASCII_INTO
+#define MICROPY_PY_UBINASCII_INTO (0)
+#endif
+
+// Whether to provide the ubinascii Base64Encoder and Base64Decoder streams
+#ifndef MICROPY_PY_UBINASCII_STREAM
+#define MICROPY_PY_UBINASCII_STREAM (0)
+#endif
+
 #ifndef MICROPY_PY_URANDOM
 #define MICROPY_PY_URANDOM (0)
 #endif
@@ -1441,6 +1536,11 @@ typedef double mp_float_t;
 #define MICROPY_PY_URANDOM_EXTRA_FUNCS (0)
 #endif
 
+// Whether to include: jump, randbytes, fill_into, uniform_into
+#ifndef MICROPY_PY_URANDOM_BULK
+#define MICROPY_PY_URANDOM_BULK (0)
+#endif
+
 #ifndef MICROPY_PY_MACHINE
 #define MICROPY_PY_MACHINE (0)
 #endif
@@ -1464,10 +1564,43 @@ typedef double mp_float_t;
 #define MICROPY_PY_USSL_FINALISER (0)
 #endif
 
+// Whether to keep per-socket and global traffic counters (see extmod/socket_stats.h)
+#ifndef MICROPY_PY_USOCKET_STATS
+#define MICROPY_PY_USOCKET_STATS (0)
+#endif
+
 #ifndef MICROPY_PY_UWEBSOCKET
 #define MICROPY_PY_UWEBSOCKET (0)
 #endif
 
+#ifndef MICROPY_PY_UHTTP
+#define MICROPY_PY_UHTTP (0)
+#endif
+
+#ifndef MICROPY_PY_UMQTTCODEC
+#define MICROPY_PY_UMQTTCODEC (0)
+#endif
+
+#ifndef MICROPY_PY_UMSGPACK
+#define MICROPY_PY_UMSGPACK (0)
+#endif
+
+#ifndef MICROPY_PY_ULZ4
+#define MICROPY_PY_ULZ4 (0)
+#endif
+
+// Whether to provide the "utimeseries" module; timestamps are 64-bit so this
+// needs long int support, and it needs MICROPY_PY_ARRAY
+#ifndef MICROPY_PY_UTIMESERIES
+#define MICROPY_PY_UTIMESERIES (0)
+#endif
+
+// Number of bits of the hash of 4 bytes that ulz4 uses to find matches; the
+// compressor's hash table takes 2 * 2**bits bytes
+#ifndef MICROPY_PY_ULZ4_HASH_BITS
+#define MICROPY_PY_ULZ4_HASH_BITS (10)
+#endif
+
 #ifndef MICROPY_PY_FRAMEBUF
 #define MICROPY_PY_FRAMEBUF (0)
 #endif
@@ -198,10 +198,20 @@ typedef struct _mp_state_vm_t {
     mp_obj_t bluetooth;
     #endif
 
+    #if MICROPY_PY_URE && MICROPY_PY_URE_CACHE_SIZE > 0
+    // compiled patterns of the ure module-level functions, most recent first
+    mp_obj_t ure_cache[MICROPY_PY_URE_CACHE_SIZE];
+    #endif
+
     //
     // END ROOT POINTER SECTION
     ////////////////////////////////////////////////////////////
 
+    #if MICROPY_PY_URE && MICROPY_PY_URE_CACHE_SIZE > 0
+    size_t ure_cache_hits;
+    size_t ure_cache_misses;
+    #endif
+
     // pointer and sizes to store interned string data
     // (qstr_last_chunk can be root pointer but is also stored in qstr pool)
     byte *qstr_last_chunk;
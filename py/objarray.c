@@ -209,6 +209,28 @@ mp_obj_t mp_obj_new_memoryview(byte typecode, size_t nitems, void *items) {
     return MP_OBJ_FROM_PTR(self);
 }
 
+// Create a byte memoryview of buf[start:start + len].  The view refers to the
+// start of buf's storage and keeps the slice as an offset, so that it holds a
+// proper reference to the storage (an interior pointer would not keep it alive).
+mp_obj_t mp_obj_new_memoryview_slice(mp_obj_t buf, size_t start, size_t len) {
+    mp_buffer_info_t bufinfo;
+    byte typecode = 'B';
+    if (mp_get_buffer(buf, &bufinfo, MP_BUFFER_RW)) {
+        typecode |= MP_OBJ_ARRAY_TYPECODE_FLAG_RW;
+    } else {
+        mp_get_buffer_raise(buf, &bufinfo, MP_BUFFER_READ);
+    }
+    void *items = bufinfo.buf;
+    if (mp_obj_is_type(buf, &mp_type_memoryview)) {
+        mp_obj_array_t *parent = MP_OBJ_TO_PTR(buf);
+        items = parent->items;
+        start += parent->memview_offset * mp_binary_get_size('@', parent->typecode & TYPECODE_MASK, NULL);
+    }
+    mp_obj_array_t *self = MP_OBJ_TO_PTR(mp_obj_new_memoryview(typecode, len, items));
+    self->memview_offset = start;
+    return MP_OBJ_FROM_PTR(self);
+}
+
 STATIC mp_obj_t memoryview_make_new(const mp_obj_type_t *type_in, size_t n_args, size_t n_kw, const mp_obj_t *args) {
     (void)type_in;
 
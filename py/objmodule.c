@@ -218,6 +218,21 @@ STATIC const mp_rom_map_elem_t mp_builtin_module_table[] = {
     #if MICROPY_PY_UWEBSOCKET
     { MP_ROM_QSTR(MP_QSTR_uwebsocket), MP_ROM_PTR(&mp_module_uwebsocket) },
     #endif
+    #if MICROPY_PY_UHTTP
+    { MP_ROM_QSTR(MP_QSTR_uhttp), MP_ROM_PTR(&mp_module_uhttp) },
+    #endif
+    #if MICROPY_PY_UMQTTCODEC
+    { MP_ROM_QSTR(MP_QSTR_umqttcodec), MP_ROM_PTR(&mp_module_umqttcodec) },
+    #endif
+    #if MICROPY_PY_UMSGPACK
+    { MP_ROM_QSTR(MP_QSTR_umsgpack), MP_ROM_PTR(&mp_module_umsgpack) },
+    #endif
+    #if MICROPY_PY_ULZ4
+    { MP_ROM_QSTR(MP_QSTR_ulz4), MP_ROM_PTR(&mp_module_ulz4) },
+    #endif
+    #if MICROPY_PY_UTIMESERIES
+    { MP_ROM_QSTR(MP_QSTR_utimeseries), MP_ROM_PTR(&mp_module_utimeseries) },
+    #endif
     #if MICROPY_PY_WEBREPL
     { MP_ROM_QSTR(MP_QSTR__webrepl), MP_ROM_PTR(&mp_module_webrepl) },
     #endif
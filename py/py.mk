@@ -196,6 +196,12 @@ PY_EXTMOD_O_BASENAME = \
 	extmod/modurandom.o \
 	extmod/moduselect.o \
 	extmod/moduwebsocket.o \
+	extmod/moduhttp.o \
+	extmod/modumqttcodec.o \
+	extmod/modumsgpack.o \
+	extmod/modulz4.o \
+	extmod/modutimeseries.o \
+	extmod/socket_stats.o \
 	extmod/modwebrepl.o \
 	extmod/modframebuf.o \
 	extmod/vfs.o \
@@ -116,6 +116,14 @@ void mp_init(void) {
     }
     #endif
 
+    #if MICROPY_PY_URE && MICROPY_PY_URE_CACHE_SIZE > 0
+    for (size_t i = 0; i < MICROPY_PY_URE_CACHE_SIZE; ++i) {
+        MP_STATE_VM(ure_cache[i]) = MP_OBJ_NULL;
+    }
+    MP_STATE_VM(ure_cache_hits) = 0;
+    MP_STATE_VM(ure_cache_misses) = 0;
+    #endif
+
     #if MICROPY_VFS
     // initialise the VFS sub-system
     MP_STATE_VM(vfs_cur) = NULL;
@@ -20,3 +20,6 @@ print(binascii.b2a_base64(b"\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f"))
 print(binascii.b2a_base64(b"\x7f\x80\xff"))
 print(binascii.b2a_base64(b"1234ABCDabcd"))
 print(binascii.b2a_base64(b"\x00\x00>"))  # convert into '+'
+
+print(binascii.b2a_base64(b"foobar", newline=False))
+print(binascii.b2a_base64(b"", newline=False))
@@ -0,0 +1,32 @@
+try:
+    import ubinascii as binascii
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+data = bytes(range(256)) * 4
+
+if hasattr(binascii, "crc32c"):
+    print(hex(binascii.crc32c(b"")))
+    print(hex(binascii.crc32c(b"123456789")))
+    print(hex(binascii.crc32c(b"\x00" * 32)))
+    print(hex(binascii.crc32c(b"\xff" * 32)))
+    print(hex(binascii.crc32c(b" over the lazy dog", binascii.crc32c(b"The quick brown fox jumps"))))
+    for n in (7, 8, 9, 15, 16, 17, 1024):
+        print(n, hex(binascii.crc32c(data[:n])), hex(binascii.crc32c(data[3 : 3 + n])))
+else:
+    print("SKIP crc32c")
+
+if hasattr(binascii, "crc_hqx"):
+    print(hex(binascii.crc_hqx(b"123456789", 0)))
+    print(hex(binascii.crc_hqx(b"123456789", 0xFFFF)))
+    print(hex(binascii.crc_hqx(b"56789", binascii.crc_hqx(b"1234", 0xFFFF))))
+    print(hex(binascii.crc_hqx(data, 0x1D0F)))
+    print(hex(binascii.crc16_modbus(b"")))
+    print(hex(binascii.crc16_modbus(b"123456789")))
+    print(hex(binascii.crc16_modbus(b"56789", binascii.crc16_modbus(b"1234"))))
+    # a Modbus RTU "read holding registers" request, CRC sent low byte first
+    print(hex(binascii.crc16_modbus(b"\x01\x03\x00\x00\x00\x0a")))
+    print(hex(binascii.crc16_modbus(data, 0)))
+else:
+    print("SKIP crc16")
@@ -22,3 +22,8 @@ print(hex(binascii.crc32(b" over the lazy dog", binascii.crc32(b"The quick brown
 print(hex(binascii.crc32(b"\x00" * 16, binascii.crc32(b"\x00" * 16))))
 print(hex(binascii.crc32(b"\xff" * 16, binascii.crc32(b"\xff" * 16))))
 print(hex(binascii.crc32(bytes(range(16, 32)), binascii.crc32(bytes(range(16))))))
+
+# lengths around the 8-byte blocks used by the fast implementation
+data = bytes(range(256)) * 4
+for n in (7, 8, 9, 15, 16, 17, 1024):
+    print(n, hex(binascii.crc32(data[:n])), hex(binascii.crc32(data[3 : 3 + n])))
@@ -0,0 +1,51 @@
+# test ubinascii *_into functions
+
+try:
+    import ubinascii as binascii
+
+    binascii.hexlify_into
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+buf = bytearray(16)
+
+print(binascii.hexlify_into(b"\x01\xab\xff", buf), buf[:6])
+print(binascii.hexlify_into(b"\x01\xab\xff", buf, ":"), buf[:8])
+print(binascii.hexlify_into(b"", buf))
+print(binascii.unhexlify_into(b"01abFF", buf), buf[:3])
+print(binascii.b2a_base64_into(b"foob", buf), buf[:9])
+print(binascii.b2a_base64_into(b"foob", buf, newline=False), buf[:8])
+print(binascii.a2b_base64_into(b"Zm9v\nYmFy", buf), buf[:6])
+
+# writing into part of a buffer
+m = memoryview(buf)
+print(binascii.hexlify_into(b"\x12", m[10:]), buf[10:12])
+
+# output that just fits, and output that doesn't
+for f, data, size in (
+    (binascii.hexlify_into, b"abc", 6),
+    (binascii.hexlify_into, b"abc", 5),
+    (binascii.unhexlify_into, b"616263", 3),
+    (binascii.unhexlify_into, b"616263", 2),
+    (binascii.b2a_base64_into, b"abc", 5),
+    (binascii.b2a_base64_into, b"abc", 4),
+    (binascii.a2b_base64_into, b"YWJj", 3),
+    (binascii.a2b_base64_into, b"YWJj", 2),
+    (binascii.a2b_base64_into, b"YWJjZA==", 3),
+):
+    try:
+        print(f(data, bytearray(size)))
+    except ValueError as er:
+        print("ValueError:", er)
+
+# invalid data
+for f, data in (
+    (binascii.unhexlify_into, b"abc"),
+    (binascii.unhexlify_into, b"zz"),
+    (binascii.a2b_base64_into, b"abc"),
+):
+    try:
+        f(data, buf)
+    except ValueError as er:
+        print("ValueError:", er)
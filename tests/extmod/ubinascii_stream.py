@@ -0,0 +1,58 @@
+# test ubinascii Base64Encoder and Base64Decoder
+
+try:
+    import ubinascii as binascii
+    import uio as io
+
+    binascii.Base64Encoder
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+data = bytes(range(256)) * 2
+
+# encode with writes of various sizes
+for size in (1, 2, 3, 7, 100, 1000):
+    out = io.BytesIO()
+    enc = binascii.Base64Encoder(out)
+    for i in range(0, len(data), size):
+        enc.write(data[i : i + size])
+    enc.close()
+    enc.close()
+    print(size, out.getvalue() == binascii.b2a_base64(data, newline=False))
+
+# flush doesn't write an incomplete group
+out = io.BytesIO()
+enc = binascii.Base64Encoder(out)
+enc.write(b"hello")
+enc.flush()
+print(out.getvalue())
+enc.close()
+print(out.getvalue())
+try:
+    enc.write(b"x")
+except OSError:
+    print("OSError")
+
+# decode with reads of various sizes, ignoring newlines
+encoded = binascii.b2a_base64(data)
+encoded = b"\n".join(encoded[i : i + 76] for i in range(0, len(encoded), 76))
+for size in (1, 2, 3, 7, 100, 1000):
+    dec = binascii.Base64Decoder(io.BytesIO(encoded))
+    res = b""
+    while True:
+        b = dec.read(size)
+        if not b:
+            break
+        res += b
+    print(size, res == data)
+
+# decoding stops at the end padding
+dec = binascii.Base64Decoder(io.BytesIO(b"aGVsbG8=\r\nd29ybGQ="))
+print(dec.read(), dec.read())
+
+# incomplete data
+try:
+    binascii.Base64Decoder(io.BytesIO(b"aGVsbG")).read()
+except OSError:
+    print("OSError")
@@ -0,0 +1,121 @@
+# test AES in GCM mode, with test cases from the GCM specification
+
+try:
+    from ucryptolib import aes
+    from ubinascii import unhexlify, hexlify
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+MODE_GCM = 11
+
+try:
+    aes(b"x" * 16, MODE_GCM, b"x" * 12).update
+except (ValueError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+K = unhexlify("feffe9928665731c6d6a8f9467308308")
+IV = unhexlify("cafebabefacedbaddecaf888")
+P = unhexlify(
+    "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+    "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255"
+)
+A = unhexlify("feedfacedeadbeeffeedfacedeadbeefabaddad2")
+
+
+def test(key, iv, plain, aad):
+    enc = aes(key, MODE_GCM, iv)
+    if aad:
+        enc.update(aad)
+    ct = enc.encrypt(plain)
+    tag = enc.digest()
+    print(hexlify(ct), hexlify(tag))
+    dec = aes(key, MODE_GCM, iv)
+    if aad:
+        dec.update(aad)
+    print(dec.decrypt(ct) == plain)
+    dec.verify(tag)
+
+
+# zero key and nonce, no data
+test(bytes(16), bytes(12), b"", b"")
+test(bytes(16), bytes(12), bytes(16), b"")
+
+# data with and without additional data
+test(K, IV, P, b"")
+test(K, IV, P[:60], A)
+
+# nonce of other than 96 bits
+test(K, unhexlify("cafebabefacedbad"), P[:60], A)
+
+# 256-bit key
+test(K + K, IV, P[:60], A)
+
+# streaming, in pieces which don't line up with blocks
+for n in (1, 7, 16, 33):
+    enc = aes(K, MODE_GCM, IV)
+    for i in range(0, len(A), n):
+        enc.update(A[i : i + n])
+    ct = b""
+    for i in range(0, 60, n):
+        ct += enc.encrypt(P[i : min(i + n, 60)])
+    print(n, hexlify(ct[-4:]), hexlify(enc.digest()))
+
+# encrypt into a buffer, then decrypt in place
+buf = bytearray(60)
+enc = aes(K, MODE_GCM, IV)
+enc.update(A)
+print(enc.encrypt(P[:60], buf) is buf)
+tag = enc.digest()
+dec = aes(K, MODE_GCM, IV)
+dec.update(A)
+dec.decrypt(buf, buf)
+dec.verify(tag)
+print(buf == P[:60])
+
+# tampered ciphertext, additional data and tag
+for ct, aad, t in (
+    (bytes([P[0] ^ 1]) + P[1:60], A, tag),
+    (P[:60], A[1:], tag),
+    (P[:60], A, tag[:15]),
+):
+    enc = aes(K, MODE_GCM, IV)
+    enc.update(A)
+    ct = enc.encrypt(ct)
+    dec = aes(K, MODE_GCM, IV)
+    dec.update(aad)
+    dec.decrypt(ct)
+    try:
+        dec.verify(t)
+    except ValueError as er:
+        print("ValueError", er)
+
+# misuse
+enc = aes(K, MODE_GCM, IV)
+enc.encrypt(b"a")
+try:
+    enc.update(b"a")
+except ValueError:
+    print("ValueError")
+try:
+    enc.verify(bytes(16))
+except ValueError:
+    print("ValueError")
+enc.digest()
+try:
+    enc.encrypt(b"a")
+except ValueError:
+    print("ValueError")
+try:
+    aes(K, MODE_GCM)
+except ValueError:
+    print("ValueError")
+try:
+    aes(K, MODE_GCM, b"")
+except ValueError:
+    print("ValueError")
+try:
+    aes(K, 1).digest()
+except ValueError:
+    print("ValueError")
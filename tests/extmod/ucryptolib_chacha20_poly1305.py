@@ -0,0 +1,82 @@
+# test ChaCha20-Poly1305, with the test vector from RFC 8439
+
+try:
+    from ucryptolib import chacha20_poly1305
+    from ubinascii import unhexlify, hexlify
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+KEY = bytes(range(0x80, 0xA0))
+NONCE = unhexlify("070000004041424344454647")
+AAD = unhexlify("50515253c0c1c2c3c4c5c6c7")
+PLAIN = (
+    b"Ladies and Gentlemen of the class of '99: If I could offer you only one tip "
+    b"for the future, sunscreen would be it."
+)
+
+c = chacha20_poly1305(KEY, NONCE)
+c.update(AAD)
+ct = c.encrypt(PLAIN)
+tag = c.digest()
+print(hexlify(ct))
+print(hexlify(tag))
+
+d = chacha20_poly1305(KEY, NONCE)
+d.update(AAD)
+print(d.decrypt(ct) == PLAIN)
+d.verify(tag)
+
+# streaming, in pieces which don't line up with blocks
+for n in (1, 15, 64, 65):
+    c = chacha20_poly1305(KEY, NONCE)
+    for i in range(0, len(AAD), n):
+        c.update(AAD[i : i + n])
+    out = b""
+    for i in range(0, len(PLAIN), n):
+        out += c.encrypt(PLAIN[i : i + n])
+    print(n, out == ct, c.digest() == tag)
+
+# no data, and no additional data
+c = chacha20_poly1305(KEY, NONCE)
+print(hexlify(c.digest()))
+c = chacha20_poly1305(KEY, NONCE)
+print(hexlify(c.encrypt(b"abc")), hexlify(c.digest()))
+
+# decrypt in place
+buf = bytearray(ct)
+d = chacha20_poly1305(KEY, NONCE)
+d.update(AAD)
+print(d.decrypt(buf, buf) is buf, buf == PLAIN)
+d.verify(tag)
+
+# tampered data
+d = chacha20_poly1305(KEY, NONCE)
+d.update(AAD)
+d.decrypt(ct[:-1] + bytes([ct[-1] ^ 0x80]))
+try:
+    d.verify(tag)
+except ValueError as er:
+    print("ValueError", er)
+
+# misuse
+for args in ((KEY[:16], NONCE), (KEY, NONCE[:8])):
+    try:
+        chacha20_poly1305(*args)
+    except ValueError as er:
+        print("ValueError", er)
+c = chacha20_poly1305(KEY, NONCE)
+c.encrypt(b"a")
+try:
+    c.decrypt(b"a")
+except ValueError:
+    print("ValueError")
+try:
+    c.update(b"a")
+except ValueError:
+    print("ValueError")
+c.digest()
+try:
+    c.encrypt(b"a")
+except ValueError:
+    print("ValueError")
@@ -0,0 +1,50 @@
+# test uhashlib.hmac and uhashlib.pbkdf2_hmac
+
+try:
+    import uhashlib
+
+    uhashlib.hmac
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+# RFC 4231 test case 2
+print(uhashlib.hmac(b"Jefe", b"what do ya want for nothing?", "sha256").digest())
+
+# keys shorter than, equal to and longer than the block size
+for n in (0, 20, 64, 65, 131):
+    key = bytes(i & 0xFF for i in range(n))
+    print(n, uhashlib.hmac(key, b"message", uhashlib.sha256).digest())
+
+# incremental updates, digest() can be called more than once
+h = uhashlib.hmac(b"key")
+h.update(b"hello ")
+print(h.digest())
+h.update(b"world")
+print(h.digest())
+print(h.digest() == uhashlib.hmac(b"key", b"hello world").digest())
+
+# copies are independent of the original
+c = h.copy()
+c.update(b"!")
+print(h.digest() == uhashlib.hmac(b"key", b"hello world").digest())
+print(c.digest() == uhashlib.hmac(b"key", b"hello world!").digest())
+
+# unsupported hash
+try:
+    uhashlib.hmac(b"key", digestmod="md5")
+except ValueError:
+    print("ValueError")
+
+# RFC 7914 section 11 test vectors, plus derived keys of other lengths
+print(uhashlib.pbkdf2_hmac("sha256", b"passwd", b"salt", 1, 64))
+print(uhashlib.pbkdf2_hmac("sha256", b"password", b"salt", 2))
+print(uhashlib.pbkdf2_hmac("sha256", b"password", b"salt", 4096, 20))
+print(uhashlib.pbkdf2_hmac("sha256", b"pass\0word", b"sa\0lt", 10, 70))
+print(uhashlib.pbkdf2_hmac("sha256", b"password", b"salt", 2, dklen=5))
+print(uhashlib.pbkdf2_hmac("sha256", b"password", b"salt", iterations=2, dklen=None))
+
+try:
+    uhashlib.pbkdf2_hmac("sha256", b"password", b"salt", 0)
+except ValueError:
+    print("ValueError")
@@ -26,13 +26,20 @@ print(hashlib.sha256(b"\xff" * 64).digest())
 # 56 bytes is a boundary case in the algorithm
 print(hashlib.sha256(b"\xff" * 56).digest())
 
-# TODO: running .digest() several times in row is not supported()
-# h = hashlib.sha256(b'123')
-# print(h.digest())
-# print(h.digest())
-
-# TODO: partial digests are not supported
-# h = hashlib.sha256(b'123')
-# print(h.digest())
-# h.update(b'456')
-# print(h.digest())
+# running .digest() several times in row
+h = hashlib.sha256(b"123")
+print(h.digest())
+print(h.digest())
+
+# partial digests
+h = hashlib.sha256(b"123")
+print(h.digest())
+h.update(b"456")
+print(h.digest())
+
+# copies are independent of the original
+h = hashlib.sha256(b"abc" * 30)
+c = h.copy()
+c.update(b"def")
+print(h.digest())
+print(c.digest())
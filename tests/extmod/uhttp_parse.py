@@ -0,0 +1,94 @@
+# test uhttp module
+
+try:
+    import uhttp
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+
+def show(res):
+    if res is None:
+        print(None)
+        return
+    print([bytes(x) if isinstance(x, memoryview) else x for x in res[:-2]])
+    print([(bytes(k), bytes(v)) for k, v in res[-2]], res[-1])
+
+
+# request
+req = b"GET /index.html?x=1 HTTP/1.1\r\nHost: example.com\r\nAccept:  */*  \r\nX-Empty:\r\n\r\nbody"
+show(uhttp.parse_request(req))
+show(uhttp.parse_request(b"\r\nPOST / HTTP/1.0\n\n"))
+
+# incomplete request, fed incrementally
+buf = bytearray()
+last_len = 0
+for part in (b"GET / HT", b"TP/1.1\r\nHost: a\r", b"\n\r", b"\nbody"):
+    buf.extend(part)
+    res = uhttp.parse_request(buf, last_len)
+    show(res)
+    last_len = len(buf)
+
+# request from a memoryview slice
+show(uhttp.parse_request(memoryview(b"xxxxPUT /p HTTP/1.1\r\nA: b\r\n\r\n")[4:]))
+
+# response
+show(uhttp.parse_response(b"HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello"))
+show(uhttp.parse_response(b"HTTP/1.0 404\r\n\r\n"))
+show(uhttp.parse_response(b"HTTP/1.1 200 OK\r\n"))
+
+# headers only
+print(uhttp.parse_headers(b"\r\nrest"))
+res = uhttp.parse_headers(b"Trailer: x\r\n\r\n")
+print([(bytes(k), bytes(v)) for k, v in res[0]], res[1])
+
+# malformed messages
+for msg in (
+    b"GET\r\n\r\n",
+    b"GET / HTTP/2.0\r\n\r\n",
+    b"GET / HTTP/1.1\r\nBad Header: x\r\n\r\n",
+    b"GET / HTTP/1.1\r\nNoColon\r\n\r\n",
+    b"GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n",
+):
+    try:
+        uhttp.parse_request(msg)
+    except ValueError:
+        print("ValueError")
+try:
+    uhttp.parse_response(b"HTTP/1.1 2x0 OK\r\n\r\n")
+except ValueError:
+    print("ValueError")
+
+# chunked decoding in one go
+d = uhttp.ChunkedDecoder()
+buf = bytearray(b"4\r\nWiki\r\n5;ext=1\r\npedia\r\n0\r\nTrailer: x\r\n\r\nnext")
+res = d.decode(buf)
+print(res, buf[: res[0]], buf[res[0] : res[0] + res[1]])
+
+# chunked decoding a byte at a time
+d = uhttp.ChunkedDecoder()
+data = b"a\r\n0123456789\r\n3\r\nabc\r\n0\r\n\r\n"
+out = b""
+for i in range(len(data)):
+    buf = bytearray(data[i : i + 1])
+    n, rest = d.decode(buf)
+    out += buf[:n]
+print(out, rest)
+
+# partial buffer length
+d = uhttp.ChunkedDecoder()
+buf = bytearray(b"3\r\nabc\r\n0\r\n\r\nGARBAGE")
+print(d.decode(buf, 13), buf[:3])
+
+# bad chunk size
+try:
+    uhttp.ChunkedDecoder().decode(bytearray(b"x\r\n"))
+except ValueError:
+    print("ValueError")
+
+# last_len out of range
+try:
+    uhttp.parse_request(b"GET / HTTP/1.1\r\n\r\n", -1)
+except ValueError:
+    print("ValueError")
+print(uhttp.parse_request(b"GET / HTTP/1.1\r\n\r\n", 100)[-1])
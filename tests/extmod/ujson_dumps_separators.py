@@ -0,0 +1,49 @@
+# test ujson.dump/dumps with the separators argument, and output that spans
+# more than one internal buffer
+
+try:
+    import uio as io
+    import ujson as json
+except ImportError:
+    try:
+        import io, json
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+try:
+    json.dumps([], separators=(",", ":"))
+except TypeError:
+    print("SKIP")
+    raise SystemExit
+
+# compact and custom separators
+print(json.dumps([1, [2, 3], {"a": None}], separators=(",", ":")))
+print(json.dumps({"a": [True, False]}, separators=(",", ":")))
+print(json.dumps({"a": 1}, separators=(" , ", " = ")))
+print(json.dumps((), separators=(",", ":")))
+print(json.dumps({1: 2}, separators=(",", ":")))
+s = io.StringIO()
+json.dump([1, {"b": 2}], s, separators=(",", ":"))
+print(s.getvalue())
+
+# ints at the edges of the small-int range and beyond
+print(json.dumps([0, -1, 9, 10, -10, 1073741823, -1073741824, 1 << 62, -(1 << 62), 1 << 70]))
+
+# long output and long strings with escapes at various positions
+for n in (10, 255, 256, 257, 1000):
+    x = "a" * n
+    print(n, json.dumps(x) == '"' + x + '"', len(json.dumps([x] * 3)))
+    s = io.StringIO()
+    json.dump({"k": [x, x + '"\n\x01']}, s)
+    print(s.getvalue()[-12:])
+print(json.dumps(list(range(300)), separators=(",", ":"))[-20:])
+print(json.dumps("\\" * 300)[:10], len(json.dumps("\\" * 300)))
+
+# bad separators
+print(json.dumps([1, 2], separators=None))
+for sep in (1, (",",), (",", ":", ";"), (1, 2)):
+    try:
+        json.dumps([1, 2], separators=sep)
+    except (TypeError, ValueError):
+        print("Error")
@@ -0,0 +1,92 @@
+# test ujson.iterload and ujson.iterevents
+
+try:
+    import uio as io
+    import ujson as json
+
+    json.iterload
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+doc = '{"meta": {"n": 3}, "data": {"items": [{"a": 1}, [2, 3], "x", 4.5, null], "z": 1}, "tail": [1]}'
+
+# elements of an array selected by a path, from str, bytes and a stream
+for src in (doc, doc.encode(), io.StringIO(doc)):
+    print(list(json.iterload(src, ("data", "items"))))
+
+# an object gives (key, value) pairs, other values are given on their own
+print(list(json.iterload(doc, ("data",))))
+print(list(json.iterload(doc, ["data", "items", 1])))
+print(list(json.iterload(doc, ("meta", "n"))))
+
+# top-level array
+print(list(json.iterload("[1, [2, [3]], {}]")))
+print(list(json.iterload("  []  ")))
+it = json.iterload("[10, 20]")
+print(next(it), next(it))
+for i in range(2):
+    try:
+        next(it)
+    except StopIteration:
+        print("StopIteration")
+
+# path errors
+for path in (("nope",), ("data", "items", 9), ("meta", 0), ("tail", "x")):
+    try:
+        list(json.iterload(doc, path))
+    except Exception as er:
+        print(type(er).__name__, er)
+
+# events
+names = {
+    json.START_ARRAY: "START_ARRAY",
+    json.END_ARRAY: "END_ARRAY",
+    json.START_OBJECT: "START_OBJECT",
+    json.END_OBJECT: "END_OBJECT",
+    json.KEY: "KEY",
+    json.VALUE: "VALUE",
+}
+for ev, val in json.iterevents(doc):
+    print(names[ev], val)
+print(list(json.iterevents("123")))
+
+# malformed input
+for bad in ("[1, 2", '{"a" 1 "b"}', "[1}", "}", '{"a": }', "[1, tru]"):
+    try:
+        print(list(json.iterevents(bad)))
+    except ValueError as er:
+        print("ValueError", er)
+for bad in ("[1, 2", '{"a" 1 "b"}', "[1}", "[1, tru]"):
+    try:
+        print(list(json.iterload(bad)))
+    except ValueError as er:
+        print("ValueError", er)
+
+
+# a long array produced by a stream, consumed one element at a time
+class Gen(io.IOBase):
+    def __init__(self, n):
+        self.n = n
+        self.i = -1
+        self.pending = b"["
+
+    def readinto(self, buf):
+        while len(self.pending) < len(buf) and self.i < self.n:
+            self.i += 1
+            if self.i == self.n:
+                self.pending += b"]"
+            else:
+                self.pending += b'%s{"id": %d, "name": "item %d"}' % (b"," if self.i else b"", self.i, self.i)
+        n = min(len(buf), len(self.pending))
+        buf[:n] = self.pending[:n]
+        self.pending = self.pending[n:]
+        return n
+
+
+total = 0
+count = 0
+for item in json.iterload(Gen(2000)):
+    total += item["id"]
+    count += 1
+print(count, total, item)
@@ -13,3 +13,17 @@ print(json.load(StringIO("null")))
 print(json.load(StringIO('"abc\\u0064e"')))
 print(json.load(StringIO("[false, true, 1, -2]")))
 print(json.load(StringIO('{"a":true}')))
+
+# values that straddle the boundaries of the blocks read from the stream
+for n in (250, 251, 252, 253, 254, 255, 256, 257, 511, 512):
+    s = "a" * n
+    print(json.load(StringIO('["%s", 12345.5, "\\n\\t%s", -98765]' % (s, s))) == [s, 12345.5, "\n\t" + s, -98765])
+    print(json.load(StringIO(" " * n + '{"k": [1, 2.5, "x\\u0041y"]}' + " " * n)))
+    print(json.load(StringIO(" " * n + "123456789")))
+
+# errors
+for s in ("", " ", '"abc', "1 2", '"\\'):
+    try:
+        json.load(StringIO(s))
+    except ValueError:
+        print("ValueError")
@@ -74,3 +74,8 @@ try:
     my_print(json.loads("[null]   a"))
 except ValueError:
     print("ValueError")
+
+# long strings and whitespace runs
+s = "x" * 300
+my_print(json.loads('  [ "%s" , "%s\\"" ]  ' % (s, s)) == [s, s + '"'])
+my_print(json.loads(bytearray(b'{"a": "b\\\\c", "d": 1e3}')))
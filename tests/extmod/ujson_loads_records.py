@@ -0,0 +1,51 @@
+# test decoding of repeated keys and containers of similar shape
+
+try:
+    import ujson as json
+except ImportError:
+    try:
+        import json
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+# an array of records with the same keys, including escaped and long keys
+recs = []
+for i in range(50):
+    recs.append(
+        {
+            "id": i,
+            "name": "n" + str(i % 3),
+            "tags": ["a", "b"][: i % 3],
+            "k\\\"ey": i,
+            "x" * 40: [i] * (i % 5),
+            "nested": {"a": {"b": {"c": [i, [i, [i]]]}}},
+        }
+    )
+s = json.dumps(recs)
+x = json.loads(s)
+print(x == recs, len(x))
+print(sorted(x[7].keys()))
+print(x[7]["nested"], x[8]["tags"], x[49]["x" * 40])
+
+# many distinct short keys that share cache entries
+d = dict(("k%d" % i, i) for i in range(200))
+print(json.loads(json.dumps(d)) == d)
+
+# sizes of siblings vary up and down
+for v in ([[1] * 10, [], [1, 2], [1] * 100, [3]], [{}, {"a": 1, "b": 2}, {"c": 3}, {}]):
+    print(json.loads(json.dumps(v)) == v)
+
+# deeper nesting than is tracked for container sizes
+v = [[[[[[[[[[[1, 2, 3]]]]]]]]]], [[[[[[[[[[4]]]]]]]]]]]
+print(json.loads(json.dumps(v)))
+
+# the result can be modified freely
+x = json.loads('[{"a": []}, {"a": []}]')
+x[0]["a"].append(1)
+x[1]["b"] = 2
+print(sorted(x[0].items()), sorted(x[1].items()))
+
+# a large array is not used to size the dicts and arrays that follow it
+x = json.loads("[[" + "0," * 1999 + "0], {}, [], {}]")
+print(len(x[0]), x[1:])
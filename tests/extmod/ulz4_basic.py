@@ -0,0 +1,52 @@
+try:
+    import ulz4
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+# block produced by the reference implementation
+data = b"MicroPython " * 8 + b"LZ4!"
+block = b"\xcfMicroPython \x0c\x00@P LZ4!"
+print(ulz4.decompress(block, 100) == data)
+print(ulz4.decompress(block, 1000) == data)
+
+# round trip, with different window sizes
+text = b"".join(b"line %d: the quick brown fox %d\n" % (i, i * i % 97) for i in range(500))
+for d in (b"", b"a", b"hello world", b"a" * 1000, bytes(range(256)) * 4, text):
+    for wbits in (8, 12, 16):
+        c = ulz4.compress(d, wbits)
+        print(len(d), wbits, len(c) < len(d), ulz4.decompress(c, len(d)) == d)
+
+# compress accepts any buffer
+print(ulz4.decompress(ulz4.compress(bytearray(text)), len(text)) == text)
+print(ulz4.decompress(ulz4.compress(memoryview(text)[10:]), len(text)) == text[10:])
+
+# decompress_into, and in place with the data at the end of the buffer
+c = ulz4.compress(text)
+buf = bytearray(len(text) + 16)
+print(ulz4.decompress_into(c, buf) == len(text), buf[: len(text)] == text)
+buf[-len(c) :] = c
+n = ulz4.decompress_into(memoryview(buf)[-len(c) :], buf)
+print(n == len(text), buf[:n] == text)
+
+# in place without enough room for the output to stay behind the input
+buf = bytearray(len(text))
+buf[-len(c) :] = c
+try:
+    ulz4.decompress_into(memoryview(buf)[-len(c) :], buf)
+except ValueError:
+    print("ValueError")
+
+# output too small, truncated and invalid data
+for d, size in ((c, 100), (c[:-10], len(text)), (b"\xf0\x05ab", 100), (b"\x10a\x05\x00", 100)):
+    try:
+        ulz4.decompress(d, size)
+    except ValueError:
+        print("ValueError")
+
+# invalid window size
+for wbits in (7, 17):
+    try:
+        ulz4.compress(b"", wbits)
+    except ValueError:
+        print("ValueError")
@@ -0,0 +1,78 @@
+try:
+    import ulz4
+    import uio as io
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+
+def read_all(d, size):
+    out = b""
+    while True:
+        b = d.read(size)
+        if not b:
+            return out
+        out += b
+
+
+# frames produced by the reference implementation: with block and content
+# checksums and the content size, and with a linked uncompressed block
+data = b"MicroPython " * 8 + b"LZ4!"
+frame = b'\x04"M\x18|@d\x00\x00\x00\x00\x00\x00\x00^\x16\x00\x00\x00\xcfMicroPython \x0c\x00@P LZ4!k\xe8\x8f<\x00\x00\x00\x00\xf3m\xd0\xe1'
+print(read_all(ulz4.DecompIO(io.BytesIO(frame)), 7) == data)
+frame2 = b'\x04"M\x18h@\x08\x00\x00\x00\x00\x00\x00\x00p\x08\x00\x00\x80abcdefgh\x00\x00\x00\x00'
+print(ulz4.DecompIO(io.BytesIO(frame2)).read(100))
+
+# nothing is read past the end of the frame
+buf = io.BytesIO(frame + b"next")
+d = ulz4.DecompIO(buf)
+print(d.read(1000) == data, d.read(10), buf.read())
+
+# round trip with different window sizes, which set the block size
+text = b"".join(b"line %d: the quick brown fox %d\n" % (i, i * i % 97) for i in range(500))
+for wbits in (8, 12, 16):
+    buf = io.BytesIO()
+    c = ulz4.CompIO(buf, wbits)
+    for i in range(0, len(text), 1000):
+        c.write(text[i : i + 1000])
+    c.close()
+    c.close()
+    out = buf.getvalue()
+    print(wbits, len(out) < len(text), read_all(ulz4.DecompIO(io.BytesIO(out), wbits), 333) == text)
+
+# flush makes the data so far readable
+buf = io.BytesIO()
+c = ulz4.CompIO(buf)
+c.write(b"hello ")
+c.flush()
+print(ulz4.DecompIO(io.BytesIO(buf.getvalue())).read(6))
+c.write(b"world")
+c.close()
+print(ulz4.DecompIO(io.BytesIO(buf.getvalue())).read())
+
+# writing after close
+try:
+    c.write(b"x")
+except OSError:
+    print("OSError")
+
+# a window smaller than the offsets in the data
+buf = io.BytesIO()
+c = ulz4.CompIO(buf, 16)
+c.write(text)
+c.close()
+try:
+    read_all(ulz4.DecompIO(io.BytesIO(buf.getvalue()), 8), 100)
+except OSError:
+    print("OSError")
+
+# wrong content checksum, wrong header checksum and truncated frame
+for f, exc in (
+    (frame[:-1] + b"\xe2", OSError),
+    (frame[:14] + b"\x5f" + frame[15:], ValueError),
+    (frame[:30], EOFError),
+):
+    try:
+        read_all(ulz4.DecompIO(io.BytesIO(f)), 100)
+    except exc:
+        print(exc.__name__)
@@ -0,0 +1,89 @@
+# test umqttcodec encoding and decoding
+
+try:
+    import umqttcodec as mqtt
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+buf = bytearray(64)
+
+# PUBLISH with the payload copied in
+n = mqtt.encode_publish(buf, "a/b", b"hello")
+print(n, bytes(buf[:n]))
+n = mqtt.encode_publish(buf, b"t", b"xy", qos=1, pid=0x1234, retain=True, dup=True)
+print(n, bytes(buf[:n]))
+
+# PUBLISH header only, payload sent separately
+n = mqtt.encode_publish(buf, "t", 200, qos=2, pid=7)
+print(n, bytes(buf[:n]))
+
+# other packets
+n = mqtt.encode_subscribe(buf, 10, "x/#", 1)
+print(n, bytes(buf[:n]))
+n = mqtt.encode_suback(buf, 10, b"\x01\x80")
+print(n, bytes(buf[:n]))
+for t in (mqtt.PUBACK, mqtt.PUBREC, mqtt.PUBREL, mqtt.PUBCOMP, mqtt.UNSUBACK):
+    n = mqtt.encode_ack(buf, t, 0x0102)
+    print(n, bytes(buf[:n]))
+n = mqtt.encode_pingreq(buf)
+print(n, bytes(buf[:n]))
+
+# encoding errors
+for args, kw in (
+    ((bytearray(4), "t", b"x"), {}),
+    ((buf, "t", b"x"), {"qos": 3}),
+    ((buf, "t", b"x"), {"qos": 1, "pid": 0x10000}),
+):
+    try:
+        mqtt.encode_publish(*args, **kw)
+    except ValueError as er:
+        print("ValueError", er)
+try:
+    mqtt.encode_ack(buf, mqtt.PUBLISH, 1)
+except ValueError as er:
+    print("ValueError", er)
+
+# decode a stream of packets, fed in pieces
+stream = bytearray()
+for args, kw in (
+    (("a/b", b"hello"), {}),
+    (("t", b"xy"), {"qos": 1, "pid": 0x1234}),
+):
+    n = mqtt.encode_publish(buf, *args, **kw)
+    stream += buf[:n]
+stream += b"\x90\x03\x00\x0a\x01"  # SUBACK
+stream += b"\xd0\x00"  # PINGRESP
+stream += b"\x30\x82\x01\x00\x01z" + b"p" * 127  # PUBLISH with 2-byte remaining length
+
+data = bytearray()
+pos = 0
+for i in range(0, len(stream), 3):
+    data += stream[i : i + 3]
+    while True:
+        pkt = mqtt.decode(data, pos)
+        if pkt is None:
+            break
+        t, flags, pid, topic, payload, pos = pkt
+        print(t, flags, pid, topic and bytes(topic), bytes(payload[:8]), len(payload), pos)
+print(pos == len(data))
+
+# decode with explicit end, and memoryview results referencing the buffer
+mv = memoryview(stream)
+pkt = mqtt.decode(mv, 0, 5)
+print(pkt)
+pkt = mqtt.decode(stream, 0, 12)
+print(type(pkt[3]), type(pkt[4]))
+stream[5] = ord("X")
+print(bytes(pkt[3]))
+
+# malformed packets
+for bad in (b"\x30\xff\xff\xff\xff\x01", b"\x30\x01\x00", b"\x30\x02\x00\x05", b"\x40\x01\x00"):
+    try:
+        mqtt.decode(bad)
+    except ValueError as er:
+        print("ValueError", er)
+try:
+    mqtt.decode(b"\xd0\x00", 3)
+except ValueError:
+    print("ValueError")
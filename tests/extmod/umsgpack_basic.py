@@ -0,0 +1,126 @@
+# test umsgpack dumps/loads/dump/load
+
+try:
+    import umsgpack
+    from ubinascii import hexlify, unhexlify
+    from uio import BytesIO
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+# encoding of each type, in its smallest form, and round trip
+for v in (
+    None,
+    False,
+    True,
+    0,
+    127,
+    128,
+    255,
+    256,
+    0x10000,
+    0xFFFFFFFF,
+    1 << 32,
+    -1,
+    -32,
+    -33,
+    -128,
+    -129,
+    -0x8000,
+    -0x8001,
+    -(1 << 31),
+    -(1 << 31) - 1,
+    1 << 63,
+    (1 << 64) - 1,
+    -(1 << 63),
+    "",
+    "abc",
+    b"",
+    b"\x00\xff",
+    bytearray(b"ba"),
+    [],
+    [1, [2, None]],
+    (1, "a"),
+    {},
+    {"a": 1},
+    {1: b"x"},
+):
+    b = umsgpack.dumps(v)
+    print(repr(v), hexlify(b), umsgpack.loads(b))
+
+# floats
+print(umsgpack.loads(umsgpack.dumps(1.5)), umsgpack.loads(umsgpack.dumps(-0.25)))
+print(umsgpack.loads(b"\xca\x3f\xc0\x00\x00"), umsgpack.loads(b"\xcb\x3f\xf8\x00\x00\x00\x00\x00\x00"))
+
+# lengths that need 8, 16 and 32 bits
+for n in (31, 32, 255, 256, 65535, 65536):
+    s = "x" * n
+    b = umsgpack.dumps(s)
+    print(n, hexlify(b[:1]), len(b) - n, umsgpack.loads(b) == s)
+    b = umsgpack.dumps(s.encode())
+    print(n, hexlify(b[:1]), len(b) - n, umsgpack.loads(b) == s.encode())
+for n in (15, 16, 65536):
+    v = list(range(n))
+    b = umsgpack.dumps(v)
+    print(n, hexlify(b[:1]), umsgpack.loads(b) == v)
+for n in (15, 16):
+    v = dict((i, None) for i in range(n))
+    b = umsgpack.dumps(v)
+    print(n, hexlify(b[:1]), umsgpack.loads(b) == v)
+print(hexlify(umsgpack.dumps("\u00e9")))
+
+# zero-copy decoding of binary data
+buf = bytearray(umsgpack.dumps([b"abc", "abc", b"de"]))
+v = umsgpack.loads(buf, zerocopy=True)
+print([type(x).__name__ for x in v], bytes(v[0]), bytes(v[2]))
+buf[3] = ord("X")
+print(bytes(v[0]), v[1])
+print(type(umsgpack.loads(buf)[0]).__name__)
+
+# dump and load with a stream, one object at a time
+s = BytesIO()
+for v in (1, "two", [3], {"four": b"4"}):
+    umsgpack.dump(v, s)
+big = [b"z" * 1000, "y" * 300] * 3
+umsgpack.dump(big, s)
+s.seek(0)
+for i in range(4):
+    print(umsgpack.load(s))
+print(umsgpack.load(s) == big)
+try:
+    umsgpack.load(s)
+except EOFError:
+    print("EOFError")
+s = BytesIO(umsgpack.dumps([1, 2, 3])[:-1])
+try:
+    umsgpack.load(s)
+except EOFError:
+    print("EOFError")
+
+# huge lengths from a stream aren't preallocated before the data arrives
+for hdr in (b"\xdd\xff\xff\xff\xff", b"\xdf\xff\xff\xff\xff", b"\xdb\xff\xff\xff\xff", b"\xc6\xff\xff\xff\xff"):
+    try:
+        umsgpack.load(BytesIO(hdr + b"\x01\x02"))
+    except EOFError:
+        print("EOFError")
+
+# ints that don't fit in 64 bits
+for v in (1 << 64, -(1 << 63) - 1):
+    try:
+        umsgpack.dumps(v)
+    except OverflowError:
+        print("OverflowError")
+
+# unsupported types
+for v in (object(), {1, 2}, [1, print]):
+    try:
+        umsgpack.dumps(v)
+    except TypeError:
+        print("TypeError")
+
+# bad data
+for b in (b"", b"\xc1", b"\x92\x01", b"\xd9\x05abc", b"\xdd\xff\xff\xff\xff", b"\xd4\x01\x02", b"\x01\x02"):
+    try:
+        umsgpack.loads(b)
+    except ValueError as er:
+        print("ValueError", er)
@@ -0,0 +1,52 @@
+# test umsgpack.Unpacker
+
+try:
+    import umsgpack
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+objs = [None, 1, -200, "hello", b"\x00" * 40, [1, [2, [3]]], {"a": {"b": 1.5}}, 1 << 40]
+data = b"".join(umsgpack.dumps(o) for o in objs)
+
+# feed the data in pieces of various sizes
+for size in (1, 2, 3, 7, 64, len(data)):
+    u = umsgpack.Unpacker()
+    out = []
+    for i in range(0, len(data), size):
+        u.feed(data[i : i + size])
+        for o in u:
+            out.append(o)
+    print(size, out == objs)
+
+# an empty Unpacker, and a partial object left over
+u = umsgpack.Unpacker()
+print(list(u))
+u.feed(b"\x93\x01")
+print(list(u))
+u.feed(bytearray(b"\x02\x03\x04"))
+print(list(u))
+u.feed(b"")
+print(list(u))
+
+# bad data raises once and is then dropped
+u = umsgpack.Unpacker()
+u.feed(b"\x01\xc1\x02")
+print(next(u))
+try:
+    next(u)
+except ValueError:
+    print("ValueError")
+print(list(u))
+u.feed(b"\x03")
+print(list(u))
+
+# an object that can't be decoded is skipped
+u = umsgpack.Unpacker()
+u.feed(b"\x01\xd4\x00\x00\x02")
+print(next(u))
+try:
+    next(u)
+except ValueError:
+    print("ValueError")
+print(list(u))
@@ -0,0 +1,72 @@
+# test urandom bulk functions: jump, randbytes, fill_into, uniform_into
+
+try:
+    import urandom as random
+
+    random.randbytes
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+# seeding gives repeatable bytes, independent of how they are requested
+random.seed(1)
+b = random.randbytes(11)
+print(type(b), len(b))
+random.seed(1)
+ba = bytearray(11)
+random.fill_into(ba)
+print(ba == b)
+random.seed(1)
+print(random.randbytes(4) + random.randbytes(4) == b[:8])
+print(random.randbytes(0))
+
+# fill_into writes into part of a buffer
+ba = bytearray(8)
+random.fill_into(memoryview(ba)[2:4])
+print(ba[:2], ba[4:])
+
+try:
+    random.randbytes(-1)
+except ValueError:
+    print("ValueError")
+try:
+    random.fill_into(b"immutable")
+except TypeError:
+    print("TypeError")
+
+# jumping gives a different stream, repeatably
+random.seed(2)
+a = random.getrandbits(32)
+random.seed(2)
+random.jump()
+j = random.getrandbits(32)
+random.seed(2)
+random.jump()
+print(a != j, random.getrandbits(32) == j)
+
+try:
+    import array
+
+    random.uniform_into
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+# uniform floats in the requested range
+for typecode in "fd":
+    try:
+        ar = array.array(typecode, range(200))
+    except ValueError:
+        # no doubles
+        continue
+    random.uniform_into(ar)
+    print(typecode, all(0 <= x < 1 for x in ar), len(set(ar)) > 190)
+    random.uniform_into(ar, -5, 5)
+    print(typecode, all(-5 <= x <= 5 for x in ar), min(ar) < 0 < max(ar))
+    random.uniform_into(ar, 0.5)
+    print(typecode, all(0.5 <= x <= 1 for x in ar))
+
+try:
+    random.uniform_into(bytearray(4))
+except TypeError:
+    print("TypeError")
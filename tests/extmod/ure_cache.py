@@ -0,0 +1,58 @@
+# test the cache of patterns compiled by the module-level ure functions
+
+try:
+    import ure
+
+    ure.cache_info
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+ure.purge()
+hits, misses, maxsize, size = ure.cache_info()
+print(size)
+
+# the same pattern is compiled once and then reused
+for i in range(5):
+    print(ure.match("a+b", "aaab").group(0))
+print([a - b for a, b in zip(ure.cache_info(), (hits, misses, maxsize, 1))])
+
+# equal patterns that are different objects are found in the cache
+hits, misses, maxsize, size = ure.cache_info()
+p = "".join(["c", "+"])
+print(ure.search(p, "xccc").group(0))
+print(ure.search("".join(["c", "+"]), "yc").group(0))
+print(ure.split(p, "acbccd"))
+print([a - b for a, b in zip(ure.cache_info(), (hits, misses, maxsize, size))])
+
+# a str and a bytes pattern are cached separately
+print(ure.match(b"c+", b"cc").group(0))
+print(ure.cache_info()[3] - size)
+
+# the cache is bounded and the least recently used pattern is dropped
+ure.match("a+b", "ab")
+for i in range(maxsize - 1):
+    ure.match("x" + str(i), "")
+print(ure.cache_info()[3] == maxsize)
+hits, misses = ure.cache_info()[:2]
+ure.match("a+b", "ab")
+ure.match("c+", "c")
+print([a - b for a, b in zip(ure.cache_info()[:2], (hits, misses))])
+
+ure.purge()
+print(ure.cache_info()[3])
+
+# errors are not cached
+for i in range(2):
+    try:
+        ure.match("(", "")
+    except ValueError:
+        print("ValueError")
+print(ure.cache_info()[3])
+
+# only the module-level split takes flags
+print(ure.split("c", "acbccd", 1, 0))
+try:
+    ure.compile("c").split("acb", 0, 0)
+except TypeError:
+    print("TypeError")
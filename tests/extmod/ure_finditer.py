@@ -0,0 +1,60 @@
+# test regex.finditer, and the pos and endpos arguments of match and search
+
+try:
+    import ure as re
+except ImportError:
+    try:
+        import re
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+r = re.compile(r"\d+")
+try:
+    r.finditer
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+print([m.group(0) for m in r.finditer("a12b345c6")])
+print([m.group(0) for m in r.finditer("a12b345c6", 2)])
+print([m.group(0) for m in r.finditer("a12b345c6", 2, 6)])
+print([m.group(0) for m in re.compile("x*").finditer("axb")])
+print([m.group(0) for m in re.compile("").finditer("abc")])
+print(re.compile("^a").search("aa", 1))
+print(re.compile("a$").search("aab", 0, 2).group(0))
+print(re.compile("b").match("ab", 1).group(0))
+print(re.compile("b").match("ab", 3))
+print(re.compile("b").match("ab", 1, 0))
+print([m.group(0) for m in re.compile(rb"\w+").finditer(b"hi there")])
+print([m.group(0) for m in re.compile(rb"\w+").finditer(bytearray(b"hi there"))])
+print(list(re.compile("a").finditer("bbb")))
+
+# groups in matches from finditer
+print([(m.group(1), m.group(2)) for m in re.compile(r"(\w)=(\d)").finditer("a=1, b=2")])
+
+# finditer is lazy: the first match is available before the rest are found
+it = r.finditer("1 2 3")
+print(next(it).group(0))
+print([m.group(0) for m in it])
+
+# a non-empty match may start where the previous, empty, match was
+print([m.group(0) for m in re.compile("|a").finditer("a")])
+print([m.group(0) for m in re.compile(r"\w*").finditer("ab cd")])
+
+# pos after endpos: match tries an empty subject at pos, search doesn't
+print(re.compile("").match("abc", 2, 1).group(0))
+print(re.compile("(x)?").match("abc", 5, 1).group(0))
+print(re.compile("").search("abc", 2, 1))
+print(list(re.compile("").finditer("abc", 2, 1)))
+
+# a negative endpos is clamped to 0, not taken as the length
+print(re.compile("a*").match("aaa", 0, -1).group(0))
+print(re.compile("a").search("aaa", 0, -1))
+
+# a match on a buffer which is resized afterwards
+ba = bytearray(b"xxabcxx")
+m = re.compile(b"a(b)c").search(ba)
+ba.extend(b"y" * 1000)
+ba[2:5] = b"ABC"
+print(m.group(0), m.group(1))
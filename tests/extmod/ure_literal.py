@@ -0,0 +1,69 @@
+# test patterns containing literal strings, which are used to find or rule out
+# matches before running the matcher
+
+try:
+    import ure as re
+except ImportError:
+    try:
+        import re
+    except ImportError:
+        print("SKIP")
+        raise SystemExit
+
+
+def print_groups(m):
+    if m is None:
+        print(None)
+        return
+    out = []
+    for i in range(4):
+        try:
+            out.append(m.group(i))
+        except IndexError:
+            break
+    print(out)
+
+
+subjects = (
+    "",
+    "abc",
+    "xxabcxx",
+    "abab",
+    "aabcab",
+    "ERROR",
+    "log: ERROR timeout 12",
+    "log: ERROR ERROR 34",
+    "ERRORS 1",
+    "12 ERR",
+    "abcabcabd",
+)
+patterns = (
+    "abc",
+    "b",
+    "abc+",
+    "(ab)+c",
+    "(a)(b)c",
+    "a(?:bc)?",
+    "ab|c",
+    "ab*",
+    "x*abc",
+    "\\w+ ERROR",
+    "ERROR (\\w+)",
+    "^ERROR",
+    "ERROR$",
+    "(\\d+) ERR",
+    "ab.abd",
+    "[ab]bc",
+)
+for p in patterns:
+    r = re.compile(p)
+    for s in subjects:
+        print_groups(r.match(s))
+        print_groups(r.search(s))
+
+# searching repeatedly from successive positions, as in sub and split
+for p in ("abc", "b", "abc+", "a(?:bc)?", "x*abc", "ab.abd"):
+    print(re.compile(p).split("xxabcxxabcxabcabd"))
+print(re.split("ab", "abxabyab"))
+print(re.split(", ", "one, two, three"))
+print(re.compile("ERROR").split("aERRORbERRORc", 1))
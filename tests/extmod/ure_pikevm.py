@@ -0,0 +1,34 @@
+# test patterns which take exponential time or unbounded stack with a
+# backtracking matcher, but not with the Pike VM
+
+try:
+    import ure as re
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+try:
+    re.match("(a*)*", "aaa")
+except RuntimeError:
+    # matcher recurses on the subject, so isn't the Pike VM
+    print("SKIP")
+    raise SystemExit
+
+# empty loops
+print(re.match("(a*)*", "aaa").group(0))
+print(re.match("(a*)+b", "aab").group(0))
+print(re.match("(a|)*b", "aab").group(0))
+
+# many ways to match a prefix of the subject before failing
+s = "a" * 1000
+print(re.match("(a|aa)*b", s))
+print(re.search("(a|aa)*c", s + "bc").group(0))
+print(re.match("(a*)*b", s))
+print(re.match("(a+)+$", s).group(0) == s)
+print(len(re.search("(a|a)*x", s + "y" + s + "x").group(0)))
+
+# long subjects need no more stack
+s = "ab" * 10000
+print(len(re.match("(ab)*", s).group(0)))
+print(len(re.match("(a|b)*", s).group(0)))
+print(len(re.search("b(a|b)*?$", s).group(0)))
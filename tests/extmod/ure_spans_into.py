@@ -0,0 +1,51 @@
+# test regex.spans_into
+
+try:
+    import ure as re
+    import uarray as array
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+r = re.compile(r"\d+")
+try:
+    r.spans_into
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+# spans of all matches
+buf = array.array("i", [0] * 8)
+print(r.spans_into("a12b345c6", buf), buf)
+
+# buffer fills up, then the search continues from the last match
+buf = array.array("H", [0] * 4)
+n = r.spans_into("1 22 333 4444", buf)
+print(n, buf)
+print(r.spans_into("1 22 333 4444", buf, buf[2 * n - 1]), buf)
+
+# pos and endpos
+buf = array.array("i", [0] * 8)
+print(r.spans_into("a12b345c6", buf, 2, 6), buf)
+
+# no matches
+print(r.spans_into("abc", buf))
+
+# empty matches
+buf = array.array("b", [0] * 8)
+print(re.compile("x*").spans_into("axb", buf), buf)
+
+# bytes subject and bytearray buffer
+buf = bytearray(4)
+print(re.compile(b"b+").spans_into(b"abbcb", buf), buf)
+
+# buffer too small for one match
+print(r.spans_into("123", bytearray(1)))
+
+# buffer items too small for the string length
+for typecode in ("b", "B"):
+    try:
+        r.spans_into("x" * 199 + "1", array.array(typecode, [0] * 2))
+        print(typecode, "ok")
+    except OverflowError:
+        print(typecode, "OverflowError")
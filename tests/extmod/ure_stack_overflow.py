@@ -11,3 +11,7 @@ try:
     re.match("(a*)*", "aaa")
 except RuntimeError:
     print("RuntimeError")
+else:
+    # the Pike VM doesn't recurse on the subject, so can't overflow
+    print("SKIP")
+    raise SystemExit
@@ -0,0 +1,52 @@
+# test regex.sub_into
+
+try:
+    import ure as re
+    import uio as io
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+r = re.compile(r"(\d+)")
+try:
+    r.sub_into
+except AttributeError:
+    print("SKIP")
+    raise SystemExit
+
+# into a buffer
+buf = bytearray(20)
+n = r.sub_into(r"<\1>", "a1b22c", buf)
+print(n, buf[:n])
+
+# count
+n = r.sub_into("#", "a1b22c333", buf, 2)
+print(n, buf[:n])
+
+# no substitutions
+n = r.sub_into("#", "abc", buf)
+print(n, buf[:n])
+
+# callable replacement
+n = r.sub_into(lambda m: str(int(m.group(0)) * 2), "a1b22c", buf)
+print(n, buf[:n])
+
+# buffer too small
+try:
+    r.sub_into("####", "1 2 3 4 5", buf)
+except ValueError as er:
+    print("ValueError", er)
+
+# into a stream, with output both smaller and larger than the internal buffer
+s = io.BytesIO()
+print(r.sub_into(r"[\1]", "x1y22z", s), s.getvalue())
+s = io.BytesIO()
+print(r.sub_into("-" * 100, "a1b", s), s.getvalue() == b"a" + b"-" * 100 + b"b")
+s = io.StringIO()
+print(r.sub_into(r"\1\1", "1" * 50 + "a" + "2" * 50, s), s.getvalue() == "1" * 100 + "a" + "2" * 100)
+
+# not a buffer or stream
+try:
+    r.sub_into("", "a", 1)
+except OSError:
+    print("OSError")
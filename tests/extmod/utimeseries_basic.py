@@ -0,0 +1,106 @@
+# test utimeseries module
+
+try:
+    import utimeseries
+    import uio
+    import ustruct
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+f = uio.BytesIO()
+ts = utimeseries.TimeSeries(f, "<hb", block_size=64)
+print(len(ts), bool(ts))
+print(ts.query())
+
+# 64-byte blocks hold 12 records of 1-byte deltas and 3 bytes of values
+for i in range(30):
+    ts.append(1000 + 10 * i, -i, i)
+print(len(ts), bool(ts))
+ts.flush()
+print(len(f.getvalue()))
+
+# range queries
+times, data = ts.query(1095, 1150)
+print(times)
+print([ustruct.unpack_from("<hb", data, 3 * i) for i in range(len(times))])
+print(ts.query(1280)[0])
+print(ts.query(None, 1010)[0])
+print(ts.query(2000), ts.query(0, 1000))
+
+# batched append, and equal and large timestamps
+ts.extend([1300, 1300, 1 << 40], ustruct.pack("<hbhbhb", 1, 2, 3, 4, 5, 6))
+print(ts.query(1290))
+
+# timestamps can't decrease
+try:
+    ts.append(1 << 39, 0, 0)
+except ValueError:
+    print("ValueError")
+
+# wrong number of values, or length of data
+try:
+    ts.append(1 << 41, 0)
+except TypeError:
+    print("TypeError")
+try:
+    ts.extend([1 << 41], b"12")
+except ValueError:
+    print("ValueError")
+ts.close()
+
+# closed
+try:
+    ts.append(1 << 41, 0, 0)
+except ValueError:
+    print("ValueError")
+
+# reopen and continue
+with utimeseries.TimeSeries(f, "<hb") as ts:
+    print(len(ts))
+    ts.append((1 << 40) + 1, 7, 8)
+    times, data = ts.query(1 << 40)
+    print(times, data)
+with utimeseries.TimeSeries(f, "<hb") as ts:
+    print(len(ts), ts.query()[0][-3:])
+
+# the record format must match
+try:
+    utimeseries.TimeSeries(f, "<hh")
+except ValueError:
+    print("ValueError")
+
+# invalid arguments
+for fmt, block_size in (("x", 64), ("<qqqqqq", 64), ("<h", 100)):
+    try:
+        utimeseries.TimeSeries(uio.BytesIO(), fmt, block_size=block_size)
+    except ValueError:
+        print("ValueError")
+try:
+    utimeseries.TimeSeries(uio.BytesIO(b"not a time series"), "<h")
+except ValueError:
+    print("ValueError")
+try:
+    utimeseries.TimeSeries(uio.BytesIO(), "<h", sync_every=-1)
+except ValueError:
+    print("ValueError")
+
+# float values
+ts = utimeseries.TimeSeries(uio.BytesIO(), "fd")
+ts.append(0, 0.5, 0.25)
+print(ustruct.unpack("<fd", ts.query()[1]))
+
+# the full range of 64-bit timestamps, and values outside it
+f = uio.BytesIO()
+ts = utimeseries.TimeSeries(f, "<b")
+ts.extend([-(1 << 63), 0, (1 << 63) - 1], b"\x01\x02\x03")
+for t in (1 << 63, -(1 << 63) - 1, 1 << 100):
+    try:
+        ts.append(t, 0)
+    except OverflowError:
+        print("OverflowError")
+print(list(ts.query()[0]))
+ts.close()
+ts = utimeseries.TimeSeries(f, "<b")
+ts.append((1 << 63) - 1, 4)
+print(list(ts.query((1 << 62), None)[0]), ts.query()[1])
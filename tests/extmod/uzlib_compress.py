@@ -0,0 +1,77 @@
+# test uzlib compression: compress, compressobj and CompIO
+
+try:
+    import uzlib as zlib
+    import uio as io
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+if not hasattr(zlib, "compressobj"):
+    print("SKIP")
+    raise SystemExit
+
+
+def decompress(data, wbits):
+    if wbits >= 16:
+        return zlib.DecompIO(io.BytesIO(data), wbits).read()
+    return zlib.decompress(data, wbits)
+
+
+text = b"".join(b"line %d: value=%d status=ok\n" % (i, i % 17) for i in range(500))
+binary = bytes((i * 7 + (i >> 3)) & 0xFF for i in range(3000))
+cases = (b"", b"a", b"abcabcabcabc", b"x" * 1000, text, binary)
+
+# one-shot compression in each format, with various window sizes
+for wbits in (9, 10, 15, 25, 31, -9, -15):
+    for data in cases:
+        c = zlib.compress(data, wbits)
+        print(wbits, len(data), decompress(c, wbits) == data, len(c) < len(data) + 24)
+print(zlib.compress(b"")[:2], zlib.compress(b"", 15)[:2], zlib.compress(b"", 31)[:4])
+print(len(zlib.compress(text)) * 4 < len(text))
+
+# compressobj with data given in pieces
+for size in (1, 5, 100, 1000):
+    data = text[: size * 1000]
+    co = zlib.compressobj()
+    out = []
+    for i in range(0, len(data), size):
+        out.append(co.compress(data[i : i + size]))
+    out.append(co.flush())
+    print(size, zlib.decompress(b"".join(out)) == data)
+co = zlib.compressobj(-12)
+c = co.compress(binary) + co.flush()
+print(zlib.decompress(c, -12) == binary, co.flush())
+try:
+    co.compress(b"more")
+except ValueError:
+    print("ValueError")
+
+# CompIO as a stream wrapper, with flush making the data so far decodable
+buf = io.BytesIO()
+f = zlib.CompIO(buf, -10)
+f.write(b"hello ")
+f.write(b"world\n")
+f.flush()
+print(zlib.DecompIO(io.BytesIO(buf.getvalue()), -10).read(12))
+for i in range(0, len(text), 300):
+    f.write(text[i : i + 300])
+f.close()
+print(zlib.decompress(buf.getvalue(), -10) == b"hello world\n" + text)
+try:
+    f.write(b"x")
+except OSError:
+    print("OSError")
+
+buf = io.BytesIO()
+f = zlib.CompIO(buf, 31)
+f.write(text)
+f.close()
+print(zlib.DecompIO(io.BytesIO(buf.getvalue()), 31).read() == text)
+
+# bad wbits
+for wbits in (8, 16, 24, 32, -8, -16):
+    try:
+        zlib.compressobj(wbits)
+    except ValueError:
+        print("ValueError")
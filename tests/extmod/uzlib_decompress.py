@@ -47,6 +47,15 @@ v = b"\xcbH\xcd\xc9\xc9\x07\x00\x86\xa6\x106\x05\x00\x00\x00"
 out = zlib.decompress(v, -15)
 assert out == exp
 
+# Raw DEFLATE bitstream with a dynamic Huffman tree using 12-bit codes,
+# longer than the codes that are decoded by table lookup
+v = (
+    b"\x05\xe0\x01\x8e\x04A\x8c\xc30\xdc\xddKx\xbf\xb9o\xf4m\xe9\xee\x0e\xb8s\x80\xbb\xb9"
+    b"\xff\x1f\xff\xe5\xff\xfe\xed\xdf\xfe\xfb\x9b\xbf{\xfd\xaf\xff\xba\xfd{\xff\xe3\xf7\x1f"
+    b"\xdf\xec?\x97\x7f\xfd\xcf\xdf\xff\xfa\xfe'\xaf\xbf{=\xbf\xbb\x7f\xfe\x7f"
+)
+print(bytes(zlib.decompress(v, -15)))
+
 # this should error
 try:
     zlib.decompress(b"abc")
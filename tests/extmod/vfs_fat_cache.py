@@ -0,0 +1,106 @@
+# Test the write-back block cache of VfsFat using a RAM device
+
+try:
+    import uos
+
+    uos.VfsFat.cache_stats
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMFS:
+
+    SEC_SIZE = 512
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.SEC_SIZE)
+        self.writes = 0
+
+    def readblocks(self, n, buf):
+        buf[:] = self.data[n * self.SEC_SIZE : n * self.SEC_SIZE + len(buf)]
+
+    def writeblocks(self, n, buf):
+        self.writes += 1
+        self.data[n * self.SEC_SIZE : n * self.SEC_SIZE + len(buf)] = buf
+
+    def ioctl(self, op, arg):
+        if op == 4:  # MP_BLOCKDEV_IOCTL_BLOCK_COUNT
+            return len(self.data) // self.SEC_SIZE
+        if op == 5:  # MP_BLOCKDEV_IOCTL_BLOCK_SIZE
+            return self.SEC_SIZE
+
+
+try:
+    bdev = RAMFS(200)
+except MemoryError:
+    print("SKIP")
+    raise SystemExit
+
+uos.VfsFat.mkfs(bdev)
+
+try:
+    uos.VfsFat(bdev, cache=-1)
+except ValueError:
+    print("ValueError")
+
+# no cache
+print(uos.VfsFat(bdev).cache_stats())
+
+# small appends to a file rewrite the same blocks, which are written out in
+# fewer calls to the device when the file is closed
+vfs = uos.VfsFat(bdev, cache=16)
+bdev.writes = 0
+lines = ["%04d some data\n" % i for i in range(500)]
+with vfs.open("log", "w") as f:
+    for line in lines:
+        f.write(line)
+hits, misses, writes, transfers = vfs.cache_stats()
+print(hits > 0, transfers < writes, bdev.writes < writes)
+
+# the data is on the device once the file is closed
+with uos.VfsFat(bdev).open("log", "r") as f:
+    print(f.read() == "".join(lines))
+
+# reads see dirty blocks, here of the FAT while another file is written
+with vfs.open("b", "w") as f:
+    f.write("b" * 2000)
+    with vfs.open("log", "r") as f2:
+        print(f2.read() == "".join(lines))
+print(vfs.stat("b")[6])
+
+# directory operations sync the filesystem
+vfs.mkdir("dir")
+with vfs.open("dir/a", "w") as f:
+    f.write("a" * 2000)
+print(sorted(uos.VfsFat(bdev).ilistdir("/")))
+print(uos.VfsFat(bdev).open("dir/a", "r").read() == "a" * 2000)
+
+# umount writes out dirty blocks
+f = vfs.open("c", "w")
+f.write("c" * 600)
+data = bytes(bdev.data)
+vfs.umount()
+print(bytes(bdev.data) != data)
+f.close()
+
+# reset the counters
+print(vfs.cache_stats(True) != (0, 0, 0, 0))
+print(vfs.cache_stats())
+
+# read-only mount
+uos.mount(vfs, "/ramdisk", readonly=True)
+try:
+    open("/ramdisk/d", "w")
+except OSError as e:
+    print(e.errno)
+uos.umount("/ramdisk")
+print(vfs.cache_stats()[2])
+
+# a cache of 1 block works
+vfs = uos.VfsFat(bdev, cache=1)
+with vfs.open("log", "w") as f:
+    for line in lines:
+        f.write(line)
+with uos.VfsFat(bdev).open("log", "r") as f:
+    print(f.read() == "".join(lines))
@@ -0,0 +1,117 @@
+# Test the block cache of VfsLfs1 and VfsLfs2 using a RAM device
+
+try:
+    import uos
+
+    uos.VfsLfs1
+    uos.VfsLfs2
+    uos.VfsLfs2.cache_stats
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+
+class RAMBlockDevice:
+    ERASE_BLOCK_SIZE = 1024
+
+    def __init__(self, blocks):
+        self.data = bytearray(blocks * self.ERASE_BLOCK_SIZE)
+        self.reads = 0
+
+    def readblocks(self, block, buf, off=0):
+        self.reads += 1
+        addr = block * self.ERASE_BLOCK_SIZE + off
+        buf[:] = self.data[addr : addr + len(buf)]
+
+    def writeblocks(self, block, buf, off=0):
+        addr = block * self.ERASE_BLOCK_SIZE + off
+        self.data[addr : addr + len(buf)] = buf
+
+    def ioctl(self, op, arg):
+        if op == 4:  # block count
+            return len(self.data) // self.ERASE_BLOCK_SIZE
+        if op == 5:  # block size
+            return self.ERASE_BLOCK_SIZE
+        if op == 6:  # erase block
+            addr = arg * self.ERASE_BLOCK_SIZE
+            self.data[addr : addr + self.ERASE_BLOCK_SIZE] = b"\xff" * self.ERASE_BLOCK_SIZE
+            return 0
+
+
+def test(vfs_class):
+    print("test", vfs_class)
+
+    # invalid arguments
+    bdev = RAMBlockDevice(60)
+    vfs_class.mkfs(bdev)
+    for kw in ({"cache": -1}, {"readahead": -1}):
+        try:
+            vfs_class(bdev, **kw)
+        except ValueError:
+            print("ValueError")
+
+    # no cache
+    vfs = vfs_class(bdev)
+    print(vfs.cache_stats())
+
+    # write some files through the cache
+    vfs = vfs_class(bdev, cache=8, readahead=3)
+    data = bytes(i * 7 & 0xFF for i in range(24000))
+    with vfs.open("big", "wb") as f:
+        f.write(data)
+    for i in range(4):
+        with vfs.open("f%d" % i, "w") as f:
+            f.write("file %d" % i)
+    vfs.mkdir("dir")
+
+    # repeated metadata operations are served from the cache
+    vfs.cache_stats(True)
+    reads = bdev.reads
+    for i in range(10):
+        vfs.stat("f1")
+        list(vfs.ilistdir("/"))
+    hits, misses, readahead = vfs.cache_stats()
+    print(hits > 0, misses, bdev.reads - reads)
+
+    # sequential reads of a file larger than the cache use read-ahead, which
+    # loads groups of blocks, so there are fewer misses
+    def read_big(readahead):
+        vfs = vfs_class(bdev, cache=16, readahead=readahead)
+        vfs.cache_stats(True)
+        reads = bdev.reads
+        read = b""
+        buf = bytearray(64)
+        with vfs.open("big", "rb") as f:
+            while True:
+                n = f.readinto(buf)
+                if not n:
+                    break
+                read += buf[:n]
+        print(read == data, bdev.reads - reads == vfs.cache_stats()[1])
+        return vfs
+
+    misses = read_big(0).cache_stats()[1]
+    vfs = read_big(3)
+    hits, misses_ra, readahead = vfs.cache_stats()
+    print(misses_ra < misses, readahead > 0)
+
+    # writes go through to the device and update the cache
+    with vfs.open("f2", "w") as f:
+        f.write("changed")
+    with vfs.open("f2", "r") as f:
+        print(f.read())
+    print(vfs_class(bdev).open("f2", "r").read())
+    print(sorted(vfs_class(bdev).ilistdir("/")))
+
+    # reset the counters
+    print(vfs.cache_stats(True) != (0, 0, 0))
+    print(vfs.cache_stats())
+
+    # a cache of 1 block works, without read-ahead
+    vfs = vfs_class(bdev, cache=1)
+    print(vfs.open("big", "rb").read() == data)
+    print(vfs.cache_stats()[2])
+
+
+test(uos.VfsLfs1)
+test(uos.VfsLfs2)
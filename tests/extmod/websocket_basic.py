@@ -60,3 +60,24 @@ try:
     ws.ioctl(-1)
 except OSError as e:
     print("ioctl: EINVAL:", e.errno == uerrno.EINVAL)
+
+# 64-bit extended payload length
+print(ws_read(b"\x81\x7f\x00\x00\x00\x00\x00\x00\x00\x04ping", 4))
+
+# long masked payload, unmasked a word at a time
+print(ws_read(b"\x82\xfe\x00\x25mask" + b"mask" * 9 + b"m", 37))
+
+# control frame payloads are not returned as data
+print(ws_read(b"\x89\x02hi\x81\x04ping", 4))
+
+# read complete frames into a buffer
+ws = uwebsocket.websocket(uio.BytesIO(b"\x81\x04ping\x89\x00\x81\x84mask\x1d\x0e\x1d\x0c\x81\x00\x81\x02hi"))
+buf = bytearray(8)
+print(ws.readframe(buf), buf[:4])
+print(ws.readframe(buf), buf[:4])
+print(ws.readframe(buf), buf[:2])
+print(ws.readframe(buf))
+try:
+    uwebsocket.websocket(uio.BytesIO(b"\x81\x04ping")).readframe(bytearray(2))
+except ValueError:
+    print("ValueError")
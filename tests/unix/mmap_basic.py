@@ -0,0 +1,88 @@
+# test mmap module
+
+try:
+    import mmap, uos, ustruct, uarray, gc
+except ImportError:
+    print("SKIP")
+    raise SystemExit
+
+fname = "micropy_test_mmap"
+
+with open(fname, "wb") as f:
+    f.write(b"hello mmap world")
+    f.write(ustruct.pack("<HI", 0x1234, 0x56789ABC))
+
+# read-only mapping of the whole file, using a file object
+f = open(fname, "r+b")
+m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+print(m, len(m))
+print(m[0], m[-1], m[:5], m[6:10])
+print(ustruct.unpack_from("<HI", m, 16))
+print(bytes(memoryview(m)[11:16]))
+try:
+    m[0] = 1
+except TypeError:
+    print("TypeError")
+m.madvise(mmap.MADV_SEQUENTIAL)
+m.close()
+print(m)
+try:
+    m[0]
+except ValueError:
+    print("ValueError")
+
+# writable shared mapping with an offset
+m = mmap.mmap(f, 6, offset=0)
+m[0] = ord("H")
+m[1:5] = b"ELLO"
+mv = memoryview(m)
+mv[5] = ord("_")
+m.flush()
+m.flush(0, 6)
+m.close()
+f.seek(0)
+print(f.read(16))
+
+# private copy-on-write mapping does not change the file
+with mmap.mmap(f.fileno(), 5, access=mmap.ACCESS_COPY) as m:
+    m[:] = b"xxxxx"
+    print(m[:])
+f.seek(0)
+print(f.read(5))
+
+# array over the mapping
+with mmap.mmap(f.fileno(), 0) as m:
+    a = uarray.array("B", m[:4])
+    print(a)
+
+try:
+    mmap.mmap(f.fileno(), 0, offset=1000)
+except ValueError:
+    print("ValueError")
+for length, offset in ((100000, 0), (16, 8), (1, 22)):
+    try:
+        mmap.mmap(f.fileno(), length, access=mmap.ACCESS_READ, offset=offset)
+    except ValueError:
+        print("ValueError")
+
+# views exported from the mapping stay valid after close
+with mmap.mmap(f.fileno(), 0) as m:
+    mv = memoryview(m)
+print(len(mv), bytes(mv[:5]))
+mv[0] = 1
+print(mv[0])
+f.seek(0)
+print(f.read(5))
+
+# the finaliser leaves a mapping alone if a view of it may still exist
+mv = memoryview(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ))
+gc.collect()
+print(bytes(mv[:5]))
+
+# an unexported mapping is released by the finaliser
+for i in range(4):
+    mmap.mmap(f.fileno(), 0)
+gc.collect()
+
+f.close()
+uos.remove(fname)
@@ -0,0 +1,56 @@
+# test usocket traffic counters over loopback UDP sockets
+
+try:
+    import usocket as socket
+
+    socket.stats
+except (ImportError, AttributeError):
+    print("SKIP")
+    raise SystemExit
+
+addr = socket.getaddrinfo("127.0.0.1", 8124)[0][-1]
+rx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+try:
+    rx.bind(addr)
+except OSError:
+    print("SKIP")
+    raise SystemExit
+tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+# fresh sockets have all counters zero; global counters can be reset
+print(rx.stats(), tx.stats())
+socket.stats(True)
+print(socket.stats())
+
+# non-blocking receive with nothing pending counts as would-block
+rx.setblocking(False)
+try:
+    rx.recv(16)
+except OSError as er:
+    print("EAGAIN", er.errno == 11)
+print(rx.stats()[2:5])
+
+# exchange a few datagrams using the various send/receive methods
+tx.sendto(b"hello", addr)
+tx.connect(addr)
+tx.send(b"abc")
+tx.write(b"0123456789")
+rx.setblocking(True)
+print(rx.recv(16))
+print(rx.recvfrom(16)[0])
+print(rx.recv(16))
+
+bi, bo, ci, co, wb, us = tx.stats()
+print("tx", bi, bo, ci, co, wb, us >= 0)
+bi, bo, ci, co, wb, us = rx.stats()
+print("rx", bi, bo, ci, co, wb, us >= 0)
+print("global", socket.stats()[:5])
+
+# reading with reset returns the old values then clears them
+print(rx.stats(True)[:5])
+print(rx.stats())
+print(socket.stats(True)[:5])
+print(socket.stats())
+
+rx.close()
+tx.close()
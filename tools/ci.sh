@@ -277,6 +277,13 @@ CI_UNIX_OPTS_SYS_SETTRACE_STACKLESS=(
     CFLAGS_EXTRA="-DMICROPY_STACKLESS=1 -DMICROPY_STACKLESS_STRICT=1 -DMICROPY_PY_SYS_SETTRACE=1"
 )
 
+# The 32-bit coverage build tests the Pike VM regex matcher, the 64-bit one the
+# backtracker.
+CI_UNIX_OPTS_COVERAGE_32BIT=(
+    MICROPY_FORCE_32BIT=1
+    CFLAGS_EXTRA="-DMICROPY_PY_URE_PIKEVM=1"
+)
+
 function ci_unix_build_helper {
     make ${MAKEOPTS} -C mpy-cross
     make ${MAKEOPTS} -C ports/unix "$@" submodules
@@ -373,11 +380,11 @@ function ci_unix_32bit_setup {
 }
 
 function ci_unix_coverage_32bit_build {
-    ci_unix_build_helper VARIANT=coverage MICROPY_FORCE_32BIT=1
+    ci_unix_build_helper VARIANT=coverage "${CI_UNIX_OPTS_COVERAGE_32BIT[@]}"
 }
 
 function ci_unix_coverage_32bit_run_tests {
-    ci_unix_run_tests_full_helper coverage MICROPY_FORCE_32BIT=1
+    ci_unix_run_tests_full_helper coverage "${CI_UNIX_OPTS_COVERAGE_32BIT[@]}"
 }
 
 function ci_unix_coverage_32bit_run_native_mpy_tests {